@@ -0,0 +1,202 @@
+#include "asset_pack.h"
+
+#include <string.h>
+
+#define ASSET_PACK_MAGIC "GLFMPAK1"
+#define ASSET_PACK_HEADER_SIZE 24
+#define ASSET_PACK_FANOUT_SIZE (256 * 4)
+#define ASSET_PACK_ENTRY_SIZE 32
+
+static uint16_t assetPackReadU16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t assetPackReadU32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t assetPackReadU64(const uint8_t *p) {
+    return (uint64_t)assetPackReadU32(p) | ((uint64_t)assetPackReadU32(p + 4) << 32);
+}
+
+static bool assetPackInBounds(uint64_t offset, uint64_t length, size_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+uint64_t assetPackHash(const char *path) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const unsigned char *c = (const unsigned char *)path; *c; c++) {
+        hash ^= *c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// MARK: - Reading
+
+bool assetPackOpen(AssetPack *pack, const void *data, size_t size) {
+    memset(pack, 0, sizeof(AssetPack));
+    const uint8_t *bytes = data;
+    if (!bytes || size < ASSET_PACK_HEADER_SIZE + ASSET_PACK_FANOUT_SIZE ||
+        memcmp(bytes, ASSET_PACK_MAGIC, 8) != 0 || assetPackReadU32(bytes + 8) != ASSET_PACK_VERSION ||
+        assetPackReadU64(bytes + 16) != size) {
+        return false;
+    }
+    uint32_t entryCount = assetPackReadU32(bytes + 12);
+    const uint8_t *fanout = bytes + ASSET_PACK_HEADER_SIZE;
+    if (!assetPackInBounds(ASSET_PACK_HEADER_SIZE + ASSET_PACK_FANOUT_SIZE,
+                           (uint64_t)entryCount * ASSET_PACK_ENTRY_SIZE, size) ||
+        assetPackReadU32(fanout + 255 * 4) != entryCount) {
+        return false;
+    }
+    // The fan-out table is validated once here, so lookups don't need to check it
+    uint32_t previous = 0;
+    for (int i = 0; i < 256; i++) {
+        uint32_t count = assetPackReadU32(fanout + i * 4);
+        if (count < previous) {
+            return false;
+        }
+        previous = count;
+    }
+    pack->data = bytes;
+    pack->size = size;
+    pack->entryCount = entryCount;
+    pack->fanout = fanout;
+    pack->entries = fanout + ASSET_PACK_FANOUT_SIZE;
+    return true;
+}
+
+bool assetPackGetEntry(const AssetPack *pack, uint32_t index, AssetPackEntry *entry) {
+    if (!pack->data || index >= pack->entryCount) {
+        return false;
+    }
+    const uint8_t *p = pack->entries + (size_t)index * ASSET_PACK_ENTRY_SIZE;
+    uint64_t dataOffset = assetPackReadU64(p + 8);
+    uint32_t storedSize = assetPackReadU32(p + 16);
+    uint32_t size = assetPackReadU32(p + 20);
+    uint32_t nameOffset = assetPackReadU32(p + 24);
+    uint16_t nameLength = assetPackReadU16(p + 28);
+    uint8_t compression = p[30];
+    if (!assetPackInBounds(dataOffset, storedSize, pack->size) ||
+        !assetPackInBounds(nameOffset, (uint64_t)nameLength + 1, pack->size) ||
+        pack->data[nameOffset + nameLength] != 0 ||
+        compression > AssetPackCompressionLZ4 ||
+        (compression == AssetPackCompressionNone && storedSize != size)) {
+        return false;
+    }
+    entry->path = (const char *)(pack->data + nameOffset);
+    entry->data = pack->data + dataOffset;
+    entry->storedSize = storedSize;
+    entry->size = size;
+    entry->compression = (AssetPackCompression)compression;
+    return true;
+}
+
+bool assetPackFind(const AssetPack *pack, const char *path, AssetPackEntry *entry) {
+    if (!pack->data || !path) {
+        return false;
+    }
+    uint64_t hash = assetPackHash(path);
+    unsigned int bucket = (unsigned int)(hash >> 56);
+    uint32_t low = bucket == 0 ? 0 : assetPackReadU32(pack->fanout + (bucket - 1) * 4);
+    uint32_t high = assetPackReadU32(pack->fanout + bucket * 4);
+
+    // Find the first entry with the hash
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (assetPackReadU64(pack->entries + (size_t)mid * ASSET_PACK_ENTRY_SIZE) < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    // Compare paths, in case of hash collisions
+    for (uint32_t i = low; i < pack->entryCount; i++) {
+        if (assetPackReadU64(pack->entries + (size_t)i * ASSET_PACK_ENTRY_SIZE) != hash) {
+            break;
+        }
+        if (assetPackGetEntry(pack, i, entry) && strcmp(entry->path, path) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// MARK: - Decompression
+
+static bool assetPackDecompressLZ4(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstSize) {
+    const uint8_t *srcEnd = src + srcSize;
+    size_t dstPos = 0;
+    while (src < srcEnd) {
+        uint8_t token = *src++;
+
+        // Literals
+        size_t literalLength = token >> 4;
+        if (literalLength == 15) {
+            uint8_t more;
+            do {
+                if (src >= srcEnd) {
+                    return false;
+                }
+                more = *src++;
+                literalLength += more;
+            } while (more == 255);
+        }
+        if (literalLength > (size_t)(srcEnd - src) || literalLength > dstSize - dstPos) {
+            return false;
+        }
+        memcpy(dst + dstPos, src, literalLength);
+        src += literalLength;
+        dstPos += literalLength;
+        if (src == srcEnd) {
+            // The last sequence has literals only
+            break;
+        }
+
+        // Match
+        if (srcEnd - src < 2) {
+            return false;
+        }
+        size_t offset = (size_t)src[0] | ((size_t)src[1] << 8);
+        src += 2;
+        size_t matchLength = token & 0x0f;
+        if (matchLength == 15) {
+            uint8_t more;
+            do {
+                if (src >= srcEnd) {
+                    return false;
+                }
+                more = *src++;
+                matchLength += more;
+            } while (more == 255);
+        }
+        matchLength += 4;
+        if (offset == 0 || offset > dstPos || matchLength > dstSize - dstPos) {
+            return false;
+        }
+        // Byte by byte, since the match may overlap the output
+        const uint8_t *match = dst + dstPos - offset;
+        for (size_t i = 0; i < matchLength; i++) {
+            dst[dstPos + i] = match[i];
+        }
+        dstPos += matchLength;
+    }
+    return dstPos == dstSize;
+}
+
+bool assetPackDecompress(const AssetPackEntry *entry, void *dst, size_t dstSize) {
+    if (!entry || (!dst && entry->size > 0) || dstSize < entry->size) {
+        return false;
+    }
+    switch (entry->compression) {
+        case AssetPackCompressionNone:
+            if (entry->size > 0) {
+                memcpy(dst, entry->data, entry->size);
+            }
+            return true;
+        case AssetPackCompressionLZ4:
+            return assetPackDecompressLZ4(entry->data, entry->storedSize, dst, entry->size);
+        default:
+            return false;
+    }
+}
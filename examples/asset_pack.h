@@ -0,0 +1,77 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A single-file container for many small assets. Opening a pack is one glfmMapAsset() call; after that, entries are
+// found with a hash lookup and read in place, without a file open per asset. Nothing here calls OpenGL or GLFM, so
+// this file can be built and tested on any host. Packs are created with tools/asset_packer.c (see
+// asset_pack_writer.h).
+//
+// Layout (all integers little-endian):
+//
+//     Header     magic "GLFMPAK1", u32 version, u32 entryCount, u64 fileSize
+//     Fan-out    u32[256]: number of entries whose hash's top byte is <= i
+//     Entries    entryCount * 32 bytes, sorted by hash:
+//                u64 hash, u64 dataOffset, u32 storedSize, u32 size, u32 nameOffset, u16 nameLength,
+//                u8 compression, u8 reserved
+//     Names      Null-terminated UTF-8 paths
+//     Data       Each entry's data, aligned to ASSET_PACK_ALIGNMENT bytes
+//
+// The hash is 64-bit FNV-1a of the path. With the fan-out table, a lookup searches a range of about entryCount / 256
+// entries.
+//
+// Usage:
+//
+//     size_t size;
+//     const void *data = glfmMapAsset(display, "assets.pack", &size);
+//     AssetPack pack;
+//     AssetPackEntry entry;
+//     if (data && assetPackOpen(&pack, data, size) && assetPackFind(&pack, "shaders/texture.vert", &entry)) {
+//         // Use entry.data in place if uncompressed. Call glfmUnmapAsset() when the pack is no longer needed.
+//     }
+
+enum {
+    ASSET_PACK_VERSION = 1,
+    ASSET_PACK_ALIGNMENT = 16,
+};
+
+typedef enum {
+    AssetPackCompressionNone = 0,
+    AssetPackCompressionLZ4 = 1, // LZ4 block format
+} AssetPackCompression;
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    uint32_t entryCount;
+    const uint8_t *fanout;
+    const uint8_t *entries;
+} AssetPack;
+
+typedef struct {
+    const char *path;
+    const uint8_t *data; // Stored data. Use assetPackDecompress() if compressed.
+    size_t storedSize;
+    size_t size; // Uncompressed size
+    AssetPackCompression compression;
+} AssetPackEntry;
+
+// Validates the header and index. The data must outlive the pack. Returns false if the data isn't a valid pack.
+bool assetPackOpen(AssetPack *pack, const void *data, size_t size);
+
+// Finds an entry by path. Returns false if not found.
+bool assetPackFind(const AssetPack *pack, const char *path, AssetPackEntry *entry);
+
+// Gets an entry by index (in hash order), for listing a pack's contents.
+bool assetPackGetEntry(const AssetPack *pack, uint32_t index, AssetPackEntry *entry);
+
+// Copies or decompresses an entry into `dst`, which must be at least `entry->size` bytes. Uncompressed entries can be
+// used in place instead (`entry->data`). Returns false if the data is corrupt.
+bool assetPackDecompress(const AssetPackEntry *entry, void *dst, size_t dstSize);
+
+uint64_t assetPackHash(const char *path);
+
+#endif
@@ -0,0 +1,307 @@
+#include "asset_pack_writer.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ASSET_PACK_MAGIC "GLFMPAK1"
+#define ASSET_PACK_HEADER_SIZE 24
+#define ASSET_PACK_FANOUT_SIZE (256 * 4)
+#define ASSET_PACK_ENTRY_SIZE 32
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5 // The last 5 bytes are always literals
+#define LZ4_MATCH_FIND_LIMIT 12 // The last match must start at least 12 bytes before the end
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 16
+
+typedef struct {
+    char *path;
+    size_t pathLength;
+    uint64_t hash;
+    uint8_t *data;
+    size_t storedSize;
+    size_t size;
+    AssetPackCompression compression;
+} AssetPackWriterEntry;
+
+struct AssetPackWriter {
+    AssetPackWriterEntry *entries;
+    size_t entryCount;
+    size_t entryCapacity;
+};
+
+static void assetPackWriteU16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t)(value & 0xff);
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void assetPackWriteU32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(value >> (i * 8));
+    }
+}
+
+static void assetPackWriteU64(uint8_t *p, uint64_t value) {
+    assetPackWriteU32(p, (uint32_t)value);
+    assetPackWriteU32(p + 4, (uint32_t)(value >> 32));
+}
+
+static size_t assetPackAlign(size_t offset) {
+    return (offset + ASSET_PACK_ALIGNMENT - 1) & ~(size_t)(ASSET_PACK_ALIGNMENT - 1);
+}
+
+// MARK: - LZ4 compression
+
+static uint32_t assetPackRead32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Writes the extra bytes of a length that doesn't fit in a token nibble. Returns the new output position, or 0 if the
+// output is full.
+static size_t assetPackWriteLZ4Length(uint8_t *dst, size_t out, size_t capacity, size_t length) {
+    for (; length >= 255; length -= 255) {
+        if (out >= capacity) {
+            return 0;
+        }
+        dst[out++] = 255;
+    }
+    if (out >= capacity) {
+        return 0;
+    }
+    dst[out++] = (uint8_t)length;
+    return out;
+}
+
+// Writes a sequence: literals, followed by a match (unless matchLength is 0, for the last sequence).
+static size_t assetPackWriteLZ4Sequence(uint8_t *dst, size_t out, size_t capacity, const uint8_t *literals,
+                                        size_t literalLength, size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength > 0 ? matchLength - LZ4_MIN_MATCH : 0;
+    if (out >= capacity) {
+        return 0;
+    }
+    dst[out++] = (uint8_t)(((literalLength < 15 ? literalLength : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+    if (literalLength >= 15 && (out = assetPackWriteLZ4Length(dst, out, capacity, literalLength - 15)) == 0) {
+        return 0;
+    }
+    if (literalLength > capacity - out) {
+        return 0;
+    }
+    memcpy(dst + out, literals, literalLength);
+    out += literalLength;
+    if (matchLength > 0) {
+        if (capacity - out < 2) {
+            return 0;
+        }
+        dst[out++] = (uint8_t)(offset & 0xff);
+        dst[out++] = (uint8_t)(offset >> 8);
+        if (matchCode >= 15 && (out = assetPackWriteLZ4Length(dst, out, capacity, matchCode - 15)) == 0) {
+            return 0;
+        }
+    }
+    return out;
+}
+
+size_t assetPackCompressLZ4(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstCapacity) {
+    // Greedy matching with a hash table of recent 4-byte sequences. Positions are stored plus one, so 0 is empty.
+    uint32_t *table = calloc((size_t)1 << LZ4_HASH_BITS, sizeof(uint32_t));
+    if (!table || srcSize > UINT32_MAX - 1) {
+        free(table);
+        return 0;
+    }
+    size_t out = 0;
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + LZ4_MATCH_FIND_LIMIT <= srcSize) {
+        uint32_t sequence = assetPackRead32(src + pos);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+        size_t candidate = table[hash];
+        table[hash] = (uint32_t)(pos + 1);
+        if (candidate == 0 || pos - (candidate - 1) > LZ4_MAX_OFFSET ||
+            assetPackRead32(src + candidate - 1) != sequence) {
+            pos++;
+            continue;
+        }
+        size_t match = candidate - 1;
+        size_t matchLength = LZ4_MIN_MATCH;
+        size_t maxMatchLength = srcSize - LZ4_LAST_LITERALS - pos;
+        while (matchLength < maxMatchLength && src[pos + matchLength] == src[match + matchLength]) {
+            matchLength++;
+        }
+        out = assetPackWriteLZ4Sequence(dst, out, dstCapacity, src + anchor, pos - anchor, pos - match,
+                                        matchLength);
+        if (out == 0) {
+            free(table);
+            return 0;
+        }
+        pos += matchLength;
+        anchor = pos;
+    }
+    free(table);
+    return assetPackWriteLZ4Sequence(dst, out, dstCapacity, src + anchor, srcSize - anchor, 0, 0);
+}
+
+// MARK: - Writer
+
+AssetPackWriter *assetPackWriterCreate(void) {
+    return calloc(1, sizeof(AssetPackWriter));
+}
+
+void assetPackWriterDestroy(AssetPackWriter *writer) {
+    if (!writer) {
+        return;
+    }
+    for (size_t i = 0; i < writer->entryCount; i++) {
+        free(writer->entries[i].path);
+        free(writer->entries[i].data);
+    }
+    free(writer->entries);
+    free(writer);
+}
+
+bool assetPackWriterAdd(AssetPackWriter *writer, const char *path, const void *data, size_t size, bool compress) {
+    size_t pathLength = path ? strlen(path) : 0;
+    if (!writer || pathLength == 0 || pathLength > UINT16_MAX || size > UINT32_MAX || (!data && size > 0)) {
+        return false;
+    }
+    uint64_t hash = assetPackHash(path);
+    for (size_t i = 0; i < writer->entryCount; i++) {
+        if (writer->entries[i].hash == hash && strcmp(writer->entries[i].path, path) == 0) {
+            return false;
+        }
+    }
+    if (writer->entryCount == writer->entryCapacity) {
+        size_t newCapacity = writer->entryCapacity == 0 ? 64 : writer->entryCapacity * 2;
+        AssetPackWriterEntry *entries = realloc(writer->entries, sizeof(AssetPackWriterEntry) * newCapacity);
+        if (!entries) {
+            return false;
+        }
+        writer->entries = entries;
+        writer->entryCapacity = newCapacity;
+    }
+
+    AssetPackWriterEntry entry = { 0 };
+    entry.path = malloc(pathLength + 1);
+    entry.data = malloc(size > 0 ? size : 1);
+    if (!entry.path || !entry.data) {
+        free(entry.path);
+        free(entry.data);
+        return false;
+    }
+    memcpy(entry.path, path, pathLength + 1);
+    entry.pathLength = pathLength;
+    entry.hash = hash;
+    entry.size = size;
+    entry.storedSize = size;
+    entry.compression = AssetPackCompressionNone;
+    if (compress && size > 0) {
+        // Only keep the compressed data if it's worth decompressing
+        size_t capacity = size - size / 8;
+        size_t compressedSize = assetPackCompressLZ4(data, size, entry.data, capacity);
+        if (compressedSize > 0 && compressedSize < capacity) {
+            entry.storedSize = compressedSize;
+            entry.compression = AssetPackCompressionLZ4;
+        }
+    }
+    if (entry.compression == AssetPackCompressionNone && size > 0) {
+        memcpy(entry.data, data, size);
+    }
+    writer->entries[writer->entryCount++] = entry;
+    return true;
+}
+
+static int assetPackCompareEntries(const void *a, const void *b) {
+    const AssetPackWriterEntry *entryA = a;
+    const AssetPackWriterEntry *entryB = b;
+    if (entryA->hash != entryB->hash) {
+        return entryA->hash < entryB->hash ? -1 : 1;
+    }
+    return strcmp(entryA->path, entryB->path);
+}
+
+uint8_t *assetPackWriterFinish(AssetPackWriter *writer, size_t *size) {
+    if (!writer) {
+        return NULL;
+    }
+    if (writer->entryCount > 0) {
+        qsort(writer->entries, writer->entryCount, sizeof(AssetPackWriterEntry), assetPackCompareEntries);
+    }
+
+    // Layout
+    const size_t entriesOffset = ASSET_PACK_HEADER_SIZE + ASSET_PACK_FANOUT_SIZE;
+    const size_t namesOffset = entriesOffset + writer->entryCount * ASSET_PACK_ENTRY_SIZE;
+    size_t offset = namesOffset;
+    for (size_t i = 0; i < writer->entryCount; i++) {
+        offset += writer->entries[i].pathLength + 1;
+    }
+    if (offset > UINT32_MAX) {
+        return NULL;
+    }
+    for (size_t i = 0; i < writer->entryCount; i++) {
+        offset = assetPackAlign(offset) + writer->entries[i].storedSize;
+    }
+    const size_t packSize = offset;
+    uint8_t *pack = calloc(1, packSize);
+    if (!pack) {
+        return NULL;
+    }
+
+    memcpy(pack, ASSET_PACK_MAGIC, 8);
+    assetPackWriteU32(pack + 8, ASSET_PACK_VERSION);
+    assetPackWriteU32(pack + 12, (uint32_t)writer->entryCount);
+    assetPackWriteU64(pack + 16, packSize);
+
+    uint32_t counts[256] = { 0 };
+    size_t nameOffset = namesOffset;
+    size_t dataOffset = namesOffset;
+    for (size_t i = 0; i < writer->entryCount; i++) {
+        dataOffset += writer->entries[i].pathLength + 1;
+    }
+    for (size_t i = 0; i < writer->entryCount; i++) {
+        const AssetPackWriterEntry *entry = &writer->entries[i];
+        dataOffset = assetPackAlign(dataOffset);
+        uint8_t *p = pack + entriesOffset + i * ASSET_PACK_ENTRY_SIZE;
+        assetPackWriteU64(p, entry->hash);
+        assetPackWriteU64(p + 8, dataOffset);
+        assetPackWriteU32(p + 16, (uint32_t)entry->storedSize);
+        assetPackWriteU32(p + 20, (uint32_t)entry->size);
+        assetPackWriteU32(p + 24, (uint32_t)nameOffset);
+        assetPackWriteU16(p + 28, (uint16_t)entry->pathLength);
+        p[30] = (uint8_t)entry->compression;
+
+        memcpy(pack + nameOffset, entry->path, entry->pathLength + 1);
+        nameOffset += entry->pathLength + 1;
+        if (entry->storedSize > 0) {
+            memcpy(pack + dataOffset, entry->data, entry->storedSize);
+        }
+        dataOffset += entry->storedSize;
+        counts[entry->hash >> 56]++;
+    }
+    uint32_t total = 0;
+    for (int i = 0; i < 256; i++) {
+        total += counts[i];
+        assetPackWriteU32(pack + ASSET_PACK_HEADER_SIZE + i * 4, total);
+    }
+    if (size) {
+        *size = packSize;
+    }
+    return pack;
+}
+
+bool assetPackWriterSave(AssetPackWriter *writer, const char *path) {
+    size_t size = 0;
+    uint8_t *pack = assetPackWriterFinish(writer, &size);
+    if (!pack) {
+        return false;
+    }
+    FILE *file = fopen(path, "wb");
+    bool success = file && fwrite(pack, 1, size, file) == size;
+    if (file) {
+        success = (fclose(file) == 0) && success;
+    }
+    free(pack);
+    return success;
+}
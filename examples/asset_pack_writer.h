@@ -0,0 +1,28 @@
+#ifndef ASSET_PACK_WRITER_H
+#define ASSET_PACK_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "asset_pack.h"
+
+// Creates asset packs (see asset_pack.h). Used by tools/asset_packer.c; apps only need asset_pack.c.
+typedef struct AssetPackWriter AssetPackWriter;
+
+AssetPackWriter *assetPackWriterCreate(void);
+void assetPackWriterDestroy(AssetPackWriter *writer);
+
+// Adds an entry. The data is copied. If `compress` is true, the entry is stored LZ4-compressed, unless compression
+// saves less than 1/8 of its size. Returns false if the path is empty or already added, or if out of memory.
+bool assetPackWriterAdd(AssetPackWriter *writer, const char *path, const void *data, size_t size, bool compress);
+
+// Returns the pack, allocated with malloc, or NULL if out of memory.
+uint8_t *assetPackWriterFinish(AssetPackWriter *writer, size_t *size);
+
+// Writes the pack to a file. Returns false on failure.
+bool assetPackWriterSave(AssetPackWriter *writer, const char *path);
+
+// Compresses `src` into `dst` in the LZ4 block format. Returns the compressed size, or 0 if it doesn't fit in
+// `dstCapacity` bytes.
+size_t assetPackCompressLZ4(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstCapacity);
+
+#endif
@@ -0,0 +1,27 @@
+#version 100
+
+precision highp float;
+
+uniform vec3 iResolution;
+uniform float iTime;
+
+// Heavier than shader_toy.frag: several octaves of sine plasma per pixel.
+void mainImage(inout vec4 fragColor, in vec2 fragCoord) {
+    vec2 uv = (2.0 * fragCoord.xy - iResolution.xy) / min(iResolution.x, iResolution.y);
+
+    float value = 0.0;
+    float amplitude = 0.5;
+    vec2 p = uv * 2.0;
+    for (int i = 0; i < 8; i++) {
+        value += amplitude * sin(p.x + sin(p.y + iTime) + iTime * 0.5);
+        p = mat2(0.8, -0.6, 0.6, 0.8) * p * 1.7 + vec2(1.3, 0.7);
+        amplitude *= 0.6;
+    }
+    fragColor = vec4(0.5 + 0.5 * cos(value * 3.0 + vec3(0.0, 2.0, 4.0)), 1.0);
+}
+
+void main() {
+    vec4 fragColor = vec4(0, 0, 0, 1);
+    mainImage(fragColor, gl_FragCoord.xy);
+    gl_FragColor = fragColor;
+}
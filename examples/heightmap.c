@@ -1,168 +1,142 @@
-// Heightmap. Demonstrates use of a depth buffer.
+// Heightmap. Demonstrates use of a depth buffer, and a chunked terrain mesh with levels of detail.
 // Rotate: Drag.
+// Zoom: Scroll wheel.
 // Regenerate: Tap lower half of screen, or Spacebar.
 // Switch between wireframe and triangles: Tap upper half of screen, or Tab key.
+// Zoom benchmark: Long press, or B key. Frame times are printed to the console.
+//
+// The map is split into chunks, each with its own vertex buffer. Each chunk is drawn at a level of detail (LOD) based
+// on its distance from the camera, using index buffers shared by all chunks. Skirts hide cracks between chunks drawn
+// at different LODs.
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
+#include <time.h>
 #include "glfm.h"
-#if defined(__EMSCRIPTEN__)
-#include <emscripten/emscripten.h>
-#endif
+#include "heightmap_generator.h"
 
 enum {
-    MAP_SIDE_TILE_COUNT = (1 << 5), // Should be a power of 2 for generateHeightmap()
-    MAP_SIDE_VERTEX_COUNT = MAP_SIDE_TILE_COUNT + 1,
-    MAP_VERTEX_STRIDE = 6, // x, y, z, r, g, b
-    MAP_INDEX_COUNT_LINES = MAP_SIDE_TILE_COUNT * MAP_SIDE_VERTEX_COUNT * 4,
-    MAP_INDEX_COUNT = MAP_SIDE_TILE_COUNT * MAP_SIDE_TILE_COUNT * 6,
+    MAP_SIDE_TILE_COUNT = (1 << 9), // Should be a power of 2 for heightmapGenerate()
+    CHUNK_SIDE_TILE_COUNT = (1 << 5), // Should be a power of 2, and at most MAP_SIDE_TILE_COUNT
+    CHUNK_SIDE_VERTEX_COUNT = CHUNK_SIDE_TILE_COUNT + 1,
+    CHUNK_COUNT_PER_SIDE = MAP_SIDE_TILE_COUNT / CHUNK_SIDE_TILE_COUNT,
+    CHUNK_COUNT = CHUNK_COUNT_PER_SIDE * CHUNK_COUNT_PER_SIDE,
+    // Grid vertices, then one row of skirt vertices per side
+    CHUNK_SKIRT_VERTEX_START = CHUNK_SIDE_VERTEX_COUNT * CHUNK_SIDE_VERTEX_COUNT,
+    CHUNK_VERTEX_COUNT = CHUNK_SKIRT_VERTEX_START + 4 * CHUNK_SIDE_VERTEX_COUNT,
+    CHUNK_VERTEX_STRIDE = 3, // x, y, z
+    // LOD 0 is full detail. Each level halves the tiles per side, down to 2x2 tiles.
+    LOD_COUNT = 5,
+    LOD_MAX_INDEX_COUNT = (CHUNK_SIDE_TILE_COUNT * CHUNK_SIDE_TILE_COUNT + 4 * CHUNK_SIDE_TILE_COUNT) * 6,
+    BENCH_FRAME_COUNT = 300,
 };
 
+static_assert(CHUNK_VERTEX_COUNT <= 65536, "Chunk vertices must be addressable with GLushort indices");
+static_assert((CHUNK_SIDE_TILE_COUNT >> (LOD_COUNT - 1)) >= 2, "Too many LODs for the chunk size");
+
 static const float MAX_HEIGHT = 1.0f;
+static const float SKIRT_DEPTH = 0.05f;
+// Chunks closer than this (in view space) are drawn at LOD 0. The distance doubles for each LOD.
+static const float LOD_0_DISTANCE = 0.6f;
+// Zoom benchmark range (offsetZ)
+static const float BENCH_ZOOM_NEAR = 1.2f;
+static const float BENCH_ZOOM_FAR = -8.0f;
 
 typedef struct {
-    GLuint program;
     GLuint vertexBuffer;
+    float centerHeight;
+    bool needsUpload;
+} HeightmapChunk;
+
+typedef struct {
+    GLuint program;
     GLuint vertexArray;
-    GLuint indexBuffer;
-    
+    GLuint indexBuffers[2][LOD_COUNT]; // [triangleMode][lod]
+    GLsizei indexCounts[2][LOD_COUNT];
+
     GLint modelLocation;
     GLint viewProjLocation;
+    GLint shadeLocation;
 
     bool triangleMode;
-    float heightmap[MAP_SIDE_VERTEX_COUNT][MAP_SIDE_VERTEX_COUNT];
-    GLfloat vertices[MAP_VERTEX_STRIDE * MAP_SIDE_VERTEX_COUNT * MAP_SIDE_VERTEX_COUNT];
-    GLushort indices[MAP_INDEX_COUNT];
+    Heightmap heightmap;
+    uint32_t seed;
+    HeightmapChunk chunks[CHUNK_COUNT];
+    GLfloat chunkVertices[CHUNK_VERTEX_STRIDE * CHUNK_VERTEX_COUNT];
+    GLushort indices[LOD_MAX_INDEX_COUNT];
 
     double touchStartTime;
+    double touchStartX;
+    double touchStartY;
     double lastTouchX;
     double lastTouchY;
     double angleX;
     double angleY;
     float offsetZ;
 
+    // Zoom benchmark. benchFrame is -1 when not running.
+    int benchFrame;
+    double benchLastFrameTime;
+    double benchTotalFrameTime;
+    double benchMaxFrameTime;
+    float benchSavedOffsetZ;
+    long benchLODChunkCounts[LOD_COUNT];
+    long benchTriangleCount;
+    int benchUploadCount;
+
     bool needsRegeneration;
-    bool needsRenderModeChange;
     bool needsRedraw;
 } HeightmapApp;
 
-static float randRange(float min, float max) {
-#if defined(__EMSCRIPTEN__)
-    float p = emscripten_random();
-#else
-    float p = (float)((double)arc4random() / UINT32_MAX);
-#endif
-    return p * (max - min) + min;
-}
-
-static void heightmapGenerateDiamondSquare(HeightmapApp *app, float range, size_t level) {
-    if (level < 2) {
+static void startBenchmark(HeightmapApp *app) {
+    if (app->benchFrame >= 0) {
         return;
     }
-
-    // Diamonds
-    for (size_t z = level; z < MAP_SIDE_VERTEX_COUNT; z += level) {
-        for (size_t x = level; x < MAP_SIDE_VERTEX_COUNT; x += level) {
-            float a = app->heightmap[x - level][z - level];
-            float b = app->heightmap[x][z - level];
-            float c = app->heightmap[x - level][z];
-            float d = app->heightmap[x][z];
-            float avg = (a + b + c + d) / 4.0f;
-
-            float offset = randRange(-range, range);
-            app->heightmap[x - (level + 1) / 2][z - (level + 1) / 2] = avg + offset;
-        }
-    }
-
-    // Edge (x == 0)
-    for (size_t z = level; z < MAP_SIDE_VERTEX_COUNT; z += level) {
-        float a = app->heightmap[0][z - level];
-        float b = app->heightmap[level/2][z - level/2];
-        float c = app->heightmap[0][z];
-        float avg = (a + b + c) / 3.0f;
-
-        float offset = randRange(-range, range);
-        app->heightmap[0][z - level/2] = avg + offset;
-    }
-
-    // Edge (x == MAP_SIDE_TILE_COUNT)
-    for (size_t z = level; z < MAP_SIDE_VERTEX_COUNT; z += level) {
-        float a = app->heightmap[MAP_SIDE_TILE_COUNT][z - level];
-        float b = app->heightmap[MAP_SIDE_TILE_COUNT - level/2][z - level/2];
-        float c = app->heightmap[MAP_SIDE_TILE_COUNT][z];
-        float avg = (a + b + c) / 3.0f;
-
-        float offset = randRange(-range, range);
-        app->heightmap[MAP_SIDE_TILE_COUNT][z - level/2] = avg + offset;
-    }
-
-    // Edge (z == 0)
-    for (size_t x = level; x < MAP_SIDE_VERTEX_COUNT; x += level) {
-        float a = app->heightmap[x - level][0];
-        float b = app->heightmap[x - level/2][level/2];
-        float c = app->heightmap[x][0];
-        float avg = (a + b + c) / 3.0f;
-
-        float offset = randRange(-range, range);
-        app->heightmap[x - level/2][0] = avg + offset;
-    }
-
-    // Edge (z == MAP_SIDE_TILE_COUNT)
-    for (size_t x = level; x < MAP_SIDE_VERTEX_COUNT; x += level) {
-        float a = app->heightmap[x - level][MAP_SIDE_TILE_COUNT];
-        float b = app->heightmap[x - level/2][MAP_SIDE_TILE_COUNT - level/2];
-        float c = app->heightmap[x][MAP_SIDE_TILE_COUNT];
-        float avg = (a + b + c) / 3.0f;
-
-        float offset = randRange(-range, range);
-        app->heightmap[x - level/2][MAP_SIDE_TILE_COUNT] = avg + offset;
+    app->benchFrame = 0;
+    app->benchLastFrameTime = 0.0;
+    app->benchTotalFrameTime = 0.0;
+    app->benchMaxFrameTime = 0.0;
+    app->benchSavedOffsetZ = app->offsetZ;
+    for (int lod = 0; lod < LOD_COUNT; lod++) {
+        app->benchLODChunkCounts[lod] = 0;
     }
+    app->benchTriangleCount = 0;
+    app->benchUploadCount = 0;
+}
 
-    // Squares (odd x)
-    for (size_t z = 3 * level / 2; z < MAP_SIDE_VERTEX_COUNT; z += level) {
-        for (size_t x = level; x < MAP_SIDE_VERTEX_COUNT; x += level) {
-            float a = app->heightmap[x - level / 2][z - level];
-            float b = app->heightmap[x - level][z - level / 2];
-            float c = app->heightmap[x - level / 2][z];
-            float d = app->heightmap[x][z - level / 2];
-            float avg = (a + b + c + d) / 4.0f;
-
-            float offset = randRange(-range, range);
-            app->heightmap[x - level / 2][z - level / 2] = avg + offset;
+static void updateBenchmark(HeightmapApp *app) {
+    // Frame time is measured between render calls, so it includes waiting for the swap.
+    double now = glfmGetTime();
+    if (app->benchFrame > 0) {
+        double frameTime = now - app->benchLastFrameTime;
+        app->benchTotalFrameTime += frameTime;
+        if (frameTime > app->benchMaxFrameTime) {
+            app->benchMaxFrameTime = frameTime;
         }
     }
-
-    // Squares (even x)
-    for (size_t z = level; z < MAP_SIDE_VERTEX_COUNT; z += level) {
-        for (size_t x = 3 * level / 2; x < MAP_SIDE_VERTEX_COUNT; x += level) {
-            float a = app->heightmap[x - level / 2][z - level];
-            float b = app->heightmap[x - level][z - level / 2];
-            float c = app->heightmap[x - level / 2][z];
-            float d = app->heightmap[x][z - level / 2];
-            float avg = (a + b + c + d) / 4.0f;
-
-            float offset = randRange(-range, range);
-            app->heightmap[x - level / 2][z - level / 2] = avg + offset;
+    app->benchLastFrameTime = now;
+
+    if (app->benchFrame == BENCH_FRAME_COUNT) {
+        int measuredFrames = BENCH_FRAME_COUNT;
+        printf("Zoom benchmark: %i frames, avg %.2f ms, max %.2f ms, %ld triangles/frame, %i chunk uploads\n",
+               measuredFrames, 1000.0 * app->benchTotalFrameTime / measuredFrames, 1000.0 * app->benchMaxFrameTime,
+               app->benchTriangleCount / BENCH_FRAME_COUNT, app->benchUploadCount);
+        for (int lod = 0; lod < LOD_COUNT; lod++) {
+            printf("  LOD %i: %.1f chunks/frame\n", lod, (double)app->benchLODChunkCounts[lod] / BENCH_FRAME_COUNT);
         }
+        app->offsetZ = app->benchSavedOffsetZ;
+        app->benchFrame = -1;
+    } else {
+        // Zoom from near to far, so every chunk passes through every LOD
+        float t = (float)app->benchFrame / (float)(BENCH_FRAME_COUNT - 1);
+        app->offsetZ = BENCH_ZOOM_NEAR + (BENCH_ZOOM_FAR - BENCH_ZOOM_NEAR) * t;
+        app->benchFrame++;
     }
-
-    heightmapGenerateDiamondSquare(app, range / 2.0f, level / 2);
 }
 
-static void heightmapGenerate(HeightmapApp *app) {
-    memset(app->heightmap, 0, sizeof(app->heightmap));
-
-    // Corners
-    float maxCorner = MAX_HEIGHT / 8;
-    app->heightmap[0][0] = randRange(-maxCorner, maxCorner);
-    app->heightmap[0][MAP_SIDE_TILE_COUNT] = randRange(-maxCorner, maxCorner);
-    app->heightmap[MAP_SIDE_TILE_COUNT][0] = randRange(-maxCorner, maxCorner);
-    app->heightmap[MAP_SIDE_TILE_COUNT][MAP_SIDE_TILE_COUNT] = randRange(-maxCorner, maxCorner);
-
-    // Generate
-    heightmapGenerateDiamondSquare(app, MAX_HEIGHT / 2, MAP_SIDE_TILE_COUNT);
+static bool dispatchJob(void *dispatchData, void (*job)(void *jobData), void *jobData) {
+    return glfmDispatchAsync((GLFMDisplay *)dispatchData, job, NULL, jobData);
 }
 
 static bool onTouch(GLFMDisplay *display, int touch, GLFMTouchPhase phase, double x, double y) {
@@ -172,18 +146,24 @@ static bool onTouch(GLFMDisplay *display, int touch, GLFMTouchPhase phase, doubl
     HeightmapApp *app = glfmGetUserData(display);
     if (phase == GLFMTouchPhaseBegan) {
         app->touchStartTime = glfmGetTime();
+        app->touchStartX = x;
+        app->touchStartY = y;
     } else {
         int width, height;
         glfmGetDisplaySize(display, &width, &height);
         app->angleX += (x - app->lastTouchX) / height;
         app->angleY += (y - app->lastTouchY) / height;
 
-        if (phase == GLFMTouchPhaseEnded && glfmGetTime() - app->touchStartTime <= 0.2) {
-            if (y > height / 2) {
-                app->needsRegeneration = true;
-            } else {
-                app->triangleMode = !app->triangleMode;
-                app->needsRenderModeChange = true;
+        if (phase == GLFMTouchPhaseEnded) {
+            double duration = glfmGetTime() - app->touchStartTime;
+            if (duration <= 0.2) {
+                if (y > height / 2) {
+                    app->needsRegeneration = true;
+                } else {
+                    app->triangleMode = !app->triangleMode;
+                }
+            } else if (duration >= 0.8 && fabs(x - app->touchStartX) + fabs(y - app->touchStartY) < height / 20) {
+                startBenchmark(app);
             }
         }
     }
@@ -222,7 +202,10 @@ static bool onKey(GLFMDisplay *display, GLFMKeyCode keyCode, GLFMKeyAction actio
         switch (keyCode) {
             case GLFMKeyCodeTab:
                 app->triangleMode = !app->triangleMode;
-                app->needsRenderModeChange = true;
+                handled = true;
+                break;
+            case GLFMKeyCodeB:
+                startBenchmark(app);
                 handled = true;
                 break;
             case GLFMKeyCodeSpace:
@@ -275,9 +258,16 @@ static void onSurfaceDestroyed(GLFMDisplay *display) {
     // When the surface is destroyed, all existing GL resources are no longer valid.
     HeightmapApp *app = glfmGetUserData(display);
     app->program = 0;
-    app->vertexBuffer = 0;
     app->vertexArray = 0;
-    app->indexBuffer = 0;
+    for (int mode = 0; mode < 2; mode++) {
+        for (int lod = 0; lod < LOD_COUNT; lod++) {
+            app->indexBuffers[mode][lod] = 0;
+        }
+    }
+    for (int i = 0; i < CHUNK_COUNT; i++) {
+        app->chunks[i].vertexBuffer = 0;
+        app->chunks[i].needsUpload = true;
+    }
     printf("Goodbye\n");
 }
 
@@ -308,19 +298,163 @@ static GLuint compileShader(GLenum type, const GLchar *shaderSource) {
     return shader;
 }
 
-static void draw(HeightmapApp *app, int width, int height) {
+static void createIndexBuffers(HeightmapApp *app) {
+    for (int mode = 0; mode < 2; mode++) {
+        bool triangleMode = mode == 1;
+        for (int lod = 0; lod < LOD_COUNT; lod++) {
+            const GLushort step = (GLushort)(1 << lod);
+            const GLushort tileCount = (GLushort)(CHUNK_SIDE_TILE_COUNT >> lod);
+            size_t i = 0;
+            if (triangleMode) {
+                for (GLushort tz = 0; tz < tileCount; tz++) {
+                    for (GLushort tx = 0; tx < tileCount; tx++) {
+                        GLushort index = (GLushort)(tz * step * CHUNK_SIDE_VERTEX_COUNT + tx * step);
+                        GLushort right = step;
+                        GLushort down = (GLushort)(step * CHUNK_SIDE_VERTEX_COUNT);
+                        app->indices[i++] = index;
+                        app->indices[i++] = index + right;
+                        app->indices[i++] = index + right + down;
+                        app->indices[i++] = index;
+                        app->indices[i++] = index + right + down;
+                        app->indices[i++] = index + down;
+                    }
+                }
+                // Skirts: sides are z == 0, z == max, x == 0, x == max
+                for (GLushort side = 0; side < 4; side++) {
+                    GLushort skirt = (GLushort)(CHUNK_SKIRT_VERTEX_START + side * CHUNK_SIDE_VERTEX_COUNT);
+                    for (GLushort t = 0; t < tileCount; t++) {
+                        GLushort k0 = (GLushort)(t * step);
+                        GLushort k1 = (GLushort)(k0 + step);
+                        GLushort a, b;
+                        switch (side) {
+                            case 0: default:
+                                a = k0;
+                                b = k1;
+                                break;
+                            case 1:
+                                a = (GLushort)(CHUNK_SIDE_TILE_COUNT * CHUNK_SIDE_VERTEX_COUNT + k0);
+                                b = (GLushort)(CHUNK_SIDE_TILE_COUNT * CHUNK_SIDE_VERTEX_COUNT + k1);
+                                break;
+                            case 2:
+                                a = (GLushort)(k0 * CHUNK_SIDE_VERTEX_COUNT);
+                                b = (GLushort)(k1 * CHUNK_SIDE_VERTEX_COUNT);
+                                break;
+                            case 3:
+                                a = (GLushort)(k0 * CHUNK_SIDE_VERTEX_COUNT + CHUNK_SIDE_TILE_COUNT);
+                                b = (GLushort)(k1 * CHUNK_SIDE_VERTEX_COUNT + CHUNK_SIDE_TILE_COUNT);
+                                break;
+                        }
+                        app->indices[i++] = a;
+                        app->indices[i++] = b;
+                        app->indices[i++] = skirt + k1;
+                        app->indices[i++] = a;
+                        app->indices[i++] = skirt + k1;
+                        app->indices[i++] = skirt + k0;
+                    }
+                }
+            } else { // line mode
+                for (GLushort k = 0; k <= CHUNK_SIDE_TILE_COUNT; k += step) {
+                    for (GLushort t = 0; t < tileCount; t++) {
+                        // Along x, then along z
+                        app->indices[i++] = (GLushort)(k * CHUNK_SIDE_VERTEX_COUNT + t * step);
+                        app->indices[i++] = (GLushort)(k * CHUNK_SIDE_VERTEX_COUNT + (t + 1) * step);
+                        app->indices[i++] = (GLushort)(t * step * CHUNK_SIDE_VERTEX_COUNT + k);
+                        app->indices[i++] = (GLushort)((t + 1) * step * CHUNK_SIDE_VERTEX_COUNT + k);
+                    }
+                }
+            }
+            assert(i <= LOD_MAX_INDEX_COUNT);
+            glGenBuffers(1, &app->indexBuffers[mode][lod]);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, app->indexBuffers[mode][lod]);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(sizeof(app->indices[0]) * i), app->indices,
+                         GL_STATIC_DRAW);
+            app->indexCounts[mode][lod] = (GLsizei)i;
+        }
+    }
+}
+
+static void uploadChunk(HeightmapApp *app, int chunkX, int chunkZ) {
+    HeightmapChunk *chunk = &app->chunks[chunkZ * CHUNK_COUNT_PER_SIDE + chunkX];
+    const int mapX = chunkX * CHUNK_SIDE_TILE_COUNT;
+    const int mapZ = chunkZ * CHUNK_SIDE_TILE_COUNT;
+    const int mapStride = app->heightmap.sideVertexCount;
+    const float *heights = app->heightmap.heights;
+    GLfloat *vertex = app->chunkVertices;
+
+    // Grid
+    for (int z = 0; z < CHUNK_SIDE_VERTEX_COUNT; z++) {
+        const float *row = heights + (mapZ + z) * mapStride + mapX;
+        float posZ = 2.0f * (float)(mapZ + z) / (float)MAP_SIDE_TILE_COUNT - 1.0f;
+        for (int x = 0; x < CHUNK_SIDE_VERTEX_COUNT; x++) {
+            vertex[0] = 2.0f * (float)(mapX + x) / (float)MAP_SIDE_TILE_COUNT - 1.0f;
+            vertex[1] = row[x];
+            vertex[2] = posZ;
+            vertex += CHUNK_VERTEX_STRIDE;
+        }
+    }
+
+    // Skirts, in the same side order as the skirt indices
+    for (int side = 0; side < 4; side++) {
+        for (int k = 0; k < CHUNK_SIDE_VERTEX_COUNT; k++) {
+            int x, z;
+            switch (side) {
+                case 0: default: x = k; z = 0; break;
+                case 1: x = k; z = CHUNK_SIDE_TILE_COUNT; break;
+                case 2: x = 0; z = k; break;
+                case 3: x = CHUNK_SIDE_TILE_COUNT; z = k; break;
+            }
+            const GLfloat *top = app->chunkVertices + (z * CHUNK_SIDE_VERTEX_COUNT + x) * CHUNK_VERTEX_STRIDE;
+            vertex[0] = top[0];
+            vertex[1] = top[1] - SKIRT_DEPTH;
+            vertex[2] = top[2];
+            vertex += CHUNK_VERTEX_STRIDE;
+        }
+    }
+    int center = CHUNK_SIDE_TILE_COUNT / 2;
+    chunk->centerHeight = heights[(mapZ + center) * mapStride + mapX + center];
+
+    // Allocate once, then update in place
+    if (chunk->vertexBuffer == 0) {
+        glGenBuffers(1, &chunk->vertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk->vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(app->chunkVertices), app->chunkVertices, GL_DYNAMIC_DRAW);
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, chunk->vertexBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(app->chunkVertices), app->chunkVertices);
+    }
+    chunk->needsUpload = false;
+}
+
+static int chunkLOD(const GLfloat model[16], float x, float y, float z) {
+    const float chunkSize = 2.0f * (float)CHUNK_SIDE_TILE_COUNT / (float)MAP_SIDE_TILE_COUNT;
+    float ex = model[0] * x + model[4] * y + model[8] * z + model[12];
+    float ey = model[1] * x + model[5] * y + model[9] * z + model[13];
+    float ez = model[2] * x + model[6] * y + model[10] * z + model[14];
+    float distance = sqrtf(ex * ex + ey * ey + ez * ez) - chunkSize * 0.7071f;
+    int lod = 0;
+    float lodDistance = LOD_0_DISTANCE;
+    while (lod < LOD_COUNT - 1 && distance > lodDistance) {
+        lod++;
+        lodDistance *= 2.0f;
+    }
+    return lod;
+}
+
+static void draw(GLFMDisplay *display, HeightmapApp *app, int width, int height) {
     // Create shader
     if (app->program == 0) {
+        // The color is based on height (MAX_HEIGHT is 1.0) in triangle mode, and white in line mode.
         const GLchar vertexShader[] =
             "#version 100\n"
             "uniform mat4 model;\n"
             "uniform mat4 viewProj;\n"
+            "uniform lowp float shade;\n"
             "attribute highp vec3 a_position;\n"
-            "attribute lowp vec3 a_color;\n"
             "varying lowp vec4 v_color;\n"
             "void main() {\n"
             "   gl_Position = (viewProj * model) * vec4(a_position, 1.0);\n"
-            "   v_color = vec4(a_color, 1.0);\n"
+            "   lowp float c = mix(1.0, (a_position.y + 1.0) * 0.5, shade);\n"
+            "   v_color = vec4(c, c, c, 1.0);\n"
             "}";
 
         const GLchar fragmentShader[] =
@@ -341,7 +475,6 @@ static void draw(HeightmapApp *app, int width, int height) {
         glAttachShader(app->program, fragShader);
 
         glBindAttribLocation(app->program, 0, "a_position");
-        glBindAttribLocation(app->program, 1, "a_color");
 
         glLinkProgram(app->program);
 
@@ -350,79 +483,34 @@ static void draw(HeightmapApp *app, int width, int height) {
 
         app->modelLocation = glGetUniformLocation(app->program, "model");
         app->viewProjLocation = glGetUniformLocation(app->program, "viewProj");
+        app->shadeLocation = glGetUniformLocation(app->program, "shade");
     }
 
-    // Fill vertex and index buffers
-    if (app->needsRegeneration || app->vertexBuffer == 0) {
-        heightmapGenerate(app);
+    // Index buffers are shared by all chunks, and don't change with the heightmap
+    if (app->indexBuffers[0][0] == 0) {
+        createIndexBuffers(app);
     }
-    if (app->needsRegeneration || app->needsRenderModeChange || app->vertexBuffer == 0 || app->indexBuffer == 0) {
-        // Generate vertices
-        size_t i = 0;
-        for (size_t z = 0; z < MAP_SIDE_VERTEX_COUNT; z++) {
-            for (size_t x = 0; x < MAP_SIDE_VERTEX_COUNT; x++) {
-                float y = app->heightmap[x][z];
-                float color = app->triangleMode ? (y + MAX_HEIGHT) / (2.0f * MAX_HEIGHT) : 1.0f;
-                app->vertices[i + 0] = 2.0f * (float)x / (float)MAP_SIDE_TILE_COUNT - 1.0f;
-                app->vertices[i + 1] = y;
-                app->vertices[i + 2] = 2.0f * (float)z / (float)MAP_SIDE_TILE_COUNT - 1.0f;
-                app->vertices[i + 3] = color;
-                app->vertices[i + 4] = color;
-                app->vertices[i + 5] = color;
-                i += 6;
-            }
-        }
-        if (app->vertexBuffer == 0) {
-            glGenBuffers(1, &app->vertexBuffer);
-        }
-        glBindBuffer(GL_ARRAY_BUFFER, app->vertexBuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(app->vertices), app->vertices, GL_STATIC_DRAW);
 
-        // Generate index buffer
-        if (app->indexBuffer == 0) {
-            glGenBuffers(1, &app->indexBuffer);
+    // Regenerate, and upload only the chunks that changed
+    if (app->needsRegeneration) {
+        app->needsRegeneration = false;
+        app->seed++;
+        const HeightmapDispatcher dispatcher = { dispatchJob, display, glfmGetWorkerCount(display) };
+        heightmapGenerate(&app->heightmap, app->seed, MAX_HEIGHT, &dispatcher);
+        for (int i = 0; i < CHUNK_COUNT; i++) {
+            app->chunks[i].needsUpload = true;
         }
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, app->indexBuffer);
-        if (app->triangleMode) {
-            size_t i = 0;
-            for (GLuint z = 0; z < MAP_SIDE_TILE_COUNT; z++) {
-                GLuint index = z * MAP_SIDE_VERTEX_COUNT;
-                for (GLuint x = 0; x < MAP_SIDE_TILE_COUNT; x++) {
-                    app->indices[i++] = index + 0;
-                    app->indices[i++] = index + 1;
-                    app->indices[i++] = index + 1 + MAP_SIDE_VERTEX_COUNT;
-                    app->indices[i++] = index + 0;
-                    app->indices[i++] = index + 1 + MAP_SIDE_VERTEX_COUNT;
-                    app->indices[i++] = index + 0 + MAP_SIDE_VERTEX_COUNT;
-                    index++;
-                }
-            }
-            assert(i == MAP_INDEX_COUNT);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(app->indices[0]) * MAP_INDEX_COUNT, app->indices, GL_STATIC_DRAW);
-        } else { // line mode
-            size_t i = 0;
-            for (GLuint z = 0; z < MAP_SIDE_TILE_COUNT; z++) {
-                GLuint index = z * MAP_SIDE_VERTEX_COUNT;
-                for (GLuint x = 0; x < MAP_SIDE_TILE_COUNT; x++) {
-                    app->indices[i++] = index + x;
-                    app->indices[i++] = index + x + 1;
-                    app->indices[i++] = index + x;
-                    app->indices[i++] = index + x + MAP_SIDE_VERTEX_COUNT;
+    }
+    for (int chunkZ = 0; chunkZ < CHUNK_COUNT_PER_SIDE; chunkZ++) {
+        for (int chunkX = 0; chunkX < CHUNK_COUNT_PER_SIDE; chunkX++) {
+            if (app->chunks[chunkZ * CHUNK_COUNT_PER_SIDE + chunkX].needsUpload) {
+                uploadChunk(app, chunkX, chunkZ);
+                if (app->benchFrame >= 0) {
+                    app->benchUploadCount++;
                 }
-                app->indices[i++] = index + MAP_SIDE_TILE_COUNT;
-                app->indices[i++] = index + MAP_SIDE_TILE_COUNT + MAP_SIDE_VERTEX_COUNT;
-            }
-            GLuint index = MAP_SIDE_TILE_COUNT * MAP_SIDE_VERTEX_COUNT;
-            for (GLuint z = 0; z < MAP_SIDE_TILE_COUNT; z++) {
-                app->indices[i++] = index + z;
-                app->indices[i++] = index + z + 1;
             }
-            assert(i == MAP_INDEX_COUNT_LINES);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(app->indices[0]) * MAP_INDEX_COUNT_LINES, app->indices, GL_STATIC_DRAW);
         }
     }
-    app->needsRenderModeChange = false;
-    app->needsRegeneration = false;
 
     // Upload matrices
     float rx, ry;
@@ -456,13 +544,14 @@ static void draw(HeightmapApp *app, int width, int height) {
     glUseProgram(app->program);
     glUniformMatrix4fv(app->modelLocation, 1, GL_FALSE, model);
     glUniformMatrix4fv(app->viewProjLocation, 1, GL_FALSE, viewProj);
+    glUniform1f(app->shadeLocation, app->triangleMode ? 1.0f : 0.0f);
 
     // Draw background
     glViewport(0, 0, width, height);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Draw heightmap
+    // Draw heightmap, one chunk at a time
     glEnable(GL_DEPTH_TEST);
 #if defined(GL_VERSION_3_0) && GL_VERSION_3_0
     if (app->vertexArray == 0) {
@@ -470,34 +559,63 @@ static void draw(HeightmapApp *app, int width, int height) {
     }
     glBindVertexArray(app->vertexArray);
 #endif
-    glBindBuffer(GL_ARRAY_BUFFER, app->vertexBuffer);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * MAP_VERTEX_STRIDE, (void *)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * MAP_VERTEX_STRIDE, (void *)(sizeof(GLfloat) * 3));
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, app->indexBuffer);
-    if (app->triangleMode) {
-        glDrawElements(GL_TRIANGLES, MAP_INDEX_COUNT, GL_UNSIGNED_SHORT, (void *)0);
-    } else {
-        glDrawElements(GL_LINES, MAP_INDEX_COUNT_LINES, GL_UNSIGNED_SHORT, (void *)0);
+    const int mode = app->triangleMode ? 1 : 0;
+    const GLenum primitive = app->triangleMode ? GL_TRIANGLES : GL_LINES;
+    int boundLOD = -1;
+    for (int chunkZ = 0; chunkZ < CHUNK_COUNT_PER_SIDE; chunkZ++) {
+        for (int chunkX = 0; chunkX < CHUNK_COUNT_PER_SIDE; chunkX++) {
+            const HeightmapChunk *chunk = &app->chunks[chunkZ * CHUNK_COUNT_PER_SIDE + chunkX];
+            float centerX = 2.0f * ((float)chunkX + 0.5f) / (float)CHUNK_COUNT_PER_SIDE - 1.0f;
+            float centerZ = 2.0f * ((float)chunkZ + 0.5f) / (float)CHUNK_COUNT_PER_SIDE - 1.0f;
+            int lod = chunkLOD(model, centerX, chunk->centerHeight, centerZ);
+            if (lod != boundLOD) {
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, app->indexBuffers[mode][lod]);
+                boundLOD = lod;
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, chunk->vertexBuffer);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * CHUNK_VERTEX_STRIDE, (void *)0);
+            glDrawElements(primitive, app->indexCounts[mode][lod], GL_UNSIGNED_SHORT, (void *)0);
+
+            if (app->benchFrame >= 0) {
+                app->benchLODChunkCounts[lod]++;
+                if (app->triangleMode) {
+                    app->benchTriangleCount += app->indexCounts[mode][lod] / 3;
+                }
+            }
+        }
     }
 }
 
 static void onDraw(GLFMDisplay *display) {
     HeightmapApp *app = glfmGetUserData(display);
+    if (app->benchFrame >= 0) {
+        updateBenchmark(app);
+        app->needsRedraw = true;
+    }
     if (app->needsRedraw) {
         app->needsRedraw = false;
 
         int width, height;
         glfmGetDisplaySize(display, &width, &height);
-        draw(app, width,  height);
+        draw(display, app, width, height);
         glfmSwapBuffers(display);
     }
 }
 
 void glfmMain(GLFMDisplay *display) {
     HeightmapApp *app = calloc(1, sizeof(HeightmapApp));
+    if (!heightmapInit(&app->heightmap, MAP_SIDE_TILE_COUNT)) {
+        printf("Couldn't allocate heightmap\n");
+        free(app);
+        return;
+    }
+    app->seed = (uint32_t)time(NULL);
+    app->benchFrame = -1;
+    app->needsRegeneration = true;
+    for (int i = 0; i < CHUNK_COUNT; i++) {
+        app->chunks[i].needsUpload = true;
+    }
     glfmSetDisplayConfig(display,
                          GLFMRenderingAPIOpenGLES2,
                          GLFMColorFormatRGBA8888,
@@ -0,0 +1,162 @@
+// Heightmap generator benchmark. Measures samples per second for maps up to 4096x4096, generated on the render
+// thread only and then split across worker threads. Results are printed to the console.
+// The screen is red while the benchmark runs, and green when finished. See tests/host for a version that runs without a
+// display.
+// Run again: Tap, or Spacebar.
+//
+// On Emscripten, the generator only uses worker threads when built with -pthread.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "glfm.h"
+#include "heightmap_generator.h"
+
+#define BENCH_MIN_DURATION 0.25
+
+static const int BENCH_SIZES[] = { 256, 1024, 4096 };
+#define BENCH_SIZE_COUNT ((int)(sizeof(BENCH_SIZES) / sizeof(BENCH_SIZES[0])))
+
+typedef enum {
+    BenchStateIdle,
+    BenchStateStart,
+    BenchStateRunning,
+} BenchState;
+
+typedef struct {
+    BenchState state;
+    int sizeIndex;
+    bool needsRedraw;
+} BenchApp;
+
+static uint32_t heightmapChecksum(const Heightmap *heightmap) {
+    uint32_t checksum = 0;
+    size_t count = (size_t)heightmap->sideVertexCount * (size_t)heightmap->sideVertexCount;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits;
+        memcpy(&bits, &heightmap->heights[i], sizeof(bits));
+        checksum = (checksum ^ bits) * 16777619u;
+    }
+    return checksum;
+}
+
+static bool dispatchJob(void *dispatchData, void (*job)(void *jobData), void *jobData) {
+    return glfmDispatchAsync((GLFMDisplay *)dispatchData, job, NULL, jobData);
+}
+
+// Returns millions of samples per second. Generates at least once, and repeats until BENCH_MIN_DURATION has passed.
+static double runGenerator(Heightmap *heightmap, const HeightmapDispatcher *dispatcher, uint32_t *checksum) {
+    double sampleCount = (double)heightmap->sideVertexCount * (double)heightmap->sideVertexCount;
+    double startTime = glfmGetTime();
+    double duration;
+    int iterations = 0;
+    do {
+        heightmapGenerate(heightmap, 1, 1.0f, dispatcher);
+        iterations++;
+        duration = glfmGetTime() - startTime;
+    } while (duration < BENCH_MIN_DURATION);
+    *checksum = heightmapChecksum(heightmap);
+    return duration > 0.0 ? (sampleCount * iterations / duration) / 1000000.0 : 0.0;
+}
+
+static void runSize(GLFMDisplay *display, int sideTileCount) {
+    Heightmap heightmap;
+    if (!heightmapInit(&heightmap, sideTileCount)) {
+        printf("%ix%i: Couldn't allocate heightmap\n", sideTileCount, sideTileCount);
+        return;
+    }
+    const HeightmapDispatcher dispatcher = { dispatchJob, display, glfmGetWorkerCount(display) };
+    uint32_t serialChecksum, parallelChecksum;
+    double serial = runGenerator(&heightmap, NULL, &serialChecksum);
+    double parallel = runGenerator(&heightmap, &dispatcher, &parallelChecksum);
+    printf("%ix%i: %.1f Msamples/s serial, %.1f Msamples/s parallel (%.2fx)%s\n",
+           sideTileCount, sideTileCount, serial, parallel, serial > 0.0 ? parallel / serial : 0.0,
+           serialChecksum == parallelChecksum ? "" : " MISMATCH");
+    heightmapFree(&heightmap);
+}
+
+static void updateBenchmark(GLFMDisplay *display, BenchApp *app) {
+    switch (app->state) {
+        case BenchStateIdle: default:
+            break;
+        case BenchStateStart:
+            // Let the red screen show before the first (slow) frame
+            printf("Workers: %i\n", glfmGetWorkerCount(display));
+            app->sizeIndex = 0;
+            app->state = BenchStateRunning;
+            break;
+        case BenchStateRunning:
+            runSize(display, BENCH_SIZES[app->sizeIndex]);
+            app->sizeIndex++;
+            if (app->sizeIndex == BENCH_SIZE_COUNT) {
+                app->state = BenchStateIdle;
+                app->needsRedraw = true;
+            }
+            break;
+    }
+}
+
+static bool onTouch(GLFMDisplay *display, int touch, GLFMTouchPhase phase, double x, double y) {
+    BenchApp *app = glfmGetUserData(display);
+    if (phase == GLFMTouchPhaseEnded && app->state == BenchStateIdle) {
+        app->state = BenchStateStart;
+        app->needsRedraw = true;
+        return true;
+    }
+    return false;
+}
+
+static bool onKey(GLFMDisplay *display, GLFMKeyCode keyCode, GLFMKeyAction action, int modifiers) {
+    BenchApp *app = glfmGetUserData(display);
+    if (action == GLFMKeyActionPressed && keyCode == GLFMKeyCodeSpace && app->state == BenchStateIdle) {
+        app->state = BenchStateStart;
+        app->needsRedraw = true;
+        return true;
+    }
+    return false;
+}
+
+static void onSurfaceRefresh(GLFMDisplay *display) {
+    BenchApp *app = glfmGetUserData(display);
+    app->needsRedraw = true;
+}
+
+static void onDraw(GLFMDisplay *display) {
+    BenchApp *app = glfmGetUserData(display);
+    bool running = app->state != BenchStateIdle;
+    if (running) {
+        updateBenchmark(display, app);
+    }
+    if (app->needsRedraw) {
+        app->needsRedraw = false;
+
+        int width, height;
+        glfmGetDisplaySize(display, &width, &height);
+        glViewport(0, 0, width, height);
+        if (running) {
+            glClearColor(0.6f, 0.1f, 0.1f, 1.0f);
+        } else {
+            glClearColor(0.1f, 0.5f, 0.1f, 1.0f);
+        }
+        glClear(GL_COLOR_BUFFER_BIT);
+        glfmSwapBuffers(display);
+    }
+}
+
+void glfmMain(GLFMDisplay *display) {
+    BenchApp *app = calloc(1, sizeof(BenchApp));
+    app->state = BenchStateStart;
+    app->needsRedraw = true;
+
+    glfmSetDisplayConfig(display,
+                         GLFMRenderingAPIOpenGLES2,
+                         GLFMColorFormatRGBA8888,
+                         GLFMDepthFormatNone,
+                         GLFMStencilFormatNone,
+                         GLFMMultisampleNone);
+    glfmSetUserData(display, app);
+    glfmSetSurfaceRefreshFunc(display, onSurfaceRefresh);
+    glfmSetRenderFunc(display, onDraw);
+    glfmSetTouchFunc(display, onTouch);
+    glfmSetKeyFunc(display, onKey);
+}
@@ -0,0 +1,244 @@
+#include "heightmap_generator.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Passes with fewer samples than this run on the calling thread only.
+#define HEIGHTMAP_MIN_PARALLEL_SAMPLES (1 << 16)
+
+typedef struct {
+    Heightmap *heightmap;
+    uint32_t seed;
+    float range;
+    int step;
+    bool diamond;
+    int rowCount;
+} HeightmapPass;
+
+// A pass split across jobs. Shared by the calling thread and the jobs, and freed by whichever releases it last, so the
+// calling thread doesn't have to wait for jobs that haven't started yet.
+typedef struct {
+    HeightmapPass pass;
+    atomic_int refCount;
+    atomic_int nextRow;
+    pthread_mutex_t mutex;
+    pthread_cond_t finishedCond;
+    int finishedRowCount; // Guarded by mutex
+} HeightmapSharedPass;
+
+// MARK: - Noise
+
+// Counter-based hash ("lowbias32"). Each sample is hashed from its index, so rows can be generated in any order, on
+// any thread, and the loops below have no dependency between iterations.
+static inline float heightmapNoise(uint32_t seed, uint32_t index) {
+    uint32_t x = index * 0x9e3779b9u ^ seed;
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    // Top 24 bits to [-1, 1)
+    return (float)(x >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+// MARK: - Rows
+
+// Diamond step: the center of each square is the average of its four corners.
+static void heightmapDiamondRow(const HeightmapPass *pass, int z) {
+    const int stride = pass->heightmap->sideVertexCount;
+    const int half = pass->step / 2;
+    const int step = pass->step;
+    const int count = pass->heightmap->sideTileCount / step;
+    const uint32_t seed = pass->seed;
+    const float range = pass->range;
+    const float *restrict above = pass->heightmap->heights + (z - half) * stride;
+    const float *restrict below = pass->heightmap->heights + (z + half) * stride;
+    float *restrict row = pass->heightmap->heights + z * stride;
+    const uint32_t rowIndex = (uint32_t)(z * stride);
+
+    for (int i = 0; i < count; i++) {
+        int x = half + i * step;
+        float avg = (above[x - half] + above[x + half] + below[x - half] + below[x + half]) * 0.25f;
+        row[x] = avg + range * heightmapNoise(seed, rowIndex + (uint32_t)x);
+    }
+}
+
+// Square step: each edge midpoint is the average of its neighbors (three on the map edges, four elsewhere).
+static void heightmapSquareRow(const HeightmapPass *pass, int z) {
+    const int stride = pass->heightmap->sideVertexCount;
+    const int sideTileCount = pass->heightmap->sideTileCount;
+    const int half = pass->step / 2;
+    const int step = pass->step;
+    const uint32_t seed = pass->seed;
+    const float range = pass->range;
+    const float *above = z > 0 ? pass->heightmap->heights + (z - half) * stride : NULL;
+    const float *below = z < sideTileCount ? pass->heightmap->heights + (z + half) * stride : NULL;
+    float *row = pass->heightmap->heights + z * stride;
+    const uint32_t rowIndex = (uint32_t)(z * stride);
+
+    if ((z / half) % 2 == 0) {
+        // Row of corners: midpoints between corners, with left and right neighbors in this row
+        const int count = sideTileCount / step;
+        if (above && below) {
+            for (int i = 0; i < count; i++) {
+                int x = half + i * step;
+                float avg = (row[x - half] + row[x + half] + above[x] + below[x]) * 0.25f;
+                row[x] = avg + range * heightmapNoise(seed, rowIndex + (uint32_t)x);
+            }
+        } else {
+            const float *other = above ? above : below;
+            for (int i = 0; i < count; i++) {
+                int x = half + i * step;
+                float avg = (row[x - half] + row[x + half] + other[x]) * (1.0f / 3.0f);
+                row[x] = avg + range * heightmapNoise(seed, rowIndex + (uint32_t)x);
+            }
+        }
+    } else {
+        // Row of diamond centers: midpoints between corners, with above and below neighbors
+        const int count = sideTileCount / step;
+        row[0] = (above[0] + below[0] + row[half]) * (1.0f / 3.0f) + range * heightmapNoise(seed, rowIndex);
+        for (int i = 1; i < count; i++) {
+            int x = i * step;
+            float avg = (row[x - half] + row[x + half] + above[x] + below[x]) * 0.25f;
+            row[x] = avg + range * heightmapNoise(seed, rowIndex + (uint32_t)x);
+        }
+        int x = sideTileCount;
+        row[x] = ((above[x] + below[x] + row[x - half]) * (1.0f / 3.0f) +
+                  range * heightmapNoise(seed, rowIndex + (uint32_t)x));
+    }
+}
+
+// MARK: - Passes
+
+static void heightmapPassRow(const HeightmapPass *pass, int r) {
+    if (pass->diamond) {
+        heightmapDiamondRow(pass, pass->step / 2 + r * pass->step);
+    } else {
+        heightmapSquareRow(pass, r * (pass->step / 2));
+    }
+}
+
+static void heightmapSharedPassRun(HeightmapSharedPass *shared) {
+    int finishedRowCount = 0;
+    while (true) {
+        int r = atomic_fetch_add_explicit(&shared->nextRow, 1, memory_order_relaxed);
+        if (r >= shared->pass.rowCount) {
+            break;
+        }
+        heightmapPassRow(&shared->pass, r);
+        finishedRowCount++;
+    }
+    if (finishedRowCount > 0) {
+        pthread_mutex_lock(&shared->mutex);
+        shared->finishedRowCount += finishedRowCount;
+        if (shared->finishedRowCount == shared->pass.rowCount) {
+            pthread_cond_signal(&shared->finishedCond);
+        }
+        pthread_mutex_unlock(&shared->mutex);
+    }
+}
+
+static void heightmapSharedPassRelease(HeightmapSharedPass *shared) {
+    if (atomic_fetch_sub_explicit(&shared->refCount, 1, memory_order_acq_rel) == 1) {
+        pthread_cond_destroy(&shared->finishedCond);
+        pthread_mutex_destroy(&shared->mutex);
+        free(shared);
+    }
+}
+
+static void heightmapPassJob(void *jobData) {
+    HeightmapSharedPass *shared = jobData;
+    heightmapSharedPassRun(shared);
+    heightmapSharedPassRelease(shared);
+}
+
+static void heightmapPass(Heightmap *heightmap, const HeightmapDispatcher *dispatcher, uint32_t seed, float range,
+                          int step, bool diamond) {
+    HeightmapPass pass;
+    pass.heightmap = heightmap;
+    pass.seed = seed;
+    pass.range = range;
+    pass.step = step;
+    pass.diamond = diamond;
+    pass.rowCount = diamond ? heightmap->sideTileCount / step : 2 * heightmap->sideTileCount / step + 1;
+
+    int jobCount = 0;
+    int sampleCount = pass.rowCount * (heightmap->sideTileCount / step);
+    if (dispatcher && dispatcher->dispatch && sampleCount >= HEIGHTMAP_MIN_PARALLEL_SAMPLES) {
+        jobCount = dispatcher->workerCount;
+        if (jobCount > pass.rowCount - 1) {
+            jobCount = pass.rowCount - 1;
+        }
+    }
+    HeightmapSharedPass *shared = jobCount > 0 ? malloc(sizeof(HeightmapSharedPass)) : NULL;
+    if (!shared) {
+        for (int r = 0; r < pass.rowCount; r++) {
+            heightmapPassRow(&pass, r);
+        }
+        return;
+    }
+
+    shared->pass = pass;
+    atomic_init(&shared->refCount, 1 + jobCount);
+    atomic_init(&shared->nextRow, 0);
+    pthread_mutex_init(&shared->mutex, NULL);
+    pthread_cond_init(&shared->finishedCond, NULL);
+    shared->finishedRowCount = 0;
+    for (int i = 0; i < jobCount; i++) {
+        if (!dispatcher->dispatch(dispatcher->dispatchData, heightmapPassJob, shared)) {
+            atomic_fetch_sub_explicit(&shared->refCount, 1, memory_order_relaxed);
+        }
+    }
+
+    // Work on this thread too, then wait for rows that jobs are still working on.
+    heightmapSharedPassRun(shared);
+    pthread_mutex_lock(&shared->mutex);
+    while (shared->finishedRowCount < pass.rowCount) {
+        pthread_cond_wait(&shared->finishedCond, &shared->mutex);
+    }
+    pthread_mutex_unlock(&shared->mutex);
+    heightmapSharedPassRelease(shared);
+}
+
+// MARK: - Public
+
+bool heightmapInit(Heightmap *heightmap, int sideTileCount) {
+    if (!heightmap || sideTileCount < 2 || (sideTileCount & (sideTileCount - 1)) != 0) {
+        return false;
+    }
+    size_t sideVertexCount = (size_t)sideTileCount + 1;
+    heightmap->heights = malloc(sizeof(float) * sideVertexCount * sideVertexCount);
+    if (!heightmap->heights) {
+        return false;
+    }
+    heightmap->sideTileCount = sideTileCount;
+    heightmap->sideVertexCount = (int)sideVertexCount;
+    return true;
+}
+
+void heightmapFree(Heightmap *heightmap) {
+    if (heightmap) {
+        free(heightmap->heights);
+        heightmap->heights = NULL;
+        heightmap->sideTileCount = 0;
+        heightmap->sideVertexCount = 0;
+    }
+}
+
+void heightmapGenerate(Heightmap *heightmap, uint32_t seed, float maxHeight, const HeightmapDispatcher *dispatcher) {
+    // Every sample is written exactly once, so there's no need to clear the map first.
+    const int n = heightmap->sideTileCount;
+    const int stride = heightmap->sideVertexCount;
+    const uint32_t corners[4] = { 0, (uint32_t)n, (uint32_t)(n * stride), (uint32_t)(n * stride + n) };
+    for (int i = 0; i < 4; i++) {
+        heightmap->heights[corners[i]] = (maxHeight / 8.0f) * heightmapNoise(seed, corners[i]);
+    }
+
+    float range = maxHeight / 2.0f;
+    for (int step = n; step >= 2; step /= 2) {
+        heightmapPass(heightmap, dispatcher, seed, range, step, true);
+        heightmapPass(heightmap, dispatcher, seed, range, step, false);
+        range /= 2.0f;
+    }
+}
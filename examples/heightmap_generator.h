@@ -0,0 +1,43 @@
+#ifndef HEIGHTMAP_GENERATOR_H
+#define HEIGHTMAP_GENERATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// A square heightmap generated with the diamond-square algorithm.
+///
+/// Heights are stored row-major: the height at (x, z) is `heights[z * sideVertexCount + x]`.
+typedef struct {
+    int sideTileCount; // A power of 2
+    int sideVertexCount; // sideTileCount + 1
+    float *heights;
+} Heightmap;
+
+/// Allocates a heightmap. The `sideTileCount` must be a power of 2. Returns `false` on failure.
+bool heightmapInit(Heightmap *heightmap, int sideTileCount);
+
+/// Frees a heightmap allocated with `heightmapInit`.
+void heightmapFree(Heightmap *heightmap);
+
+/// Runs `job(jobData)` asynchronously, for example with `glfmDispatchAsync`. Returns `false` if the job couldn't be
+/// dispatched.
+typedef bool (*HeightmapDispatchFunc)(void *dispatchData, void (*job)(void *jobData), void *jobData);
+
+/// Splits generation across worker threads.
+typedef struct {
+    HeightmapDispatchFunc dispatch;
+    void *dispatchData;
+    int workerCount; // The maximum number of jobs per pass
+} HeightmapDispatcher;
+
+/// Generates heights in the range (-maxHeight, maxHeight).
+///
+/// The result only depends on the `seed`, so the same seed generates the same terrain regardless of thread count.
+/// If `dispatcher` is not `NULL`, large passes are split into jobs. The calling thread works on each pass too, and
+/// only waits for rows that jobs have already started. Jobs that start after a pass is finished return immediately.
+///
+/// Must not be called from a job: the calling thread would do most of the work while the jobs it dispatched wait in
+/// the queue behind it.
+void heightmapGenerate(Heightmap *heightmap, uint32_t seed, float maxHeight, const HeightmapDispatcher *dispatcher);
+
+#endif
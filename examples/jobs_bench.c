@@ -0,0 +1,182 @@
+// Job system throughput benchmark. Measures jobs per second with glfmDispatchAsync(), compared to running the same
+// jobs serially on the render thread. Results are printed to the console.
+// The screen is red while the benchmark runs, and green when finished.
+// Run again: Tap, or Spacebar.
+//
+// On Emscripten, jobs only run on worker threads when built with -pthread.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "glfm.h"
+
+enum {
+    JOB_COUNT = 4096,
+    SMALL_JOB_ITERATIONS = 16,
+    LARGE_JOB_ITERATIONS = 1 << 16,
+};
+
+typedef enum {
+    BenchStateIdle,
+    BenchStateStart,
+    BenchStateSmallJobs,
+    BenchStateLargeJobs,
+} BenchState;
+
+typedef struct {
+    uint32_t iterations;
+    uint32_t seed;
+    uint32_t result;
+} BenchJob;
+
+typedef struct {
+    BenchState state;
+    BenchJob jobs[JOB_COUNT];
+    int completedCount;
+    double startTime;
+    double serialSmallJobsPerSecond;
+    double serialLargeJobsPerSecond;
+    double parallelSmallJobsPerSecond;
+    bool needsRedraw;
+} BenchApp;
+
+static void runJob(void *userData) {
+    // Busy work that can't be optimized away (xorshift)
+    BenchJob *job = userData;
+    uint32_t x = job->seed;
+    for (uint32_t i = 0; i < job->iterations; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+    job->result = x;
+}
+
+static void onJobComplete(GLFMDisplay *display, void *userData) {
+    (void)userData;
+    BenchApp *app = glfmGetUserData(display);
+    app->completedCount++;
+}
+
+static void dispatchJobs(GLFMDisplay *display, BenchApp *app, uint32_t iterations) {
+    app->completedCount = 0;
+    app->startTime = glfmGetTime();
+    for (int i = 0; i < JOB_COUNT; i++) {
+        app->jobs[i].iterations = iterations;
+        app->jobs[i].seed = (uint32_t)i + 1;
+        if (!glfmDispatchAsync(display, runJob, onJobComplete, &app->jobs[i])) {
+            printf("Couldn't dispatch job %i\n", i);
+            app->completedCount++;
+        }
+    }
+}
+
+static double runSerial(BenchApp *app, uint32_t iterations) {
+    double startTime = glfmGetTime();
+    for (int i = 0; i < JOB_COUNT; i++) {
+        app->jobs[i].iterations = iterations;
+        app->jobs[i].seed = (uint32_t)i + 1;
+        runJob(&app->jobs[i]);
+    }
+    double duration = glfmGetTime() - startTime;
+    return duration > 0.0 ? JOB_COUNT / duration : 0.0;
+}
+
+static void updateBenchmark(GLFMDisplay *display, BenchApp *app) {
+    switch (app->state) {
+        case BenchStateIdle: default:
+            break;
+        case BenchStateStart:
+            printf("Workers: %i\n", glfmGetWorkerCount(display));
+            app->serialSmallJobsPerSecond = runSerial(app, SMALL_JOB_ITERATIONS);
+            app->serialLargeJobsPerSecond = runSerial(app, LARGE_JOB_ITERATIONS);
+            dispatchJobs(display, app, SMALL_JOB_ITERATIONS);
+            app->state = BenchStateSmallJobs;
+            break;
+        case BenchStateSmallJobs:
+            if (app->completedCount == JOB_COUNT) {
+                // Includes the latency of waiting for the next frame
+                app->parallelSmallJobsPerSecond = JOB_COUNT / (glfmGetTime() - app->startTime);
+                dispatchJobs(display, app, LARGE_JOB_ITERATIONS);
+                app->state = BenchStateLargeJobs;
+            }
+            break;
+        case BenchStateLargeJobs:
+            if (app->completedCount == JOB_COUNT) {
+                double parallelLargeJobsPerSecond = JOB_COUNT / (glfmGetTime() - app->startTime);
+                printf("Small jobs: %.0f jobs/s serial, %.0f jobs/s dispatched\n",
+                       app->serialSmallJobsPerSecond, app->parallelSmallJobsPerSecond);
+                printf("Large jobs: %.0f jobs/s serial, %.0f jobs/s dispatched (%.2fx)\n",
+                       app->serialLargeJobsPerSecond, parallelLargeJobsPerSecond,
+                       app->serialLargeJobsPerSecond > 0.0 ?
+                       parallelLargeJobsPerSecond / app->serialLargeJobsPerSecond : 0.0);
+                app->state = BenchStateIdle;
+                app->needsRedraw = true;
+            }
+            break;
+    }
+}
+
+static bool onTouch(GLFMDisplay *display, int touch, GLFMTouchPhase phase, double x, double y) {
+    BenchApp *app = glfmGetUserData(display);
+    if (phase == GLFMTouchPhaseEnded && app->state == BenchStateIdle) {
+        app->state = BenchStateStart;
+        app->needsRedraw = true;
+        return true;
+    }
+    return false;
+}
+
+static bool onKey(GLFMDisplay *display, GLFMKeyCode keyCode, GLFMKeyAction action, int modifiers) {
+    BenchApp *app = glfmGetUserData(display);
+    if (action == GLFMKeyActionPressed && keyCode == GLFMKeyCodeSpace && app->state == BenchStateIdle) {
+        app->state = BenchStateStart;
+        app->needsRedraw = true;
+        return true;
+    }
+    return false;
+}
+
+static void onSurfaceRefresh(GLFMDisplay *display) {
+    BenchApp *app = glfmGetUserData(display);
+    app->needsRedraw = true;
+}
+
+static void onDraw(GLFMDisplay *display) {
+    BenchApp *app = glfmGetUserData(display);
+    bool running = app->state != BenchStateIdle;
+    if (running) {
+        updateBenchmark(display, app);
+    }
+    if (app->needsRedraw) {
+        app->needsRedraw = false;
+
+        int width, height;
+        glfmGetDisplaySize(display, &width, &height);
+        glViewport(0, 0, width, height);
+        if (running) {
+            glClearColor(0.6f, 0.1f, 0.1f, 1.0f);
+        } else {
+            glClearColor(0.1f, 0.5f, 0.1f, 1.0f);
+        }
+        glClear(GL_COLOR_BUFFER_BIT);
+        glfmSwapBuffers(display);
+    }
+}
+
+void glfmMain(GLFMDisplay *display) {
+    BenchApp *app = calloc(1, sizeof(BenchApp));
+    app->state = BenchStateStart;
+    app->needsRedraw = true;
+
+    glfmSetDisplayConfig(display,
+                         GLFMRenderingAPIOpenGLES2,
+                         GLFMColorFormatRGBA8888,
+                         GLFMDepthFormatNone,
+                         GLFMStencilFormatNone,
+                         GLFMMultisampleNone);
+    glfmSetUserData(display, app);
+    glfmSetSurfaceRefreshFunc(display, onSurfaceRefresh);
+    glfmSetRenderFunc(display, onDraw);
+    glfmSetTouchFunc(display, onTouch);
+    glfmSetKeyFunc(display, onKey);
+}
@@ -0,0 +1,271 @@
+#include "ktx2.h"
+
+#include <string.h>
+
+#define KTX2_HEADER_SIZE 80
+#define KTX2_LEVEL_INDEX_ENTRY_SIZE 24
+
+static const uint8_t KTX2_IDENTIFIER[12] = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+
+// MARK: - Formats
+
+#define KTX2_ASTC(vkFormat, index, width, height) \
+    { vkFormat, 0x93B0 + (index), Ktx2FamilyASTC, Ktx2RequirementASTC, width, height, 16 }, \
+    { (vkFormat) + 1, 0x93D0 + (index), Ktx2FamilyASTC, Ktx2RequirementASTC, width, height, 16 }
+
+// VkFormat values, with the matching OpenGL ES (or extension) internal formats.
+static const Ktx2Format KTX2_FORMATS[] = {
+    { 37, 0x8058, Ktx2FamilyUncompressed, Ktx2RequirementNone, 1, 1, 4 },          // R8G8B8A8_UNORM, GL_RGBA8
+    { 43, 0x8C43, Ktx2FamilyUncompressed, Ktx2RequirementOpenGLES3, 1, 1, 4 },     // R8G8B8A8_SRGB, GL_SRGB8_ALPHA8
+
+    { 131, 0x83F0, Ktx2FamilyBC, Ktx2RequirementS3TC, 4, 4, 8 },      // BC1_RGB_UNORM, GL_COMPRESSED_RGB_S3TC_DXT1
+    { 132, 0x8C4C, Ktx2FamilyBC, Ktx2RequirementS3TCSRGB, 4, 4, 8 },  // BC1_RGB_SRGB
+    { 133, 0x83F1, Ktx2FamilyBC, Ktx2RequirementS3TC, 4, 4, 8 },      // BC1_RGBA_UNORM
+    { 134, 0x8C4D, Ktx2FamilyBC, Ktx2RequirementS3TCSRGB, 4, 4, 8 },  // BC1_RGBA_SRGB
+    { 135, 0x83F2, Ktx2FamilyBC, Ktx2RequirementS3TC, 4, 4, 16 },     // BC2_UNORM, GL_COMPRESSED_RGBA_S3TC_DXT3
+    { 136, 0x8C4E, Ktx2FamilyBC, Ktx2RequirementS3TCSRGB, 4, 4, 16 }, // BC2_SRGB
+    { 137, 0x83F3, Ktx2FamilyBC, Ktx2RequirementS3TC, 4, 4, 16 },     // BC3_UNORM, GL_COMPRESSED_RGBA_S3TC_DXT5
+    { 138, 0x8C4F, Ktx2FamilyBC, Ktx2RequirementS3TCSRGB, 4, 4, 16 }, // BC3_SRGB
+    { 139, 0x8DBB, Ktx2FamilyBC, Ktx2RequirementRGTC, 4, 4, 8 },      // BC4_UNORM, GL_COMPRESSED_RED_RGTC1
+    { 140, 0x8DBC, Ktx2FamilyBC, Ktx2RequirementRGTC, 4, 4, 8 },      // BC4_SNORM
+    { 141, 0x8DBD, Ktx2FamilyBC, Ktx2RequirementRGTC, 4, 4, 16 },     // BC5_UNORM, GL_COMPRESSED_RG_RGTC2
+    { 142, 0x8DBE, Ktx2FamilyBC, Ktx2RequirementRGTC, 4, 4, 16 },     // BC5_SNORM
+    { 143, 0x8E8F, Ktx2FamilyBC, Ktx2RequirementBPTC, 4, 4, 16 },     // BC6H_UFLOAT, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT
+    { 144, 0x8E8E, Ktx2FamilyBC, Ktx2RequirementBPTC, 4, 4, 16 },     // BC6H_SFLOAT
+    { 145, 0x8E8C, Ktx2FamilyBC, Ktx2RequirementBPTC, 4, 4, 16 },     // BC7_UNORM, GL_COMPRESSED_RGBA_BPTC_UNORM
+    { 146, 0x8E8D, Ktx2FamilyBC, Ktx2RequirementBPTC, 4, 4, 16 },     // BC7_SRGB
+
+    { 147, 0x9274, Ktx2FamilyETC2, Ktx2RequirementETC2, 4, 4, 8 },    // ETC2_R8G8B8_UNORM, GL_COMPRESSED_RGB8_ETC2
+    { 148, 0x9275, Ktx2FamilyETC2, Ktx2RequirementETC2, 4, 4, 8 },    // ETC2_R8G8B8_SRGB
+    { 149, 0x9276, Ktx2FamilyETC2, Ktx2RequirementETC2, 4, 4, 8 },    // ETC2_R8G8B8A1_UNORM
+    { 150, 0x9277, Ktx2FamilyETC2, Ktx2RequirementETC2, 4, 4, 8 },    // ETC2_R8G8B8A1_SRGB
+    { 151, 0x9278, Ktx2FamilyETC2, Ktx2RequirementETC2, 4, 4, 16 },   // ETC2_R8G8B8A8_UNORM, GL_COMPRESSED_RGBA8_ETC2_EAC
+    { 152, 0x9279, Ktx2FamilyETC2, Ktx2RequirementETC2, 4, 4, 16 },   // ETC2_R8G8B8A8_SRGB
+    { 153, 0x9270, Ktx2FamilyETC2, Ktx2RequirementETC2, 4, 4, 8 },    // EAC_R11_UNORM, GL_COMPRESSED_R11_EAC
+    { 154, 0x9271, Ktx2FamilyETC2, Ktx2RequirementETC2, 4, 4, 8 },    // EAC_R11_SNORM
+    { 155, 0x9272, Ktx2FamilyETC2, Ktx2RequirementETC2, 4, 4, 16 },   // EAC_R11G11_UNORM, GL_COMPRESSED_RG11_EAC
+    { 156, 0x9273, Ktx2FamilyETC2, Ktx2RequirementETC2, 4, 4, 16 },   // EAC_R11G11_SNORM
+
+    // ASTC LDR: UNORM and SRGB pairs, GL_COMPRESSED_RGBA_ASTC_*_KHR and GL_COMPRESSED_SRGB8_ALPHA8_ASTC_*_KHR
+    KTX2_ASTC(157, 0, 4, 4),
+    KTX2_ASTC(159, 1, 5, 4),
+    KTX2_ASTC(161, 2, 5, 5),
+    KTX2_ASTC(163, 3, 6, 5),
+    KTX2_ASTC(165, 4, 6, 6),
+    KTX2_ASTC(167, 5, 8, 5),
+    KTX2_ASTC(169, 6, 8, 6),
+    KTX2_ASTC(171, 7, 8, 8),
+    KTX2_ASTC(173, 8, 10, 5),
+    KTX2_ASTC(175, 9, 10, 6),
+    KTX2_ASTC(177, 10, 10, 8),
+    KTX2_ASTC(179, 11, 10, 10),
+    KTX2_ASTC(181, 12, 12, 10),
+    KTX2_ASTC(183, 13, 12, 12),
+};
+
+#define KTX2_FORMAT_COUNT (sizeof(KTX2_FORMATS) / sizeof(KTX2_FORMATS[0]))
+
+const Ktx2Format *ktx2GetFormat(uint32_t vkFormat) {
+    for (size_t i = 0; i < KTX2_FORMAT_COUNT; i++) {
+        if (KTX2_FORMATS[i].vkFormat == vkFormat) {
+            return &KTX2_FORMATS[i];
+        }
+    }
+    return NULL;
+}
+
+size_t ktx2GetLevelSize(const Ktx2Format *format, uint32_t width, uint32_t height) {
+    size_t blocksX = (width + format->blockWidth - 1) / format->blockWidth;
+    size_t blocksY = (height + format->blockHeight - 1) / format->blockHeight;
+    return blocksX * blocksY * format->blockSize;
+}
+
+// MARK: - Parsing
+
+static uint32_t ktx2ReadU32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t ktx2ReadU64(const uint8_t *p) {
+    return (uint64_t)ktx2ReadU32(p) | ((uint64_t)ktx2ReadU32(p + 4) << 32);
+}
+
+// Returns true if [offset, offset + length) is inside a file of `size` bytes.
+static bool ktx2InBounds(uint64_t offset, uint64_t length, size_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+Ktx2Result ktx2Parse(const uint8_t *data, size_t size, Ktx2Texture *texture) {
+    memset(texture, 0, sizeof(Ktx2Texture));
+    if (!data || size < KTX2_HEADER_SIZE) {
+        return data && size >= sizeof(KTX2_IDENTIFIER) ? Ktx2ResultTruncated : Ktx2ResultInvalid;
+    }
+    if (memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        return Ktx2ResultInvalid;
+    }
+
+    uint32_t vkFormat = ktx2ReadU32(data + 12);
+    uint32_t pixelWidth = ktx2ReadU32(data + 20);
+    uint32_t pixelHeight = ktx2ReadU32(data + 24);
+    uint32_t pixelDepth = ktx2ReadU32(data + 28);
+    uint32_t layerCount = ktx2ReadU32(data + 32);
+    uint32_t faceCount = ktx2ReadU32(data + 36);
+    uint32_t levelCount = ktx2ReadU32(data + 40);
+    uint32_t supercompressionScheme = ktx2ReadU32(data + 44);
+    uint32_t dfdByteOffset = ktx2ReadU32(data + 48);
+    uint32_t dfdByteLength = ktx2ReadU32(data + 52);
+
+    if (supercompressionScheme != 0) {
+        return Ktx2ResultSupercompressed;
+    }
+    const Ktx2Format *format = ktx2GetFormat(vkFormat);
+    if (!format) {
+        return Ktx2ResultUnsupportedFormat;
+    }
+    if (pixelWidth == 0) {
+        return Ktx2ResultInvalid;
+    }
+    if (pixelHeight == 0 || pixelDepth != 0 || layerCount > 1 || faceCount != 1) {
+        // 1D, 3D, array, or cube map
+        return Ktx2ResultUnsupportedLayout;
+    }
+
+    // A level count of 0 means the app may generate mipmaps. Only the base level is stored, and it's used as is.
+    uint32_t storedLevelCount = levelCount == 0 ? 1 : levelCount;
+    uint32_t maxLevelCount = 1;
+    for (uint32_t n = pixelWidth > pixelHeight ? pixelWidth : pixelHeight; n > 1; n >>= 1) {
+        maxLevelCount++;
+    }
+    if (storedLevelCount > maxLevelCount) {
+        return Ktx2ResultInvalid;
+    }
+    if (storedLevelCount > KTX2_MAX_LEVELS) {
+        return Ktx2ResultUnsupportedLayout;
+    }
+    if (!ktx2InBounds(KTX2_HEADER_SIZE, (uint64_t)storedLevelCount * KTX2_LEVEL_INDEX_ENTRY_SIZE, size) ||
+        !ktx2InBounds(dfdByteOffset, dfdByteLength, size)) {
+        return Ktx2ResultTruncated;
+    }
+
+    for (uint32_t i = 0; i < storedLevelCount; i++) {
+        const uint8_t *entry = data + KTX2_HEADER_SIZE + i * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+        uint64_t byteOffset = ktx2ReadU64(entry);
+        uint64_t byteLength = ktx2ReadU64(entry + 8);
+        uint32_t width = pixelWidth >> i ? pixelWidth >> i : 1;
+        uint32_t height = pixelHeight >> i ? pixelHeight >> i : 1;
+        if (byteLength != ktx2GetLevelSize(format, width, height)) {
+            return Ktx2ResultInvalid;
+        }
+        if (!ktx2InBounds(byteOffset, byteLength, size)) {
+            return Ktx2ResultTruncated;
+        }
+        Ktx2Level *level = &texture->levels[i];
+        level->width = width;
+        level->height = height;
+        level->data = data + byteOffset;
+        level->size = (size_t)byteLength;
+    }
+
+    texture->format = format;
+    texture->width = pixelWidth;
+    texture->height = pixelHeight;
+    texture->levelCount = storedLevelCount;
+    return Ktx2ResultOK;
+}
+
+const char *ktx2ResultString(Ktx2Result result) {
+    switch (result) {
+        case Ktx2ResultOK:
+            return "OK";
+        case Ktx2ResultInvalid: default:
+            return "Invalid KTX2 file";
+        case Ktx2ResultTruncated:
+            return "Truncated KTX2 file";
+        case Ktx2ResultUnsupportedFormat:
+            return "Unsupported format";
+        case Ktx2ResultUnsupportedLayout:
+            return "Unsupported layout (only 2D textures are supported)";
+        case Ktx2ResultSupercompressed:
+            return "Supercompression is not supported";
+    }
+}
+
+// MARK: - Upload scheduling
+
+void ktx2UploadCursorInit(Ktx2UploadCursor *cursor, const Ktx2Texture *texture, bool splitLevels) {
+    cursor->texture = texture;
+    cursor->splitLevels = splitLevels;
+    cursor->level = texture->levelCount - 1;
+    cursor->blockRow = 0;
+    cursor->complete = texture->levelCount == 0;
+}
+
+// Gets the next chunk that fits in the budget. If `force` is true, the smallest possible chunk is returned even if it
+// doesn't fit.
+static bool ktx2UploadCursorNext(Ktx2UploadCursor *cursor, size_t budget, bool force, Ktx2UploadChunk *chunk) {
+    const Ktx2Format *format = cursor->texture->format;
+    const Ktx2Level *level = &cursor->texture->levels[cursor->level];
+    const uint32_t blockRowCount = (level->height + format->blockHeight - 1) / format->blockHeight;
+    const size_t rowSize = level->size / blockRowCount;
+    const uint32_t remainingRows = blockRowCount - cursor->blockRow;
+
+    uint32_t rows;
+    if (cursor->splitLevels) {
+        size_t fit = budget / rowSize;
+        rows = fit >= remainingRows ? remainingRows : (uint32_t)fit;
+        if (rows == 0 && force) {
+            rows = 1;
+        }
+    } else {
+        rows = (level->size <= budget || force) ? remainingRows : 0;
+    }
+    if (rows == 0) {
+        return false;
+    }
+
+    chunk->level = cursor->level;
+    chunk->y = cursor->blockRow * format->blockHeight;
+    chunk->width = level->width;
+    chunk->height = (cursor->blockRow + rows == blockRowCount) ? level->height - chunk->y : rows * format->blockHeight;
+    chunk->data = level->data + cursor->blockRow * rowSize;
+    chunk->size = rows * rowSize;
+    chunk->levelComplete = cursor->blockRow + rows == blockRowCount;
+    chunk->textureComplete = chunk->levelComplete && cursor->level == 0;
+
+    if (chunk->textureComplete) {
+        cursor->complete = true;
+    } else if (chunk->levelComplete) {
+        cursor->level--;
+        cursor->blockRow = 0;
+    } else {
+        cursor->blockRow += rows;
+    }
+    return true;
+}
+
+size_t ktx2ScheduleUploads(Ktx2UploadCursor *const *cursors, int cursorCount, size_t byteBudget,
+                           Ktx2UploadFunc uploadFunc, void *userData) {
+    size_t scheduled = 0;
+    for (int i = 0; i < cursorCount; i++) {
+        Ktx2UploadCursor *cursor = cursors[i];
+        if (!cursor || cursor->complete) {
+            continue;
+        }
+        Ktx2UploadChunk chunk;
+        while (!cursor->complete) {
+            size_t budget = scheduled < byteBudget ? byteBudget - scheduled : 0;
+            if (!ktx2UploadCursorNext(cursor, budget, scheduled == 0, &chunk)) {
+                // Doesn't fit. A later texture's smaller level might.
+                break;
+            }
+            uploadFunc(userData, cursor, &chunk);
+            scheduled += chunk.size;
+        }
+        if (scheduled >= byteBudget) {
+            break;
+        }
+    }
+    return scheduled;
+}
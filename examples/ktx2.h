@@ -0,0 +1,115 @@
+#ifndef KTX2_H
+#define KTX2_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// KTX2 container parser and mip level upload scheduler. Nothing here calls OpenGL or GLFM, so this file can be built
+// and tested on any host. See texture_loader.h for the OpenGL side.
+//
+// Only 2D textures without supercompression are supported (no arrays, cube maps, or Basis Universal).
+
+enum {
+    KTX2_MAX_LEVELS = 16,
+};
+
+typedef enum {
+    Ktx2FamilyUncompressed,
+    Ktx2FamilyETC2,
+    Ktx2FamilyASTC,
+    Ktx2FamilyBC,
+} Ktx2Family;
+
+// What the OpenGL context must support to use a format.
+typedef enum {
+    Ktx2RequirementNone,
+    Ktx2RequirementOpenGLES3, // sRGB textures
+    Ktx2RequirementETC2,
+    Ktx2RequirementASTC,
+    Ktx2RequirementS3TC,
+    Ktx2RequirementS3TCSRGB,
+    Ktx2RequirementRGTC,
+    Ktx2RequirementBPTC,
+} Ktx2Requirement;
+
+typedef struct {
+    uint32_t vkFormat;
+    uint32_t glInternalFormat; // Sized internal format (for glTexStorage2D and compressed uploads)
+    Ktx2Family family;
+    Ktx2Requirement requirement;
+    uint8_t blockWidth;
+    uint8_t blockHeight;
+    uint8_t blockSize; // Bytes per block (or per pixel, for uncompressed formats)
+} Ktx2Format;
+
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    const uint8_t *data;
+    size_t size;
+} Ktx2Level;
+
+// Levels point into the data passed to ktx2Parse(), which must outlive the texture. Level 0 is the largest.
+typedef struct {
+    const Ktx2Format *format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    Ktx2Level levels[KTX2_MAX_LEVELS];
+} Ktx2Texture;
+
+typedef enum {
+    Ktx2ResultOK,
+    Ktx2ResultInvalid,
+    Ktx2ResultTruncated,
+    Ktx2ResultUnsupportedFormat,
+    Ktx2ResultUnsupportedLayout,
+    Ktx2ResultSupercompressed,
+} Ktx2Result;
+
+Ktx2Result ktx2Parse(const uint8_t *data, size_t size, Ktx2Texture *texture);
+const char *ktx2ResultString(Ktx2Result result);
+
+// Returns NULL if the format isn't supported by this parser.
+const Ktx2Format *ktx2GetFormat(uint32_t vkFormat);
+
+// Size of one level of a 2D texture, in bytes.
+size_t ktx2GetLevelSize(const Ktx2Format *format, uint32_t width, uint32_t height);
+
+// MARK: - Upload scheduling
+
+// Tracks the upload of one texture. Levels are uploaded smallest first, so a texture can be drawn (blurry) before
+// it's complete.
+typedef struct {
+    const Ktx2Texture *texture;
+    bool splitLevels; // If true, levels may be split into bands of block rows (requires immutable storage)
+    uint32_t level;   // Next level to upload
+    uint32_t blockRow; // Next block row in the level
+    bool complete;
+} Ktx2UploadCursor;
+
+// A block-aligned region of one level. `y` and `height` are in pixels; the region is always the full level width.
+typedef struct {
+    uint32_t level;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+    const uint8_t *data;
+    size_t size;
+    bool levelComplete;
+    bool textureComplete;
+} Ktx2UploadChunk;
+
+typedef void (*Ktx2UploadFunc)(void *userData, Ktx2UploadCursor *cursor, const Ktx2UploadChunk *chunk);
+
+void ktx2UploadCursorInit(Ktx2UploadCursor *cursor, const Ktx2Texture *texture, bool splitLevels);
+
+// Calls `uploadFunc` for chunks of the cursors' textures, in order, until `byteBudget` bytes are scheduled. NULL and
+// complete cursors are skipped. If the first chunk doesn't fit in the budget, it's scheduled anyway (one block row,
+// or one level if levels can't be split), so uploads always make progress.
+// Returns the number of bytes scheduled.
+size_t ktx2ScheduleUploads(Ktx2UploadCursor *const *cursors, int cursorCount, size_t byteBudget,
+                           Ktx2UploadFunc uploadFunc, void *userData);
+
+#endif
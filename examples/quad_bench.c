@@ -0,0 +1,173 @@
+// Quad throughput benchmark for the test pattern GLES2 renderer. Draws 100,000 small quads per frame with four
+// interleaved textures, one quad at a time (one upload and draw call per quad) and batched (one upload per frame, one
+// draw call per texture). Results are printed to the console.
+// The screen is red while the benchmark runs, and green when finished.
+// Run again: Tap, or Spacebar.
+//
+// Frame time is measured from the start of the frame to the end of glFinish(), so it includes GPU time but not the
+// wait for vsync.
+#include <stdio.h>
+#include <stdlib.h>
+#include "glfm.h"
+#include "test_pattern_renderer.h"
+
+enum {
+    BENCH_QUAD_COUNT = 100000,
+    BENCH_TEXTURE_COUNT = 4,
+    BENCH_IMMEDIATE_FRAMES = 5, // Slow
+    BENCH_BATCHED_FRAMES = 60,
+};
+
+typedef enum {
+    BenchStateIdle,
+    BenchStateImmediate,
+    BenchStateBatched,
+} BenchState;
+
+typedef struct {
+    Renderer *renderer;
+    Texture textures[BENCH_TEXTURE_COUNT];
+    BenchState state;
+    int frame;
+    double totalFrameTime;
+    double immediateFrameTime;
+    bool needsRedraw;
+} BenchApp;
+
+static void createTextures(BenchApp *app) {
+    static const uint32_t colors[BENCH_TEXTURE_COUNT] = { 0xff2020ff, 0xff20ff20, 0xffff2020, 0xffffffff };
+    for (int i = 0; i < BENCH_TEXTURE_COUNT; i++) {
+        uint32_t data[4] = { colors[i], 0xff000000, 0xff000000, colors[i] };
+        app->textures[i] = app->renderer->textureUpload(app->renderer, 2, 2, (uint8_t *)data);
+    }
+}
+
+static void drawQuads(BenchApp *app) {
+    // Deterministic positions on a grid, cycling through the textures so every quad changes texture
+    const int gridSize = 317; // ceil(sqrt(BENCH_QUAD_COUNT))
+    const float quadSize = 2.0f / gridSize;
+    for (int i = 0; i < BENCH_QUAD_COUNT; i++) {
+        float x0 = -1.0f + (float)(i % gridSize) * quadSize;
+        float y0 = -1.0f + (float)(i / gridSize) * quadSize;
+        float x1 = x0 + quadSize * 0.8f;
+        float y1 = y0 + quadSize * 0.8f;
+        const Vertex vertices[4] = {
+            { .position = { x0, y0 }, .texCoord = { 0, 0 } },
+            { .position = { x1, y0 }, .texCoord = { 1, 0 } },
+            { .position = { x0, y1 }, .texCoord = { 0, 1 } },
+            { .position = { x1, y1 }, .texCoord = { 1, 1 } },
+        };
+        app->renderer->drawQuad(app->renderer, app->textures[i % BENCH_TEXTURE_COUNT], &vertices);
+    }
+}
+
+static void startBenchmark(BenchApp *app) {
+    app->state = BenchStateImmediate;
+    app->frame = 0;
+    app->totalFrameTime = 0.0;
+    app->needsRedraw = true;
+}
+
+static void onSurfaceCreated(GLFMDisplay *display, int width, int height) {
+    BenchApp *app = glfmGetUserData(display);
+    app->renderer = createRendererGLES2(display);
+    createTextures(app);
+    app->needsRedraw = true;
+}
+
+static void onSurfaceDestroyed(GLFMDisplay *display) {
+    // When the surface is destroyed, all existing GL resources are no longer valid.
+    BenchApp *app = glfmGetUserData(display);
+    app->renderer->destroy(app->renderer);
+    app->renderer = NULL;
+}
+
+static void onSurfaceRefresh(GLFMDisplay *display) {
+    BenchApp *app = glfmGetUserData(display);
+    app->needsRedraw = true;
+}
+
+static bool onTouch(GLFMDisplay *display, int touch, GLFMTouchPhase phase, double x, double y) {
+    BenchApp *app = glfmGetUserData(display);
+    if (phase == GLFMTouchPhaseEnded && app->state == BenchStateIdle) {
+        startBenchmark(app);
+        return true;
+    }
+    return false;
+}
+
+static bool onKey(GLFMDisplay *display, GLFMKeyCode keyCode, GLFMKeyAction action, int modifiers) {
+    BenchApp *app = glfmGetUserData(display);
+    if (action == GLFMKeyActionPressed && keyCode == GLFMKeyCodeSpace && app->state == BenchStateIdle) {
+        startBenchmark(app);
+        return true;
+    }
+    return false;
+}
+
+static void onDraw(GLFMDisplay *display) {
+    BenchApp *app = glfmGetUserData(display);
+    if (!app->renderer || !app->needsRedraw) {
+        return;
+    }
+    int width, height;
+    glfmGetDisplaySize(display, &width, &height);
+
+    if (app->state == BenchStateIdle) {
+        app->needsRedraw = false;
+        glViewport(0, 0, width, height);
+        glClearColor(0.1f, 0.5f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glfmSwapBuffers(display);
+        return;
+    }
+
+    double startTime = glfmGetTime();
+    rendererGLES2SetBatchingEnabled(app->renderer, app->state == BenchStateBatched);
+    app->renderer->drawFrameStart(app->renderer, width, height);
+    glClearColor(0.6f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawQuads(app);
+    app->renderer->drawFrameEnd(app->renderer);
+    glFinish();
+    // Skip the first frame of each state (buffer allocation)
+    if (app->frame > 0) {
+        app->totalFrameTime += glfmGetTime() - startTime;
+    }
+    app->frame++;
+
+    if (app->state == BenchStateImmediate && app->frame > BENCH_IMMEDIATE_FRAMES) {
+        app->immediateFrameTime = app->totalFrameTime / BENCH_IMMEDIATE_FRAMES;
+        app->state = BenchStateBatched;
+        app->frame = 0;
+        app->totalFrameTime = 0.0;
+    } else if (app->state == BenchStateBatched && app->frame > BENCH_BATCHED_FRAMES) {
+        double batchedFrameTime = app->totalFrameTime / BENCH_BATCHED_FRAMES;
+        printf("%i quads/frame, %i textures\n", BENCH_QUAD_COUNT, BENCH_TEXTURE_COUNT);
+        printf("Immediate: %8.2f ms/frame, %6.2f Mquads/s\n", 1000.0 * app->immediateFrameTime,
+               BENCH_QUAD_COUNT / app->immediateFrameTime / 1000000.0);
+        printf("Batched:   %8.2f ms/frame, %6.2f Mquads/s (%.1fx)\n", 1000.0 * batchedFrameTime,
+               BENCH_QUAD_COUNT / batchedFrameTime / 1000000.0, app->immediateFrameTime / batchedFrameTime);
+        app->state = BenchStateIdle;
+    }
+    glfmSwapBuffers(display);
+}
+
+void glfmMain(GLFMDisplay *display) {
+    BenchApp *app = calloc(1, sizeof(BenchApp));
+    startBenchmark(app);
+
+    glfmSetDisplayConfig(display,
+                         GLFMRenderingAPIOpenGLES3, // For glMapBufferRange. Falls back to OpenGL ES 2.0.
+                         GLFMColorFormatRGBA8888,
+                         GLFMDepthFormatNone,
+                         GLFMStencilFormatNone,
+                         GLFMMultisampleNone);
+    glfmSetUserData(display, app);
+    glfmSetSurfaceCreatedFunc(display, onSurfaceCreated);
+    glfmSetSurfaceDestroyedFunc(display, onSurfaceDestroyed);
+    glfmSetSurfaceRefreshFunc(display, onSurfaceRefresh);
+    glfmSetRenderFunc(display, onDraw);
+    glfmSetTouchFunc(display, onTouch);
+    glfmSetKeyFunc(display, onKey);
+}
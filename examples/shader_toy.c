@@ -1,113 +1,415 @@
 // Draws a shader similar to shadertoy.com
+//
+// The shader is drawn into an offscreen framebuffer, then scaled up to the display. The offscreen resolution is
+// adjusted from the measured frame time, to stay within the frame budget. The GPU frame time is used when available
+// (see glfmSetGPUTimerEnabled); otherwise, the resolution is lowered when frames are missed, and raised again after a
+// while. The HUD shows p50/p99 frame times and the offscreen resolution.
+// Tap to toggle adaptive resolution. Press B to run the benchmark.
+//
+// The benchmark draws each shader in SHADER_TOY_FRAGMENT_SHADERS at full resolution for SHADER_TOY_BENCH_FRAMES
+// frames, and prints the results as JSON. Frame time is measured from the start of the frame to the end of
+// glFinish(), so it includes GPU time but not the wait for vsync. Build with -DSHADER_TOY_HEADLESS=1 to run the
+// benchmark on launch, without the HUD.
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "glfm.h"
-#include "file_compat.h"
+#include "text_renderer.h"
 
 #define FILE_COMPAT_ANDROID_ACTIVITY glfmGetAndroidActivity(display)
 
+#ifndef SHADER_TOY_HEADLESS
+#define SHADER_TOY_HEADLESS 0
+#endif
+
+#ifndef SHADER_TOY_BENCH_FRAMES
+#define SHADER_TOY_BENCH_FRAMES 240
+#endif
+
+#define SHADER_TOY_TARGET_FRAME_TIME (1.0 / 60.0)
+#define SHADER_TOY_FRAME_BUDGET (SHADER_TOY_TARGET_FRAME_TIME * 0.85) // Headroom for the blit, HUD, and compositor
+#define SHADER_TOY_MIN_SCALE 0.25
+#define SHADER_TOY_SCALE_STEP (1.0 / 32.0)
+
+static const char *SHADER_TOY_FRAGMENT_SHADERS[] = { "shader_toy.frag", "shader_toy_plasma.frag" };
+#define SHADER_TOY_SHADER_COUNT ((int)(sizeof(SHADER_TOY_FRAGMENT_SHADERS) / sizeof(SHADER_TOY_FRAGMENT_SHADERS[0])))
+
+enum {
+    SHADER_TOY_BENCH_WARMUP_FRAMES = 10,
+    FRAME_HISTORY_COUNT = 120,
+    ADAPT_WINDOW_COUNT = 30,
+    ADAPT_GOOD_WINDOWS_BEFORE_RAISE = 4,
+    HUD_COLS = 40,
+    HUD_ROWS = 3,
+    HUD_UPDATE_FRAMES = 15,
+};
+
+static const char *BLIT_VERTEX_SHADER =
+    "#version 100\n"
+    "attribute vec2 position;\n"
+    "uniform vec2 texScale;\n"
+    "varying vec2 texCoord;\n"
+    "void main() {\n"
+    "    texCoord = (position * 0.5 + 0.5) * texScale;\n"
+    "    gl_Position = vec4(position, 0, 1);\n"
+    "}\n";
+
+// Linear filtering must not sample outside the rendered region of the offscreen texture.
+static const char *BLIT_FRAGMENT_SHADER =
+    "#version 100\n"
+    "precision mediump float;\n"
+    "uniform sampler2D tex;\n"
+    "uniform vec2 texMax;\n"
+    "varying vec2 texCoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(tex, min(texCoord, texMax));\n"
+    "}\n";
+
 typedef struct {
     GLuint program;
-    GLuint vertexBuffer;
-    GLuint vertexArray;
     GLint uniformTime;
     GLint uniformResolution;
+    int resolution[2];
+} ShaderToyProgram;
+
+typedef struct {
+    bool valid;
+    double p50;
+    double p99;
+    double mean;
+    double max;
+} ShaderToyBenchResult;
+
+typedef struct {
+    ShaderToyProgram programs[SHADER_TOY_SHADER_COUNT];
+    GLuint vertexBuffer;
+    GLuint vertexArray;
     double startTime;
     double pausedTime;
-    int resolution[2];
+
+    // Offscreen target, allocated at the surface size. Only the scaled region is drawn and sampled, so changing the
+    // scale doesn't reallocate anything.
+    GLuint blitProgram;
+    GLint blitUniformTexScale;
+    GLint blitUniformTexMax;
+    GLuint framebuffer;
+    GLuint framebufferTexture;
+    int framebufferSize[2];
+    bool offscreenFailed;
+    double scale;
+    bool adaptiveEnabled;
+
+    // Frame times, in seconds
+    double lastFrameStartTime;
+    double frameIntervals[FRAME_HISTORY_COUNT];
+    double gpuTimes[FRAME_HISTORY_COUNT];
+    int frameIntervalCount;
+    int gpuTimeCount;
+    int frameHistoryIndex;
+    double adaptWindow[ADAPT_WINDOW_COUNT];
+    int adaptWindowCount;
+    int adaptGoodWindowCount;
+    double scratch[SHADER_TOY_BENCH_FRAMES > FRAME_HISTORY_COUNT ? SHADER_TOY_BENCH_FRAMES : FRAME_HISTORY_COUNT];
+
+    // HUD
+    TextRenderer *hud;
+    int hudFrame;
+
+    // Benchmark
+    bool benchPending;
+    bool benchRunning;
+    int benchShader;
+    int benchFrame;
+    double benchFrameTimes[SHADER_TOY_BENCH_FRAMES];
+    ShaderToyBenchResult benchResults[SHADER_TOY_SHADER_COUNT];
 } ShaderToyApp;
 
-static GLuint compileShader(GLFMDisplay *display, GLenum type, const char *shaderName) {
-    char fullPath[PATH_MAX];
-    fc_resdir(fullPath, sizeof(fullPath));
-    strncat(fullPath, shaderName, sizeof(fullPath) - strlen(fullPath) - 1);
-
-    // Get shader string
-    char *shaderString = NULL;
-    FILE *shaderFile = fopen(fullPath, "rb");
-    if (shaderFile) {
-        fseek(shaderFile, 0, SEEK_END);
-        size_t length = (size_t)ftell(shaderFile);
-        fseek(shaderFile, 0, SEEK_SET);
-
-        shaderString = malloc(length + 1);
-        if (shaderString) {
-            fread(shaderString, length, 1, shaderFile);
-            shaderString[length] = 0;
+// Maps a shader asset. The source is used in place and is not null-terminated. Unmap with glfmUnmapAsset().
+static const char *mapShaderFile(GLFMDisplay *display, const char *shaderName, size_t *length) {
+    const char *shaderString = glfmMapAsset(display, shaderName, length);
+    if (!shaderString) {
+        printf("Couldn't read file: %s\n", shaderName);
+    }
+    return shaderString;
+}
+
+// MARK: - Statistics
+
+static int compareDoubles(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+// Sorts a copy of the values into `scratch`, and returns the value at each percentile (0 to 1).
+static void percentiles(const double *values, int count, double *scratch, const double *ps, double *results,
+                        int resultCount) {
+    memcpy(scratch, values, sizeof(double) * (size_t)count);
+    qsort(scratch, (size_t)count, sizeof(double), compareDoubles);
+    for (int i = 0; i < resultCount; i++) {
+        int index = (int)(ps[i] * (count - 1) + 0.5);
+        results[i] = count > 0 ? scratch[index] : 0.0;
+    }
+}
+
+static void resetFrameHistory(ShaderToyApp *app) {
+    app->lastFrameStartTime = 0.0;
+    app->frameIntervalCount = 0;
+    app->gpuTimeCount = 0;
+    app->frameHistoryIndex = 0;
+    app->adaptWindowCount = 0;
+    app->adaptGoodWindowCount = 0;
+}
+
+// MARK: - Adaptive resolution
+
+static void adaptScale(ShaderToyApp *app, double frameLoad, bool gpuTimeAvailable) {
+    app->adaptWindow[app->adaptWindowCount++] = frameLoad;
+    if (app->adaptWindowCount < ADAPT_WINDOW_COUNT) {
+        return;
+    }
+    app->adaptWindowCount = 0;
+    if (!app->adaptiveEnabled) {
+        return;
+    }
+
+    static const double p90 = 0.9;
+    double load;
+    percentiles(app->adaptWindow, ADAPT_WINDOW_COUNT, app->scratch, &p90, &load, 1);
+    if (load <= 0.0) {
+        return;
+    }
+
+    double scale = app->scale;
+    if (gpuTimeAvailable) {
+        // Shading cost is roughly proportional to the pixel count. Limit the step to avoid overshooting when the
+        // measurement is noisy, and ignore small differences so the resolution doesn't flicker.
+        double factor = sqrt(SHADER_TOY_FRAME_BUDGET / load);
+        if (fabs(factor - 1.0) < 0.05) {
+            return;
         }
-        fclose(shaderFile);
+        factor = factor < 0.7 ? 0.7 : (factor > 1.15 ? 1.15 : factor);
+        scale *= factor;
+    } else if (load > SHADER_TOY_TARGET_FRAME_TIME * 1.2) {
+        // Only the frame interval is known, which can't go below the refresh interval. Lower the scale when frames
+        // are missed, and raise it again after several windows without misses.
+        scale *= 0.85;
+        app->adaptGoodWindowCount = 0;
+    } else if (++app->adaptGoodWindowCount >= ADAPT_GOOD_WINDOWS_BEFORE_RAISE) {
+        scale *= 1.1;
+        app->adaptGoodWindowCount = 0;
     }
-    if (!shaderString) {
-        printf("Couldn't read file: %s\n", fullPath);
-        return 0;
-    }
-
-    // Compile
-    const char *constShaderString = shaderString;
-    GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &constShaderString, NULL);
-    glCompileShader(shader);
-    free(shaderString);
-
-    // Check compile status
-    GLint status;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
-    if (status == 0) {
-        printf("Couldn't compile shader: %s\n", shaderName);
-        GLint logLength;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-        if (logLength > 0) {
-            GLchar *log = malloc((size_t)logLength);
-            glGetShaderInfoLog(shader, logLength, &logLength, log);
-            if (log[0] != 0) {
-                printf("Shader log: %s\n", log);
-            }
-            free(log);
+
+    scale = floor(scale / SHADER_TOY_SCALE_STEP + 0.5) * SHADER_TOY_SCALE_STEP;
+    app->scale = scale < SHADER_TOY_MIN_SCALE ? SHADER_TOY_MIN_SCALE : (scale > 1.0 ? 1.0 : scale);
+}
+
+// MARK: - HUD
+
+static void hudSetRow(ShaderToyApp *app, int row, const char *text) {
+    size_t length = strlen(text);
+    for (int col = 0; col < HUD_COLS; col++) {
+        textRendererSetChar(app->hud, row, col, (size_t)col < length ? (uint32_t)(unsigned char)text[col] : 0);
+    }
+}
+
+static void hudUpdate(ShaderToyApp *app, int targetWidth, int targetHeight) {
+    // Rows change every HUD_UPDATE_FRAMES, so the text renderer uploads nothing on the frames in between.
+    if (!app->hud || (app->hudFrame++ % HUD_UPDATE_FRAMES) != 0) {
+        return;
+    }
+    static const double ps[2] = { 0.5, 0.99 };
+    double results[2];
+    char text[HUD_COLS + 1];
+
+    if (app->frameIntervalCount > 0) {
+        percentiles(app->frameIntervals, app->frameIntervalCount, app->scratch, ps, results, 2);
+        snprintf(text, sizeof(text), "frame p50 %5.1f p99 %5.1f ms", results[0] * 1000.0, results[1] * 1000.0);
+    } else {
+        snprintf(text, sizeof(text), "frame -");
+    }
+    hudSetRow(app, 2, text);
+
+    if (app->gpuTimeCount > 0) {
+        percentiles(app->gpuTimes, app->gpuTimeCount, app->scratch, ps, results, 2);
+        snprintf(text, sizeof(text), "gpu   p50 %5.1f p99 %5.1f ms", results[0] * 1000.0, results[1] * 1000.0);
+    } else {
+        snprintf(text, sizeof(text), "gpu   n/a");
+    }
+    hudSetRow(app, 1, text);
+
+    snprintf(text, sizeof(text), "scale %3i%% %ix%i%s", (int)(app->scale * 100.0 + 0.5), targetWidth, targetHeight,
+             app->adaptiveEnabled ? " auto" : "");
+    hudSetRow(app, 0, text);
+}
+
+static void hudDraw(GLFMDisplay *display, ShaderToyApp *app, int width, int height) {
+    if (!app->hud) {
+        return;
+    }
+    double top, right, bottom, left;
+    glfmGetDisplayChromeInsets(display, &top, &right, &bottom, &left);
+    double scale = glfmGetDisplayScale(display);
+    float cellWidth = (float)(2.0 * TEXT_FONT_CHAR_WIDTH * scale / width);
+    float cellHeight = (float)(2.0 * TEXT_FONT_CHAR_HEIGHT * scale / height);
+    float originX = -1.0f + (float)(2.0 * (left + 4.0 * scale) / width);
+    float originY = 1.0f - (float)(2.0 * (top + 4.0 * scale) / height) - cellHeight * HUD_ROWS;
+
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    textRendererDraw(app->hud, originX, originY, cellWidth, cellHeight, 0, HUD_ROWS);
+}
+
+// MARK: - Benchmark
+
+static void benchStart(ShaderToyApp *app) {
+    app->benchPending = false;
+    app->benchRunning = true;
+    app->benchShader = 0;
+    app->benchFrame = 0;
+    memset(app->benchResults, 0, sizeof(app->benchResults));
+}
+
+static void benchPrintResults(ShaderToyApp *app, int width, int height) {
+    // One printf call, so the JSON isn't split across log lines on Android
+    char json[256 + SHADER_TOY_SHADER_COUNT * 256];
+    size_t length = 0;
+    length += (size_t)snprintf(json + length, sizeof(json) - length,
+                               "{\"width\":%i,\"height\":%i,\"frames\":%i,\"shaders\":[", width, height,
+                               SHADER_TOY_BENCH_FRAMES);
+    for (int i = 0; i < SHADER_TOY_SHADER_COUNT && length < sizeof(json); i++) {
+        const ShaderToyBenchResult *result = &app->benchResults[i];
+        const char *separator = i > 0 ? "," : "";
+        if (result->valid) {
+            length += (size_t)snprintf(json + length, sizeof(json) - length,
+                                       "%s{\"name\":\"%s\",\"p50_ms\":%.3f,\"p99_ms\":%.3f,\"mean_ms\":%.3f,"
+                                       "\"max_ms\":%.3f}", separator, SHADER_TOY_FRAGMENT_SHADERS[i],
+                                       result->p50 * 1000.0, result->p99 * 1000.0, result->mean * 1000.0,
+                                       result->max * 1000.0);
+        } else {
+            length += (size_t)snprintf(json + length, sizeof(json) - length,
+                                       "%s{\"name\":\"%s\",\"error\":\"Couldn't create program\"}", separator,
+                                       SHADER_TOY_FRAGMENT_SHADERS[i]);
         }
-        glDeleteShader(shader);
-        shader = 0;
     }
-    return shader;
+    if (length < sizeof(json)) {
+        snprintf(json + length, sizeof(json) - length, "]}");
+    }
+    printf("%s\n", json);
 }
 
+static void benchAdvance(ShaderToyApp *app, double frameTime, int width, int height) {
+    int measuredFrame = app->benchFrame - SHADER_TOY_BENCH_WARMUP_FRAMES;
+    if (measuredFrame >= 0) {
+        app->benchFrameTimes[measuredFrame] = frameTime;
+    }
+    app->benchFrame++;
+    bool programValid = app->programs[app->benchShader].program != 0;
+    if (programValid && app->benchFrame < SHADER_TOY_BENCH_WARMUP_FRAMES + SHADER_TOY_BENCH_FRAMES) {
+        return;
+    }
+
+    ShaderToyBenchResult *result = &app->benchResults[app->benchShader];
+    if (programValid) {
+        static const double ps[2] = { 0.5, 0.99 };
+        double values[2];
+        percentiles(app->benchFrameTimes, SHADER_TOY_BENCH_FRAMES, app->scratch, ps, values, 2);
+        double total = 0.0;
+        double max = 0.0;
+        for (int i = 0; i < SHADER_TOY_BENCH_FRAMES; i++) {
+            total += app->benchFrameTimes[i];
+            max = app->benchFrameTimes[i] > max ? app->benchFrameTimes[i] : max;
+        }
+        result->valid = true;
+        result->p50 = values[0];
+        result->p99 = values[1];
+        result->mean = total / SHADER_TOY_BENCH_FRAMES;
+        result->max = max;
+    }
+    app->benchShader++;
+    app->benchFrame = 0;
+    if (app->benchShader == SHADER_TOY_SHADER_COUNT) {
+        benchPrintResults(app, width, height);
+        app->benchRunning = false;
+        resetFrameHistory(app);
+    }
+}
+
+// MARK: - GLFM callbacks
+
 static void onSurfaceCreated(GLFMDisplay *display, int width, int height) {
     ShaderToyApp *app = glfmGetUserData(display);
-    
-    GLuint vertShader = compileShader(display, GL_VERTEX_SHADER, "shader_toy.vert");
-    GLuint fragShader = compileShader(display, GL_FRAGMENT_SHADER, "shader_toy.frag");
-    if (vertShader != 0 && fragShader != 0) {
-        app->program = glCreateProgram();
-        
-        glAttachShader(app->program, vertShader);
-        glAttachShader(app->program, fragShader);
-        
-        glBindAttribLocation(app->program, 0, "position");
-        
-        glLinkProgram(app->program);
-        
-        glDeleteShader(vertShader);
-        glDeleteShader(fragShader);
-        
-        app->uniformTime = glGetUniformLocation(app->program, "iTime");
-        app->uniformResolution = glGetUniformLocation(app->program, "iResolution");
-    }
-    
+
+    // Programs are loaded from the program binary cache when possible
+    const char *attributeNames[] = { "position" };
+    size_t vertLength = 0;
+    const char *vertShader = mapShaderFile(display, "shader_toy.vert", &vertLength);
+    for (int i = 0; i < SHADER_TOY_SHADER_COUNT && vertShader; i++) {
+        ShaderToyProgram *program = &app->programs[i];
+        size_t fragLength = 0;
+        const char *fragShader = mapShaderFile(display, SHADER_TOY_FRAGMENT_SHADERS[i], &fragLength);
+        if (fragShader) {
+            program->program = glfmCreateProgramWithSourceLengths(display, vertShader, vertLength,
+                                                                  fragShader, fragLength, attributeNames, 1);
+        }
+        if (program->program == 0) {
+            printf("Couldn't create program: %s\n", SHADER_TOY_FRAGMENT_SHADERS[i]);
+        } else {
+            program->uniformTime = glGetUniformLocation(program->program, "iTime");
+            program->uniformResolution = glGetUniformLocation(program->program, "iResolution");
+        }
+        glfmUnmapAsset(display, fragShader);
+    }
+    glfmUnmapAsset(display, vertShader);
+
+    app->blitProgram = glfmCreateProgram(display, BLIT_VERTEX_SHADER, BLIT_FRAGMENT_SHADER, attributeNames, 1);
+    if (app->blitProgram != 0) {
+        app->blitUniformTexScale = glGetUniformLocation(app->blitProgram, "texScale");
+        app->blitUniformTexMax = glGetUniformLocation(app->blitProgram, "texMax");
+        glUseProgram(app->blitProgram);
+        glUniform1i(glGetUniformLocation(app->blitProgram, "tex"), 0);
+    }
+
+    GLFMProgramCacheStats stats;
+    glfmGetProgramCacheStats(display, &stats);
+    printf("Program cache: %i hits, %i misses, %.1f ms\n", stats.hitCount, stats.missCount,
+           stats.totalTime * 1000.0);
+
+    // The vertices never change, so they're uploaded once
+    static const float vertices[] = {
+        -1, -1,
+        +1, -1,
+        -1, +1,
+        +1, +1
+    };
     glGenBuffers(1, &app->vertexBuffer);
-    
+    glBindBuffer(GL_ARRAY_BUFFER, app->vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
 #if defined(GL_VERSION_3_0) && GL_VERSION_3_0
     glGenVertexArrays(1, &app->vertexArray);
+    glBindVertexArray(app->vertexArray);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, 0);
 #endif
 }
 
 static void onSurfaceDestroyed(GLFMDisplay *display) {
     ShaderToyApp *app = glfmGetUserData(display);
-    app->program = 0;
+    memset(app->programs, 0, sizeof(app->programs));
     app->vertexBuffer = 0;
     app->vertexArray = 0;
-    app->resolution[0] = 0;
-    app->resolution[1] = 0;
+    app->blitProgram = 0;
+    app->framebuffer = 0;
+    app->framebufferTexture = 0;
+    app->framebufferSize[0] = 0;
+    app->framebufferSize[1] = 0;
+    app->offscreenFailed = false;
+    if (app->hud) {
+        textRendererContextLost(app->hud);
+    }
 }
 
 static void onFocus(GLFMDisplay *display, bool focused) {
@@ -120,66 +422,216 @@ static void onFocus(GLFMDisplay *display, bool focused) {
     } else {
         app->pausedTime = glfmGetTime();
     }
+    // Frames around a pause aren't representative
+    resetFrameHistory(app);
+}
+
+static bool onTouch(GLFMDisplay *display, int touch, GLFMTouchPhase phase, double x, double y) {
+    ShaderToyApp *app = glfmGetUserData(display);
+    if (phase == GLFMTouchPhaseEnded && !app->benchRunning) {
+        app->adaptiveEnabled = !app->adaptiveEnabled;
+        if (!app->adaptiveEnabled) {
+            app->scale = 1.0;
+        }
+        app->hudFrame = 0;
+        return true;
+    }
+    return false;
+}
+
+static bool onKey(GLFMDisplay *display, GLFMKeyCode keyCode, GLFMKeyAction action, int modifiers) {
+    ShaderToyApp *app = glfmGetUserData(display);
+    if (action == GLFMKeyActionPressed && keyCode == GLFMKeyCodeB && !app->benchRunning) {
+        app->benchPending = true;
+        return true;
+    }
+    return false;
+}
+
+// Returns false if the offscreen framebuffer isn't supported; the shader is then drawn directly.
+static bool updateOffscreenTarget(ShaderToyApp *app, int width, int height) {
+    if (app->offscreenFailed) {
+        return false;
+    }
+    if (app->framebuffer != 0 && app->framebufferSize[0] == width && app->framebufferSize[1] == height) {
+        return true;
+    }
+    if (app->framebuffer == 0) {
+        glGenFramebuffers(1, &app->framebuffer);
+        glGenTextures(1, &app->framebufferTexture);
+    }
+    glBindTexture(GL_TEXTURE_2D, app->framebufferTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindFramebuffer(GL_FRAMEBUFFER, app->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, app->framebufferTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        printf("Offscreen framebuffer not supported; drawing at full resolution\n");
+        glDeleteFramebuffers(1, &app->framebuffer);
+        glDeleteTextures(1, &app->framebufferTexture);
+        app->framebuffer = 0;
+        app->framebufferTexture = 0;
+        app->offscreenFailed = true;
+        return false;
+    }
+    app->framebufferSize[0] = width;
+    app->framebufferSize[1] = height;
+    return true;
+}
+
+static void bindVertices(ShaderToyApp *app) {
+#if defined(GL_VERSION_3_0) && GL_VERSION_3_0
+    glBindVertexArray(app->vertexArray);
+#else
+    glBindBuffer(GL_ARRAY_BUFFER, app->vertexBuffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, 0);
+#endif
+}
+
+static void drawShader(ShaderToyApp *app, ShaderToyProgram *program, double time, int width, int height) {
+    glUseProgram(program->program);
+    if (program->uniformTime >= 0) {
+        glUniform1f(program->uniformTime, (GLfloat)time);
+    }
+    if (program->uniformResolution >= 0 && (width != program->resolution[0] || height != program->resolution[1])) {
+        program->resolution[0] = width;
+        program->resolution[1] = height;
+        glUniform3f(program->uniformResolution, (GLfloat)width, (GLfloat)height, 1.0f);
+    }
+    bindVertices(app);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 }
 
 static void onDraw(GLFMDisplay *display) {
     ShaderToyApp *app = glfmGetUserData(display);
-    
+    double frameStartTime = glfmGetTime();
+    if (app->benchPending) {
+        benchStart(app);
+    }
+
     int width, height;
     glfmGetDisplaySize(display, &width, &height);
-    
+
+    // The benchmark uses a fixed time step, so every run draws the same frames.
+    ShaderToyProgram *program;
+    double time;
+    double scale;
+    if (app->benchRunning) {
+        program = &app->programs[app->benchShader];
+        time = app->benchFrame / 60.0;
+        scale = 1.0;
+    } else {
+        program = &app->programs[0];
+        if (app->startTime <= 0.0) {
+            app->startTime = frameStartTime;
+        }
+        time = frameStartTime - app->startTime;
+        scale = app->scale;
+    }
+
+    int targetWidth = (int)(width * scale + 0.5);
+    int targetHeight = (int)(height * scale + 0.5);
+    targetWidth = targetWidth < 1 ? 1 : targetWidth;
+    targetHeight = targetHeight < 1 ? 1 : targetHeight;
+
+    // At full resolution, the offscreen pass would only add a copy.
+    GLint defaultFramebuffer = 0;
+    bool offscreen = (scale < 1.0 && program->program != 0 && app->blitProgram != 0);
+    if (offscreen) {
+        // On iOS, the default framebuffer isn't 0.
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &defaultFramebuffer);
+        offscreen = updateOffscreenTarget(app, width, height);
+    }
+
+    if (offscreen) {
+        glBindFramebuffer(GL_FRAMEBUFFER, app->framebuffer);
+        glViewport(0, 0, targetWidth, targetHeight);
+        glDisable(GL_BLEND);
+        drawShader(app, program, time, targetWidth, targetHeight);
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)defaultFramebuffer);
+    } else {
+        targetWidth = width;
+        targetHeight = height;
+    }
+
     // Clear
     glViewport(0, 0, width, height);
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // Set iTime
-    glUseProgram(app->program);
-    if (app->uniformTime >= 0) {
-        double time = glfmGetTime();
-        if (app->startTime <= 0.0) {
-            app->startTime = time;
-            time = 0.0;
+    // Draw, or scale up the offscreen target
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    if (offscreen) {
+        float texScaleX = (float)targetWidth / (float)width;
+        float texScaleY = (float)targetHeight / (float)height;
+        glUseProgram(app->blitProgram);
+        glUniform2f(app->blitUniformTexScale, texScaleX, texScaleY);
+        glUniform2f(app->blitUniformTexMax, ((float)targetWidth - 0.5f) / (float)width,
+                    ((float)targetHeight - 0.5f) / (float)height);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, app->framebufferTexture);
+        bindVertices(app);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    } else if (program->program != 0) {
+        drawShader(app, program, time, width, height);
+    }
+
+    if (app->benchRunning) {
+        glFinish();
+        benchAdvance(app, glfmGetTime() - frameStartTime, width, height);
+        glfmSwapBuffers(display);
+        return;
+    }
+
+    hudUpdate(app, targetWidth, targetHeight);
+    hudDraw(display, app, width, height);
+
+    // Measure. The GPU time is from a few frames ago, which is fine for a controller that looks at 30-frame windows.
+    double cpuTime = glfmGetTime() - frameStartTime;
+    double gpuTime = glfmGetGPUFrameTime(display);
+    double interval = app->lastFrameStartTime > 0.0 ? frameStartTime - app->lastFrameStartTime : 0.0;
+    app->lastFrameStartTime = frameStartTime;
+    if (interval > 0.0) {
+        int index = app->frameHistoryIndex;
+        app->frameIntervals[index] = interval;
+        if (app->frameIntervalCount < FRAME_HISTORY_COUNT) {
+            app->frameIntervalCount++;
+        }
+        if (gpuTime >= 0.0) {
+            app->gpuTimes[index] = gpuTime;
+            if (app->gpuTimeCount < FRAME_HISTORY_COUNT) {
+                app->gpuTimeCount++;
+            }
+        }
+        app->frameHistoryIndex = (index + 1) % FRAME_HISTORY_COUNT;
+
+        if (gpuTime >= 0.0) {
+            adaptScale(app, gpuTime > cpuTime ? gpuTime : cpuTime, true);
         } else {
-            time -= app->startTime;
+            adaptScale(app, interval, false);
         }
-        glUniform1f(app->uniformTime, time);
-    }
-    
-    // Set iResolution
-    if (app->uniformResolution >= 0 && (width != app->resolution[0] || height != app->resolution[1])) {
-        app->resolution[0] = width;
-        app->resolution[1] = height;
-        glUniform3f(app->uniformResolution, (GLfloat)width, (GLfloat)height, 1.0f);
     }
 
-    // Set vertices
-    const float vertices[] = {
-        -1, -1,
-        +1, -1,
-        -1, +1,
-        +1, +1
-    };
-#if defined(GL_VERSION_3_0) && GL_VERSION_3_0
-    glBindVertexArray(app->vertexArray);
-#endif
-    glBindBuffer(GL_ARRAY_BUFFER, app->vertexBuffer);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, 0);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-    
-    // Draw
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
     glfmSwapBuffers(display);
 }
 
 void glfmMain(GLFMDisplay *display) {
     ShaderToyApp *app = calloc(1, sizeof(ShaderToyApp));
+    app->scale = 1.0;
+    app->adaptiveEnabled = true;
+#if SHADER_TOY_HEADLESS
+    app->benchPending = true;
+#else
+    app->hud = textRendererCreate(display, HUD_COLS, HUD_ROWS);
+#endif
 
     glfmSetDisplayConfig(display,
-                         GLFMRenderingAPIOpenGLES2,
+                         GLFMRenderingAPIOpenGLES3, // For instanced HUD text. Falls back to OpenGL ES 2.0.
                          GLFMColorFormatRGBA8888,
                          GLFMDepthFormatNone,
                          GLFMStencilFormatNone,
@@ -187,8 +639,11 @@ void glfmMain(GLFMDisplay *display) {
 
     glfmSetUserData(display, app);
     glfmSetDisplayChrome(display, GLFMUserInterfaceChromeNone);
+    glfmSetGPUTimerEnabled(display, true);
     glfmSetSurfaceCreatedFunc(display, onSurfaceCreated);
     glfmSetSurfaceDestroyedFunc(display, onSurfaceDestroyed);
     glfmSetAppFocusFunc(display, onFocus);
     glfmSetRenderFunc(display, onDraw);
+    glfmSetTouchFunc(display, onTouch);
+    glfmSetKeyFunc(display, onKey);
 }
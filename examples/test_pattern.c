@@ -1,5 +1,7 @@
 // Draws a test pattern to check if framebuffer is scaled correctly.
 // Tap to modify interface chrome (navigation bar, status bar, etc)
+// Press P to draw the current frame with the software renderer, print its counters, and save it as a PPM image in
+// the cache directory (for profiling the CPU side without a GPU, and for golden image comparisons).
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,68 +18,50 @@ typedef struct {
     bool needsRedraw;
 } TestPatternApp;
 
-static Texture createTestPatternTexture(GLFMDisplay *display, uint32_t width, uint32_t height) {
+static Texture createTestPatternTexture(GLFMDisplay *display, Renderer *renderer, uint32_t width, uint32_t height) {
     double top, right, bottom, left;
     glfmGetDisplayChromeInsets(display, &top, &right, &bottom, &left);
-
-    static const uint32_t maxBorderSize = 1;
-    static const uint32_t borderColor = 0xff0000ff;
-    static const uint32_t insetColor = 0xffff3322;
-
-    uint32_t borderSize = maxBorderSize;
-    if (borderSize * 2 > width) {
-        borderSize = width / 2;
+    Texture texture = testPatternCreateTexture(renderer, width, height, top, right, bottom, left);
+    if (texture != NULL_TEXTURE) {
+        printf("Created test pattern %ix%i with insets %i, %i, %i, %i\n", width, height,
+               (int)top, (int)right, (int)bottom, (int)left);
     }
-    if (borderSize * 2 > height) {
-        borderSize = height / 2;
+    return texture;
+}
+
+static void captureSoftwareFrame(GLFMDisplay *display) {
+    Renderer *renderer = createRendererSoftware();
+    if (!renderer) {
+        return;
     }
+    int width, height;
+    glfmGetDisplaySize(display, &width, &height);
 
-    TestPatternApp *app = glfmGetUserData(display);
-    Texture texture = 0;
-    uint32_t *data = malloc(width * height * sizeof(uint32_t));
-    if (data) {
-        uint32_t *out = data;
-        for (uint32_t y = 0; y < height; y++) {
-            for (int i = 0; i < borderSize; i++) {
-                *out++ = borderColor;
-            }
-            if (y < borderSize || y >= height - borderSize) {
-                for (uint32_t x = borderSize; x < width - borderSize; x++) {
-                    *out++ = borderColor;
-                }
-            } else if (y < bottom || y >= height - top) {
-                for (uint32_t x = borderSize; x < width - borderSize; x++) {
-                    *out++ = insetColor;
-                }
-            } else {
-                uint32_t x = borderSize;
-                while (x < left) {
-                    *out++ = insetColor;
-                    x++;
-                }
-                while (x < width - right - borderSize) {
-                    *out++ = ((x & 1U) == (y & 1U)) ? 0xff000000 : 0xffffffff;
-                    x++;
-                }
-
-                while (x < width - borderSize) {
-                    *out++ = insetColor;
-                    x++;
-                }
-            }
-            for (int i = 0; i < borderSize; i++) {
-                *out++ = borderColor;
-            }
+    double startTime = glfmGetTime();
+    Texture texture = createTestPatternTexture(display, renderer, (uint32_t)width, (uint32_t)height);
+    double textureTime = glfmGetTime() - startTime;
+    startTime = glfmGetTime();
+    testPatternDraw(renderer, texture, width, height);
+    double drawTime = glfmGetTime() - startTime;
+    renderer->textureDestroy(renderer, texture);
+
+    const RendererSoftwareStats *stats = rendererSoftwareGetStats(renderer);
+    printf("Software: texture %.2f ms, draw %.2f ms, %llu upload(s) (%llu bytes), %llu frame(s), %llu quad(s), "
+           "%llu pixel(s)\n", 1000.0 * textureTime, 1000.0 * drawTime,
+           (unsigned long long)stats->textureUploadCount, (unsigned long long)stats->textureUploadBytes,
+           (unsigned long long)stats->frameCount, (unsigned long long)stats->quadCount,
+           (unsigned long long)stats->pixelCount);
+
+    char path[PATH_MAX];
+    if (fc_cachedir("GLFMTestPattern", path, sizeof(path)) == 0) {
+        strncat(path, "test_pattern.ppm", sizeof(path) - strlen(path) - 1);
+        if (rendererSoftwareWritePPM(renderer, path)) {
+            printf("Saved %s\n", path);
+        } else {
+            printf("Couldn't save %s\n", path);
         }
-
-        texture = app->renderer->textureUpload(app->renderer, width, height, (uint8_t *)data);
-        free(data);
-    }
-    if (texture != 0) {
-        printf("Created test pattern %ix%i with insets %i, %i, %i, %i\n", width, height,
-               (int)top, (int)right, (int)bottom, (int)left);
     }
-    return texture;
+    renderer->destroy(renderer);
 }
 
 static void onSurfaceCreated(GLFMDisplay *display, int width, int height) {
@@ -150,6 +134,14 @@ static bool onTouch(GLFMDisplay *display, int touch, GLFMTouchPhase phase, doubl
     }
 }
 
+static bool onKey(GLFMDisplay *display, GLFMKeyCode keyCode, GLFMKeyAction action, int modifiers) {
+    if (action == GLFMKeyActionPressed && keyCode == GLFMKeyCodeP) {
+        captureSoftwareFrame(display);
+        return true;
+    }
+    return false;
+}
+
 static void onDraw(GLFMDisplay *display) {
     TestPatternApp *app = glfmGetUserData(display);
     if (!app->textureNeedsUpdate && !app->needsRedraw) {
@@ -164,21 +156,11 @@ static void onDraw(GLFMDisplay *display) {
         app->texture = NULL_TEXTURE;
     }
     if (app->texture == NULL_TEXTURE) {
-        app->texture = createTestPatternTexture(display, width, height);
+        app->texture = createTestPatternTexture(display, app->renderer, (uint32_t)width, (uint32_t)height);
         app->textureNeedsUpdate = false;
     }
 
-    app->renderer->drawFrameStart(app->renderer, width, height);
-    
-    const Vertex vertices[4] = {
-        { .position = { -1, -1 }, .texCoord = { 0, 0 } },
-        { .position = {  1, -1 }, .texCoord = { 1, 0 } },
-        { .position = { -1,  1 }, .texCoord = { 0, 1 } },
-        { .position = {  1,  1 }, .texCoord = { 1, 1 } },
-    };
-    
-    app->renderer->drawQuad(app->renderer, app->texture, &vertices);
-    app->renderer->drawFrameEnd(app->renderer);
+    testPatternDraw(app->renderer, app->texture, width, height);
     glfmSwapBuffers(display);
     app->needsRedraw = false;
 }
@@ -197,6 +179,7 @@ void glfmMain(GLFMDisplay *display) {
     glfmSetUserData(display, app);
     glfmSetDisplayChrome(display, GLFMUserInterfaceChromeNavigationAndStatusBar);
     glfmSetTouchFunc(display, onTouch);
+    glfmSetKeyFunc(display, onKey);
     glfmSetSurfaceCreatedFunc(display, onSurfaceCreated);
     glfmSetSurfaceResizedFunc(display, onSurfaceResized);
     glfmSetSurfaceRefreshFunc(display, onSurfaceRefresh);
@@ -0,0 +1,76 @@
+#include "test_pattern_renderer.h"
+
+#include <stdlib.h>
+
+// Only uses the Renderer interface, so it can draw with any renderer, including on a host (see tests/host).
+
+Texture testPatternCreateTexture(Renderer *renderer, uint32_t width, uint32_t height,
+                                 double top, double right, double bottom, double left) {
+    static const uint32_t maxBorderSize = 1;
+    static const uint32_t borderColor = 0xff0000ff;
+    static const uint32_t insetColor = 0xffff3322;
+
+    uint32_t borderSize = maxBorderSize;
+    if (borderSize * 2 > width) {
+        borderSize = width / 2;
+    }
+    if (borderSize * 2 > height) {
+        borderSize = height / 2;
+    }
+
+    Texture texture = NULL_TEXTURE;
+    uint32_t *data = malloc(width * height * sizeof(uint32_t));
+    if (data) {
+        uint32_t *out = data;
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t i = 0; i < borderSize; i++) {
+                *out++ = borderColor;
+            }
+            if (y < borderSize || y >= height - borderSize) {
+                for (uint32_t x = borderSize; x < width - borderSize; x++) {
+                    *out++ = borderColor;
+                }
+            } else if (y < bottom || y >= height - top) {
+                for (uint32_t x = borderSize; x < width - borderSize; x++) {
+                    *out++ = insetColor;
+                }
+            } else {
+                uint32_t x = borderSize;
+                while (x < left) {
+                    *out++ = insetColor;
+                    x++;
+                }
+                while (x < width - right - borderSize) {
+                    *out++ = ((x & 1U) == (y & 1U)) ? 0xff000000 : 0xffffffff;
+                    x++;
+                }
+
+                while (x < width - borderSize) {
+                    *out++ = insetColor;
+                    x++;
+                }
+            }
+            for (uint32_t i = 0; i < borderSize; i++) {
+                *out++ = borderColor;
+            }
+        }
+
+        texture = renderer->textureUpload(renderer, width, height, (uint8_t *)data);
+        free(data);
+    }
+    return texture;
+}
+
+void testPatternDraw(Renderer *renderer, Texture texture, int width, int height) {
+    renderer->drawFrameStart(renderer, width, height);
+
+    const Vertex vertices[4] = {
+        { .position = { -1, -1 }, .texCoord = { 0, 0 } },
+        { .position = {  1, -1 }, .texCoord = { 1, 0 } },
+        { .position = { -1,  1 }, .texCoord = { 0, 1 } },
+        { .position = {  1,  1 }, .texCoord = { 1, 1 } },
+    };
+
+    renderer->drawQuad(renderer, texture, &vertices);
+    renderer->drawFrameEnd(renderer);
+}
@@ -1,8 +1,12 @@
 #ifndef TEST_PATTERN_RENDERER_H
 #define TEST_PATTERN_RENDERER_H
 
+#include <stdbool.h>
 #include <stdint.h>
-#include "glfm.h"
+
+// This header doesn't include glfm.h, so the software renderer and the test pattern can be built on a host without a
+// GLFM platform (see tests/host).
+typedef struct GLFMDisplay GLFMDisplay;
 
 typedef struct Renderer Renderer;
 typedef uintptr_t Texture;
@@ -24,8 +28,43 @@ struct Renderer {
 
 Renderer *createRendererGLES2(GLFMDisplay *display);
 
+// The GLES2 renderer batches quads until drawFrameEnd(), sorted by texture, so quads with different textures may be
+// drawn in a different order than submitted. When batching is disabled, each drawQuad() uploads and draws
+// immediately. Batching is enabled by default.
+void rendererGLES2SetBatchingEnabled(Renderer *renderer, bool enabled);
+
+// The software renderer rasterizes into a framebuffer in memory, without a GPU. Textures are sampled with nearest
+// filtering, and there is no blending. The framebuffer holds the most recent frame, bottom row first (like
+// glReadPixels), and is kept until the next drawFrameStart().
+typedef struct {
+    uint64_t textureUploadCount;
+    uint64_t textureUploadBytes;
+    uint64_t textureDestroyCount;
+    uint64_t frameCount;
+    uint64_t quadCount;
+    uint64_t pixelCount;
+} RendererSoftwareStats;
+
+Renderer *createRendererSoftware(void);
+const RendererSoftwareStats *rendererSoftwareGetStats(const Renderer *renderer);
+void rendererSoftwareResetStats(Renderer *renderer);
+
+// Returns RGBA pixels, or NULL if no frame was drawn.
+const uint8_t *rendererSoftwareGetFramebuffer(const Renderer *renderer, int *width, int *height);
+
+// Writes the framebuffer as a binary PPM (alpha is dropped). Returns false on failure.
+bool rendererSoftwareWritePPM(const Renderer *renderer, const char *path);
+
 #if defined(__APPLE__)
 Renderer *createRendererMetal(GLFMDisplay *display);
 #endif
 
+// The test pattern: a checkerboard with a one-pixel red border. The insets (for example, the display chrome insets) are
+// filled with blue. Returns NULL_TEXTURE on failure.
+Texture testPatternCreateTexture(Renderer *renderer, uint32_t width, uint32_t height,
+                                 double top, double right, double bottom, double left);
+
+// Draws a frame with the texture filling the screen.
+void testPatternDraw(Renderer *renderer, Texture texture, int width, int height);
+
 #endif
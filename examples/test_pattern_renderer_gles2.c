@@ -1,16 +1,60 @@
 #include "test_pattern_renderer.h"
+#include "glfm.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
-#include "file_compat.h"
+#include <string.h>
 
-#define FILE_COMPAT_ANDROID_ACTIVITY glfmGetAndroidActivity(display)
+// OpenGL ES 3.0 constants, for builds using OpenGL ES 2.0 headers
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_INVALIDATE_RANGE_BIT
+#define GL_MAP_INVALIDATE_RANGE_BIT 0x0004
+#endif
+#ifndef GL_MAP_INVALIDATE_BUFFER_BIT
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#endif
+#ifndef GL_MAP_UNSYNCHRONIZED_BIT
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#endif
+
+// Quads per draw call, limited by GLushort indices
+#define BATCH_MAX_QUADS_PER_DRAW 16384
+// The ring buffer holds this many frames of the largest batch seen so far
+#define BATCH_RING_FRAMES 3
+
+typedef void *(*MapBufferRangeFunc)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef GLboolean (*UnmapBufferFunc)(GLenum target);
+
+typedef struct {
+    Texture texture;
+    uint32_t index; // Order of drawQuad() calls, so the sort is stable
+} BatchQuad;
 
 typedef struct {
     Renderer renderer;
     GLuint textureProgram;
     GLuint textureVertexBuffer;
     GLuint textureVertexArray;
+
+    // Batch, flushed in drawFrameEnd()
+    bool batchingEnabled;
+    Vertex *batchVertices;
+    BatchQuad *batchQuads;
+    Vertex *batchSortedVertices;
+    size_t batchCount;
+    size_t batchCapacity;
+    bool batchNeedsSort;
+
+    // Streaming vertex ring
+    GLuint ringBuffer;
+    GLuint quadIndexBuffer;
+    GLsizeiptr ringSize;
+    GLintptr ringOffset;
+    MapBufferRangeFunc mapBufferRange;
+    UnmapBufferFunc unmapBuffer;
 } RendererGLES2;
 
 #define impl_of(this_renderer) ((RendererGLES2 *)(void *)((uint8_t *)this_renderer - offsetof(RendererGLES2, renderer)))
@@ -28,8 +72,12 @@ static Texture textureUpload(Renderer *renderer, uint32_t width, uint32_t height
     return textureId;
 }
 
+static void batchFlush(RendererGLES2 *impl);
+
 static void textureDestroy(Renderer *renderer, Texture texture) {
     if (texture != NULL_TEXTURE) {
+        // Draw pending quads that may use this texture
+        batchFlush(impl_of(renderer));
         GLuint textureId = (GLuint)texture;
         glDeleteTextures(1, &textureId);
     }
@@ -42,11 +90,19 @@ static void drawFrameStart(Renderer *renderer, int screenWidth, int screenHeight
 }
 
 static void drawFrameEnd(Renderer *renderer) {
-    // Do nothing
+    RendererGLES2 *impl = impl_of(renderer);
+    batchFlush(impl);
 }
 
-static void drawQuad(Renderer *renderer, Texture texture, const Vertex (*vertices)[4]) {
-    // NOTE: This function draws one quad at a time, which is slow. Don't use in production.
+static void bindVertexAttributes(GLintptr offset) {
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)(offset + offsetof(Vertex, position)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)(offset + offsetof(Vertex, texCoord)));
+}
+
+static void drawQuadImmediate(Renderer *renderer, Texture texture, const Vertex (*vertices)[4]) {
+    // NOTE: This function draws one quad at a time, which is slow. Used when batching is disabled, for comparison.
     RendererGLES2 *impl = impl_of(renderer);
     glUseProgram(impl->textureProgram);
 
@@ -55,10 +111,7 @@ static void drawQuad(Renderer *renderer, Texture texture, const Vertex (*vertice
 #endif
 
     glBindBuffer(GL_ARRAY_BUFFER, impl->textureVertexBuffer);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, position));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoord));
+    bindVertexAttributes(0);
     
     GLuint textureId = (GLuint)texture;
     glBufferData(GL_ARRAY_BUFFER, sizeof(*vertices), vertices, GL_DYNAMIC_DRAW);
@@ -66,85 +119,228 @@ static void drawQuad(Renderer *renderer, Texture texture, const Vertex (*vertice
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 }
 
-static void destroy(Renderer *renderer) {
-    RendererGLES2 *impl = impl_of(renderer);
-    free(impl);
+static int compareBatchQuads(const void *a, const void *b) {
+    const BatchQuad *quadA = a;
+    const BatchQuad *quadB = b;
+    if (quadA->texture != quadB->texture) {
+        return quadA->texture < quadB->texture ? -1 : 1;
+    }
+    return quadA->index < quadB->index ? -1 : (quadA->index > quadB->index ? 1 : 0);
 }
 
-static GLuint compileShader(GLFMDisplay *display, GLenum type, const char *shaderName) {
-    char fullPath[PATH_MAX];
-    fc_resdir(fullPath, sizeof(fullPath));
-    strncat(fullPath, shaderName, sizeof(fullPath) - strlen(fullPath) - 1);
+static bool batchReserve(RendererGLES2 *impl, size_t count) {
+    if (count <= impl->batchCapacity) {
+        return true;
+    }
+    size_t capacity = impl->batchCapacity > 0 ? impl->batchCapacity * 2 : 1024;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    Vertex *vertices = realloc(impl->batchVertices, sizeof(Vertex) * 4 * capacity);
+    if (vertices) {
+        impl->batchVertices = vertices;
+    }
+    BatchQuad *quads = realloc(impl->batchQuads, sizeof(BatchQuad) * capacity);
+    if (quads) {
+        impl->batchQuads = quads;
+    }
+    Vertex *sortedVertices = realloc(impl->batchSortedVertices, sizeof(Vertex) * 4 * capacity);
+    if (sortedVertices) {
+        impl->batchSortedVertices = sortedVertices;
+    }
+    if (!vertices || !quads || !sortedVertices) {
+        return false;
+    }
+    impl->batchCapacity = capacity;
+    return true;
+}
 
-    // Get shader string
-    char *shaderString = NULL;
-    FILE *shaderFile = fopen(fullPath, "rb");
-    if (shaderFile) {
-        fseek(shaderFile, 0, SEEK_END);
-        size_t length = (size_t)ftell(shaderFile);
-        fseek(shaderFile, 0, SEEK_SET);
+// Copies quad vertices in sorted order.
+static void batchGather(const RendererGLES2 *impl, Vertex *dst) {
+    if (impl->batchNeedsSort) {
+        for (size_t i = 0; i < impl->batchCount; i++) {
+            memcpy(dst + i * 4, impl->batchVertices + impl->batchQuads[i].index * 4, sizeof(Vertex) * 4);
+        }
+    } else {
+        memcpy(dst, impl->batchVertices, sizeof(Vertex) * 4 * impl->batchCount);
+    }
+}
 
-        shaderString = malloc(length + 1);
-        if (shaderString) {
-            fread(shaderString, length, 1, shaderFile);
-            shaderString[length] = 0;
+static void createQuadIndexBuffer(RendererGLES2 *impl) {
+    // Same triangles as a 4-vertex GL_TRIANGLE_STRIP
+    GLushort *indices = malloc(sizeof(GLushort) * 6 * BATCH_MAX_QUADS_PER_DRAW);
+    if (!indices) {
+        return;
+    }
+    for (GLushort quad = 0; quad < BATCH_MAX_QUADS_PER_DRAW; quad++) {
+        GLushort base = (GLushort)(quad * 4);
+        GLushort *i = indices + quad * 6;
+        i[0] = base + 0;
+        i[1] = base + 1;
+        i[2] = base + 2;
+        i[3] = base + 2;
+        i[4] = base + 1;
+        i[5] = base + 3;
+    }
+    glGenBuffers(1, &impl->quadIndexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, impl->quadIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(sizeof(GLushort) * 6 * BATCH_MAX_QUADS_PER_DRAW), indices,
+                 GL_STATIC_DRAW);
+    free(indices);
+}
+
+static void batchFlush(RendererGLES2 *impl) {
+    if (impl->batchCount == 0) {
+        return;
+    }
+    if (impl->batchNeedsSort) {
+        qsort(impl->batchQuads, impl->batchCount, sizeof(BatchQuad), compareBatchQuads);
+    }
+
+    glUseProgram(impl->textureProgram);
+#if defined(GL_VERSION_3_0) && GL_VERSION_3_0
+    glBindVertexArray(impl->textureVertexArray);
+#endif
+    if (impl->quadIndexBuffer == 0) {
+        createQuadIndexBuffer(impl);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, impl->quadIndexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, impl->ringBuffer);
+
+    // Grow the ring if this frame doesn't fit. New storage starts empty, so writing from offset 0 is safe.
+    GLsizeiptr size = (GLsizeiptr)(sizeof(Vertex) * 4 * impl->batchCount);
+    if (size > impl->ringSize) {
+        impl->ringSize = size * BATCH_RING_FRAMES;
+        impl->ringOffset = 0;
+        glBufferData(GL_ARRAY_BUFFER, impl->ringSize, NULL, GL_STREAM_DRAW);
+    }
+
+    // Upload
+    bool uploaded = false;
+    if (impl->mapBufferRange && impl->unmapBuffer) {
+        // Ranges ahead of ringOffset haven't been used since the buffer was last invalidated, so the map doesn't need
+        // to wait for the GPU. When the ring wraps, invalidate the whole buffer instead (the driver orphans it).
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        if (impl->ringOffset + size > impl->ringSize) {
+            impl->ringOffset = 0;
+            access |= GL_MAP_INVALIDATE_BUFFER_BIT;
+        } else {
+            access |= GL_MAP_INVALIDATE_RANGE_BIT;
         }
-        fclose(shaderFile);
-    }
-    if (!shaderString) {
-        printf("Couldn't read file: %s\n", fullPath);
-        return 0;
-    }
-
-    // Compile
-    const char *constShaderString = shaderString;
-    GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &constShaderString, NULL);
-    glCompileShader(shader);
-    free(shaderString);
-
-    // Check compile status
-    GLint status;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
-    if (status == 0) {
-        printf("Couldn't compile shader: %s\n", shaderName);
-        GLint logLength;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-        if (logLength > 0) {
-            GLchar *log = malloc((size_t)logLength);
-            glGetShaderInfoLog(shader, logLength, &logLength, log);
-            if (log[0] != 0) {
-                printf("Shader log: %s\n", log);
-            }
-            free(log);
+        Vertex *dst = impl->mapBufferRange(GL_ARRAY_BUFFER, impl->ringOffset, size, access);
+        if (dst) {
+            batchGather(impl, dst);
+            uploaded = impl->unmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
         }
-        glDeleteShader(shader);
-        shader = 0;
     }
-    return shader;
+    if (!uploaded) {
+        // OpenGL ES 2.0 and WebGL: Orphan the buffer, then upload the whole frame with one call
+        impl->ringOffset = 0;
+        glBufferData(GL_ARRAY_BUFFER, impl->ringSize, NULL, GL_STREAM_DRAW);
+        const Vertex *src = impl->batchVertices;
+        if (impl->batchNeedsSort) {
+            batchGather(impl, impl->batchSortedVertices);
+            src = impl->batchSortedVertices;
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, src);
+    }
+
+    // One draw call per run of quads with the same texture
+    size_t start = 0;
+    while (start < impl->batchCount) {
+        Texture texture = impl->batchQuads[start].texture;
+        size_t end = start + 1;
+        while (end < impl->batchCount && end - start < BATCH_MAX_QUADS_PER_DRAW &&
+               impl->batchQuads[end].texture == texture) {
+            end++;
+        }
+        bindVertexAttributes(impl->ringOffset + (GLintptr)(sizeof(Vertex) * 4 * start));
+        glBindTexture(GL_TEXTURE_2D, (GLuint)texture);
+        glDrawElements(GL_TRIANGLES, (GLsizei)((end - start) * 6), GL_UNSIGNED_SHORT, (void *)0);
+        start = end;
+    }
+
+    impl->ringOffset += size;
+    impl->batchCount = 0;
+    impl->batchNeedsSort = false;
+}
+
+static void drawQuad(Renderer *renderer, Texture texture, const Vertex (*vertices)[4]) {
+    RendererGLES2 *impl = impl_of(renderer);
+    if (!impl->batchingEnabled) {
+        drawQuadImmediate(renderer, texture, vertices);
+        return;
+    }
+    if (!batchReserve(impl, impl->batchCount + 1)) {
+        batchFlush(impl);
+        drawQuadImmediate(renderer, texture, vertices);
+        return;
+    }
+    size_t index = impl->batchCount++;
+    if (index > 0 && impl->batchQuads[index - 1].texture != texture) {
+        impl->batchNeedsSort = true;
+    }
+    impl->batchQuads[index].texture = texture;
+    impl->batchQuads[index].index = (uint32_t)index;
+    memcpy(impl->batchVertices + index * 4, vertices, sizeof(*vertices));
+}
+
+void rendererGLES2SetBatchingEnabled(Renderer *renderer, bool enabled) {
+    RendererGLES2 *impl = impl_of(renderer);
+    if (!enabled) {
+        batchFlush(impl);
+    }
+    impl->batchingEnabled = enabled;
+}
+
+static void destroy(Renderer *renderer) {
+    RendererGLES2 *impl = impl_of(renderer);
+    free(impl->batchVertices);
+    free(impl->batchQuads);
+    free(impl->batchSortedVertices);
+    free(impl);
+}
+
+/// Maps a shader asset, or returns NULL if it couldn't be read. The source is not null-terminated.
+static const char *mapShaderSource(GLFMDisplay *display, const char *shaderName, size_t *length) {
+    const char *source = glfmMapAsset(display, shaderName, length);
+    if (!source) {
+        printf("Couldn't read file: %s\n", shaderName);
+    }
+    return source;
 }
 
 Renderer *createRendererGLES2(GLFMDisplay *display) {
     RendererGLES2 *impl = calloc(1, sizeof(RendererGLES2));
     
-    GLuint vertShader = compileShader(display, GL_VERTEX_SHADER, "texture.vert");
-    GLuint fragShader = compileShader(display, GL_FRAGMENT_SHADER, "texture.frag");
-    if (vertShader != 0 && fragShader != 0) {
-        impl->textureProgram = glCreateProgram();
-        
-        glAttachShader(impl->textureProgram, vertShader);
-        glAttachShader(impl->textureProgram, fragShader);
-        
-        glBindAttribLocation(impl->textureProgram, 0, "position");
-        glBindAttribLocation(impl->textureProgram, 1, "texCoord");
-        
-        glLinkProgram(impl->textureProgram);
-        
-        glDeleteShader(vertShader);
-        glDeleteShader(fragShader);
+    // Compiled (or loaded from the program cache) and linked by GLFM, which logs errors. The mapped assets are passed
+    // in place, without copying them.
+    size_t vertLength = 0;
+    size_t fragLength = 0;
+    const char *vertSource = mapShaderSource(display, "texture.vert", &vertLength);
+    const char *fragSource = mapShaderSource(display, "texture.frag", &fragLength);
+    if (vertSource && fragSource) {
+        static const char *const attributeNames[] = { "position", "texCoord" };
+        impl->textureProgram = glfmCreateProgramWithSourceLengths(display, vertSource, vertLength,
+                                                                  fragSource, fragLength, attributeNames, 2);
+        if (impl->textureProgram == 0) {
+            printf("Couldn't create program: texture.vert, texture.frag\n");
+        }
     }
+    glfmUnmapAsset(display, vertSource);
+    glfmUnmapAsset(display, fragSource);
     
     glGenBuffers(1, &impl->textureVertexBuffer);
+    glGenBuffers(1, &impl->ringBuffer);
+    impl->batchingEnabled = true;
+
+    // Core functions in OpenGL ES 3.0. WebGL 2 has no glMapBufferRange, so Emscripten always uses orphaning.
+#if !defined(__EMSCRIPTEN__)
+    if (glfmGetRenderingAPI(display) >= GLFMRenderingAPIOpenGLES3) {
+        impl->mapBufferRange = (MapBufferRangeFunc)glfmGetProcAddress("glMapBufferRange");
+        impl->unmapBuffer = (UnmapBufferFunc)glfmGetProcAddress("glUnmapBuffer");
+    }
+#endif
     
 #if defined(GL_VERSION_3_0) && GL_VERSION_3_0
     glGenVertexArrays(1, &impl->textureVertexArray);
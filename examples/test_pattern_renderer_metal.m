@@ -1,4 +1,5 @@
 #include "test_pattern_renderer.h"
+#include "glfm.h"
 
 #import <MetalKit/MetalKit.h>
 
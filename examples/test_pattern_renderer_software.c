@@ -0,0 +1,269 @@
+#include "test_pattern_renderer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+// This renderer makes no GL or GLFM calls, so its cost is only the CPU work of the app and the rasterizer.
+
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint32_t texels[]; // RGBA bytes, bottom row first
+} SoftwareTexture;
+
+typedef struct {
+    float x, y;
+    float u, v;
+} RasterVertex;
+
+typedef struct {
+    Renderer renderer;
+    uint32_t *framebuffer; // RGBA bytes, bottom row first
+    int width;
+    int height;
+    size_t framebufferCapacity;
+    RendererSoftwareStats stats;
+} RendererSoftware;
+
+#define impl_of(this_renderer) ((RendererSoftware *)(void *)((uint8_t *)this_renderer - offsetof(RendererSoftware, renderer)))
+
+// MARK: - Rasterizer
+
+// Edges shared by two triangles belong to exactly one of them (the "top-left" rule, for counter-clockwise triangles
+// in y-up coordinates), so no pixel of a quad is drawn twice.
+static inline bool isTopLeftEdge(const RasterVertex *a, const RasterVertex *b) {
+    float dx = b->x - a->x;
+    float dy = b->y - a->y;
+    return dy < 0.0f || (dy == 0.0f && dx < 0.0f);
+}
+
+static void rasterizeTriangle(RendererSoftware *impl, const SoftwareTexture *texture,
+                              const RasterVertex *v0, const RasterVertex *v1, const RasterVertex *v2) {
+    float area = (v1->x - v0->x) * (v2->y - v0->y) - (v1->y - v0->y) * (v2->x - v0->x);
+    if (area == 0.0f) {
+        return;
+    }
+    if (area < 0.0f) {
+        const RasterVertex *t = v1;
+        v1 = v2;
+        v2 = t;
+        area = -area;
+    }
+
+    // Bounding box, clipped to the framebuffer
+    float minX = v0->x, maxX = v0->x, minY = v0->y, maxY = v0->y;
+    if (v1->x < minX) minX = v1->x;
+    if (v2->x < minX) minX = v2->x;
+    if (v1->x > maxX) maxX = v1->x;
+    if (v2->x > maxX) maxX = v2->x;
+    if (v1->y < minY) minY = v1->y;
+    if (v2->y < minY) minY = v2->y;
+    if (v1->y > maxY) maxY = v1->y;
+    if (v2->y > maxY) maxY = v2->y;
+    int x0 = minX < 0.0f ? 0 : (int)minX;
+    int y0 = minY < 0.0f ? 0 : (int)minY;
+    int x1 = maxX >= (float)impl->width ? impl->width - 1 : (int)maxX;
+    int y1 = maxY >= (float)impl->height ? impl->height - 1 : (int)maxY;
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+    // Edge functions, each opposite its vertex: e0 is the edge v1->v2, and so on.
+    const RasterVertex *edgeStart[3] = { v1, v2, v0 };
+    const RasterVertex *edgeEnd[3] = { v2, v0, v1 };
+    float stepX[3], stepY[3], rowStart[3], bias[3];
+    float px = (float)x0 + 0.5f;
+    float py = (float)y0 + 0.5f;
+    for (int i = 0; i < 3; i++) {
+        const RasterVertex *a = edgeStart[i];
+        const RasterVertex *b = edgeEnd[i];
+        stepX[i] = -(b->y - a->y);
+        stepY[i] = b->x - a->x;
+        rowStart[i] = (b->x - a->x) * (py - a->y) - (b->y - a->y) * (px - a->x);
+        // Pixels exactly on an edge that isn't top-left are outside
+        bias[i] = isTopLeftEdge(a, b) ? 0.0f : -1e-6f;
+    }
+
+    // Texture coordinates are affine across the triangle
+    const float invArea = 1.0f / area;
+    const float texWidth = (float)texture->width;
+    const float texHeight = (float)texture->height;
+    const float du = (stepX[0] * v0->u + stepX[1] * v1->u + stepX[2] * v2->u) * invArea * texWidth;
+    const float dv = (stepX[0] * v0->v + stepX[1] * v1->v + stepX[2] * v2->v) * invArea * texHeight;
+    const int maxTexX = (int)texture->width - 1;
+    const int maxTexY = (int)texture->height - 1;
+    uint64_t pixelCount = 0;
+
+    for (int y = y0; y <= y1; y++) {
+        float e0 = rowStart[0], e1 = rowStart[1], e2 = rowStart[2];
+        float u = (e0 * v0->u + e1 * v1->u + e2 * v2->u) * invArea * texWidth;
+        float v = (e0 * v0->v + e1 * v1->v + e2 * v2->v) * invArea * texHeight;
+        uint32_t *row = impl->framebuffer + (size_t)y * (size_t)impl->width;
+        for (int x = x0; x <= x1; x++) {
+            if (e0 + bias[0] >= 0.0f && e1 + bias[1] >= 0.0f && e2 + bias[2] >= 0.0f) {
+                // Nearest filtering, clamped to edge
+                int tx = (int)u;
+                int ty = (int)v;
+                tx = tx < 0 ? 0 : (tx > maxTexX ? maxTexX : tx);
+                ty = ty < 0 ? 0 : (ty > maxTexY ? maxTexY : ty);
+                row[x] = texture->texels[(size_t)ty * texture->width + (size_t)tx];
+                pixelCount++;
+            }
+            e0 += stepX[0];
+            e1 += stepX[1];
+            e2 += stepX[2];
+            u += du;
+            v += dv;
+        }
+        rowStart[0] += stepY[0];
+        rowStart[1] += stepY[1];
+        rowStart[2] += stepY[2];
+    }
+    impl->stats.pixelCount += pixelCount;
+}
+
+// MARK: - Renderer functions
+
+static Texture textureUpload(Renderer *renderer, uint32_t width, uint32_t height, uint8_t *data) {
+    RendererSoftware *impl = impl_of(renderer);
+    if (width == 0 || height == 0 || !data) {
+        return NULL_TEXTURE;
+    }
+    size_t size = sizeof(uint32_t) * width * height;
+    SoftwareTexture *texture = malloc(sizeof(SoftwareTexture) + size);
+    if (!texture) {
+        return NULL_TEXTURE;
+    }
+    texture->width = width;
+    texture->height = height;
+    memcpy(texture->texels, data, size);
+    impl->stats.textureUploadCount++;
+    impl->stats.textureUploadBytes += size;
+    return (Texture)texture;
+}
+
+static void textureDestroy(Renderer *renderer, Texture texture) {
+    RendererSoftware *impl = impl_of(renderer);
+    if (texture != NULL_TEXTURE) {
+        free((SoftwareTexture *)texture);
+        impl->stats.textureDestroyCount++;
+    }
+}
+
+static void drawFrameStart(Renderer *renderer, int screenWidth, int screenHeight) {
+    RendererSoftware *impl = impl_of(renderer);
+    size_t pixelCount = (screenWidth > 0 && screenHeight > 0) ? (size_t)screenWidth * (size_t)screenHeight : 0;
+    if (pixelCount > impl->framebufferCapacity) {
+        uint32_t *framebuffer = realloc(impl->framebuffer, sizeof(uint32_t) * pixelCount);
+        if (!framebuffer) {
+            pixelCount = 0;
+        } else {
+            impl->framebuffer = framebuffer;
+            impl->framebufferCapacity = pixelCount;
+        }
+    }
+    impl->width = pixelCount > 0 ? screenWidth : 0;
+    impl->height = pixelCount > 0 ? screenHeight : 0;
+    if (pixelCount > 0) {
+        memset(impl->framebuffer, 0, sizeof(uint32_t) * pixelCount);
+    }
+    impl->stats.frameCount++;
+}
+
+static void drawFrameEnd(Renderer *renderer) {
+    (void)renderer;
+}
+
+static void drawQuad(Renderer *renderer, Texture texture, const Vertex (*vertices)[4]) {
+    RendererSoftware *impl = impl_of(renderer);
+    impl->stats.quadCount++;
+    if (texture == NULL_TEXTURE || impl->width == 0) {
+        return;
+    }
+
+    // Normalized device coordinates to pixels. The quad is a triangle strip: (0, 1, 2) and (2, 1, 3).
+    RasterVertex v[4];
+    const float halfWidth = (float)impl->width * 0.5f;
+    const float halfHeight = (float)impl->height * 0.5f;
+    for (int i = 0; i < 4; i++) {
+        v[i].x = ((*vertices)[i].position[0] + 1.0f) * halfWidth;
+        v[i].y = ((*vertices)[i].position[1] + 1.0f) * halfHeight;
+        v[i].u = (*vertices)[i].texCoord[0];
+        v[i].v = (*vertices)[i].texCoord[1];
+    }
+    const SoftwareTexture *softwareTexture = (const SoftwareTexture *)texture;
+    rasterizeTriangle(impl, softwareTexture, &v[0], &v[1], &v[2]);
+    rasterizeTriangle(impl, softwareTexture, &v[2], &v[1], &v[3]);
+}
+
+static void destroy(Renderer *renderer) {
+    RendererSoftware *impl = impl_of(renderer);
+    free(impl->framebuffer);
+    free(impl);
+}
+
+// MARK: - Public
+
+Renderer *createRendererSoftware(void) {
+    RendererSoftware *impl = calloc(1, sizeof(RendererSoftware));
+    if (!impl) {
+        return NULL;
+    }
+
+    Renderer *renderer = &impl->renderer;
+    renderer->textureUpload = textureUpload;
+    renderer->textureDestroy = textureDestroy;
+    renderer->drawFrameStart = drawFrameStart;
+    renderer->drawFrameEnd = drawFrameEnd;
+    renderer->drawQuad = drawQuad;
+    renderer->destroy = destroy;
+    return renderer;
+}
+
+const RendererSoftwareStats *rendererSoftwareGetStats(const Renderer *renderer) {
+    return &impl_of(renderer)->stats;
+}
+
+void rendererSoftwareResetStats(Renderer *renderer) {
+    memset(&impl_of(renderer)->stats, 0, sizeof(RendererSoftwareStats));
+}
+
+const uint8_t *rendererSoftwareGetFramebuffer(const Renderer *renderer, int *width, int *height) {
+    const RendererSoftware *impl = impl_of(renderer);
+    *width = impl->width;
+    *height = impl->height;
+    return impl->width > 0 ? (const uint8_t *)impl->framebuffer : NULL;
+}
+
+bool rendererSoftwareWritePPM(const Renderer *renderer, const char *path) {
+    const RendererSoftware *impl = impl_of(renderer);
+    if (impl->width == 0 || !path) {
+        return false;
+    }
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    uint8_t *line = malloc((size_t)impl->width * 3);
+    bool success = line != NULL && fprintf(file, "P6\n%i %i\n255\n", impl->width, impl->height) > 0;
+
+    // PPM rows are top to bottom
+    for (int y = impl->height - 1; success && y >= 0; y--) {
+        const uint8_t *in = (const uint8_t *)(impl->framebuffer + (size_t)y * (size_t)impl->width);
+        uint8_t *out = line;
+        for (int x = 0; x < impl->width; x++) {
+            *out++ = in[0];
+            *out++ = in[1];
+            *out++ = in[2];
+            in += 4;
+        }
+        success = fwrite(line, 3, (size_t)impl->width, file) == (size_t)impl->width;
+    }
+    free(line);
+    if (fclose(file) != 0) {
+        success = false;
+    }
+    return success;
+}
@@ -0,0 +1,193 @@
+// Text renderer benchmark. Draws a 128x80 grid (10,240 cells) and measures frame time with instancing and with the
+// fallback quads, for three workloads: no changes, one row changed per frame (typing), and every row changed per
+// frame. Results are printed to the console.
+// The screen is red while the benchmark runs, and green when finished.
+// Run again: Tap, or Spacebar.
+//
+// Frame time is measured from the start of the frame to the end of glFinish(), so it includes GPU time but not the
+// wait for vsync.
+#include <stdio.h>
+#include <stdlib.h>
+#include "glfm.h"
+#include "text_renderer.h"
+
+enum {
+    BENCH_COLS = 128,
+    BENCH_ROWS = 80,
+    BENCH_FRAMES_PER_PHASE = 120,
+    BENCH_PHASE_COUNT = 6,
+};
+
+typedef enum {
+    BenchWorkloadStatic,
+    BenchWorkloadOneRow,
+    BenchWorkloadAllRows,
+} BenchWorkload;
+
+typedef struct {
+    TextRenderer *text;
+    bool running;
+    int phase;
+    int frame;
+    uint32_t seed;
+    double totalFrameTime;
+    long uploadedRowCount;
+    bool needsRedraw;
+} BenchApp;
+
+static const char *workloadName(BenchWorkload workload) {
+    switch (workload) {
+        case BenchWorkloadStatic: default:
+            return "static";
+        case BenchWorkloadOneRow:
+            return "one row/frame";
+        case BenchWorkloadAllRows:
+            return "all rows/frame";
+    }
+}
+
+static void fillRow(BenchApp *app, int row) {
+    for (int col = 0; col < BENCH_COLS; col++) {
+        uint32_t codePoint = '!' + (uint32_t)(row * 7 + col + (int)app->seed) % 94;
+        textRendererSetChar(app->text, row, col, codePoint);
+    }
+}
+
+static void startPhase(BenchApp *app) {
+    app->frame = 0;
+    app->totalFrameTime = 0.0;
+    app->uploadedRowCount = 0;
+    // Phases 0-2 use instancing (if available), phases 3-5 use the fallback
+    textRendererSetInstancingEnabled(app->text, app->phase < 3);
+}
+
+static void endPhase(BenchApp *app) {
+    BenchWorkload workload = (BenchWorkload)(app->phase % 3);
+    double frameTime = app->totalFrameTime / BENCH_FRAMES_PER_PHASE;
+    printf("%-9s %-15s %6.2f ms/frame, %7.1f Mcells/s, %5.1f rows uploaded/frame\n",
+           textRendererIsInstanced(app->text) ? "Instanced" : "Fallback", workloadName(workload),
+           1000.0 * frameTime, frameTime > 0.0 ? BENCH_COLS * BENCH_ROWS / frameTime / 1000000.0 : 0.0,
+           (double)app->uploadedRowCount / BENCH_FRAMES_PER_PHASE);
+}
+
+static void drawBenchFrame(GLFMDisplay *display, BenchApp *app) {
+    double startTime = glfmGetTime();
+    BenchWorkload workload = (BenchWorkload)(app->phase % 3);
+    app->seed++;
+    if (workload == BenchWorkloadOneRow) {
+        fillRow(app, (int)(app->seed % BENCH_ROWS));
+    } else if (workload == BenchWorkloadAllRows) {
+        for (int row = 0; row < BENCH_ROWS; row++) {
+            fillRow(app, row);
+        }
+    }
+
+    int width, height;
+    glfmGetDisplaySize(display, &width, &height);
+    glViewport(0, 0, width, height);
+    glClearColor(0.6f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    textRendererDraw(app->text, -1.0f, -1.0f, 2.0f / BENCH_COLS, 2.0f / BENCH_ROWS, 0, BENCH_ROWS);
+    glFinish();
+
+    // The first frame of each phase creates buffers and uploads everything
+    if (app->frame > 0) {
+        app->totalFrameTime += glfmGetTime() - startTime;
+        app->uploadedRowCount += textRendererGetUploadedRowCount(app->text);
+    }
+}
+
+static void onDraw(GLFMDisplay *display) {
+    BenchApp *app = glfmGetUserData(display);
+    if (app->running) {
+        if (app->frame == 0 && app->phase == 0) {
+            printf("Text benchmark: %ix%i cells\n", BENCH_COLS, BENCH_ROWS);
+            for (int row = 0; row < BENCH_ROWS; row++) {
+                fillRow(app, row);
+            }
+            startPhase(app);
+        }
+        drawBenchFrame(display, app);
+        app->frame++;
+        if (app->frame > BENCH_FRAMES_PER_PHASE) {
+            endPhase(app);
+            app->phase++;
+            if (app->phase == BENCH_PHASE_COUNT) {
+                app->running = false;
+                app->needsRedraw = true;
+            } else {
+                startPhase(app);
+            }
+        }
+        glfmSwapBuffers(display);
+    } else if (app->needsRedraw) {
+        app->needsRedraw = false;
+
+        int width, height;
+        glfmGetDisplaySize(display, &width, &height);
+        glViewport(0, 0, width, height);
+        glClearColor(0.1f, 0.5f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glfmSwapBuffers(display);
+    }
+}
+
+static void startBenchmark(BenchApp *app) {
+    app->running = true;
+    app->phase = 0;
+    app->frame = 0;
+}
+
+static bool onTouch(GLFMDisplay *display, int touch, GLFMTouchPhase phase, double x, double y) {
+    BenchApp *app = glfmGetUserData(display);
+    if (phase == GLFMTouchPhaseEnded && !app->running) {
+        startBenchmark(app);
+        return true;
+    }
+    return false;
+}
+
+static bool onKey(GLFMDisplay *display, GLFMKeyCode keyCode, GLFMKeyAction action, int modifiers) {
+    BenchApp *app = glfmGetUserData(display);
+    if (action == GLFMKeyActionPressed && keyCode == GLFMKeyCodeSpace && !app->running) {
+        startBenchmark(app);
+        return true;
+    }
+    return false;
+}
+
+static void onSurfaceRefresh(GLFMDisplay *display) {
+    BenchApp *app = glfmGetUserData(display);
+    app->needsRedraw = true;
+}
+
+static void onSurfaceDestroyed(GLFMDisplay *display) {
+    BenchApp *app = glfmGetUserData(display);
+    textRendererContextLost(app->text);
+}
+
+void glfmMain(GLFMDisplay *display) {
+    BenchApp *app = calloc(1, sizeof(BenchApp));
+    app->text = textRendererCreate(display, BENCH_COLS, BENCH_ROWS);
+    if (!app->text) {
+        printf("Couldn't create text renderer\n");
+        free(app);
+        return;
+    }
+    startBenchmark(app);
+
+    glfmSetDisplayConfig(display,
+                         GLFMRenderingAPIOpenGLES3,
+                         GLFMColorFormatRGBA8888,
+                         GLFMDepthFormatNone,
+                         GLFMStencilFormatNone,
+                         GLFMMultisampleNone);
+    glfmSetUserData(display, app);
+    glfmSetSurfaceRefreshFunc(display, onSurfaceRefresh);
+    glfmSetSurfaceDestroyedFunc(display, onSurfaceDestroyed);
+    glfmSetRenderFunc(display, onDraw);
+    glfmSetTouchFunc(display, onTouch);
+    glfmSetKeyFunc(display, onKey);
+}
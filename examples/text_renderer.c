@@ -0,0 +1,672 @@
+#include "text_renderer.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    TEXTURE_CHARS_X = 8,
+    TEXTURE_CHARS_Y = (TEXT_FONT_CHAR_COUNT + TEXTURE_CHARS_X - 1) / TEXTURE_CHARS_X,
+    TEXTURE_SPACING = 1, // Prevent bleeding
+
+    // Fallback quads use GLushort indices, four vertices per cell (plus the cursor)
+    TEXT_MAX_CELLS = 16383,
+};
+
+// Cozette font converted to bitmap via Image Magick
+static const uint8_t FONT_DATA[TEXT_FONT_CHAR_COUNT][TEXT_FONT_CHAR_HEIGHT] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x00, 0x00, 0x00 },
+    { 0x00, 0x14, 0x14, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x14, 0x14, 0x3E, 0x14, 0x14, 0x3E, 0x14, 0x14, 0x00, 0x00, 0x00 },
+    { 0x00, 0x08, 0x1C, 0x2A, 0x0A, 0x1C, 0x28, 0x28, 0x2A, 0x1C, 0x08, 0x00, 0x00 },
+    { 0x00, 0x04, 0x0A, 0x24, 0x10, 0x08, 0x04, 0x12, 0x28, 0x10, 0x00, 0x00, 0x00 },
+    { 0x00, 0x08, 0x14, 0x14, 0x08, 0x2C, 0x12, 0x12, 0x12, 0x2C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x10, 0x08, 0x08, 0x04, 0x04, 0x04, 0x04, 0x04, 0x08, 0x08, 0x10, 0x00 },
+    { 0x00, 0x04, 0x08, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x08, 0x04, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x14, 0x08, 0x3E, 0x08, 0x14, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x3E, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x08, 0x04, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x20, 0x20, 0x10, 0x10, 0x08, 0x08, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x22, 0x2A, 0x2A, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x08, 0x0C, 0x0A, 0x08, 0x08, 0x08, 0x08, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x20, 0x10, 0x08, 0x04, 0x02, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x20, 0x18, 0x20, 0x20, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x20, 0x30, 0x28, 0x24, 0x22, 0x7E, 0x20, 0x20, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x3E, 0x02, 0x02, 0x1E, 0x20, 0x20, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x18, 0x04, 0x02, 0x1E, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x3E, 0x20, 0x10, 0x10, 0x08, 0x08, 0x04, 0x04, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x22, 0x1C, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x3C, 0x20, 0x10, 0x0C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x08, 0x04, 0x00 },
+    { 0x00, 0x00, 0x00, 0x20, 0x10, 0x08, 0x04, 0x08, 0x10, 0x20, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x20, 0x10, 0x08, 0x08, 0x00, 0x08, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x22, 0x3A, 0x2A, 0x3A, 0x02, 0x3C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1E, 0x22, 0x22, 0x1E, 0x22, 0x22, 0x22, 0x1E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x02, 0x02, 0x02, 0x02, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x0E, 0x12, 0x22, 0x22, 0x22, 0x22, 0x12, 0x0E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x3E, 0x02, 0x02, 0x1E, 0x02, 0x02, 0x02, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x3E, 0x02, 0x02, 0x1E, 0x02, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x02, 0x02, 0x32, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x22, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x38, 0x20, 0x20, 0x20, 0x20, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x22, 0x12, 0x0A, 0x0E, 0x12, 0x12, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x22, 0x36, 0x2A, 0x2A, 0x22, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x22, 0x26, 0x26, 0x2A, 0x2A, 0x32, 0x32, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1E, 0x22, 0x22, 0x22, 0x1E, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x12, 0x2C, 0x20, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1E, 0x22, 0x22, 0x1E, 0x12, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x02, 0x1C, 0x20, 0x20, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x3E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x22, 0x22, 0x22, 0x14, 0x14, 0x14, 0x08, 0x08, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x22, 0x22, 0x22, 0x2A, 0x2A, 0x1C, 0x14, 0x14, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x22, 0x22, 0x14, 0x08, 0x08, 0x14, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x22, 0x22, 0x22, 0x14, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x3E, 0x10, 0x08, 0x08, 0x04, 0x04, 0x02, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x1C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x1C, 0x00 },
+    { 0x00, 0x02, 0x02, 0x04, 0x04, 0x08, 0x08, 0x10, 0x10, 0x20, 0x20, 0x00, 0x00 },
+    { 0x00, 0x1C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1C, 0x00 },
+    { 0x08, 0x14, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x00 },
+    { 0x00, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x3C, 0x22, 0x22, 0x22, 0x32, 0x2C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x02, 0x02, 0x02, 0x1E, 0x22, 0x22, 0x22, 0x22, 0x1E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x1C, 0x22, 0x02, 0x02, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x20, 0x20, 0x20, 0x3C, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x1C, 0x22, 0x3E, 0x02, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x38, 0x04, 0x04, 0x1E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x3C, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x20, 0x20, 0x1C },
+    { 0x00, 0x02, 0x02, 0x02, 0x1E, 0x22, 0x22, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x08, 0x00, 0x0C, 0x08, 0x08, 0x08, 0x08, 0x30, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x10, 0x00, 0x18, 0x10, 0x10, 0x10, 0x10, 0x10, 0x14, 0x08, 0x00 },
+    { 0x00, 0x02, 0x02, 0x02, 0x22, 0x12, 0x0A, 0x0E, 0x12, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x0C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x18, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x16, 0x2A, 0x2A, 0x2A, 0x2A, 0x2A, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x1E, 0x22, 0x22, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x1E, 0x22, 0x22, 0x22, 0x22, 0x1E, 0x02, 0x02, 0x02 },
+    { 0x00, 0x00, 0x00, 0x00, 0x3C, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x20, 0x20, 0x60 },
+    { 0x00, 0x00, 0x00, 0x00, 0x1E, 0x22, 0x02, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x3C, 0x02, 0x1C, 0x20, 0x20, 0x1E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x04, 0x04, 0x1E, 0x04, 0x04, 0x04, 0x04, 0x38, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x22, 0x22, 0x14, 0x14, 0x08, 0x08, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x22, 0x22, 0x2A, 0x2A, 0x14, 0x14, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x22, 0x14, 0x08, 0x08, 0x14, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x20, 0x20, 0x1C },
+    { 0x00, 0x00, 0x00, 0x00, 0x3E, 0x10, 0x08, 0x04, 0x02, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x30, 0x08, 0x08, 0x08, 0x08, 0x06, 0x08, 0x08, 0x08, 0x08, 0x30, 0x00 },
+    { 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00 },
+    { 0x00, 0x06, 0x08, 0x08, 0x08, 0x08, 0x30, 0x08, 0x08, 0x08, 0x08, 0x06, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x2A, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00 },
+    { 0x00, 0x00, 0x00, 0x08, 0x1C, 0x2A, 0x0A, 0x0A, 0x2A, 0x1C, 0x08, 0x00, 0x00 },
+    { 0x00, 0x00, 0x18, 0x04, 0x04, 0x1E, 0x04, 0x04, 0x04, 0x3A, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x22, 0x1C, 0x14, 0x14, 0x1C, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x22, 0x22, 0x22, 0x14, 0x08, 0x3E, 0x08, 0x3E, 0x08, 0x00, 0x00, 0x00 },
+    { 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00 },
+    { 0x00, 0x1C, 0x22, 0x02, 0x0C, 0x14, 0x14, 0x18, 0x20, 0x22, 0x1C, 0x00, 0x00 },
+    { 0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x1C, 0x22, 0x5D, 0x45, 0x5D, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x18, 0x20, 0x38, 0x24, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x28, 0x14, 0x0A, 0x14, 0x28, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x1C, 0x22, 0x5D, 0x45, 0x45, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x0C, 0x12, 0x12, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x08, 0x08, 0x3E, 0x08, 0x08, 0x00, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x00, 0x0C, 0x12, 0x08, 0x04, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x0E, 0x10, 0x0C, 0x10, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x10, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x24, 0x24, 0x24, 0x24, 0x2C, 0x14, 0x04, 0x02, 0x00 },
+    { 0x00, 0x00, 0x3C, 0x2E, 0x2E, 0x2C, 0x28, 0x28, 0x28, 0x28, 0x28, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x1C, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x10, 0x0C, 0x00 },
+    { 0x00, 0x04, 0x06, 0x04, 0x04, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x10, 0x28, 0x10, 0x00, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x0A, 0x14, 0x28, 0x14, 0x0A, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x22, 0x12, 0x12, 0x0A, 0x08, 0x24, 0x34, 0x3A, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x22, 0x12, 0x12, 0x0A, 0x08, 0x14, 0x24, 0x12, 0x32, 0x00, 0x00, 0x00 },
+    { 0x00, 0x26, 0x14, 0x12, 0x0C, 0x0E, 0x24, 0x34, 0x3A, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x08, 0x08, 0x04, 0x02, 0x22, 0x1C, 0x00 },
+    { 0x04, 0x08, 0x00, 0x1C, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x10, 0x08, 0x00, 0x1C, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x08, 0x14, 0x00, 0x1C, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x2C, 0x1A, 0x00, 0x1C, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x14, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x08, 0x14, 0x08, 0x00, 0x1C, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x3C, 0x0A, 0x0A, 0x3A, 0x0E, 0x0A, 0x0A, 0x3A, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1C, 0x22, 0x02, 0x02, 0x02, 0x02, 0x22, 0x1C, 0x08, 0x08, 0x04 },
+    { 0x04, 0x08, 0x00, 0x3E, 0x02, 0x02, 0x1E, 0x02, 0x02, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x10, 0x08, 0x00, 0x3E, 0x02, 0x02, 0x1E, 0x02, 0x02, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x08, 0x14, 0x00, 0x3E, 0x02, 0x02, 0x1E, 0x02, 0x02, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x14, 0x00, 0x3E, 0x02, 0x02, 0x1E, 0x02, 0x02, 0x02, 0x3E, 0x00, 0x00, 0x00 },
+    { 0x04, 0x08, 0x00, 0x1C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x10, 0x08, 0x00, 0x1C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x08, 0x14, 0x00, 0x1C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x14, 0x00, 0x1C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x1C, 0x24, 0x24, 0x2E, 0x24, 0x24, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x2C, 0x1A, 0x00, 0x22, 0x26, 0x26, 0x2A, 0x32, 0x32, 0x22, 0x00, 0x00, 0x00 },
+    { 0x04, 0x08, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x10, 0x08, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x08, 0x14, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x2C, 0x1A, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x14, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x22, 0x14, 0x08, 0x14, 0x22, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x20, 0x1C, 0x32, 0x32, 0x2A, 0x2A, 0x26, 0x26, 0x1C, 0x02, 0x00, 0x00 },
+    { 0x04, 0x08, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x10, 0x08, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x08, 0x14, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x14, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x10, 0x08, 0x00, 0x22, 0x22, 0x22, 0x14, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x02, 0x02, 0x1E, 0x22, 0x22, 0x1E, 0x02, 0x02, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x0C, 0x12, 0x12, 0x0A, 0x12, 0x22, 0x22, 0x1A, 0x00, 0x00, 0x00 },
+    { 0x00, 0x04, 0x08, 0x00, 0x3C, 0x22, 0x22, 0x22, 0x32, 0x2C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x10, 0x08, 0x00, 0x3C, 0x22, 0x22, 0x22, 0x32, 0x2C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x08, 0x14, 0x00, 0x3C, 0x22, 0x22, 0x22, 0x32, 0x2C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x2C, 0x1A, 0x00, 0x3C, 0x22, 0x22, 0x22, 0x32, 0x2C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x14, 0x00, 0x3C, 0x22, 0x22, 0x22, 0x32, 0x2C, 0x00, 0x00, 0x00 },
+    { 0x08, 0x14, 0x08, 0x00, 0x3C, 0x22, 0x22, 0x22, 0x32, 0x2C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x1C, 0x2A, 0x3A, 0x0A, 0x2A, 0x14, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x1C, 0x22, 0x02, 0x02, 0x22, 0x1C, 0x08, 0x10, 0x0C },
+    { 0x00, 0x04, 0x08, 0x00, 0x1C, 0x22, 0x3E, 0x02, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x10, 0x08, 0x00, 0x1C, 0x22, 0x3E, 0x02, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x08, 0x14, 0x00, 0x1C, 0x22, 0x3E, 0x02, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x14, 0x00, 0x1C, 0x22, 0x3E, 0x02, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x04, 0x08, 0x00, 0x0C, 0x08, 0x08, 0x08, 0x08, 0x30, 0x00, 0x00, 0x00 },
+    { 0x00, 0x10, 0x08, 0x00, 0x0C, 0x08, 0x08, 0x08, 0x08, 0x30, 0x00, 0x00, 0x00 },
+    { 0x00, 0x08, 0x14, 0x00, 0x0C, 0x08, 0x08, 0x08, 0x08, 0x30, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x14, 0x00, 0x0C, 0x08, 0x08, 0x08, 0x08, 0x30, 0x00, 0x00, 0x00 },
+    { 0x00, 0x2C, 0x10, 0x28, 0x20, 0x3C, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x2C, 0x1A, 0x00, 0x1E, 0x22, 0x22, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00 },
+    { 0x00, 0x04, 0x08, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x10, 0x08, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x08, 0x14, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x2C, 0x1A, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x14, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x3E, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x20, 0x1C, 0x32, 0x2A, 0x2A, 0x26, 0x1C, 0x02, 0x00, 0x00 },
+    { 0x00, 0x04, 0x08, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x10, 0x08, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x08, 0x14, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x14, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x00, 0x00, 0x00 },
+    { 0x00, 0x10, 0x08, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x20, 0x20, 0x1C },
+    { 0x00, 0x00, 0x02, 0x02, 0x1E, 0x22, 0x22, 0x22, 0x22, 0x1E, 0x02, 0x02, 0x00 },
+    { 0x00, 0x00, 0x14, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x3C, 0x20, 0x20, 0x1C },
+};
+
+typedef void (*TextDrawArraysInstancedFunc)(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount);
+typedef void (*TextVertexAttribDivisorFunc)(GLuint index, GLuint divisor);
+
+// Per-instance record. The cell index is row * cols + col; the cursor record follows the last cell.
+typedef struct {
+    GLushort cell;
+    GLushort glyph;
+} TextInstance;
+
+// Fallback vertex: the instance record repeated for each corner of the quad.
+typedef struct {
+    TextInstance instance;
+    GLubyte corner[2];
+    GLubyte padding[2];
+} TextVertex;
+
+struct TextRenderer {
+    GLFMDisplay *display;
+    int cols;
+    int rows;
+    int cellCount;
+    GLushort *glyphs;
+    bool *dirtyRows;
+    bool anyRowDirty;
+    int cursorCell;
+    bool cursorVisible;
+    bool cursorDirty;
+    int uploadedRowCount;
+
+    bool instancingEnabled;
+    bool instanced; // Set when GL resources are created
+    TextDrawArraysInstancedFunc drawArraysInstanced;
+    TextVertexAttribDivisorFunc vertexAttribDivisor;
+    void *staging; // TextInstance or TextVertex, for (cellCount + 1) cells
+
+    GLuint program;
+    GLuint vertexArray;
+    GLuint texture;
+    GLuint cornerBuffer;
+    GLuint instanceBuffer;
+    GLuint indexBuffer;
+    GLint gridLocation;
+    GLint layoutLocation;
+    GLint atlasLocation;
+};
+
+static const GLchar TEXT_VERTEX_SHADER[] =
+    "#version 100\n"
+    "uniform highp vec4 gridInfo;\n" // cols, rows, firstRow, visibleRowCount
+    "uniform highp vec4 cellLayout;\n" // originX, originY, cellWidth, cellHeight
+    "uniform highp vec4 atlasInfo;\n" // charsX, charsY, glyph width and height (fraction of a texture cell)
+    "attribute mediump vec2 a_corner;\n"
+    "attribute highp vec2 a_instance;\n" // cell, glyph
+    "varying mediump vec2 texCoordFragment;\n"
+    "void main() {\n"
+    "    highp float row = floor((a_instance.x + 0.5) / gridInfo.x);\n"
+    "    highp float col = a_instance.x - row * gridInfo.x;\n"
+    "    highp float line = row - gridInfo.z;\n"
+    "    line += line < 0.0 ? gridInfo.y : 0.0;\n"
+    "    highp vec2 position = cellLayout.xy + (vec2(col, line) + a_corner) * cellLayout.zw;\n"
+    "    gl_Position = line < gridInfo.w ? vec4(position, 0.0, 1.0) : vec4(2.0, 2.0, 2.0, 1.0);\n"
+    "    highp float glyphY = floor((a_instance.y + 0.5) / atlasInfo.x);\n"
+    "    highp float glyphX = a_instance.y - glyphY * atlasInfo.x;\n"
+    "    texCoordFragment = (vec2(glyphX, glyphY) + a_corner * atlasInfo.zw) / atlasInfo.xy;\n"
+    "}";
+
+static const GLchar TEXT_FRAGMENT_SHADER[] =
+    "#version 100\n"
+    "uniform lowp sampler2D texture0;\n"
+    "varying mediump vec2 texCoordFragment;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(texture0, texCoordFragment);\n"
+    "}";
+
+static GLushort textGlyphForCodePoint(uint32_t codePoint) {
+    if (codePoint < TEXT_FONT_CHAR_FIRST || codePoint >= TEXT_FONT_CHAR_FIRST + TEXT_FONT_CHAR_COUNT) {
+        codePoint = ' ';
+    }
+    return (GLushort)(codePoint - TEXT_FONT_CHAR_FIRST);
+}
+
+static void textMarkAllDirty(TextRenderer *renderer) {
+    for (int row = 0; row < renderer->rows; row++) {
+        renderer->dirtyRows[row] = true;
+    }
+    renderer->anyRowDirty = true;
+    renderer->cursorDirty = true;
+}
+
+// MARK: - GL resources
+
+static void textCreateTexture(TextRenderer *renderer) {
+    GLsizei textureWidth = TEXTURE_CHARS_X * (TEXT_FONT_CHAR_WIDTH + TEXTURE_SPACING);
+    GLsizei textureHeight = TEXTURE_CHARS_Y * (TEXT_FONT_CHAR_HEIGHT + TEXTURE_SPACING);
+    size_t bpp = 4;
+    size_t stride = textureWidth * bpp;
+    uint8_t *textureData = calloc(stride, textureHeight);
+    if (!textureData) {
+        return;
+    }
+    for (size_t glyphIndex = 0; glyphIndex < TEXT_FONT_CHAR_COUNT; glyphIndex++) {
+        size_t offset = ((glyphIndex % TEXTURE_CHARS_X) * (TEXT_FONT_CHAR_WIDTH + TEXTURE_SPACING) * bpp +
+                         (glyphIndex / TEXTURE_CHARS_X) * (TEXT_FONT_CHAR_HEIGHT + TEXTURE_SPACING) * stride);
+        for (GLsizei y = 0; y < TEXT_FONT_CHAR_HEIGHT; y++) {
+            unsigned int row = FONT_DATA[glyphIndex][TEXT_FONT_CHAR_HEIGHT - y - 1];
+            for (GLsizei x = 0; x < TEXT_FONT_CHAR_WIDTH; x++) {
+                GLubyte b = ((row >> x) & 1);
+                textureData[offset++] = b * 0xff;
+                textureData[offset++] = b * 0xff;
+                textureData[offset++] = b * 0xff;
+                textureData[offset++] = b * 0xff;
+            }
+            offset += stride - bpp * TEXT_FONT_CHAR_WIDTH;
+        }
+    }
+
+    glGenTextures(1, &renderer->texture);
+    glBindTexture(GL_TEXTURE_2D, renderer->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    free(textureData);
+}
+
+static void textCreateBuffers(TextRenderer *renderer) {
+    const int recordCount = renderer->cellCount + 1;
+    renderer->instanced = (renderer->instancingEnabled && renderer->drawArraysInstanced &&
+                           renderer->vertexAttribDivisor);
+    if (renderer->instanced) {
+        static const GLubyte corners[4][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+        glGenBuffers(1, &renderer->cornerBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->cornerBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+        glGenBuffers(1, &renderer->instanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(sizeof(TextInstance) * recordCount), NULL, GL_DYNAMIC_DRAW);
+    } else {
+        glGenBuffers(1, &renderer->instanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(sizeof(TextVertex) * 4 * recordCount), NULL, GL_DYNAMIC_DRAW);
+
+        size_t indexCount = (size_t)recordCount * 6;
+        GLushort *indices = malloc(sizeof(GLushort) * indexCount);
+        if (indices) {
+            size_t i = 0;
+            for (int record = 0; record < recordCount; record++) {
+                GLushort base = (GLushort)(record * 4);
+                indices[i++] = base + 0;
+                indices[i++] = base + 1;
+                indices[i++] = base + 2;
+                indices[i++] = base + 3;
+                indices[i++] = base + 2;
+                indices[i++] = base + 1;
+            }
+            glGenBuffers(1, &renderer->indexBuffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->indexBuffer);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(sizeof(GLushort) * indexCount), indices,
+                         GL_STATIC_DRAW);
+            free(indices);
+        }
+    }
+    textMarkAllDirty(renderer);
+}
+
+static void textDeleteBuffers(TextRenderer *renderer) {
+    if (renderer->cornerBuffer != 0) {
+        glDeleteBuffers(1, &renderer->cornerBuffer);
+        renderer->cornerBuffer = 0;
+    }
+    if (renderer->instanceBuffer != 0) {
+        glDeleteBuffers(1, &renderer->instanceBuffer);
+        renderer->instanceBuffer = 0;
+    }
+    if (renderer->indexBuffer != 0) {
+        glDeleteBuffers(1, &renderer->indexBuffer);
+        renderer->indexBuffer = 0;
+    }
+}
+
+static bool textCreateResources(TextRenderer *renderer) {
+    if (renderer->program == 0) {
+        static const char *const attributeNames[] = { "a_corner", "a_instance" };
+        renderer->program = glfmCreateProgram(renderer->display, TEXT_VERTEX_SHADER, TEXT_FRAGMENT_SHADER,
+                                              attributeNames, 2);
+        if (renderer->program == 0) {
+            printf("Text renderer: Couldn't create program\n");
+            return false;
+        }
+
+        renderer->gridLocation = glGetUniformLocation(renderer->program, "gridInfo");
+        renderer->layoutLocation = glGetUniformLocation(renderer->program, "cellLayout");
+        renderer->atlasLocation = glGetUniformLocation(renderer->program, "atlasInfo");
+
+        // Core functions in OpenGL ES 3.0 and WebGL 2
+        renderer->drawArraysInstanced = NULL;
+        renderer->vertexAttribDivisor = NULL;
+        if (glfmGetRenderingAPI(renderer->display) >= GLFMRenderingAPIOpenGLES3) {
+            renderer->drawArraysInstanced =
+                (TextDrawArraysInstancedFunc)glfmGetProcAddress("glDrawArraysInstanced");
+            renderer->vertexAttribDivisor =
+                (TextVertexAttribDivisorFunc)glfmGetProcAddress("glVertexAttribDivisor");
+        }
+    }
+    if (renderer->texture == 0) {
+        textCreateTexture(renderer);
+    }
+#if defined(GL_VERSION_3_0) && GL_VERSION_3_0
+    if (renderer->vertexArray == 0) {
+        glGenVertexArrays(1, &renderer->vertexArray);
+    }
+#endif
+    if (renderer->instanceBuffer == 0) {
+        textCreateBuffers(renderer);
+    }
+    return renderer->program != 0 && renderer->texture != 0 && renderer->instanceBuffer != 0;
+}
+
+// MARK: - Uploads
+
+static void textFillRecords(TextRenderer *renderer, int firstRecord, int recordCount) {
+    for (int record = firstRecord; record < firstRecord + recordCount; record++) {
+        TextInstance instance;
+        if (record == renderer->cellCount) {
+            instance.cell = (GLushort)renderer->cursorCell;
+            instance.glyph = textGlyphForCodePoint('_');
+        } else {
+            instance.cell = (GLushort)record;
+            instance.glyph = renderer->glyphs[record];
+        }
+        if (renderer->instanced) {
+            ((TextInstance *)renderer->staging)[record] = instance;
+        } else {
+            TextVertex *vertex = (TextVertex *)renderer->staging + record * 4;
+            for (int corner = 0; corner < 4; corner++) {
+                vertex[corner].instance = instance;
+                vertex[corner].corner[0] = (GLubyte)(corner & 1);
+                vertex[corner].corner[1] = (GLubyte)(corner >> 1);
+                vertex[corner].padding[0] = 0;
+                vertex[corner].padding[1] = 0;
+            }
+        }
+    }
+    size_t recordSize = renderer->instanced ? sizeof(TextInstance) : sizeof(TextVertex) * 4;
+    glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(recordSize * firstRecord), (GLsizeiptr)(recordSize * recordCount),
+                    (const uint8_t *)renderer->staging + recordSize * firstRecord);
+}
+
+static void textUploadDirty(TextRenderer *renderer) {
+    renderer->uploadedRowCount = 0;
+    if (!renderer->anyRowDirty && !(renderer->cursorDirty && renderer->cursorVisible)) {
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->instanceBuffer);
+    if (renderer->anyRowDirty) {
+        // Upload each run of consecutive dirty rows with one call
+        int row = 0;
+        while (row < renderer->rows) {
+            if (!renderer->dirtyRows[row]) {
+                row++;
+                continue;
+            }
+            int firstRow = row;
+            while (row < renderer->rows && renderer->dirtyRows[row]) {
+                renderer->dirtyRows[row] = false;
+                row++;
+            }
+            textFillRecords(renderer, firstRow * renderer->cols, (row - firstRow) * renderer->cols);
+            renderer->uploadedRowCount += row - firstRow;
+        }
+        renderer->anyRowDirty = false;
+    }
+    if (renderer->cursorDirty && renderer->cursorVisible) {
+        textFillRecords(renderer, renderer->cellCount, 1);
+        renderer->cursorDirty = false;
+    }
+}
+
+// MARK: - Public
+
+TextRenderer *textRendererCreate(GLFMDisplay *display, int cols, int rows) {
+    if (cols <= 0 || rows <= 0 || cols * rows > TEXT_MAX_CELLS) {
+        return NULL;
+    }
+    TextRenderer *renderer = calloc(1, sizeof(TextRenderer));
+    if (!renderer) {
+        return NULL;
+    }
+    renderer->display = display;
+    renderer->cols = cols;
+    renderer->rows = rows;
+    renderer->cellCount = cols * rows;
+    renderer->instancingEnabled = true;
+    renderer->glyphs = calloc((size_t)renderer->cellCount, sizeof(GLushort));
+    renderer->dirtyRows = calloc((size_t)rows, sizeof(bool));
+    // Large enough for either record format
+    renderer->staging = malloc(sizeof(TextVertex) * 4 * (size_t)(renderer->cellCount + 1));
+    if (!renderer->glyphs || !renderer->dirtyRows || !renderer->staging) {
+        textRendererDestroy(renderer, false);
+        return NULL;
+    }
+    textMarkAllDirty(renderer);
+    return renderer;
+}
+
+void textRendererDestroy(TextRenderer *renderer, bool contextValid) {
+    if (!renderer) {
+        return;
+    }
+    if (contextValid) {
+        textDeleteBuffers(renderer);
+        if (renderer->texture != 0) {
+            glDeleteTextures(1, &renderer->texture);
+        }
+        if (renderer->program != 0) {
+            glDeleteProgram(renderer->program);
+        }
+#if defined(GL_VERSION_3_0) && GL_VERSION_3_0
+        if (renderer->vertexArray != 0) {
+            glDeleteVertexArrays(1, &renderer->vertexArray);
+        }
+#endif
+    }
+    free(renderer->glyphs);
+    free(renderer->dirtyRows);
+    free(renderer->staging);
+    free(renderer);
+}
+
+void textRendererContextLost(TextRenderer *renderer) {
+    renderer->program = 0;
+    renderer->vertexArray = 0;
+    renderer->texture = 0;
+    renderer->cornerBuffer = 0;
+    renderer->instanceBuffer = 0;
+    renderer->indexBuffer = 0;
+    textMarkAllDirty(renderer);
+}
+
+void textRendererSetChar(TextRenderer *renderer, int row, int col, uint32_t codePoint) {
+    if (row < 0 || row >= renderer->rows || col < 0 || col >= renderer->cols) {
+        return;
+    }
+    GLushort glyph = textGlyphForCodePoint(codePoint);
+    GLushort *cell = &renderer->glyphs[row * renderer->cols + col];
+    if (*cell != glyph) {
+        *cell = glyph;
+        renderer->dirtyRows[row] = true;
+        renderer->anyRowDirty = true;
+    }
+}
+
+void textRendererClearRow(TextRenderer *renderer, int row) {
+    for (int col = 0; col < renderer->cols; col++) {
+        textRendererSetChar(renderer, row, col, ' ');
+    }
+}
+
+void textRendererSetCursor(TextRenderer *renderer, int row, int col, bool visible) {
+    int cell = row * renderer->cols + col;
+    visible = visible && row >= 0 && row < renderer->rows && col >= 0 && col < renderer->cols;
+    if (visible && cell != renderer->cursorCell) {
+        renderer->cursorCell = cell;
+        renderer->cursorDirty = true;
+    }
+    renderer->cursorVisible = visible;
+}
+
+void textRendererSetInstancingEnabled(TextRenderer *renderer, bool enabled) {
+    if (renderer->instancingEnabled != enabled) {
+        renderer->instancingEnabled = enabled;
+        // Recreated with the other record format on the next draw
+        textDeleteBuffers(renderer);
+    }
+}
+
+bool textRendererIsInstanced(const TextRenderer *renderer) {
+    return renderer->instanced && renderer->instanceBuffer != 0;
+}
+
+int textRendererGetUploadedRowCount(const TextRenderer *renderer) {
+    return renderer->uploadedRowCount;
+}
+
+void textRendererDraw(TextRenderer *renderer, float originX, float originY, float cellWidth, float cellHeight,
+                      int firstRow, int visibleRowCount) {
+    if (!textCreateResources(renderer)) {
+        return;
+    }
+    textUploadDirty(renderer);
+
+    glUseProgram(renderer->program);
+    glUniform4f(renderer->gridLocation, (GLfloat)renderer->cols, (GLfloat)renderer->rows, (GLfloat)firstRow,
+                (GLfloat)visibleRowCount);
+    glUniform4f(renderer->layoutLocation, originX, originY, cellWidth, cellHeight);
+    glUniform4f(renderer->atlasLocation, (GLfloat)TEXTURE_CHARS_X, (GLfloat)TEXTURE_CHARS_Y,
+                (GLfloat)TEXT_FONT_CHAR_WIDTH / (TEXT_FONT_CHAR_WIDTH + TEXTURE_SPACING),
+                (GLfloat)TEXT_FONT_CHAR_HEIGHT / (TEXT_FONT_CHAR_HEIGHT + TEXTURE_SPACING));
+    glBindTexture(GL_TEXTURE_2D, renderer->texture);
+
+#if defined(GL_VERSION_3_0) && GL_VERSION_3_0
+    glBindVertexArray(renderer->vertexArray);
+#endif
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    GLsizei recordCount = (GLsizei)(renderer->cellCount + (renderer->cursorVisible ? 1 : 0));
+    if (renderer->instanced) {
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->cornerBuffer);
+        glVertexAttribPointer(0, 2, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(GLubyte) * 2, (void *)0);
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->instanceBuffer);
+        glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(TextInstance), (void *)0);
+        renderer->vertexAttribDivisor(1, 1);
+        renderer->drawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, recordCount);
+        renderer->vertexAttribDivisor(1, 0);
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->instanceBuffer);
+        glVertexAttribPointer(0, 2, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(TextVertex),
+                              (void *)offsetof(TextVertex, corner));
+        glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(TextVertex),
+                              (void *)offsetof(TextVertex, instance));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->indexBuffer);
+        glDrawElements(GL_TRIANGLES, recordCount * 6, GL_UNSIGNED_SHORT, (void *)0);
+    }
+}
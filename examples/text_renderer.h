@@ -0,0 +1,54 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "glfm.h"
+
+// Built-in font (ASCII and Latin-1 only)
+enum {
+    TEXT_FONT_CHAR_FIRST = ' ',
+    TEXT_FONT_CHAR_COUNT = 224,
+    TEXT_FONT_CHAR_WIDTH = 6,
+    TEXT_FONT_CHAR_HEIGHT = 13,
+};
+
+// A grid of character cells drawn with a bitmap font.
+//
+// Each cell is one instance record (cell index and glyph id). On OpenGL ES 3.0 and WebGL 2 the grid is drawn with
+// instancing; otherwise, each record is expanded to a quad. Only rows changed since the last draw are uploaded.
+//
+// Rows form a ring: textRendererDraw() places `firstRow` at the bottom and the following rows above it, so scrolling
+// changes a uniform instead of the cell data.
+typedef struct TextRenderer TextRenderer;
+
+// Returns NULL if the grid is too large (more than 16383 cells) or allocation fails.
+// GL resources are created on the first call to textRendererDraw().
+TextRenderer *textRendererCreate(GLFMDisplay *display, int cols, int rows);
+
+// Deletes GL resources (if the context is still valid) and frees the renderer.
+void textRendererDestroy(TextRenderer *renderer, bool contextValid);
+
+// Forgets GL resources after the context was lost. They are recreated on the next draw.
+void textRendererContextLost(TextRenderer *renderer);
+
+// Code points without a glyph (including 0) are drawn as a space.
+void textRendererSetChar(TextRenderer *renderer, int row, int col, uint32_t codePoint);
+void textRendererClearRow(TextRenderer *renderer, int row);
+
+// Draws an underscore over a cell. Only the cursor record is uploaded when it moves or blinks.
+void textRendererSetCursor(TextRenderer *renderer, int row, int col, bool visible);
+
+// For benchmarking. Instancing is enabled by default when available.
+void textRendererSetInstancingEnabled(TextRenderer *renderer, bool enabled);
+bool textRendererIsInstanced(const TextRenderer *renderer);
+
+// Number of rows uploaded by the most recent call to textRendererDraw().
+int textRendererGetUploadedRowCount(const TextRenderer *renderer);
+
+// Draws `visibleRowCount` rows, starting with `firstRow` at the bottom. Positions and sizes are in normalized device
+// coordinates. The caller sets up the viewport and blending.
+void textRendererDraw(TextRenderer *renderer, float originX, float originY, float cellWidth, float cellHeight,
+                      int firstRow, int visibleRowCount);
+
+#endif
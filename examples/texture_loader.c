@@ -0,0 +1,409 @@
+#include "texture_loader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__EMSCRIPTEN__)
+#include <emscripten/html5.h>
+#endif
+
+// OpenGL ES 3.0 constants, for builds using OpenGL ES 2.0 headers
+#ifndef GL_TEXTURE_BASE_LEVEL
+#define GL_TEXTURE_BASE_LEVEL 0x813C
+#endif
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+
+#define TEXTURE_LOADER_REQUIREMENT_COUNT (Ktx2RequirementBPTC + 1)
+
+typedef void (*TexStorage2DFunc)(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width,
+                                 GLsizei height);
+
+typedef struct {
+    TextureLoader *loader; // NULL if the loader was destroyed while the job was running
+    GLFMDisplay *display;
+    char *path;
+    TextureLoaderState state;
+    bool jobRunning;
+    bool needsLoad;
+
+    // Set by the job. The file is mapped with glfmMapAsset(), and levels point into it.
+    const uint8_t *fileData;
+    size_t fileSize;
+    bool readFailed;
+    Ktx2Result result;
+    Ktx2Texture ktx2;
+
+    // Upload
+    Ktx2UploadCursor cursor;
+    GLuint texture;
+    bool uploadStarted;
+    bool drawable;
+} TextureLoaderEntry;
+
+struct TextureLoader {
+    GLFMDisplay *display;
+    TextureLoaderEntry **entries;
+    int entryCount;
+    int entryCapacity;
+    Ktx2UploadCursor **cursors; // Scratch, entryCapacity long
+
+    bool capabilitiesKnown;
+    bool supported[TEXTURE_LOADER_REQUIREMENT_COUNT];
+    TexStorage2DFunc texStorage2D;
+};
+
+// MARK: - Capabilities
+
+static bool textureLoaderHasExtension(const char *extensions, const char *name) {
+    // Match whole names only ("GL_WEBGL_compressed_texture_etc" must not match "..._etc1")
+    size_t length = strlen(name);
+    const char *found = extensions;
+    while (found && (found = strstr(found, name)) != NULL) {
+        bool start = found == extensions || found[-1] == ' ';
+        bool end = found[length] == ' ' || found[length] == 0;
+        if (start && end) {
+            return true;
+        }
+        found += length;
+    }
+    return false;
+}
+
+static void textureLoaderQueryCapabilities(TextureLoader *loader) {
+    if (loader->capabilitiesKnown) {
+        return;
+    }
+    loader->capabilitiesKnown = true;
+
+#if defined(__EMSCRIPTEN__)
+    // WebGL extensions must be enabled before use. GLFM creates the context with extensions disabled by default.
+    static const char *webGLExtensions[] = {
+        "WEBGL_compressed_texture_astc", "WEBGL_compressed_texture_etc", "WEBGL_compressed_texture_s3tc",
+        "WEBGL_compressed_texture_s3tc_srgb", "EXT_texture_compression_rgtc", "EXT_texture_compression_bptc",
+    };
+    EMSCRIPTEN_WEBGL_CONTEXT_HANDLE context = emscripten_webgl_get_current_context();
+    for (size_t i = 0; i < sizeof(webGLExtensions) / sizeof(webGLExtensions[0]); i++) {
+        emscripten_webgl_enable_extension(context, webGLExtensions[i]);
+    }
+#endif
+
+    bool es3 = glfmGetRenderingAPI(loader->display) >= GLFMRenderingAPIOpenGLES3;
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    if (!extensions) {
+        extensions = "";
+    }
+    bool *supported = loader->supported;
+    supported[Ktx2RequirementNone] = true;
+    supported[Ktx2RequirementOpenGLES3] = es3;
+    supported[Ktx2RequirementASTC] = (textureLoaderHasExtension(extensions, "GL_KHR_texture_compression_astc_ldr") ||
+                                      textureLoaderHasExtension(extensions, "GL_WEBGL_compressed_texture_astc"));
+#if defined(__EMSCRIPTEN__)
+    supported[Ktx2RequirementETC2] = textureLoaderHasExtension(extensions, "GL_WEBGL_compressed_texture_etc");
+#elif defined(GL_VERSION_3_0) && GL_VERSION_3_0
+    supported[Ktx2RequirementETC2] = false; // Desktop OpenGL on macOS has no ETC2
+#else
+    // Core in OpenGL ES 3.0
+    supported[Ktx2RequirementETC2] = es3;
+#endif
+    supported[Ktx2RequirementS3TC] = (textureLoaderHasExtension(extensions, "GL_EXT_texture_compression_s3tc") ||
+                                      textureLoaderHasExtension(extensions, "GL_WEBGL_compressed_texture_s3tc"));
+    supported[Ktx2RequirementS3TCSRGB] =
+        (textureLoaderHasExtension(extensions, "GL_EXT_texture_compression_s3tc_srgb") ||
+         textureLoaderHasExtension(extensions, "GL_WEBGL_compressed_texture_s3tc_srgb") ||
+         (supported[Ktx2RequirementS3TC] && textureLoaderHasExtension(extensions, "GL_EXT_texture_sRGB")));
+    supported[Ktx2RequirementRGTC] = textureLoaderHasExtension(extensions, "GL_EXT_texture_compression_rgtc");
+    supported[Ktx2RequirementBPTC] = textureLoaderHasExtension(extensions, "GL_EXT_texture_compression_bptc");
+
+    // Immutable storage allows uploading levels in bands, and drawing before all levels are uploaded
+    loader->texStorage2D = es3 ? (TexStorage2DFunc)glfmGetProcAddress("glTexStorage2D") : NULL;
+}
+
+bool textureLoaderIsFormatSupported(TextureLoader *loader, const Ktx2Format *format) {
+    textureLoaderQueryCapabilities(loader);
+    return format && loader->supported[format->requirement];
+}
+
+Ktx2Family textureLoaderGetPreferredFamily(TextureLoader *loader) {
+    textureLoaderQueryCapabilities(loader);
+    if (loader->supported[Ktx2RequirementASTC]) {
+        return Ktx2FamilyASTC;
+    } else if (loader->supported[Ktx2RequirementETC2]) {
+        return Ktx2FamilyETC2;
+    } else if (loader->supported[Ktx2RequirementS3TC]) {
+        return Ktx2FamilyBC;
+    } else {
+        return Ktx2FamilyUncompressed;
+    }
+}
+
+const char *textureLoaderGetFamilyName(Ktx2Family family) {
+    switch (family) {
+        case Ktx2FamilyUncompressed: default:
+            return "rgba";
+        case Ktx2FamilyETC2:
+            return "etc2";
+        case Ktx2FamilyASTC:
+            return "astc";
+        case Ktx2FamilyBC:
+            return "bc";
+    }
+}
+
+// MARK: - Loading (worker thread)
+
+static void textureLoaderEntryFreeData(TextureLoaderEntry *entry) {
+    glfmUnmapAsset(entry->display, entry->fileData);
+    entry->fileData = NULL;
+    entry->fileSize = 0;
+    memset(&entry->ktx2, 0, sizeof(entry->ktx2));
+}
+
+static void textureLoaderEntryFree(TextureLoaderEntry *entry) {
+    textureLoaderEntryFreeData(entry);
+    free(entry->path);
+    free(entry);
+}
+
+static void textureLoaderJob(void *userData) {
+    TextureLoaderEntry *entry = userData;
+    entry->fileData = glfmMapAsset(entry->display, entry->path, &entry->fileSize);
+    entry->readFailed = (entry->fileData == NULL);
+    if (!entry->readFailed) {
+        entry->result = ktx2Parse(entry->fileData, entry->fileSize, &entry->ktx2);
+    }
+}
+
+static void textureLoaderJobComplete(GLFMDisplay *display, void *userData) {
+    TextureLoaderEntry *entry = userData;
+    entry->jobRunning = false;
+    if (!entry->loader) {
+        textureLoaderEntryFree(entry);
+        return;
+    }
+    if (entry->readFailed || entry->result != Ktx2ResultOK) {
+        printf("Couldn't load %s: %s\n", entry->path,
+               entry->readFailed ? "Couldn't read file" : ktx2ResultString(entry->result));
+        textureLoaderEntryFreeData(entry);
+        entry->state = TextureLoaderStateFailed;
+    }
+    // Otherwise, the texture is created in the next call to textureLoaderUpdate()
+}
+
+static void textureLoaderDispatch(TextureLoader *loader, TextureLoaderEntry *entry) {
+    entry->needsLoad = false;
+    entry->uploadStarted = false;
+    entry->state = TextureLoaderStateLoading;
+    entry->readFailed = false;
+    entry->result = Ktx2ResultOK;
+    entry->jobRunning = true;
+    if (!glfmDispatchAsync(loader->display, textureLoaderJob, textureLoaderJobComplete, entry)) {
+        entry->jobRunning = false;
+        entry->needsLoad = true; // Try again next update
+    }
+}
+
+// MARK: - Uploading (render thread)
+
+static void textureLoaderBeginUpload(TextureLoader *loader, TextureLoaderEntry *entry) {
+    const Ktx2Texture *ktx2 = &entry->ktx2;
+    if (!textureLoaderIsFormatSupported(loader, ktx2->format)) {
+        printf("Couldn't load %s: Format %u not supported by this device\n", entry->path,
+               (unsigned int)ktx2->format->vkFormat);
+        textureLoaderEntryFreeData(entry);
+        entry->state = TextureLoaderStateFailed;
+        return;
+    }
+
+    glGenTextures(1, &entry->texture);
+    glBindTexture(GL_TEXTURE_2D, entry->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    ktx2->levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    bool immutable = loader->texStorage2D != NULL;
+    if (immutable) {
+        loader->texStorage2D(GL_TEXTURE_2D, (GLsizei)ktx2->levelCount, ktx2->format->glInternalFormat,
+                             (GLsizei)ktx2->width, (GLsizei)ktx2->height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)ktx2->levelCount - 1);
+    }
+    ktx2UploadCursorInit(&entry->cursor, ktx2, immutable);
+    entry->uploadStarted = true;
+    entry->drawable = false;
+    entry->state = TextureLoaderStateUploading;
+}
+
+static void textureLoaderUploadChunk(void *userData, Ktx2UploadCursor *cursor, const Ktx2UploadChunk *chunk) {
+    TextureLoaderEntry *entry = (TextureLoaderEntry *)(void *)((uint8_t *)cursor -
+                                                               offsetof(TextureLoaderEntry, cursor));
+    const Ktx2Format *format = entry->ktx2.format;
+    bool compressed = format->family != Ktx2FamilyUncompressed;
+    GLint level = (GLint)chunk->level;
+    GLsizei width = (GLsizei)chunk->width;
+    GLsizei height = (GLsizei)chunk->height;
+
+    glBindTexture(GL_TEXTURE_2D, entry->texture);
+    if (cursor->splitLevels) {
+        if (compressed) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, (GLint)chunk->y, width, height,
+                                      format->glInternalFormat, (GLsizei)chunk->size, chunk->data);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, (GLint)chunk->y, width, height, GL_RGBA, GL_UNSIGNED_BYTE,
+                            chunk->data);
+        }
+        if (chunk->levelComplete) {
+            // Draw with the levels uploaded so far
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+            entry->drawable = true;
+        }
+    } else {
+        if (compressed) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, format->glInternalFormat, width, height, 0,
+                                   (GLsizei)chunk->size, chunk->data);
+        } else {
+            // Unsized internal format, for OpenGL ES 2.0
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, chunk->data);
+        }
+    }
+    if (chunk->textureComplete) {
+        entry->drawable = true;
+        entry->state = TextureLoaderStateReady;
+        // The levels point into the file data
+        textureLoaderEntryFreeData(entry);
+    }
+}
+
+// MARK: - Public
+
+TextureLoader *textureLoaderCreate(GLFMDisplay *display) {
+    TextureLoader *loader = calloc(1, sizeof(TextureLoader));
+    if (loader) {
+        loader->display = display;
+    }
+    return loader;
+}
+
+void textureLoaderDestroy(TextureLoader *loader, bool contextValid) {
+    if (!loader) {
+        return;
+    }
+    for (int i = 0; i < loader->entryCount; i++) {
+        TextureLoaderEntry *entry = loader->entries[i];
+        if (contextValid && entry->texture != 0) {
+            glDeleteTextures(1, &entry->texture);
+        }
+        if (entry->jobRunning) {
+            // Freed by the completion function
+            entry->loader = NULL;
+        } else {
+            textureLoaderEntryFree(entry);
+        }
+    }
+    free(loader->entries);
+    free(loader->cursors);
+    free(loader);
+}
+
+void textureLoaderContextLost(TextureLoader *loader) {
+    loader->capabilitiesKnown = false;
+    for (int i = 0; i < loader->entryCount; i++) {
+        TextureLoaderEntry *entry = loader->entries[i];
+        entry->texture = 0;
+        entry->drawable = false;
+        if (entry->state == TextureLoaderStateReady) {
+            // The file data was freed after uploading
+            entry->needsLoad = true;
+            entry->state = TextureLoaderStateLoading;
+        } else if (entry->state == TextureLoaderStateUploading) {
+            // Start over with the data still in memory
+            entry->uploadStarted = false;
+            entry->state = TextureLoaderStateLoading;
+        }
+    }
+}
+
+int textureLoaderLoad(TextureLoader *loader, const char *path) {
+    if (!loader || !path) {
+        return -1;
+    }
+    if (loader->entryCount == loader->entryCapacity) {
+        int newCapacity = loader->entryCapacity == 0 ? 16 : loader->entryCapacity * 2;
+        TextureLoaderEntry **entries = realloc(loader->entries, sizeof(TextureLoaderEntry *) * (size_t)newCapacity);
+        if (!entries) {
+            return -1;
+        }
+        loader->entries = entries;
+        Ktx2UploadCursor **cursors = realloc(loader->cursors, sizeof(Ktx2UploadCursor *) * (size_t)newCapacity);
+        if (!cursors) {
+            return -1;
+        }
+        loader->cursors = cursors;
+        loader->entryCapacity = newCapacity;
+    }
+    TextureLoaderEntry *entry = calloc(1, sizeof(TextureLoaderEntry));
+    char *pathCopy = malloc(strlen(path) + 1);
+    if (!entry || !pathCopy) {
+        free(entry);
+        free(pathCopy);
+        return -1;
+    }
+    strcpy(pathCopy, path);
+    entry->loader = loader;
+    entry->display = loader->display;
+    entry->path = pathCopy;
+    loader->entries[loader->entryCount] = entry;
+    textureLoaderDispatch(loader, entry);
+    return loader->entryCount++;
+}
+
+size_t textureLoaderUpdate(TextureLoader *loader, size_t byteBudget) {
+    textureLoaderQueryCapabilities(loader);
+    int cursorCount = 0;
+    for (int i = 0; i < loader->entryCount; i++) {
+        TextureLoaderEntry *entry = loader->entries[i];
+        if (entry->needsLoad) {
+            textureLoaderDispatch(loader, entry);
+        }
+        if (entry->state == TextureLoaderStateLoading && !entry->jobRunning && !entry->needsLoad &&
+            !entry->uploadStarted) {
+            textureLoaderBeginUpload(loader, entry);
+        }
+        if (entry->state == TextureLoaderStateUploading) {
+            loader->cursors[cursorCount++] = &entry->cursor;
+        }
+    }
+    if (cursorCount == 0) {
+        return 0;
+    }
+    size_t uploaded = ktx2ScheduleUploads(loader->cursors, cursorCount, byteBudget, textureLoaderUploadChunk, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return uploaded;
+}
+
+TextureLoaderState textureLoaderGetState(const TextureLoader *loader, int handle) {
+    if (!loader || handle < 0 || handle >= loader->entryCount) {
+        return TextureLoaderStateFailed;
+    }
+    return loader->entries[handle]->state;
+}
+
+GLuint textureLoaderGetTexture(const TextureLoader *loader, int handle) {
+    if (!loader || handle < 0 || handle >= loader->entryCount) {
+        return 0;
+    }
+    const TextureLoaderEntry *entry = loader->entries[handle];
+    return entry->drawable ? entry->texture : 0;
+}
+
+bool textureLoaderIsIdle(const TextureLoader *loader) {
+    for (int i = 0; i < loader->entryCount; i++) {
+        TextureLoaderState state = loader->entries[i]->state;
+        if (state != TextureLoaderStateReady && state != TextureLoaderStateFailed) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "glfm.h"
+#include "ktx2.h"
+
+// Loads KTX2 textures in the background and uploads them over several frames.
+//
+// Files are mapped (see glfmMapAsset) and parsed on a worker thread (see glfmDispatchAsync). Mip levels are then
+// uploaded on the render thread, smallest first, within a per-frame byte budget, so a texture can be drawn (blurry)
+// before it's complete.
+// On OpenGL ES 3.0 and WebGL 2, storage is allocated with glTexStorage2D and large levels are split into bands of
+// block rows. On OpenGL ES 2.0, whole levels are uploaded, and a texture can't be drawn until all levels are uploaded.
+//
+// Apps usually ship each texture in several compressed formats and load the variant returned by
+// textureLoaderGetPreferredFamily().
+typedef struct TextureLoader TextureLoader;
+
+typedef enum {
+    TextureLoaderStateLoading,   // Reading and parsing the file
+    TextureLoaderStateUploading, // Some levels uploaded; drawable on OpenGL ES 3.0
+    TextureLoaderStateReady,
+    TextureLoaderStateFailed,
+} TextureLoaderState;
+
+TextureLoader *textureLoaderCreate(GLFMDisplay *display);
+
+// Deletes textures (if the context is still valid) and frees the loader. Loads still running on worker threads are
+// discarded when they finish.
+void textureLoaderDestroy(TextureLoader *loader, bool contextValid);
+
+// Forgets GL textures after the context was lost. Loaded textures are read again and re-uploaded.
+void textureLoaderContextLost(TextureLoader *loader);
+
+// The following functions must be called on the render thread, with a current context.
+
+// Returns true if textures in the format can be uploaded.
+bool textureLoaderIsFormatSupported(TextureLoader *loader, const Ktx2Format *format);
+
+// Returns the preferred supported family: ASTC, then ETC2, then BC, then uncompressed. Only the requirements of the
+// common formats (ASTC LDR, ETC2, BC1-BC3) are checked.
+Ktx2Family textureLoaderGetPreferredFamily(TextureLoader *loader);
+
+// Short name of a family, like "astc", for file name variants.
+const char *textureLoaderGetFamilyName(Ktx2Family family);
+
+// Starts loading a KTX2 file, given an asset path or an absolute path. Returns a handle, or -1 if the load couldn't be
+// started.
+int textureLoaderLoad(TextureLoader *loader, const char *path);
+
+// Uploads pending levels, up to `byteBudget` bytes (at least one block row or level, if any are pending). Call once
+// per frame. Returns the number of bytes uploaded.
+size_t textureLoaderUpdate(TextureLoader *loader, size_t byteBudget);
+
+TextureLoaderState textureLoaderGetState(const TextureLoader *loader, int handle);
+
+// Returns the GL texture, or 0 if it can't be drawn yet.
+GLuint textureLoaderGetTexture(const TextureLoader *loader, int handle);
+
+// Returns true if all textures are ready (or failed).
+bool textureLoaderIsIdle(const TextureLoader *loader);
+
+#endif
@@ -0,0 +1,545 @@
+// Texture streaming benchmark. Writes eight 1024x1024 KTX2 textures with full mipmaps to the cache directory (on
+// worker threads, in the best compressed format the device supports), then loads them with TextureLoader and draws
+// them in a grid as their levels arrive. Results are printed to the console.
+// The background is red while textures load, and green when finished.
+// Run again: Tap, or Spacebar. Runs alternate between a per-frame upload budget and no budget.
+//
+// "Max update" is the longest time spent in textureLoaderUpdate() in one frame, which is the frame time spike caused
+// by uploads. Without a budget, every texture is uploaded in the frame its file finishes loading.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "glfm.h"
+#include "ktx2.h"
+#include "texture_loader.h"
+#include "file_compat.h"
+
+#define FILE_COMPAT_ANDROID_ACTIVITY glfmGetAndroidActivity(display)
+
+enum {
+    STREAM_TEXTURE_COUNT = 8,
+    STREAM_TEXTURE_SIZE = 1024,
+    STREAM_CHECKER_SIZE = 64,
+    STREAM_UPLOAD_BUDGET = 1024 * 1024, // Bytes per frame
+};
+
+static const char *STREAM_VERTEX_SHADER =
+    "#version 100\n"
+    "attribute vec2 position;\n"
+    "uniform vec4 rect;\n"
+    "varying vec2 texCoord;\n"
+    "void main() {\n"
+    "    texCoord = position;\n"
+    "    gl_Position = vec4(rect.xy + position * rect.zw, 0, 1);\n"
+    "}\n";
+
+static const char *STREAM_FRAGMENT_SHADER =
+    "#version 100\n"
+    "precision mediump float;\n"
+    "uniform sampler2D tex;\n"
+    "varying vec2 texCoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(tex, texCoord);\n"
+    "}\n";
+
+typedef enum {
+    StreamStateStarting,
+    StreamStateGenerating,
+    StreamStateLoading,
+    StreamStateIdle,
+} StreamState;
+
+typedef struct {
+    GLFMDisplay *display;
+    int index;
+    Ktx2Family family;
+    char path[PATH_MAX];
+    bool written;
+} StreamFile;
+
+typedef struct {
+    GLFMDisplay *display;
+    StreamState state;
+    Ktx2Family family;
+    StreamFile files[STREAM_TEXTURE_COUNT];
+    int generatedCount;
+
+    TextureLoader *loader;
+    int handles[STREAM_TEXTURE_COUNT];
+    bool budgetEnabled;
+
+    // Current run
+    double startTime;
+    int frameCount;
+    int firstDrawableFrame;
+    double maxUpdateTime;
+    size_t uploadedBytes;
+
+    GLuint program;
+    GLint uniformRect;
+    GLuint vertexBuffer;
+    GLuint vertexArray;
+    bool needsRedraw;
+} StreamApp;
+
+// MARK: - Texture generation (worker thread)
+
+static void streamPixel(int index, uint32_t level, uint32_t x, uint32_t y, uint8_t rgb[3]) {
+    static const uint8_t colors[STREAM_TEXTURE_COUNT][3] = {
+        { 230, 60, 60 }, { 230, 160, 40 }, { 220, 220, 60 }, { 70, 200, 70 },
+        { 60, 200, 200 }, { 60, 110, 230 }, { 150, 80, 220 }, { 230, 80, 180 },
+    };
+    static const uint8_t dark[3] = { 40, 40, 40 };
+    uint32_t checkerSize = STREAM_CHECKER_SIZE >> level;
+    if (checkerSize == 0) {
+        // Smaller than a pixel: the average of both colors
+        for (int i = 0; i < 3; i++) {
+            rgb[i] = (uint8_t)((colors[index][i] + dark[i]) / 2);
+        }
+    } else {
+        const uint8_t *color = (((x / checkerSize) ^ (y / checkerSize)) & 1) ? dark : colors[index];
+        memcpy(rgb, color, 3);
+    }
+}
+
+// Averages the pixels of the block at (x, y), clipped to the level size.
+static void streamBlockColor(int index, uint32_t level, uint32_t levelSize, uint32_t x, uint32_t y,
+                             uint8_t rgb[3]) {
+    uint32_t sum[3] = { 0 };
+    uint32_t count = 0;
+    for (uint32_t by = y; by < y + 4 && by < levelSize; by++) {
+        for (uint32_t bx = x; bx < x + 4 && bx < levelSize; bx++) {
+            uint8_t pixel[3];
+            streamPixel(index, level, bx, by, pixel);
+            for (int i = 0; i < 3; i++) {
+                sum[i] += pixel[i];
+            }
+            count++;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        rgb[i] = (uint8_t)((sum[i] + count / 2) / count);
+    }
+}
+
+// The blocks below are single-color blocks, which is enough to show the checkerboard (the checker edges are
+// block-aligned) and keeps the encoders short. Real apps should use a texture compressor.
+
+static void streamEncodeBC1(const uint8_t rgb[3], uint8_t *block) {
+    // color0 == color1, all indices 0
+    uint16_t color = (uint16_t)(((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3));
+    block[0] = (uint8_t)(color & 0xff);
+    block[1] = (uint8_t)(color >> 8);
+    block[2] = block[0];
+    block[3] = block[1];
+    memset(block + 4, 0, 4);
+}
+
+static void streamEncodeETC2(const uint8_t rgb[3], uint8_t *block) {
+    // ETC1 "individual" mode (valid ETC2) with 4-bit base colors and modifier table 0. Every pixel uses the modifier
+    // that best matches the color.
+    static const int modifiers[4] = { 2, 8, -2, -8 };
+    uint8_t base[3];
+    for (int i = 0; i < 3; i++) {
+        base[i] = (uint8_t)((rgb[i] + 8) / 17);
+    }
+    int bestModifier = 0;
+    int bestError = INT32_MAX;
+    for (int m = 0; m < 4; m++) {
+        int error = 0;
+        for (int i = 0; i < 3; i++) {
+            int value = base[i] * 17 + modifiers[m];
+            value = value < 0 ? 0 : (value > 255 ? 255 : value);
+            error += (value - rgb[i]) * (value - rgb[i]);
+        }
+        if (error < bestError) {
+            bestError = error;
+            bestModifier = m;
+        }
+    }
+    block[0] = (uint8_t)((base[0] << 4) | base[0]);
+    block[1] = (uint8_t)((base[1] << 4) | base[1]);
+    block[2] = (uint8_t)((base[2] << 4) | base[2]);
+    block[3] = 0; // Table 0 for both halves, individual mode, no flip
+    uint8_t msb = (bestModifier & 2) ? 0xff : 0x00;
+    uint8_t lsb = (bestModifier & 1) ? 0xff : 0x00;
+    block[4] = msb;
+    block[5] = msb;
+    block[6] = lsb;
+    block[7] = lsb;
+}
+
+static void streamEncodeASTC(const uint8_t rgb[3], uint8_t *block) {
+    // LDR void-extent block: a constant color with no extent
+    static const uint8_t header[8] = { 0xfc, 0xfd, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    memcpy(block, header, sizeof(header));
+    for (int i = 0; i < 4; i++) {
+        uint16_t value = (uint16_t)((i < 3 ? rgb[i] : 255) * 257);
+        block[8 + i * 2] = (uint8_t)(value & 0xff);
+        block[9 + i * 2] = (uint8_t)(value >> 8);
+    }
+}
+
+static void streamEncodeLevel(int index, const Ktx2Format *format, uint32_t level, uint8_t *data) {
+    uint32_t size = STREAM_TEXTURE_SIZE >> level;
+    if (format->family == Ktx2FamilyUncompressed) {
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                uint8_t *pixel = data + (y * size + x) * 4;
+                streamPixel(index, level, x, y, pixel);
+                pixel[3] = 255;
+            }
+        }
+        return;
+    }
+    for (uint32_t y = 0; y < size; y += 4) {
+        for (uint32_t x = 0; x < size; x += 4) {
+            uint8_t rgb[3];
+            streamBlockColor(index, level, size, x, y, rgb);
+            switch (format->family) {
+                case Ktx2FamilyBC:
+                    streamEncodeBC1(rgb, data);
+                    break;
+                case Ktx2FamilyETC2:
+                    streamEncodeETC2(rgb, data);
+                    break;
+                case Ktx2FamilyASTC: default:
+                    streamEncodeASTC(rgb, data);
+                    break;
+            }
+            data += format->blockSize;
+        }
+    }
+}
+
+static void streamWriteU32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(value >> (i * 8));
+    }
+}
+
+static void streamWriteU64(uint8_t *p, uint64_t value) {
+    streamWriteU32(p, (uint32_t)value);
+    streamWriteU32(p + 4, (uint32_t)(value >> 32));
+}
+
+static bool streamWriteKTX2(const StreamFile *file) {
+    GLFMDisplay *display = file->display;
+    (void)display; // Used by fopen on Android
+    static const uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    static const uint32_t vkFormats[] = {
+        [Ktx2FamilyUncompressed] = 37, // R8G8B8A8_UNORM
+        [Ktx2FamilyETC2] = 147,        // ETC2_R8G8B8_UNORM_BLOCK
+        [Ktx2FamilyASTC] = 157,        // ASTC_4x4_UNORM_BLOCK
+        [Ktx2FamilyBC] = 131,          // BC1_RGB_UNORM_BLOCK
+    };
+    const Ktx2Format *format = ktx2GetFormat(vkFormats[file->family]);
+    uint32_t levelCount = 1;
+    while ((STREAM_TEXTURE_SIZE >> levelCount) > 0) {
+        levelCount++;
+    }
+
+    // Header, level index, and a minimal data format descriptor (a basic block with no samples, which is all
+    // ktx2Parse() needs). Levels are stored smallest first, 16-byte aligned.
+    const uint32_t indexSize = levelCount * 24;
+    const uint32_t dfdOffset = 80 + indexSize;
+    const uint32_t dfdSize = 28;
+    size_t offsets[KTX2_MAX_LEVELS];
+    size_t offset = (dfdOffset + dfdSize + 15) & ~(size_t)15;
+    for (uint32_t level = levelCount; level-- > 0;) {
+        uint32_t size = STREAM_TEXTURE_SIZE >> level;
+        offsets[level] = offset;
+        offset = (offset + ktx2GetLevelSize(format, size, size) + 15) & ~(size_t)15;
+    }
+    const size_t fileSize = offset;
+    uint8_t *data = calloc(1, fileSize);
+    if (!data) {
+        return false;
+    }
+
+    memcpy(data, identifier, sizeof(identifier));
+    streamWriteU32(data + 12, format->vkFormat);
+    streamWriteU32(data + 16, 1); // typeSize
+    streamWriteU32(data + 20, STREAM_TEXTURE_SIZE);
+    streamWriteU32(data + 24, STREAM_TEXTURE_SIZE);
+    streamWriteU32(data + 36, 1); // faceCount
+    streamWriteU32(data + 40, levelCount);
+    streamWriteU32(data + 48, dfdOffset);
+    streamWriteU32(data + 52, dfdSize);
+    for (uint32_t level = 0; level < levelCount; level++) {
+        uint32_t size = STREAM_TEXTURE_SIZE >> level;
+        size_t levelSize = ktx2GetLevelSize(format, size, size);
+        uint8_t *entry = data + 80 + level * 24;
+        streamWriteU64(entry, offsets[level]);
+        streamWriteU64(entry + 8, levelSize);
+        streamWriteU64(entry + 16, levelSize);
+        streamEncodeLevel(file->index, format, level, data + offsets[level]);
+    }
+    streamWriteU32(data + dfdOffset, dfdSize);
+    streamWriteU32(data + dfdOffset + 8, (2 << 0) | (24 << 16)); // versionNumber 2, descriptorBlockSize 24
+
+    FILE *out = fopen(file->path, "wb");
+    bool success = out && fwrite(data, 1, fileSize, out) == fileSize;
+    if (out) {
+        success = (fclose(out) == 0) && success;
+    }
+    free(data);
+    return success;
+}
+
+static void streamGenerateJob(void *userData) {
+    StreamFile *file = userData;
+    file->written = streamWriteKTX2(file);
+}
+
+// MARK: - Benchmark (render thread)
+
+static void streamStartRun(StreamApp *app) {
+    // A new loader for each run, so every texture is read and uploaded again
+    textureLoaderDestroy(app->loader, true);
+    app->loader = textureLoaderCreate(app->display);
+    for (int i = 0; i < STREAM_TEXTURE_COUNT; i++) {
+        app->handles[i] = app->files[i].written ? textureLoaderLoad(app->loader, app->files[i].path) : -1;
+    }
+    app->state = StreamStateLoading;
+    app->startTime = glfmGetTime();
+    app->frameCount = 0;
+    app->firstDrawableFrame = 0;
+    app->maxUpdateTime = 0.0;
+    app->uploadedBytes = 0;
+    app->needsRedraw = true;
+}
+
+static void streamGenerateComplete(GLFMDisplay *display, void *userData) {
+    StreamApp *app = glfmGetUserData(display);
+    StreamFile *file = userData;
+    if (!file->written) {
+        printf("Couldn't write %s\n", file->path);
+    }
+    app->generatedCount++;
+    if (app->generatedCount == STREAM_TEXTURE_COUNT) {
+        printf("Generated %i %s textures in %.2f ms\n", STREAM_TEXTURE_COUNT,
+               textureLoaderGetFamilyName(app->family), 1000.0 * (glfmGetTime() - app->startTime));
+        streamStartRun(app);
+    }
+}
+
+static void streamGenerate(StreamApp *app) {
+    GLFMDisplay *display = app->display;
+    // The preferred family requires a current context, so this is called from the first frame
+    TextureLoader *probe = textureLoaderCreate(display);
+    app->family = textureLoaderGetPreferredFamily(probe);
+    textureLoaderDestroy(probe, true);
+
+    char cacheDir[PATH_MAX];
+    if (fc_cachedir("GLFMTextureStream", cacheDir, sizeof(cacheDir)) != 0) {
+        cacheDir[0] = 0;
+    }
+    app->state = StreamStateGenerating;
+    app->generatedCount = 0;
+    app->startTime = glfmGetTime();
+    for (int i = 0; i < STREAM_TEXTURE_COUNT; i++) {
+        StreamFile *file = &app->files[i];
+        file->display = display;
+        file->index = i;
+        file->family = app->family;
+        file->written = false;
+        snprintf(file->path, sizeof(file->path), "%stexture_stream_%i_%s.ktx2", cacheDir, i,
+                 textureLoaderGetFamilyName(app->family));
+        if (!glfmDispatchAsync(display, streamGenerateJob, streamGenerateComplete, file)) {
+            streamGenerateJob(file);
+            streamGenerateComplete(display, file);
+        }
+    }
+}
+
+static void streamFinishRun(StreamApp *app) {
+    double totalTime = glfmGetTime() - app->startTime;
+    if (app->budgetEnabled) {
+        printf("Budget %i KB/frame:\n", STREAM_UPLOAD_BUDGET / 1024);
+    } else {
+        printf("No budget:\n");
+    }
+    printf("  %i textures (%s), %.1f MB uploaded\n", STREAM_TEXTURE_COUNT, textureLoaderGetFamilyName(app->family),
+           (double)app->uploadedBytes / (1024.0 * 1024.0));
+    printf("  All drawable: frame %i. Complete: %i frames, %.2f ms\n", app->firstDrawableFrame, app->frameCount,
+           1000.0 * totalTime);
+    printf("  Max update: %.2f ms\n", 1000.0 * app->maxUpdateTime);
+    app->state = StreamStateIdle;
+    app->budgetEnabled = !app->budgetEnabled;
+}
+
+// MARK: - GLFM callbacks
+
+static void onSurfaceCreated(GLFMDisplay *display, int width, int height) {
+    StreamApp *app = glfmGetUserData(display);
+    const char *attributeNames[] = { "position" };
+    app->program = glfmCreateProgram(display, STREAM_VERTEX_SHADER, STREAM_FRAGMENT_SHADER, attributeNames, 1);
+    if (app->program != 0) {
+        app->uniformRect = glGetUniformLocation(app->program, "rect");
+        glUseProgram(app->program);
+        glUniform1i(glGetUniformLocation(app->program, "tex"), 0);
+    }
+
+    static const float vertices[] = {
+        0, 0,
+        1, 0,
+        0, 1,
+        1, 1
+    };
+    glGenBuffers(1, &app->vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, app->vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+#if defined(GL_VERSION_3_0) && GL_VERSION_3_0
+    glGenVertexArrays(1, &app->vertexArray);
+    glBindVertexArray(app->vertexArray);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, 0);
+#endif
+    app->needsRedraw = true;
+}
+
+static void onSurfaceDestroyed(GLFMDisplay *display) {
+    // When the surface is destroyed, all existing GL resources are no longer valid.
+    StreamApp *app = glfmGetUserData(display);
+    app->program = 0;
+    app->vertexBuffer = 0;
+    app->vertexArray = 0;
+    if (app->loader) {
+        textureLoaderContextLost(app->loader);
+    }
+}
+
+static void onSurfaceRefresh(GLFMDisplay *display) {
+    StreamApp *app = glfmGetUserData(display);
+    app->needsRedraw = true;
+}
+
+static bool onTouch(GLFMDisplay *display, int touch, GLFMTouchPhase phase, double x, double y) {
+    StreamApp *app = glfmGetUserData(display);
+    if (phase == GLFMTouchPhaseEnded && app->state == StreamStateIdle) {
+        streamStartRun(app);
+        return true;
+    }
+    return false;
+}
+
+static bool onKey(GLFMDisplay *display, GLFMKeyCode keyCode, GLFMKeyAction action, int modifiers) {
+    StreamApp *app = glfmGetUserData(display);
+    if (action == GLFMKeyActionPressed && keyCode == GLFMKeyCodeSpace && app->state == StreamStateIdle) {
+        streamStartRun(app);
+        return true;
+    }
+    return false;
+}
+
+static void drawTextures(StreamApp *app, int width, int height) {
+    if (app->program == 0 || !app->loader) {
+        return;
+    }
+    // Square cells in a grid that fits the display
+    int columns = 1;
+    while (columns * columns < STREAM_TEXTURE_COUNT) {
+        columns++;
+    }
+    int rows = (STREAM_TEXTURE_COUNT + columns - 1) / columns;
+    float cellSize = (float)width / (float)columns < (float)height / (float)rows ?
+        (float)width / (float)columns : (float)height / (float)rows;
+    float cellWidth = 2.0f * cellSize / (float)width;
+    float cellHeight = 2.0f * cellSize / (float)height;
+    float originX = -0.5f * cellWidth * (float)columns;
+    float originY = 0.5f * cellHeight * (float)rows;
+
+    glUseProgram(app->program);
+#if defined(GL_VERSION_3_0) && GL_VERSION_3_0
+    glBindVertexArray(app->vertexArray);
+#else
+    glBindBuffer(GL_ARRAY_BUFFER, app->vertexBuffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, 0);
+#endif
+    glActiveTexture(GL_TEXTURE0);
+    for (int i = 0; i < STREAM_TEXTURE_COUNT; i++) {
+        GLuint texture = textureLoaderGetTexture(app->loader, app->handles[i]);
+        if (texture == 0) {
+            continue;
+        }
+        float x = originX + cellWidth * (float)(i % columns);
+        float y = originY - cellHeight * (float)(i / columns + 1);
+        glUniform4f(app->uniformRect, x + cellWidth * 0.05f, y + cellHeight * 0.05f, cellWidth * 0.9f,
+                    cellHeight * 0.9f);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static void onDraw(GLFMDisplay *display) {
+    StreamApp *app = glfmGetUserData(display);
+    if (app->state == StreamStateStarting) {
+        streamGenerate(app);
+    }
+    if (app->state == StreamStateLoading) {
+        double startTime = glfmGetTime();
+        size_t budget = app->budgetEnabled ? STREAM_UPLOAD_BUDGET : SIZE_MAX;
+        app->uploadedBytes += textureLoaderUpdate(app->loader, budget);
+        double updateTime = glfmGetTime() - startTime;
+        if (updateTime > app->maxUpdateTime) {
+            app->maxUpdateTime = updateTime;
+        }
+        app->frameCount++;
+        if (app->firstDrawableFrame == 0) {
+            bool allDrawable = true;
+            for (int i = 0; i < STREAM_TEXTURE_COUNT && allDrawable; i++) {
+                allDrawable = (textureLoaderGetTexture(app->loader, app->handles[i]) != 0 ||
+                               textureLoaderGetState(app->loader, app->handles[i]) == TextureLoaderStateFailed);
+            }
+            if (allDrawable) {
+                app->firstDrawableFrame = app->frameCount;
+            }
+        }
+        if (textureLoaderIsIdle(app->loader)) {
+            streamFinishRun(app);
+        }
+        app->needsRedraw = true;
+    }
+    if (!app->needsRedraw) {
+        return;
+    }
+    app->needsRedraw = (app->state != StreamStateIdle);
+
+    int width, height;
+    glfmGetDisplaySize(display, &width, &height);
+    glViewport(0, 0, width, height);
+    if (app->state == StreamStateIdle) {
+        glClearColor(0.1f, 0.5f, 0.1f, 1.0f);
+    } else {
+        glClearColor(0.6f, 0.1f, 0.1f, 1.0f);
+    }
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawTextures(app, width, height);
+    glfmSwapBuffers(display);
+}
+
+void glfmMain(GLFMDisplay *display) {
+    StreamApp *app = calloc(1, sizeof(StreamApp));
+    app->display = display;
+    app->budgetEnabled = true;
+    app->needsRedraw = true;
+
+    glfmSetDisplayConfig(display,
+                         GLFMRenderingAPIOpenGLES3, // For glTexStorage2D and ETC2. Falls back to OpenGL ES 2.0.
+                         GLFMColorFormatRGBA8888,
+                         GLFMDepthFormatNone,
+                         GLFMStencilFormatNone,
+                         GLFMMultisampleNone);
+    glfmSetUserData(display, app);
+    glfmSetSurfaceCreatedFunc(display, onSurfaceCreated);
+    glfmSetSurfaceDestroyedFunc(display, onSurfaceDestroyed);
+    glfmSetSurfaceRefreshFunc(display, onSurfaceRefresh);
+    glfmSetRenderFunc(display, onDraw);
+    glfmSetTouchFunc(display, onTouch);
+    glfmSetKeyFunc(display, onKey);
+}
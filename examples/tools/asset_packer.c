@@ -0,0 +1,374 @@
+// Creates asset packs (see asset_pack.h), and benchmarks them against reading each file with fopen.
+// This is a host tool (macOS, Linux). Build it separately from the examples:
+//
+//     cmake -S examples/tools -B build/tools && cmake --build build/tools
+//
+// Usage:
+//     asset_packer pack [-z] <input_dir> <output.pack>   Packs all files in a directory (-z: LZ4 compression)
+//     asset_packer list <input.pack>                     Lists the entries of a pack
+//     asset_packer bench [-z] [input_dir]                Compares fopen per file to pack lookups. Without an input
+//                                                        directory, 2000 small files are generated.
+//
+// The benchmark runs with a warm file cache, so it measures the cost of the per-file system calls, not disk reads.
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "asset_pack.h"
+#include "asset_pack_writer.h"
+
+enum {
+    BENCH_GENERATED_FILE_COUNT = 2000,
+    BENCH_ITERATIONS = 7,
+};
+
+typedef struct {
+    char **paths; // Relative to the input directory
+    size_t count;
+    size_t capacity;
+} FileList;
+
+static double getTime(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+static bool fileListAdd(FileList *list, const char *path) {
+    if (list->count == list->capacity) {
+        size_t newCapacity = list->capacity == 0 ? 256 : list->capacity * 2;
+        char **paths = realloc(list->paths, sizeof(char *) * newCapacity);
+        if (!paths) {
+            return false;
+        }
+        list->paths = paths;
+        list->capacity = newCapacity;
+    }
+    list->paths[list->count] = strdup(path);
+    return list->paths[list->count++] != NULL;
+}
+
+static void fileListFree(FileList *list) {
+    for (size_t i = 0; i < list->count; i++) {
+        free(list->paths[i]);
+    }
+    free(list->paths);
+    memset(list, 0, sizeof(FileList));
+}
+
+// Adds regular files in `dir`/`relativeDir`, recursively. Hidden files are skipped.
+static bool listFiles(const char *dir, const char *relativeDir, FileList *list) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, relativeDir);
+    DIR *d = opendir(path);
+    if (!d) {
+        fprintf(stderr, "Couldn't open directory: %s\n", path);
+        return false;
+    }
+    bool success = true;
+    struct dirent *dirEntry;
+    while (success && (dirEntry = readdir(d)) != NULL) {
+        if (dirEntry->d_name[0] == '.') {
+            continue;
+        }
+        char relativePath[PATH_MAX];
+        snprintf(relativePath, sizeof(relativePath), "%s%s%s", relativeDir, relativeDir[0] ? "/" : "",
+                 dirEntry->d_name);
+        int length = snprintf(path, sizeof(path), "%s/%s", dir, relativePath);
+        struct stat info;
+        if (length < 0 || (size_t)length >= sizeof(path) || stat(path, &info) != 0) {
+            continue;
+        }
+        if (S_ISDIR(info.st_mode)) {
+            success = listFiles(dir, relativePath, list);
+        } else if (S_ISREG(info.st_mode)) {
+            success = fileListAdd(list, relativePath);
+        }
+    }
+    closedir(d);
+    return success;
+}
+
+static uint8_t *readFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *data = length >= 0 ? malloc((size_t)length + 1) : NULL;
+    if (data && fread(data, 1, (size_t)length, file) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    if (data) {
+        *size = (size_t)length;
+    }
+    return data;
+}
+
+static bool packDirectory(const char *dir, const FileList *files, bool compress, const char *outputPath,
+                          size_t *totalSize) {
+    AssetPackWriter *writer = assetPackWriterCreate();
+    bool success = writer != NULL;
+    *totalSize = 0;
+    for (size_t i = 0; i < files->count && success; i++) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", dir, files->paths[i]);
+        size_t size = 0;
+        uint8_t *data = readFile(path, &size);
+        if (!data) {
+            fprintf(stderr, "Couldn't read file: %s\n", path);
+            success = false;
+        } else {
+            success = assetPackWriterAdd(writer, files->paths[i], data, size, compress);
+            if (!success) {
+                fprintf(stderr, "Couldn't add file: %s\n", files->paths[i]);
+            }
+            *totalSize += size;
+            free(data);
+        }
+    }
+    if (success && !assetPackWriterSave(writer, outputPath)) {
+        fprintf(stderr, "Couldn't write pack: %s\n", outputPath);
+        success = false;
+    }
+    assetPackWriterDestroy(writer);
+    return success;
+}
+
+static const uint8_t *mapFile(const char *path, size_t *size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+    *size = (size_t)info.st_size;
+    return data;
+}
+
+// MARK: - Commands
+
+static int commandPack(int argc, char *argv[]) {
+    bool compress = argc > 0 && strcmp(argv[0], "-z") == 0;
+    if (compress) {
+        argc--;
+        argv++;
+    }
+    if (argc != 2) {
+        return 2;
+    }
+    FileList files = { 0 };
+    size_t totalSize = 0;
+    bool success = listFiles(argv[0], "", &files) && packDirectory(argv[0], &files, compress, argv[1], &totalSize);
+    if (success) {
+        printf("Packed %zu files (%zu bytes) into %s\n", files.count, totalSize, argv[1]);
+    }
+    fileListFree(&files);
+    return success ? 0 : 1;
+}
+
+static int commandList(int argc, char *argv[]) {
+    if (argc != 1) {
+        return 2;
+    }
+    size_t size = 0;
+    const uint8_t *data = mapFile(argv[0], &size);
+    AssetPack pack;
+    if (!data || !assetPackOpen(&pack, data, size)) {
+        fprintf(stderr, "Couldn't open pack: %s\n", argv[0]);
+        return 1;
+    }
+    for (uint32_t i = 0; i < pack.entryCount; i++) {
+        AssetPackEntry entry;
+        if (assetPackGetEntry(&pack, i, &entry)) {
+            printf("%10zu %10zu %-4s %s\n", entry.size, entry.storedSize,
+                   entry.compression == AssetPackCompressionLZ4 ? "lz4" : "", entry.path);
+        }
+    }
+    munmap((void *)data, size);
+    return 0;
+}
+
+static bool generateFiles(const char *dir) {
+    // Shader-like text of varying length, in a few subdirectories
+    static const char *lines[] = {
+        "precision mediump float;\n", "uniform sampler2D tex;\n", "varying vec2 texCoord;\n",
+        "void main() {\n", "    gl_FragColor = texture2D(tex, texCoord);\n", "}\n",
+    };
+    uint32_t random = 1;
+    for (int i = 0; i < BENCH_GENERATED_FILE_COUNT; i++) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/dir%i", dir, i % 8);
+        if (mkdir(path, 0700) != 0 && i < 8) {
+            return false;
+        }
+        snprintf(path, sizeof(path), "%s/dir%i/asset%04i.txt", dir, i % 8, i);
+        FILE *file = fopen(path, "wb");
+        if (!file) {
+            return false;
+        }
+        random = random * 1103515245u + 12345u;
+        int lineCount = 8 + (int)((random >> 16) % 120);
+        for (int line = 0; line < lineCount; line++) {
+            fputs(lines[(line + i) % 6], file);
+        }
+        fclose(file);
+    }
+    return true;
+}
+
+static int compareDoubles(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static int commandBench(int argc, char *argv[]) {
+    bool compress = argc > 0 && strcmp(argv[0], "-z") == 0;
+    if (compress) {
+        argc--;
+        argv++;
+    }
+    if (argc > 1) {
+        return 2;
+    }
+    char generatedDir[] = "/tmp/asset_packer_bench_XXXXXX";
+    const char *dir = argc == 1 ? argv[0] : mkdtemp(generatedDir);
+    if (!dir || (argc == 0 && !generateFiles(dir))) {
+        fprintf(stderr, "Couldn't generate files\n");
+        return 1;
+    }
+
+    char packPath[PATH_MAX];
+    snprintf(packPath, sizeof(packPath), "/tmp/asset_packer_bench_%i.pack", (int)getpid());
+    FileList files = { 0 };
+    size_t totalSize = 0;
+    if (!listFiles(dir, "", &files) || files.count == 0 ||
+        !packDirectory(dir, &files, compress, packPath, &totalSize)) {
+        fileListFree(&files);
+        return 1;
+    }
+
+    size_t maxSize = 0;
+    double fopenTimes[BENCH_ITERATIONS];
+    double packTimes[BENCH_ITERATIONS];
+    uint32_t fopenChecksum = 0;
+    uint32_t packChecksum = 0;
+    for (int iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+        // Per file: open, seek, read, close
+        double startTime = getTime();
+        uint32_t checksum = 0;
+        for (size_t i = 0; i < files.count; i++) {
+            char path[PATH_MAX];
+            snprintf(path, sizeof(path), "%s/%s", dir, files.paths[i]);
+            size_t size = 0;
+            uint8_t *data = readFile(path, &size);
+            for (size_t j = 0; data && j < size; j++) {
+                checksum = checksum * 31 + data[j];
+            }
+            maxSize = size > maxSize ? size : maxSize;
+            free(data);
+        }
+        fopenTimes[iteration] = getTime() - startTime;
+        fopenChecksum = checksum;
+
+        // Pack: map once, then look up each entry. Compressed entries are decompressed into a reused buffer.
+        startTime = getTime();
+        checksum = 0;
+        size_t packSize = 0;
+        const uint8_t *packData = mapFile(packPath, &packSize);
+        uint8_t *buffer = malloc(maxSize > 0 ? maxSize : 1);
+        AssetPack pack;
+        if (!packData || !buffer || !assetPackOpen(&pack, packData, packSize)) {
+            fprintf(stderr, "Couldn't open pack: %s\n", packPath);
+            free(buffer);
+            fileListFree(&files);
+            return 1;
+        }
+        for (size_t i = 0; i < files.count; i++) {
+            AssetPackEntry entry;
+            if (!assetPackFind(&pack, files.paths[i], &entry)) {
+                continue;
+            }
+            const uint8_t *data = entry.data;
+            if (entry.compression != AssetPackCompressionNone) {
+                data = assetPackDecompress(&entry, buffer, maxSize) ? buffer : NULL;
+            }
+            for (size_t j = 0; data && j < entry.size; j++) {
+                checksum = checksum * 31 + data[j];
+            }
+        }
+        free(buffer);
+        munmap((void *)packData, packSize);
+        packTimes[iteration] = getTime() - startTime;
+        packChecksum = checksum;
+    }
+    qsort(fopenTimes, BENCH_ITERATIONS, sizeof(double), compareDoubles);
+    qsort(packTimes, BENCH_ITERATIONS, sizeof(double), compareDoubles);
+    double fopenTime = fopenTimes[BENCH_ITERATIONS / 2];
+    double packTime = packTimes[BENCH_ITERATIONS / 2];
+
+    struct stat packInfo;
+    stat(packPath, &packInfo);
+    printf("%zu files, %zu bytes. Pack: %lld bytes%s\n", files.count, totalSize, (long long)packInfo.st_size,
+           compress ? " (LZ4)" : "");
+    printf("fopen per file: %8.2f ms (%6.2f us/file)\n", 1000.0 * fopenTime, 1e6 * fopenTime / (double)files.count);
+    printf("Pack lookup:    %8.2f ms (%6.2f us/file, %.1fx)\n", 1000.0 * packTime,
+           1e6 * packTime / (double)files.count, fopenTime / packTime);
+    if (fopenChecksum != packChecksum) {
+        printf("Checksum mismatch!\n");
+    }
+
+    unlink(packPath);
+    if (argc == 0) {
+        // Remove the generated files
+        for (size_t i = 0; i < files.count; i++) {
+            char path[PATH_MAX];
+            snprintf(path, sizeof(path), "%s/%s", dir, files.paths[i]);
+            unlink(path);
+        }
+        for (int i = 0; i < 8; i++) {
+            char path[PATH_MAX];
+            snprintf(path, sizeof(path), "%s/dir%i", dir, i);
+            rmdir(path);
+        }
+        rmdir(dir);
+    }
+    fileListFree(&files);
+    return fopenChecksum == packChecksum ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    int result = 2;
+    if (argc >= 2 && strcmp(argv[1], "pack") == 0) {
+        result = commandPack(argc - 2, argv + 2);
+    } else if (argc >= 2 && strcmp(argv[1], "list") == 0) {
+        result = commandList(argc - 2, argv + 2);
+    } else if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        result = commandBench(argc - 2, argv + 2);
+    }
+    if (result == 2) {
+        fprintf(stderr, "Usage: asset_packer pack [-z] <input_dir> <output.pack>\n"
+                        "       asset_packer list <input.pack>\n"
+                        "       asset_packer bench [-z] [input_dir]\n");
+    }
+    return result;
+}
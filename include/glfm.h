@@ -72,6 +72,7 @@
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -113,6 +114,10 @@ typedef enum {
     GLFMSwapBehaviorPlatformDefault,
     GLFMSwapBehaviorBufferDestroyed,
     GLFMSwapBehaviorBufferPreserved,
+    /// Low-latency rendering directly to the front buffer, for apps like stylus drawing. The app should only draw
+    /// regions that changed, and call ``glfmSwapBuffers`` (or `glFlush`) when done. Tearing may occur.
+    /// See ``glfmIsSingleBufferActive``.
+    GLFMSwapBehaviorSingleBuffer,
 } GLFMSwapBehavior;
 
 /// Defines whether system UI chrome (status bar, navigation bar) is shown.
@@ -394,6 +399,15 @@ typedef struct GLFMDisplay GLFMDisplay;
 /// Function pointer returned from ``glfmGetProcAddress``.
 typedef void (*GLFMProc)(void);
 
+/// A rectangle in pixels, with the origin at the bottom-left of the surface (like `glScissor`).
+/// See ``glfmSwapBuffersWithDamage``.
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} GLFMRect;
+
 /// Render callback function. See ``glfmSetRenderFunc``.
 typedef void (*GLFMRenderFunc)(GLFMDisplay *display);
 
@@ -467,6 +481,10 @@ typedef void (*GLFMSurfaceErrorFunc)(GLFMDisplay *display, const char *message);
 /// See ``glfmSetSurfaceCreatedFunc``.
 typedef void (*GLFMSurfaceCreatedFunc)(GLFMDisplay *display, int width, int height);
 
+/// Callback function when the OpenGL context was created, possibly before the surface exists.
+/// See ``glfmSetContextReadyFunc``.
+typedef void (*GLFMContextReadyFunc)(GLFMDisplay *display);
+
 /// Callback function when the OpenGL surface was resized (or rotated).
 /// See ``glfmSetSurfaceResizedFunc``.
 typedef void (*GLFMSurfaceResizedFunc)(GLFMDisplay *display, int width, int height);
@@ -517,6 +535,18 @@ typedef struct {
 /// Callback function when sensor events occur. See ``glfmSetSensorFunc``.
 typedef void (*GLFMSensorFunc)(GLFMDisplay *display, GLFMSensorEvent event);
 
+/// Job function run on a worker thread. See ``glfmDispatchAsync``.
+typedef void (*GLFMJobFunc)(void *userData);
+
+/// Callback function when a job has finished. Called on the render thread. See ``glfmDispatchAsync``.
+typedef void (*GLFMJobCompletionFunc)(GLFMDisplay *display, void *userData);
+
+/// Callback function when an asset has loaded. Called on the render thread. See ``glfmLoadAssetAsync``.
+///
+/// The `data` is `NULL` if the asset couldn't be loaded. The `data` is only valid until the function returns.
+typedef void (*GLFMAssetLoadFunc)(GLFMDisplay *display, const char *path, const void *data, size_t size,
+                                  void *userData);
+
 // MARK: - Functions
 
 /// Main entry point for a GLFM app.
@@ -558,6 +588,35 @@ void *glfmGetUserData(const GLFMDisplay *display);
 ///                    must happen in application code.
 void glfmSwapBuffers(GLFMDisplay *display);
 
+/// Swap buffers, hinting that only the specified rectangles changed since the previous frame.
+///
+/// The compositor may use the damage rectangles to present only the changed regions. The entire surface must still
+/// contain valid content: use ``glfmGetBufferAge`` to determine which regions need to be redrawn.
+///
+/// If `rects` is `NULL` or `rectCount` is zero, or partial presentation is not supported, this function is the same as
+/// ``glfmSwapBuffers``.
+///
+/// - Android: Requires `EGL_KHR_swap_buffers_with_damage` or `EGL_EXT_swap_buffers_with_damage`.
+/// - Emscripten, Apple platforms: Partial presentation is not supported.
+void glfmSwapBuffersWithDamage(GLFMDisplay *display, const GLFMRect *rects, int rectCount);
+
+/// Gets the age of the current back buffer, in frames.
+///
+/// The age is the number of frames since the back buffer's contents were rendered. For example, if the age is 1, the
+/// back buffer contains the previous frame, and only the regions that changed since the previous frame need to be
+/// redrawn. If the age is 2, the back buffer contains the frame before the previous frame, and the damage from the two
+/// most recent frames needs to be redrawn.
+///
+/// Returns 0 if the contents of the back buffer are undefined, in which case the entire surface must be redrawn.
+///
+/// Call this function in the ``GLFMRenderFunc``, before rendering.
+///
+/// - Android: Uses `EGL_EXT_buffer_age` if available. Otherwise, returns 1 if the swap behavior is
+///            `GLFMSwapBehaviorBufferPreserved` and a frame was previously swapped, and 0 otherwise.
+/// - Emscripten: Always returns 0.
+/// - Apple platforms: Always returns 0.
+int glfmGetBufferAge(const GLFMDisplay *display);
+
 /// *Deprecated:* Use ``glfmGetSupportedInterfaceOrientation``.
 GLFMUserInterfaceOrientation glfmGetUserInterfaceOrientation(GLFMDisplay *display)
 GLFM_DEPRECATED("Replaced with glfmGetSupportedInterfaceOrientation");
@@ -588,13 +647,16 @@ GLFMInterfaceOrientation glfmGetInterfaceOrientation(const GLFMDisplay *display)
 
 /// Gets the display size, in pixels.
 ///
+/// The size is the size of the drawable surface, which is smaller than the native display size if the render scale is
+/// less than 1.0. See ``glfmSetRenderScale``.
+///
 /// The arguments for the `width` and `height` parameters may be `NULL`.
 void glfmGetDisplaySize(const GLFMDisplay *display, int *width, int *height);
 
 /// Gets the display scale.
 ///
 /// On Apple platforms, the value will be 1.0 for non-retina displays and 2.0 for retina. Similar values will be
-/// returned for Android and Emscripten.
+/// returned for Android and Emscripten. The value includes the render scale (see ``glfmSetRenderScale``).
 double glfmGetDisplayScale(const GLFMDisplay *display);
 
 /// Gets the chrome insets, in pixels (AKA "safe area insets" in iOS).
@@ -623,15 +685,49 @@ void glfmSetDisplayChrome(GLFMDisplay *display, GLFMUserInterfaceChrome uiChrome
 /// The return value is not valid until the surface is created.
 GLFMRenderingAPI glfmGetRenderingAPI(const GLFMDisplay *display);
 
-/// Sets the swap behavior for newly created surfaces (Android only).
+/// Sets the swap behavior for newly created surfaces (Android only, except for `GLFMSwapBehaviorSingleBuffer`).
 ///
 /// In order to take effect, the behavior should be set before the surface is created, preferable at the very beginning
 /// of the ``glfmMain`` function.
+///
+/// `GLFMSwapBehaviorSingleBuffer` falls back to the platform default if it is not supported:
+/// - Android: Requires `EGL_KHR_mutable_render_buffer` and `EGL_ANDROID_front_buffer_auto_refresh`. Single buffer mode
+///            is active after the first ``glfmSwapBuffers`` call.
+/// - Emscripten: Creates a `desynchronized` WebGL context with a preserved drawing buffer, if the browser supports it.
+/// - Apple platforms: Not supported.
 void glfmSetSwapBehavior(GLFMDisplay *display, GLFMSwapBehavior behavior);
 
 /// Returns the swap buffer behavior.
 GLFMSwapBehavior glfmGetSwapBehavior(const GLFMDisplay *display);
 
+/// Returns `true` if the `GLFMSwapBehaviorSingleBuffer` swap behavior was requested and rendering currently goes
+/// directly to the front buffer. See ``glfmSetSwapBehavior``.
+bool glfmIsSingleBufferActive(const GLFMDisplay *display);
+
+/// Sets whether the OpenGL context is kept for the lifetime of the process (Android only).
+///
+/// By default, the context and all its objects (textures, buffers, programs) are destroyed when the Android Activity is
+/// destroyed, even if the process keeps running and the Activity is later recreated. If enabled, the context is
+/// kept when the Activity is destroyed and is used again when the Activity is recreated. The
+/// ``GLFMSurfaceDestroyedFunc`` is not called, and in the next ``GLFMSurfaceCreatedFunc``,
+/// ``glfmIsContextPreserved`` returns `true`.
+///
+/// The context can still be lost (for example, on some drivers after the device sleeps), in which case the usual
+/// ``GLFMSurfaceDestroyedFunc`` and ``GLFMSurfaceCreatedFunc`` calls are made.
+///
+/// - iOS, tvOS, macOS, Emscripten: This setting has no effect.
+void glfmSetPersistentContextEnabled(GLFMDisplay *display, bool enabled);
+
+/// Returns `true` if the OpenGL context is kept for the lifetime of the process. See
+/// ``glfmSetPersistentContextEnabled``.
+bool glfmGetPersistentContextEnabled(const GLFMDisplay *display);
+
+/// Returns `true` if called from a ``GLFMSurfaceCreatedFunc`` and the OpenGL context and all its objects were kept
+/// from a previous Activity instance, so resources do not need to be reloaded. Returns `false` otherwise.
+///
+/// See ``glfmSetPersistentContextEnabled``.
+bool glfmIsContextPreserved(const GLFMDisplay *display);
+
 /// Gets the address of the specified function.
 GLFMProc glfmGetProcAddress(const char *functionName);
 
@@ -693,6 +789,17 @@ GLFMSurfaceErrorFunc glfmSetSurfaceErrorFunc(GLFMDisplay *display, GLFMSurfaceEr
 /// Sets the function to call when the surface was created.
 GLFMSurfaceCreatedFunc glfmSetSurfaceCreatedFunc(GLFMDisplay *display, GLFMSurfaceCreatedFunc surfaceCreatedFunc);
 
+/// Sets the function to call when the OpenGL context was created and made current.
+///
+/// The context may be ready before the surface exists, so the app can compile shaders and upload textures while the
+/// window is still being created. The default framebuffer must not be used until the ``GLFMSurfaceCreatedFunc`` is
+/// called. This function is called again if the context is lost and recreated.
+///
+/// - Android: If `EGL_KHR_surfaceless_context` is available, the context is created right after ``glfmMain``
+///   returns. Otherwise, the context is created with the surface.
+/// - iOS, tvOS, macOS, Emscripten: Called immediately before the ``GLFMSurfaceCreatedFunc``.
+GLFMContextReadyFunc glfmSetContextReadyFunc(GLFMDisplay *display, GLFMContextReadyFunc contextReadyFunc);
+
 /// Sets the function to call when the surface was resized (or rotated).
 GLFMSurfaceResizedFunc glfmSetSurfaceResizedFunc(GLFMDisplay *display, GLFMSurfaceResizedFunc surfaceResizedFunc);
 
@@ -857,6 +964,383 @@ bool glfmIsHapticFeedbackSupported(const GLFMDisplay *display);
 /// - Emscripten: This function does nothing.
 void glfmPerformHapticFeedback(GLFMDisplay *display, GLFMHapticFeedbackStyle style);
 
+// MARK: - Jobs
+
+/// Runs a job on a worker thread.
+///
+/// When the job has finished, the `completionFunc` is called on the render thread, before the next call to the
+/// ``GLFMRenderFunc``. Completion functions are called in the order the jobs finished. GLFM does not call OpenGL or
+/// other GLFM functions from worker threads, so the `jobFunc` should only do CPU work (decoding, mesh generation, etc.).
+///
+/// Worker threads are created on the first call to this function. This function may be called from any thread,
+/// including from a job. Completion functions are always called on the render thread.
+///
+/// - Parameters:
+///   - jobFunc: The function to run on a worker thread.
+///   - completionFunc: The function to call on the render thread after the job has finished. May be `NULL`.
+///   - userData: The value passed to both `jobFunc` and `completionFunc`.
+/// - Returns: `true` if the job was dispatched, `false` otherwise.
+///
+/// - Emscripten: Jobs run on worker threads only if built with `-pthread`. Otherwise, the `jobFunc` is called before
+///   this function returns, and the `completionFunc` is called before the next ``GLFMRenderFunc``.
+/// - Apple platforms: Jobs run on a Grand Central Dispatch global queue.
+bool glfmDispatchAsync(GLFMDisplay *display, GLFMJobFunc jobFunc, GLFMJobCompletionFunc completionFunc,
+                       void *userData);
+
+/// Gets the number of jobs that may run concurrently. Use this value as a hint when splitting work into multiple jobs.
+///
+/// The count is based on the number of CPU cores, leaving one core for the render thread. On devices with
+/// heterogeneous cores ("big.LITTLE" on Android, performance and efficiency cores on Apple silicon), only the faster
+/// cores are counted.
+///
+/// - Emscripten: Returns 0 if not built with `-pthread`.
+int glfmGetWorkerCount(const GLFMDisplay *display);
+
+// MARK: - Shared contexts
+
+/// An OpenGL context that shares textures, buffers, and programs with the display's context. See
+/// ``glfmCreateSharedContext``.
+typedef struct GLFMSharedContext GLFMSharedContext;
+
+/// A sync object inserted into an OpenGL command stream. See ``glfmCreateFence``.
+typedef struct GLFMFence GLFMFence;
+
+/// Creates an OpenGL context that shares objects with the display's context, so that textures and buffers can be
+/// uploaded on a loader thread without blocking the render thread.
+///
+/// This function must be called on the render thread after the surface is created, for example in the
+/// ``GLFMSurfaceCreatedFunc``. The shared context has no default framebuffer; use it for uploads and
+/// framebuffer objects only.
+///
+/// The shared context becomes invalid when the display's context is destroyed. Stop using it and call
+/// ``glfmDestroySharedContext`` in the ``GLFMSurfaceDestroyedFunc``.
+///
+/// - Returns: The shared context, or `NULL` if shared contexts are not supported.
+///
+/// - Android: The context uses `EGL_KHR_surfaceless_context` if available, or a 1x1 pbuffer otherwise.
+/// - Apple platforms: Returns `NULL` when using Metal.
+/// - Emscripten: Returns `NULL`. WebGL contexts can't share objects.
+GLFMSharedContext *glfmCreateSharedContext(GLFMDisplay *display);
+
+/// Makes the shared context current on the calling thread.
+///
+/// A shared context may only be current on one thread at a time. Pass `NULL` to release the shared context that is
+/// current on the calling thread (for example, before the thread exits).
+///
+/// - Returns: `true` if successful, `false` otherwise.
+bool glfmMakeSharedContextCurrent(GLFMSharedContext *sharedContext);
+
+/// Destroys a shared context. The context must not be current on any thread other than the calling thread.
+void glfmDestroySharedContext(GLFMSharedContext *sharedContext);
+
+/// Inserts a fence into the command stream of the context that is current on the calling thread, and flushes the
+/// context.
+///
+/// A typical use is a loader thread that uploads a texture with a shared context, creates a fence, and passes the fence
+/// to the render thread. The render thread checks the fence with ``glfmWaitFence`` (with a timeout of zero) before
+/// drawing with the texture.
+///
+/// - Returns: The fence, or `NULL` if fences are not supported.
+///
+/// - Android: Requires `EGL_KHR_fence_sync`.
+/// - Emscripten: Returns `NULL`.
+GLFMFence *glfmCreateFence(GLFMDisplay *display);
+
+/// Waits for the commands before the fence to complete.
+///
+/// - Parameters:
+///   - fence: The fence created with ``glfmCreateFence``.
+///   - timeout: The maximum time to wait, in seconds. Use zero to check the fence without waiting, or a negative
+///              value to wait indefinitely.
+/// - Returns: `true` if the commands completed, `false` if the timeout expired or an error occurred.
+///
+/// - Android: This function may be called from any thread.
+/// - Apple platforms: The display's context or a shared context must be current on the calling thread.
+bool glfmWaitFence(GLFMFence *fence, double timeout);
+
+/// Destroys a fence. The same threading rules as ``glfmWaitFence`` apply.
+void glfmDestroyFence(GLFMFence *fence);
+
+// MARK: - Program cache
+
+/// Program cache statistics. See ``glfmGetProgramCacheStats``.
+typedef struct {
+    /// The number of programs loaded from the cache.
+    int hitCount;
+    /// The number of programs compiled from source, because they were not in the cache, the cache was invalid, or
+    /// program binaries are not supported.
+    int missCount;
+    /// The total time spent in ``glfmCreateProgram``, in seconds.
+    double totalTime;
+} GLFMProgramCacheStats;
+
+/// Creates an OpenGL program from vertex and fragment shader source, using a persistent program binary cache.
+///
+/// The cache key is a hash of the shader source and attribute names. Cached binaries are invalidated when the
+/// `GL_VENDOR`, `GL_RENDERER`, or `GL_VERSION` strings change (for example, after a driver update). If a cached binary
+/// can't be loaded, the program is compiled from source and the cache entry is replaced.
+///
+/// This function must be called on a thread with a current OpenGL context, usually the render thread.
+///
+/// - Parameters:
+///   - vertexShaderSource: The vertex shader source.
+///   - fragmentShaderSource: The fragment shader source.
+///   - attributeNames: The vertex attribute names. The attribute at index `i` is bound to location `i`. May be `NULL`
+///                     if `attributeCount` is zero.
+///   - attributeCount: The number of attribute names.
+/// - Returns: The program name, or 0 if the shaders couldn't be compiled or linked. In debug builds, the info log is
+///            logged.
+///
+/// - Android: Binaries are stored in the app's cache directory. Requires OpenGL ES 3.0 or `GL_OES_get_program_binary`.
+/// - Apple platforms: Binaries are stored in the app's caches directory, if the driver supports program binaries.
+/// - Emscripten: Programs are always compiled from source. WebGL does not support program binaries.
+unsigned int glfmCreateProgram(GLFMDisplay *display, const char *vertexShaderSource, const char *fragmentShaderSource,
+                               const char *const *attributeNames, int attributeCount);
+
+/// Creates an OpenGL program from shader source that is not null-terminated, like an asset mapped with
+/// ``glfmMapAsset``. Otherwise, the same as ``glfmCreateProgram``.
+///
+/// - Parameters:
+///   - vertexShaderSource: The vertex shader source.
+///   - vertexSourceLength: The length of the vertex shader source, in bytes.
+///   - fragmentShaderSource: The fragment shader source.
+///   - fragmentSourceLength: The length of the fragment shader source, in bytes.
+///   - attributeNames: The vertex attribute names. See ``glfmCreateProgram``.
+///   - attributeCount: The number of attribute names.
+unsigned int glfmCreateProgramWithSourceLengths(GLFMDisplay *display,
+                                                const char *vertexShaderSource, size_t vertexSourceLength,
+                                                const char *fragmentShaderSource, size_t fragmentSourceLength,
+                                                const char *const *attributeNames, int attributeCount);
+
+/// Gets the program cache statistics, counted since the app launched.
+void glfmGetProgramCacheStats(const GLFMDisplay *display, GLFMProgramCacheStats *stats);
+
+// MARK: - Render scale
+
+/// The minimum render scale. See ``glfmSetRenderScale``.
+#define GLFM_MIN_RENDER_SCALE 0.5
+
+/// Sets the render scale, from ``GLFM_MIN_RENDER_SCALE`` to 1.0. The default is 1.0.
+///
+/// When the render scale is less than 1.0, the drawable surface is smaller than the native display size, and the
+/// system compositor scales it up to fill the display. This reduces fill-rate cost at the expense of sharpness.
+///
+/// The change takes effect before the next frame is rendered. The ``GLFMSurfaceResizedFunc`` callback is called with
+/// the new size, and ``glfmGetDisplaySize`` returns the new size. Touch coordinates, chrome insets, the keyboard frame,
+/// and ``glfmGetDisplayScale`` are in the scaled coordinate space.
+///
+/// Values outside the valid range are clamped.
+///
+/// - Android: Sets the window's buffer geometry.
+/// - Emscripten: Sets the size of the canvas's backing store.
+/// - iOS, tvOS, macOS: This setting has no effect.
+void glfmSetRenderScale(GLFMDisplay *display, double renderScale);
+
+/// Gets the render scale. See ``glfmSetRenderScale``.
+///
+/// - iOS, tvOS, macOS: Always returns 1.0.
+double glfmGetRenderScale(const GLFMDisplay *display);
+
+/// Sets whether the render scale is adjusted automatically. The default is `false`.
+///
+/// When enabled, the average frame duration is measured every frame. If frames are consistently slower than the
+/// display's refresh rate, the render scale is lowered. After a sustained period of frames at the refresh rate, the
+/// render scale is raised again, up to 1.0.
+///
+/// The app must render every frame (see ``glfmSetRenderFunc``) for the measurements to be meaningful.
+///
+/// - iOS, tvOS, macOS: This setting has no effect.
+void glfmSetAutoRenderScaleEnabled(GLFMDisplay *display, bool enabled);
+
+/// Returns `true` if the render scale is adjusted automatically. See ``glfmSetAutoRenderScaleEnabled``.
+bool glfmGetAutoRenderScaleEnabled(const GLFMDisplay *display);
+
+// MARK: - Frame pacing
+
+/// Frame statistics, counted since the app launched. See ``glfmGetFrameStats``.
+typedef struct {
+    /// The number of frames that waited for the GPU before rendering. See ``glfmSetMaxFramesInFlight``.
+    int waitCount;
+    /// The time spent waiting for the GPU before the most recent frame, in seconds.
+    double lastWaitTime;
+    /// The total time spent waiting for the GPU, in seconds.
+    double totalWaitTime;
+} GLFMFrameStats;
+
+/// Sets the maximum number of frames queued on the GPU, from 1 to 4. The default is 0 (no limit; the driver decides,
+/// usually 2 or 3 frames).
+///
+/// Limiting the number of frames in flight reduces input latency in GPU-bound apps, at the cost of throughput.
+/// A fence is inserted after each ``glfmSwapBuffers`` call. Before the ``GLFMRenderFunc`` is called, GLFM waits for the
+/// fence from `maxFramesInFlight` frames ago. The wait time is reported in ``glfmGetFrameStats``.
+///
+/// - Android: Requires `EGL_KHR_fence_sync`.
+/// - Emscripten, Apple platforms: This setting has no effect.
+void glfmSetMaxFramesInFlight(GLFMDisplay *display, int maxFramesInFlight);
+
+/// Gets the maximum number of frames queued on the GPU, or 0 if there is no limit. See ``glfmSetMaxFramesInFlight``.
+int glfmGetMaxFramesInFlight(const GLFMDisplay *display);
+
+/// Gets the frame statistics.
+void glfmGetFrameStats(const GLFMDisplay *display, GLFMFrameStats *stats);
+
+/// Sets whether the GPU time of each frame is measured. The default is `false`.
+///
+/// When enabled, each ``GLFMRenderFunc`` call is wrapped in a GPU timer query. Results are read back asynchronously
+/// a few frames later, so measuring does not stall the GPU. Use ``glfmGetGPUFrameTime`` to get the result. Comparing
+/// the GPU frame time to the CPU frame time shows whether a slow frame is CPU-bound or GPU-bound.
+///
+/// - Android: Requires `GL_EXT_disjoint_timer_query`.
+/// - Emscripten: Requires `EXT_disjoint_timer_query_webgl2` (WebGL 2) or `EXT_disjoint_timer_query` (WebGL 1). Many
+///               browsers disable these extensions for privacy reasons.
+/// - Apple platforms: Not supported.
+void glfmSetGPUTimerEnabled(GLFMDisplay *display, bool enabled);
+
+/// Returns `true` if the GPU time of each frame is measured. See ``glfmSetGPUTimerEnabled``.
+bool glfmGetGPUTimerEnabled(const GLFMDisplay *display);
+
+/// Gets the GPU time of the most recently measured frame, in seconds.
+///
+/// The result is usually from a frame rendered a few frames ago. Results are discarded if a disjoint event occurred
+/// (for example, the GPU changed frequency), since the timing is not reliable.
+///
+/// Returns -1 if the GPU timer is not enabled, not supported, or a result is not available yet.
+double glfmGetGPUFrameTime(const GLFMDisplay *display);
+
+// MARK: - Debug
+
+/// The type of an OpenGL debug message. See ``glfmSetDebugEnabled``.
+typedef enum {
+    GLFMDebugMessageTypeError,
+    GLFMDebugMessageTypeDeprecatedBehavior,
+    GLFMDebugMessageTypeUndefinedBehavior,
+    GLFMDebugMessageTypePortability,
+    /// Performance warnings, like implicit multisample resolves, shader recompiles, or buffer stalls.
+    GLFMDebugMessageTypePerformance,
+    GLFMDebugMessageTypeOther,
+} GLFMDebugMessageType;
+
+#define GLFM_NUM_DEBUG_MESSAGE_TYPES 6
+
+/// Callback function when an OpenGL debug message is received. See ``glfmSetDebugMessageFunc``.
+typedef void (*GLFMDebugMessageFunc)(GLFMDisplay *display, GLFMDebugMessageType type, const char *message);
+
+/// Debug message counts. See ``glfmGetDebugStats``.
+typedef struct {
+    /// The number of messages of each type (indexed by ``GLFMDebugMessageType``) received during the most recent
+    /// frame.
+    int lastFrameCounts[GLFM_NUM_DEBUG_MESSAGE_TYPES];
+    /// The number of messages of each type received since debug mode was enabled.
+    int totalCounts[GLFM_NUM_DEBUG_MESSAGE_TYPES];
+} GLFMDebugStats;
+
+/// Sets whether OpenGL debug mode is enabled. The default is `false`.
+///
+/// Like ``glfmSetDisplayConfig``, this function should be called at the beginning of the ``glfmMain`` function,
+/// before the surface is created.
+///
+/// When enabled, a debug context is requested, and driver messages (errors and performance warnings) are received
+/// with `GL_KHR_debug`. Messages are counted per frame (see ``glfmGetDebugStats``) and sent to the
+/// ``GLFMDebugMessageFunc`` callback on the render thread. Notifications are not reported. If `GL_KHR_debug` is not
+/// available, `glGetError` is checked after each frame, and errors are reported as `GLFMDebugMessageTypeError`.
+///
+/// Debug mode has no cost when disabled. When enabled, messages are generated synchronously, which may reduce
+/// performance.
+///
+/// - Android: The context is created with `EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR`, if `EGL_KHR_create_context` is
+///            available.
+/// - Emscripten: WebGL does not support `GL_KHR_debug`. Only `glGetError` is checked.
+/// - Apple platforms: Not supported.
+void glfmSetDebugEnabled(GLFMDisplay *display, bool enabled);
+
+/// Returns `true` if OpenGL debug mode is enabled. See ``glfmSetDebugEnabled``.
+bool glfmGetDebugEnabled(const GLFMDisplay *display);
+
+/// Sets the function to call when an OpenGL debug message is received.
+///
+/// If no function is set, messages are logged in debug builds.
+///
+/// - Returns: The previous callback function.
+GLFMDebugMessageFunc glfmSetDebugMessageFunc(GLFMDisplay *display, GLFMDebugMessageFunc debugMessageFunc);
+
+/// Gets the debug message counts.
+void glfmGetDebugStats(const GLFMDisplay *display, GLFMDebugStats *stats);
+
+// MARK: - Assets
+
+/// Maps an asset into memory, read-only. When possible, the asset is used in place, without copying it.
+///
+/// Assets are the files bundled with the app. Relative paths are relative to the app's assets: the `assets` directory
+/// of the APK on Android, the bundle's resources directory on Apple platforms, and the root directory of the preloaded
+/// files on Emscripten. Absolute paths are mapped as regular files (for example, files in the cache directory).
+///
+/// The data is valid until ``glfmUnmapAsset`` is called, and is not null-terminated. This function may be called from
+/// any thread, including from a job (see ``glfmDispatchAsync``).
+///
+/// - Parameters:
+///   - path: The asset path, like `"textures/wood.ktx2"`.
+///   - size: On return, the size of the asset in bytes, or 0 if the asset couldn't be mapped. May be `NULL`.
+/// - Returns: A pointer to the asset data, or `NULL` if the asset couldn't be mapped.
+///
+/// - Android: Uses `AAsset_getBuffer`. Assets stored uncompressed in the APK are mapped directly from the APK. Store
+///            large assets uncompressed (with `androidResources.noCompress` in Gradle); compressed assets are
+///            decompressed into memory.
+/// - Apple platforms: Uses `mmap`.
+/// - Emscripten: Uses `mmap`. Preloaded files are stored outside of the WebAssembly heap, so they are copied into the
+///               heap once.
+const void *glfmMapAsset(GLFMDisplay *display, const char *path, size_t *size);
+
+/// Unmaps an asset mapped with ``glfmMapAsset``. Does nothing if `data` is `NULL`.
+///
+/// This function may be called from any thread.
+void glfmUnmapAsset(GLFMDisplay *display, const void *data);
+
+/// Loads an asset on a worker thread, and calls `func` on the render thread when it has loaded.
+///
+/// The asset is mapped with ``glfmMapAsset`` and its pages are read on the worker thread, so the `func` can use the
+/// data (for example, to upload a texture) without waiting for storage. Callbacks are called before the
+/// ``GLFMRenderFunc``. To keep frames short during level loads, callbacks stop for the frame after about 4 ms, so
+/// loads that finish together are delivered over several frames. At least one callback is called per frame.
+///
+/// Loads with a higher `priority` start first, and are delivered first. Requests for an asset that is already being
+/// loaded are coalesced: the asset is loaded once, each `func` is called with the same data, and the load uses the
+/// highest priority of the requests.
+///
+/// This function must be called on the render thread. Loads start before the next ``GLFMRenderFunc``.
+///
+/// - Parameters:
+///   - path: The asset path. See ``glfmMapAsset``.
+///   - priority: The load priority. Higher values load first. Use 0 as the default.
+///   - func: The function to call on the render thread when the asset has loaded, or failed to load.
+///   - userData: The value passed to `func`.
+/// - Returns: A request ID that can be passed to ``glfmCancelAssetLoad``, or 0 if the request couldn't be created.
+///
+/// - Emscripten: Assets are read from the preloaded files. Without `-pthread`, one asset is loaded per frame.
+unsigned int glfmLoadAssetAsync(GLFMDisplay *display, const char *path, int priority, GLFMAssetLoadFunc func,
+                                void *userData);
+
+/// Cancels an asset load started with ``glfmLoadAssetAsync``. The request's `func` will not be called.
+///
+/// If no other requests for the asset remain, the load is discarded. A load already running on a worker thread
+/// finishes, but its data is unmapped without being delivered.
+///
+/// This function must be called on the render thread.
+///
+/// - Returns: `true` if the request was cancelled, or `false` if the request was not found (for example, if its `func`
+///            was already called).
+bool glfmCancelAssetLoad(GLFMDisplay *display, unsigned int requestID);
+
+/// Sets the maximum number of bytes loaded by ``glfmLoadAssetAsync`` and not yet delivered to callbacks. The default is
+/// 0 (no limit).
+///
+/// New loads don't start while the loaded assets waiting for delivery exceed the budget. The budget may be exceeded by
+/// the assets that are loading at the time. Data is unmapped after its callbacks are called, so delivered assets don't
+/// count toward the budget.
+void glfmSetAssetMemoryBudget(GLFMDisplay *display, size_t budget);
+
+/// Gets the asset memory budget, in bytes. See ``glfmSetAssetMemoryBudget``.
+size_t glfmGetAssetMemoryBudget(const GLFMDisplay *display);
+
 // MARK: - Platform-specific functions
 
 /// Returns `true` if this is an Apple platform that supports Metal, `false` otherwise.
@@ -5,14 +5,22 @@
 
 #include "glfm.h"
 #include "glfm_internal.h"
+#include "glfm_egl.h"
 
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <android/asset_manager.h>
 #include <android/configuration.h>
 #include <android/sensor.h>
 #include <android/window.h>
 #include <assert.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <limits.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
+#include <time.h>
 #include <unistd.h>
 
 #define GLFM_LOG_LIFECYCLE_ENABLE 0
@@ -33,7 +41,10 @@
 #define GLFM_MAX_SIMULTANEOUS_TOUCHES 5
 // Same update interval as iOS
 #define GLFM_SENSOR_UPDATE_INTERVAL_MICROS ((int)(0.01 * 1000000))
-#define GLFM_RESIZE_EVENT_MAX_WAIT_FRAMES 5
+#define GLFM_MAX_CPUS 64
+#define GLFM_UI_THREAD_SYNC_TIMEOUT_MILLIS 250
+#define GLFM_MAX_ORDERED_COMMANDS 32 // Must be a power of 2
+#define GLFM_MAX_DAMAGE_RECTS 16
 
 // If GLFM_HANDLE_BACK_BUTTON is 1, when the user presses the back button, the task is moved to the back. Otherwise,
 // when the user presses the back button, the activity is destroyed. On newer API levels (31) this may not be needed.
@@ -41,18 +52,32 @@
 
 // MARK: - Platform data (global singleton)
 
+typedef struct GLFMLooperMessage GLFMLooperMessage;
+typedef struct GLFMOverflowCommand GLFMOverflowCommand;
+
 typedef struct {
     ALooper *looper;
     pthread_t thread;
     pthread_mutex_t mutex;
     pthread_cond_t cond;
-    int commandPipeRead;
-    int commandPipeWrite;
+    // Activity commands, sent from the UI thread. Idempotent commands are coalesced into a bitmask. Other commands are
+    // queued in order in a single-producer, single-consumer ring buffer. When the ring is full, commands are appended
+    // to an overflow list, so the UI thread never waits for the GLFM thread. Overflow commands follow every command in
+    // the ring.
+    int commandEventFd;
+    _Atomic(uint32_t) pendingCommandMask;
+    _Atomic(uint32_t) orderedCommandsHead; // Read by the GLFM thread
+    _Atomic(uint32_t) orderedCommandsTail; // Written by the UI thread
+    uint8_t orderedCommands[GLFM_MAX_ORDERED_COMMANDS];
+    _Atomic(bool) overflowCommandsPending; // Set by the UI thread, cleared by the GLFM thread when it takes the list
+    GLFMOverflowCommand *overflowCommands; // Oldest first. Guarded by mutex.
+    GLFMOverflowCommand *overflowCommandsTail; // Guarded by mutex.
     bool threadRunning;
+    bool uiThreadWaiting; // The UI thread is blocked waiting for the GLFM thread. Guarded by mutex.
 
     ALooper *uiLooper;
-    int uiCommandPipeRead;
-    int uiCommandPipeWrite;
+    int uiEventFd;
+    _Atomic(GLFMLooperMessage *) uiMessages; // Lock-free stack, newest first
 
     ANativeWindow *window;
     AInputQueue *inputQueue;
@@ -75,6 +100,7 @@ typedef struct {
     bool refreshRequested;
     bool swapCalled;
     bool surfaceCreatedNotified;
+    bool contextPreserved; // Context kept from a previous activity, until surfaceCreatedFunc is called
     double lastSwapTime;
 
     EGLDisplay eglDisplay;
@@ -82,11 +108,23 @@ typedef struct {
     EGLConfig eglConfig;
     EGLContext eglContext;
     bool eglContextCurrent;
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC eglSwapBuffersWithDamage; // NULL if not supported
+    bool eglBufferAgeSupported;
+    bool eglSingleBufferSupported; // True if single buffer mode was requested and is supported
+    bool eglSurfaceSwapped; // True if a frame was swapped since the surface was created
+
+    GLFMEGLFrameFences frameFences;
 
     int32_t width;
     int32_t height;
     double scale;
-    int resizeEventWaitFrames;
+    bool surfaceSizeChanged; // Set by window events, checked before the next frame
+
+    // Render scale. When the buffer geometry is scaled, width and height are smaller than the native window size.
+    int32_t windowWidth;
+    int32_t windowHeight;
+    bool bufferGeometryScaled;
+    bool renderScaleChanged;
 
     struct {
         int top, right, bottom, left;
@@ -103,6 +141,8 @@ typedef struct {
 
     GLFMInterfaceOrientation orientation;
 
+    char cacheDirectory[GLFM_MAX_PATH]; // Empty until first requested
+
     JNIEnv *jniEnv;
 } GLFMPlatformData;
 
@@ -111,7 +151,8 @@ static GLFMPlatformData *platformDataGlobal = NULL;
 // MARK: - Private function declarations
 
 static void *glfm__mainLoop(void *param);
-static int glfm__looperCallback(int pipe, int events, void *userData);
+static int glfm__looperCallback(int fd, int events, void *userData);
+static void glfm__freeUIThreadMessages(GLFMPlatformData *platformData);
 static void glfm__setAllRequestedSensorsEnabled(GLFMDisplay *display, bool enable);
 static void glfm__reportOrientationChangeIfNeeded(GLFMDisplay *display);
 static void glfm__reportInsetsChangedIfNeeded(GLFMDisplay *display);
@@ -203,12 +244,40 @@ static jfieldID glfm__getJavaStaticFieldID(JNIEnv *jni, jclass class, const char
 
 // MARK: - EGL
 
-static bool glfm__eglContextInit(GLFMPlatformData *platformData) {
-
-    // Available in eglext.h in API 18
-    static const int EGL_CONTEXT_MAJOR_VERSION_KHR = 0x3098;
-    static const int EGL_CONTEXT_MINOR_VERSION_KHR = 0x30FB;
+/// Creates a context for the specified OpenGL ES version. In debug mode, a debug context is requested first.
+static EGLContext glfm__eglCreateContext(GLFMPlatformData *platformData, EGLint majorVersion, EGLint minorVersion) {
+    EGLint contextAttribList[8];
+    int count = 0;
+    if (minorVersion > 0) {
+        contextAttribList[count++] = EGL_CONTEXT_MAJOR_VERSION_KHR;
+        contextAttribList[count++] = majorVersion;
+        contextAttribList[count++] = EGL_CONTEXT_MINOR_VERSION_KHR;
+        contextAttribList[count++] = minorVersion;
+    } else {
+        contextAttribList[count++] = EGL_CONTEXT_CLIENT_VERSION;
+        contextAttribList[count++] = majorVersion;
+    }
+    EGLContext context = EGL_NO_CONTEXT;
+    if (platformData->display->debugEnabled &&
+        glfm__eglHasExtension(platformData->eglDisplay, "EGL_KHR_create_context")) {
+        contextAttribList[count] = EGL_CONTEXT_FLAGS_KHR;
+        contextAttribList[count + 1] = EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR;
+        contextAttribList[count + 2] = EGL_NONE;
+        contextAttribList[count + 3] = EGL_NONE;
+        context = eglCreateContext(platformData->eglDisplay, platformData->eglConfig, EGL_NO_CONTEXT,
+                                   contextAttribList);
+    }
+    if (context == EGL_NO_CONTEXT) {
+        // Some drivers don't support debug contexts for OpenGL ES. GL_KHR_debug may still be available.
+        contextAttribList[count] = EGL_NONE;
+        contextAttribList[count + 1] = EGL_NONE;
+        context = eglCreateContext(platformData->eglDisplay, platformData->eglConfig, EGL_NO_CONTEXT,
+                                   contextAttribList);
+    }
+    return context;
+}
 
+static bool glfm__eglContextInit(GLFMPlatformData *platformData) {
     if (!platformData || !platformData->display) {
         return false;
     }
@@ -221,42 +290,28 @@ static bool glfm__eglContextInit(GLFMPlatformData *platformData) {
         if (platformData->display->preferredAPI >= GLFMRenderingAPIOpenGLES32) {
             majorVersion = 3;
             minorVersion = 2;
-            const EGLint contextAttribList[] = { EGL_CONTEXT_MAJOR_VERSION_KHR, majorVersion,
-                                                 EGL_CONTEXT_MINOR_VERSION_KHR, minorVersion,
-                                                 EGL_NONE, EGL_NONE };
-            platformData->eglContext = eglCreateContext(platformData->eglDisplay, platformData->eglConfig,
-                                                        EGL_NO_CONTEXT, contextAttribList);
+            platformData->eglContext = glfm__eglCreateContext(platformData, majorVersion, minorVersion);
             created = platformData->eglContext != EGL_NO_CONTEXT;
         }
         // OpenGL ES 3.1
         if (!created && platformData->display->preferredAPI >= GLFMRenderingAPIOpenGLES31) {
             majorVersion = 3;
             minorVersion = 1;
-            const EGLint contextAttribList[] = { EGL_CONTEXT_MAJOR_VERSION_KHR, majorVersion,
-                                                 EGL_CONTEXT_MINOR_VERSION_KHR, minorVersion,
-                                                 EGL_NONE, EGL_NONE };
-            platformData->eglContext = eglCreateContext(platformData->eglDisplay, platformData->eglConfig,
-                                                        EGL_NO_CONTEXT, contextAttribList);
+            platformData->eglContext = glfm__eglCreateContext(platformData, majorVersion, minorVersion);
             created = platformData->eglContext != EGL_NO_CONTEXT;
         }
         // OpenGL ES 3.0
         if (!created && platformData->display->preferredAPI >= GLFMRenderingAPIOpenGLES3) {
             majorVersion = 3;
             minorVersion = 0;
-            const EGLint contextAttribList[] = { EGL_CONTEXT_CLIENT_VERSION, majorVersion,
-                                                 EGL_NONE, EGL_NONE };
-            platformData->eglContext = eglCreateContext(platformData->eglDisplay, platformData->eglConfig,
-                                                        EGL_NO_CONTEXT, contextAttribList);
+            platformData->eglContext = glfm__eglCreateContext(platformData, majorVersion, minorVersion);
             created = platformData->eglContext != EGL_NO_CONTEXT;
         }
         // OpenGL ES 2.0
         if (!created) {
             majorVersion = 2;
             minorVersion = 0;
-            const EGLint contextAttribList[] = { EGL_CONTEXT_CLIENT_VERSION, majorVersion,
-                                                 EGL_NONE, EGL_NONE };
-            platformData->eglContext = eglCreateContext(platformData->eglDisplay, platformData->eglConfig,
-                                                        EGL_NO_CONTEXT, contextAttribList);
+            platformData->eglContext = glfm__eglCreateContext(platformData, majorVersion, minorVersion);
             created = platformData->eglContext != EGL_NO_CONTEXT;
         }
 
@@ -290,11 +345,18 @@ static bool glfm__eglContextInit(GLFMPlatformData *platformData) {
 
     GLFM_LOG_LIFECYCLE("GL Context made current");
     platformData->eglContextCurrent = true;
-    if (created && !platformData->surfaceCreatedNotified) {
+    if (created) {
+        platformData->contextPreserved = false;
+        if (platformData->display->contextReadyFunc) {
+            platformData->display->contextReadyFunc(platformData->display);
+        }
+    }
+    if (platformData->eglSurface != EGL_NO_SURFACE && !platformData->surfaceCreatedNotified) {
         platformData->surfaceCreatedNotified = true;
         if (platformData->display && platformData->display->surfaceCreatedFunc) {
             platformData->display->surfaceCreatedFunc(platformData->display, platformData->width, platformData->height);
         }
+        platformData->contextPreserved = false;
     }
     return true;
 }
@@ -306,10 +368,49 @@ static void glfm__eglContextDisable(GLFMPlatformData *platformData) {
     platformData->eglContextCurrent = false;
 }
 
+/// Sets the window's buffer geometry from the render scale. The compositor scales the buffers to fill the window.
+/// The new size is reported by eglQuerySurface after the next swap.
+static void glfm__applyRenderScale(GLFMPlatformData *platformData) {
+    platformData->renderScaleChanged = false;
+    if (!platformData->window || platformData->eglDisplay == EGL_NO_DISPLAY) {
+        return;
+    }
+    EGLint format = 0;
+    eglGetConfigAttrib(platformData->eglDisplay, platformData->eglConfig, EGL_NATIVE_VISUAL_ID, &format);
+    ANativeWindow_setBuffersGeometry(platformData->window, 0, 0, format);
+    platformData->windowWidth = ANativeWindow_getWidth(platformData->window);
+    platformData->windowHeight = ANativeWindow_getHeight(platformData->window);
+    platformData->bufferGeometryScaled = false;
+
+    const double renderScale = glfmGetRenderScale(platformData->display);
+    if (renderScale < 1.0 && platformData->windowWidth > 0 && platformData->windowHeight > 0) {
+        int32_t width = (int32_t)((double)platformData->windowWidth * renderScale + 0.5);
+        int32_t height = (int32_t)((double)platformData->windowHeight * renderScale + 0.5);
+        width = width < 1 ? 1 : width;
+        height = height < 1 ? 1 : height;
+        ANativeWindow_setBuffersGeometry(platformData->window, width, height, format);
+        platformData->bufferGeometryScaled = true;
+    }
+    platformData->surfaceSizeChanged = true;
+}
+
+/// Returns the ratio of the surface size to the native window size. Used to convert window coordinates (touches,
+/// insets, keyboard frame) to surface coordinates.
+static double glfm__getRenderScaleFactor(const GLFMPlatformData *platformData) {
+    if (platformData->bufferGeometryScaled && platformData->windowWidth > 0 && platformData->width > 0) {
+        return (double)platformData->width / (double)platformData->windowWidth;
+    } else {
+        return 1.0;
+    }
+}
+
 static void glfm__eglSurfaceInit(GLFMPlatformData *platformData) {
     if (platformData->eglSurface == EGL_NO_SURFACE) {
+        glfm__applyRenderScale(platformData);
+
         platformData->eglSurface = eglCreateWindowSurface(platformData->eglDisplay, platformData->eglConfig,
                                                           platformData->window, NULL);
+        platformData->eglSurfaceSwapped = false;
 
         switch (platformData->display->swapBehavior) {
             case GLFMSwapBehaviorPlatformDefault: default:
@@ -322,6 +423,16 @@ static void glfm__eglSurfaceInit(GLFMPlatformData *platformData) {
             case GLFMSwapBehaviorBufferDestroyed:
                 eglSurfaceAttrib(platformData->eglDisplay, platformData->eglSurface,
                                  EGL_SWAP_BEHAVIOR, EGL_BUFFER_DESTROYED);
+                break;
+            case GLFMSwapBehaviorSingleBuffer:
+                // Takes effect after the next eglSwapBuffers. The compositor reads the shared buffer every vsync.
+                if (platformData->eglSingleBufferSupported && platformData->eglSurface != EGL_NO_SURFACE) {
+                    eglSurfaceAttrib(platformData->eglDisplay, platformData->eglSurface,
+                                     EGL_RENDER_BUFFER, EGL_SINGLE_BUFFER);
+                    eglSurfaceAttrib(platformData->eglDisplay, platformData->eglSurface,
+                                     EGL_FRONT_BUFFER_AUTO_REFRESH_ANDROID, EGL_TRUE);
+                }
+                break;
         }
     }
 }
@@ -355,11 +466,48 @@ static void glfm__eglLogConfig(GLFMPlatformData *platformData, EGLConfig config)
 
 #endif
 
-static bool glfm__eglInit(GLFMPlatformData *platformData) {
-    if (platformData->eglDisplay != EGL_NO_DISPLAY) {
-        glfm__eglSurfaceInit(platformData);
-        return glfm__eglContextInit(platformData);
+// MARK: EGL config cache
+
+static uint64_t glfm__eglConfigCacheKey(EGLDisplay eglDisplay, const GLFMEGLConfigAttribs *requested) {
+    char attribs[128];
+    snprintf(attribs, sizeof(attribs), "%i %i %i %i %i %i %i %i", requested->red, requested->green, requested->blue,
+             requested->alpha, requested->depth, requested->stencil, requested->samples, requested->surfaceType);
+    uint64_t key = GLFM_HASH_INIT;
+    key = glfm__hashString(key, eglQueryString(eglDisplay, EGL_VENDOR));
+    key = glfm__hashString(key, eglQueryString(eglDisplay, EGL_VERSION));
+    key = glfm__hashString(key, attribs);
+    return key;
+}
+
+static bool glfm__eglGetConfigCachePath(GLFMPlatformData *platformData, char *path, size_t pathSize) {
+    const char *cacheDirectory = glfm__getCacheDirectory(platformData->display);
+    if (!cacheDirectory) {
+        return false;
+    }
+    int length = snprintf(path, pathSize, "%s/glfm_egl_config", cacheDirectory);
+    return length > 0 && (size_t)length < pathSize;
+}
+
+static void glfm__eglExtensionsInit(GLFMPlatformData *platformData) {
+    platformData->eglSwapBuffersWithDamage = NULL;
+    if (glfm__eglHasExtension(platformData->eglDisplay, "EGL_KHR_swap_buffers_with_damage")) {
+        platformData->eglSwapBuffersWithDamage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)
+            eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+    }
+    if (!platformData->eglSwapBuffersWithDamage &&
+        glfm__eglHasExtension(platformData->eglDisplay, "EGL_EXT_swap_buffers_with_damage")) {
+        // Same signature as the KHR function
+        platformData->eglSwapBuffersWithDamage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)
+            eglGetProcAddress("eglSwapBuffersWithDamageEXT");
     }
+    platformData->eglBufferAgeSupported = glfm__eglHasExtension(platformData->eglDisplay, "EGL_EXT_buffer_age");
+    platformData->eglSingleBufferSupported = (platformData->display->swapBehavior == GLFMSwapBehaviorSingleBuffer &&
+        glfm__eglHasExtension(platformData->eglDisplay, "EGL_KHR_mutable_render_buffer") &&
+        glfm__eglHasExtension(platformData->eglDisplay, "EGL_ANDROID_front_buffer_auto_refresh"));
+}
+
+/// Initializes the EGL display and chooses a config. Does not require a window.
+static bool glfm__eglDisplayInit(GLFMPlatformData *platformData) {
     int rBits, gBits, bBits, aBits;
     int depthBits, stencilBits, samples;
 
@@ -410,82 +558,124 @@ static bool glfm__eglInit(GLFMPlatformData *platformData) {
 
     EGLint majorVersion = 0;
     EGLint minorVersion = 0;
-    EGLint format = 0;
-    EGLint numConfigs = 0;
 
     platformData->eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
     eglInitialize(platformData->eglDisplay, &majorVersion, &minorVersion);
+    glfm__eglExtensionsInit(platformData);
 
-    while (true) {
-        const EGLint attribList[] = {
-            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
-            EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-            EGL_RED_SIZE, rBits,
-            EGL_GREEN_SIZE, gBits,
-            EGL_BLUE_SIZE, bBits,
-            EGL_ALPHA_SIZE, aBits,
-            EGL_DEPTH_SIZE, depthBits,
-            EGL_STENCIL_SIZE, stencilBits,
-            EGL_SAMPLE_BUFFERS, samples > 0 ? 1 : 0,
-            EGL_SAMPLES, samples > 0 ? samples : 0,
-            EGL_NONE, EGL_NONE
-        };
-        eglChooseConfig(platformData->eglDisplay, attribList, &platformData->eglConfig,
-                        1, &numConfigs);
-        if (numConfigs) {
-            // Found!
-            //glfm__eglLogConfig(platformData, platformData->eglConfig);
-            break;
-        }
-        if (samples > 0) {
-            // Try 2x multisampling or no multisampling
-            samples -= 2;
-        } else if (depthBits > 8) {
-            // Try 16-bit depth or 8-bit depth
-            depthBits -= 8;
-        } else {
-            // Failure
+    GLFMEGLConfigAttribs requested = {
+        .red = rBits, .green = gBits, .blue = bBits, .alpha = aBits,
+        .depth = depthBits, .stencil = stencilBits, .samples = samples,
+        .surfaceType = (EGL_WINDOW_BIT |
+                        (platformData->eglSingleBufferSupported ? EGL_MUTABLE_RENDER_BUFFER_BIT_KHR : 0)),
+    };
+
+    char cachePath[GLFM_MAX_PATH];
+    const bool cacheAvailable = glfm__eglGetConfigCachePath(platformData, cachePath, sizeof(cachePath));
+    uint64_t cacheKey = glfm__eglConfigCacheKey(platformData->eglDisplay, &requested);
+    if (cacheAvailable && glfm__eglLoadCachedConfig(platformData->eglDisplay, cachePath, cacheKey,
+                                                    requested.surfaceType, &platformData->eglConfig)) {
+        return true;
+    }
+    bool found = glfm__eglChooseBestConfig(platformData->eglDisplay, &requested, &platformData->eglConfig);
+    if (!found && requested.surfaceType != EGL_WINDOW_BIT) {
+        // No config supports a mutable render buffer. Fall back to double buffering.
+        GLFM_LOG("No EGL config supports single buffer mode");
+        platformData->eglSingleBufferSupported = false;
+        requested.surfaceType = EGL_WINDOW_BIT;
+        cacheKey = glfm__eglConfigCacheKey(platformData->eglDisplay, &requested);
+        found = glfm__eglChooseBestConfig(platformData->eglDisplay, &requested, &platformData->eglConfig);
+    }
+    if (!found) {
 #ifndef NDEBUG
-            static bool printedConfigs = false;
-            if (!printedConfigs) {
-                printedConfigs = true;
-                GLFM_LOG("eglChooseConfig() failed");
-                EGLConfig configs[256];
-                EGLint numTotalConfigs = 0;
-                if (eglGetConfigs(platformData->eglDisplay, configs, 256, &numTotalConfigs)) {
-                    GLFM_LOG("Num available configs: %i", numTotalConfigs);
-                    for (int i = 0; i < numTotalConfigs; i++) {
-                        glfm__eglLogConfig(platformData, configs[i]);
-                    }
-                } else {
-                    GLFM_LOG("Couldn't get any EGL configs");
+        static bool printedConfigs = false;
+        if (!printedConfigs) {
+            printedConfigs = true;
+            EGLConfig configs[256];
+            EGLint numTotalConfigs = 0;
+            if (eglGetConfigs(platformData->eglDisplay, configs, 256, &numTotalConfigs)) {
+                GLFM_LOG("Num available configs: %i", numTotalConfigs);
+                for (int i = 0; i < numTotalConfigs; i++) {
+                    glfm__eglLogConfig(platformData, configs[i]);
                 }
+            } else {
+                GLFM_LOG("Couldn't get any EGL configs");
             }
-#endif
-
-            GLFM_LOG("eglChooseConfig() failed");
-            glfm__reportSurfaceError(platformData->eglDisplay, "eglChooseConfig() failed");
-            eglTerminate(platformData->eglDisplay);
-            platformData->eglDisplay = EGL_NO_DISPLAY;
-            return false;
         }
+#endif
+        GLFM_LOG("eglChooseConfig() failed");
+        glfm__reportSurfaceError(platformData->display, "eglChooseConfig() failed");
+        eglTerminate(platformData->eglDisplay);
+        platformData->eglDisplay = EGL_NO_DISPLAY;
+        return false;
+    }
+    if (cacheAvailable) {
+        glfm__eglStoreCachedConfig(platformData->eglDisplay, cachePath, cacheKey, platformData->eglConfig);
     }
+    return true;
+}
 
+static bool glfm__eglInit(GLFMPlatformData *platformData) {
+    if (platformData->eglDisplay == EGL_NO_DISPLAY && !glfm__eglDisplayInit(platformData)) {
+        return false;
+    }
     glfm__eglSurfaceInit(platformData);
+    if (platformData->eglSurface == EGL_NO_SURFACE) {
+        return false;
+    }
+    if (!platformData->surfaceCreatedNotified) {
+        // Get the size before surfaceCreatedFunc is called
+        eglQuerySurface(platformData->eglDisplay, platformData->eglSurface, EGL_WIDTH, &platformData->width);
+        eglQuerySurface(platformData->eglDisplay, platformData->eglSurface, EGL_HEIGHT, &platformData->height);
+    }
+    return glfm__eglContextInit(platformData);
+}
+
+/// Creates the context before the window exists, if EGL_KHR_surfaceless_context is available. This lets the app load
+/// resources in the GLFMContextReadyFunc while the window is being created. The window surface is attached to the
+/// context when the window is created.
+static void glfm__eglSurfacelessInit(GLFMPlatformData *platformData) {
+    if (platformData->eglContext != EGL_NO_CONTEXT || platformData->window) {
+        return;
+    }
+    if (platformData->eglDisplay == EGL_NO_DISPLAY && !glfm__eglDisplayInit(platformData)) {
+        return;
+    }
+    if (!glfm__eglHasExtension(platformData->eglDisplay, "EGL_KHR_surfaceless_context")) {
+        return;
+    }
+    if (glfm__eglContextInit(platformData)) {
+        GLFM_LOG_LIFECYCLE("Surfaceless GL Context created");
+    }
+}
 
-    eglQuerySurface(platformData->eglDisplay, platformData->eglSurface, EGL_WIDTH,
-                    &platformData->width);
-    eglQuerySurface(platformData->eglDisplay, platformData->eglSurface, EGL_HEIGHT,
-                    &platformData->height);
-    eglGetConfigAttrib(platformData->eglDisplay, platformData->eglConfig, EGL_NATIVE_VISUAL_ID,
-                       &format);
+// MARK: EGL frames in flight
 
-    ANativeWindow_setBuffersGeometry(platformData->window, 0, 0, format);
+_Static_assert(GLFM_EGL_MAX_FRAME_FENCES >= GLFM_MAX_FRAMES_IN_FLIGHT, "Not enough frame fences");
 
-    return glfm__eglContextInit(platformData);
+static void glfm__eglFrameFencesReset(GLFMPlatformData *platformData) {
+    glfm__eglFrameFencesDestroy(platformData->eglDisplay, &platformData->frameFences);
+}
+
+/// Waits until fewer than `maxFramesInFlight` frames are queued on the GPU, and updates the frame stats. Called
+/// before the render function.
+static void glfm__eglFrameFenceWaitForFrame(GLFMPlatformData *platformData) {
+    if (platformData->frameFences.count == 0 || !platformData->display) {
+        return;
+    }
+    double startTime = glfmGetTime();
+    bool waited = glfm__eglFrameFenceWait(platformData->eglDisplay, &platformData->frameFences,
+                                          platformData->display->maxFramesInFlight);
+    GLFMFrameStats *stats = &platformData->display->frameStats;
+    stats->lastWaitTime = waited ? glfmGetTime() - startTime : 0.0;
+    if (waited) {
+        stats->waitCount++;
+        stats->totalWaitTime += stats->lastWaitTime;
+    }
 }
 
 static void glfm__eglSurfaceDestroy(GLFMPlatformData *platformData) {
+    glfm__eglFrameFencesReset(platformData);
     if (platformData->eglSurface != EGL_NO_SURFACE) {
         eglDestroySurface(platformData->eglDisplay, platformData->eglSurface);
         platformData->eglSurface = EGL_NO_SURFACE;
@@ -495,10 +685,15 @@ static void glfm__eglSurfaceDestroy(GLFMPlatformData *platformData) {
 
 static void glfm__eglDestroy(GLFMPlatformData *platformData) {
     if (platformData->eglDisplay != EGL_NO_DISPLAY) {
+        glfm__eglFrameFencesReset(platformData);
         eglMakeCurrent(platformData->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
         if (platformData->eglContext != EGL_NO_CONTEXT) {
             eglDestroyContext(platformData->eglDisplay, platformData->eglContext);
             GLFM_LOG_LIFECYCLE("GL Context destroyed");
+            if (platformData->display) {
+                glfm__gpuTimerReset(platformData->display);
+                glfm__debugReset(platformData->display);
+            }
             if (platformData->surfaceCreatedNotified) {
                 platformData->surfaceCreatedNotified = false;
                 if (platformData->display && platformData->display->surfaceDestroyedFunc) {
@@ -517,6 +712,22 @@ static void glfm__eglDestroy(GLFMPlatformData *platformData) {
     platformData->eglContextCurrent = false;
 }
 
+/// Called when the activity is destroyed. If the persistent context is enabled, only the surface is destroyed, and the
+/// context is used again if the activity is recreated in the same process.
+static void glfm__eglRelease(GLFMPlatformData *platformData) {
+    if (platformData->display && platformData->display->persistentContextEnabled &&
+        platformData->eglContext != EGL_NO_CONTEXT) {
+        GLFM_LOG_LIFECYCLE("GL Context preserved");
+        glfm__eglSurfaceDestroy(platformData);
+        if (platformData->surfaceCreatedNotified) {
+            platformData->surfaceCreatedNotified = false;
+            platformData->contextPreserved = true;
+        }
+    } else {
+        glfm__eglDestroy(platformData);
+    }
+}
+
 static void glfm__eglCheckError(GLFMPlatformData *platformData) {
     EGLint err = eglGetError();
     if (err == EGL_BAD_SURFACE) {
@@ -527,6 +738,10 @@ static void glfm__eglCheckError(GLFMPlatformData *platformData) {
             platformData->eglContext = EGL_NO_CONTEXT;
             platformData->eglContextCurrent = false;
             GLFM_LOG_LIFECYCLE("GL Context lost");
+            if (platformData->display) {
+                glfm__gpuTimerReset(platformData->display);
+                glfm__debugReset(platformData->display);
+            }
             if (platformData->surfaceCreatedNotified) {
                 platformData->surfaceCreatedNotified = false;
                 if (platformData->display && platformData->display->surfaceDestroyedFunc) {
@@ -546,10 +761,29 @@ static void glfm__drawFrame(GLFMPlatformData *platformData) {
         // Probably a bad config (Happens on Android 2.3 emulator)
         return;
     }
+    if (platformData->eglSurface == EGL_NO_SURFACE) {
+        // Surfaceless context, waiting for the window
+        return;
+    }
+
+    // Auto render scale
+    if (platformData->display && platformData->display->renderScaleController.enabled) {
+        glfm__updateAutoRenderScale(platformData->display,
+                                    1.0 / (double)glfm__getRefreshRate(platformData->display));
+    }
+    if (platformData->renderScaleChanged) {
+        glfm__applyRenderScale(platformData);
+    }
 
     // Check for resize (or rotate)
     glfm__updateSurfaceSizeIfNeeded(platformData->display, false);
 
+    // Finished jobs and asset loads
+    if (platformData->display) {
+        glfm__jobPoolDrainCompletions(platformData->display);
+        glfm__assetLoaderUpdate(platformData->display);
+    }
+
     // Tick and draw
     if (platformData->refreshRequested) {
         platformData->refreshRequested = false;
@@ -558,7 +792,12 @@ static void glfm__drawFrame(GLFMPlatformData *platformData) {
         }
     }
     if (platformData->display && platformData->display->renderFunc) {
+        glfm__eglFrameFenceWaitForFrame(platformData);
+        glfm__debugBeginFrame(platformData->display);
+        glfm__gpuTimerBeginFrame(platformData->display);
         platformData->display->renderFunc(platformData->display);
+        glfm__gpuTimerEndFrame(platformData->display);
+        glfm__debugEndFrame(platformData->display);
     }
 }
 
@@ -589,14 +828,105 @@ typedef enum {
     GLFMActivityCommandOnLowMemory,
 } GLFMActivityCommand;
 
+/// Returns true if sending the command multiple times before it is handled is the same as sending it once.
+static bool glfm__isCoalescedCommand(GLFMActivityCommand command) {
+    switch (command) {
+        case GLFMActivityCommandOnNativeWindowResized:
+        case GLFMActivityCommandOnNativeWindowRedrawNeeded:
+        case GLFMActivityCommandOnContentRectChanged:
+        case GLFMActivityCommandOnConfigurationChanged:
+        case GLFMActivityCommandOnLowMemory:
+            return true;
+        case GLFMActivityCommandOnStart:
+        case GLFMActivityCommandOnPause:
+        case GLFMActivityCommandOnResume:
+        case GLFMActivityCommandOnStop:
+        case GLFMActivityCommandOnDestroy:
+        case GLFMActivityCommandOnWindowFocusGained:
+        case GLFMActivityCommandOnWindowFocusLost:
+        case GLFMActivityCommandOnNativeWindowCreated:
+        case GLFMActivityCommandOnNativeWindowDestroyed:
+        case GLFMActivityCommandOnInputQueueCreated:
+        case GLFMActivityCommandOnInputQueueDestroyed:
+        default:
+            return false;
+    }
+}
+
+struct GLFMOverflowCommand {
+    GLFMActivityCommand command;
+    GLFMOverflowCommand *next;
+};
+
+static void glfm__freeOverflowCommands(GLFMOverflowCommand *overflowCommand) {
+    while (overflowCommand) {
+        GLFMOverflowCommand *next = overflowCommand->next;
+        free(overflowCommand);
+        overflowCommand = next;
+    }
+}
+
+/// Returns true if the ordered command ring is full. Only called on the UI thread.
+static bool glfm__orderedCommandsFull(GLFMPlatformData *platformData) {
+    uint32_t tail = atomic_load_explicit(&platformData->orderedCommandsTail, memory_order_relaxed);
+    return (tail - atomic_load_explicit(&platformData->orderedCommandsHead, memory_order_acquire) >=
+            GLFM_MAX_ORDERED_COMMANDS);
+}
+
+/// Queues an ordered command. Only called on the UI thread.
+static void glfm__queueOrderedCommand(GLFMPlatformData *platformData, GLFMActivityCommand command) {
+    // Only the UI thread sets overflowCommandsPending, so if it's clear, the overflow list is empty and the ring can
+    // be used without reordering commands.
+    if (atomic_load_explicit(&platformData->overflowCommandsPending, memory_order_acquire) ||
+        glfm__orderedCommandsFull(platformData)) {
+        GLFMOverflowCommand *overflowCommand = malloc(sizeof(GLFMOverflowCommand));
+        if (overflowCommand) {
+            overflowCommand->command = command;
+            overflowCommand->next = NULL;
+            pthread_mutex_lock(&platformData->mutex);
+            if (platformData->overflowCommandsTail) {
+                platformData->overflowCommandsTail->next = overflowCommand;
+            } else {
+                platformData->overflowCommands = overflowCommand;
+            }
+            platformData->overflowCommandsTail = overflowCommand;
+            atomic_store_explicit(&platformData->overflowCommandsPending, true, memory_order_release);
+            pthread_mutex_unlock(&platformData->mutex);
+            return;
+        }
+
+        // Out of memory. Lifecycle commands can't be dropped, so wait for the GLFM thread to take the overflow list
+        // and make room in the ring. Meanwhile, sync calls from the GLFM thread fail instead of waiting for the UI
+        // thread.
+        pthread_mutex_lock(&platformData->mutex);
+        platformData->uiThreadWaiting = true;
+        pthread_mutex_unlock(&platformData->mutex);
+        while (atomic_load_explicit(&platformData->overflowCommandsPending, memory_order_acquire) ||
+               glfm__orderedCommandsFull(platformData)) {
+            usleep(1000);
+        }
+        pthread_mutex_lock(&platformData->mutex);
+        platformData->uiThreadWaiting = false;
+        pthread_mutex_unlock(&platformData->mutex);
+    }
+    uint32_t tail = atomic_load_explicit(&platformData->orderedCommandsTail, memory_order_relaxed);
+    platformData->orderedCommands[tail & (GLFM_MAX_ORDERED_COMMANDS - 1)] = (uint8_t)command;
+    atomic_store_explicit(&platformData->orderedCommandsTail, tail + 1, memory_order_release);
+}
+
 static void glfm__sendCommand(ANativeActivity *activity, GLFMActivityCommand command) {
     GLFMPlatformData *platformData = activity->instance;
     if (!platformData) {
         return;
     }
-    uint8_t data = (uint8_t)command;
-    if (write(platformData->commandPipeWrite, &data, sizeof(data)) != sizeof(data)) {
-        GLFM_LOG("Couldn't write to pipe");
+    if (glfm__isCoalescedCommand(command)) {
+        atomic_fetch_or_explicit(&platformData->pendingCommandMask, 1u << command, memory_order_release);
+    } else {
+        glfm__queueOrderedCommand(platformData, command);
+    }
+    const uint64_t one = 1;
+    if (write(platformData->commandEventFd, &one, sizeof(one)) != sizeof(one)) {
+        GLFM_LOG("Couldn't write to command eventfd");
     }
 }
 
@@ -647,10 +977,15 @@ static void glfm__activityOnNativeWindowCreated(ANativeActivity *activity, ANati
     GLFMPlatformData *platformData = activity->instance;
     pthread_mutex_lock(&platformData->mutex);
     platformData->pendingWindow = window;
+    pthread_mutex_unlock(&platformData->mutex);
+    // Send without holding the mutex. If the command ring is full, sending locks the mutex to add to the overflow list.
     glfm__sendCommand(activity, GLFMActivityCommandOnNativeWindowCreated);
+    pthread_mutex_lock(&platformData->mutex);
+    platformData->uiThreadWaiting = true;
     while (platformData->window != window) {
         pthread_cond_wait(&platformData->cond, &platformData->mutex);
     }
+    platformData->uiThreadWaiting = false;
     pthread_mutex_unlock(&platformData->mutex);
 }
 
@@ -663,10 +998,14 @@ static void glfm__activityOnInputQueueCreated(ANativeActivity *activity, AInputQ
     GLFMPlatformData *platformData = activity->instance;
     pthread_mutex_lock(&platformData->mutex);
     platformData->pendingInputQueue = queue;
+    pthread_mutex_unlock(&platformData->mutex);
     glfm__sendCommand(activity, GLFMActivityCommandOnInputQueueCreated);
+    pthread_mutex_lock(&platformData->mutex);
+    platformData->uiThreadWaiting = true;
     while (platformData->inputQueue != queue) {
         pthread_cond_wait(&platformData->cond, &platformData->mutex);
     }
+    platformData->uiThreadWaiting = false;
     pthread_mutex_unlock(&platformData->mutex);
 }
 
@@ -686,20 +1025,26 @@ static void glfm__activityOnContentRectChanged(ANativeActivity *activity, const
 
 static void glfm__activityOnDestroy(ANativeActivity *activity) {
     GLFMPlatformData *platformData = activity->instance;
-    pthread_mutex_lock(&platformData->mutex);
     glfm__sendCommand(activity, GLFMActivityCommandOnDestroy);
+    pthread_mutex_lock(&platformData->mutex);
+    platformData->uiThreadWaiting = true;
     while (platformData->threadRunning) {
         pthread_cond_wait(&platformData->cond, &platformData->mutex);
     }
+    platformData->uiThreadWaiting = false;
     pthread_mutex_unlock(&platformData->mutex);
 
-    close(platformData->commandPipeRead);
-    close(platformData->commandPipeWrite);
+    close(platformData->commandEventFd);
+    glfm__freeOverflowCommands(platformData->overflowCommands);
+    platformData->overflowCommands = NULL;
+    platformData->overflowCommandsTail = NULL;
+    atomic_store(&platformData->overflowCommandsPending, false);
     pthread_cond_destroy(&platformData->cond);
     pthread_mutex_destroy(&platformData->mutex);
 
-    close(platformData->uiCommandPipeRead);
-    close(platformData->uiCommandPipeWrite);
+    ALooper_removeFd(platformData->uiLooper, platformData->uiEventFd);
+    close(platformData->uiEventFd);
+    glfm__freeUIThreadMessages(platformData);
     GLFM_LOG_LIFECYCLE("Goodbye");
 }
 
@@ -719,14 +1064,15 @@ JNIEXPORT void ANativeActivity_onCreate(ANativeActivity *activity, void *savedSt
         GLFM_LOG("No looper");
         return;
     }
-    int commandPipe[2];
-    int uiCommandPipe[2];
-    if (pipe(commandPipe)) {
-        GLFM_LOG("Couldn't create pipe");
+    int commandEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (commandEventFd < 0) {
+        GLFM_LOG("Couldn't create command eventfd");
         return;
     }
-    if (pipe(uiCommandPipe)) {
-        GLFM_LOG("Couldn't create UI pipe");
+    int uiEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (uiEventFd < 0) {
+        GLFM_LOG("Couldn't create UI eventfd");
+        close(commandEventFd);
         return;
     }
 
@@ -759,20 +1105,25 @@ JNIEXPORT void ANativeActivity_onCreate(ANativeActivity *activity, void *savedSt
     platformData->activity = activity;
     platformData->window = NULL;
     platformData->threadRunning = false;
+    platformData->uiThreadWaiting = true; // Until glfmMain() has returned and the GLFM thread is running
     platformData->destroyRequested = false;
     platformData->contentRectArray[0] = (ARect) { 0 };
     platformData->contentRectArray[1] = (ARect) { 0 };
-    platformData->commandPipeRead = commandPipe[0];
-    platformData->commandPipeWrite = commandPipe[1];
+    platformData->commandEventFd = commandEventFd;
+    atomic_store(&platformData->pendingCommandMask, 0);
+    atomic_store(&platformData->orderedCommandsHead, 0);
+    atomic_store(&platformData->orderedCommandsTail, 0);
+    atomic_store(&platformData->overflowCommandsPending, false);
+    platformData->overflowCommands = NULL;
+    platformData->overflowCommandsTail = NULL;
 
     pthread_mutex_init(&platformData->mutex, NULL);
     pthread_cond_init(&platformData->cond, NULL);
 
     // Setup UI thread callbacks
     platformData->uiLooper = looper;
-    platformData->uiCommandPipeRead = uiCommandPipe[0];
-    platformData->uiCommandPipeWrite = uiCommandPipe[1];
-    ALooper_addFd(platformData->uiLooper, platformData->uiCommandPipeRead, ALOOPER_POLL_CALLBACK,
+    platformData->uiEventFd = uiEventFd;
+    ALooper_addFd(platformData->uiLooper, platformData->uiEventFd, ALOOPER_POLL_CALLBACK,
                   ALOOPER_EVENT_INPUT, glfm__looperCallback, platformData);
 
     // Start thread
@@ -787,6 +1138,7 @@ JNIEXPORT void ANativeActivity_onCreate(ANativeActivity *activity, void *savedSt
     while (!platformData->threadRunning) {
         pthread_cond_wait(&platformData->cond, &platformData->mutex);
     }
+    platformData->uiThreadWaiting = false;
     pthread_mutex_unlock(&platformData->mutex);
     GLFM_LOG_LIFECYCLE("Returning from ANativeActivity_onCreate");
 }
@@ -795,40 +1147,214 @@ JNIEXPORT void ANativeActivity_onCreate(ANativeActivity *activity, void *savedSt
 
 typedef void (*GLFMUIThreadFunc)(GLFMPlatformData *platformData, void *userData);
 
+typedef enum {
+    GLFMUIThreadSyncStatusPending,
+    GLFMUIThreadSyncStatusRunning,
+    GLFMUIThreadSyncStatusDone,
+    GLFMUIThreadSyncStatusCancelled,
+} GLFMUIThreadSyncStatus;
+
+/// Shared between the waiting thread and the UI thread. Freed when both have released it.
 typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    GLFMUIThreadSyncStatus status;
+    int refCount;
+} GLFMUIThreadSync;
+
+struct GLFMLooperMessage {
     GLFMUIThreadFunc function;
     void *userData;
-} GLFMLooperMessage;
+    GLFMUIThreadSync *sync; // NULL if nothing is waiting for the result
+    GLFMLooperMessage *next;
+};
+
+static void glfm__releaseUIThreadSync(GLFMUIThreadSync *sync) {
+    pthread_mutex_lock(&sync->mutex);
+    bool shouldFree = --sync->refCount == 0;
+    pthread_mutex_unlock(&sync->mutex);
+    if (shouldFree) {
+        pthread_cond_destroy(&sync->cond);
+        pthread_mutex_destroy(&sync->mutex);
+        free(sync);
+    }
+}
+
+static void glfm__runUIThreadMessage(GLFMPlatformData *platformData, GLFMLooperMessage *message) {
+    GLFMUIThreadSync *sync = message->sync;
+    if (!sync) {
+        message->function(platformData, message->userData);
+        return;
+    }
+    pthread_mutex_lock(&sync->mutex);
+    bool cancelled = sync->status == GLFMUIThreadSyncStatusCancelled;
+    if (!cancelled) {
+        sync->status = GLFMUIThreadSyncStatusRunning;
+    }
+    pthread_mutex_unlock(&sync->mutex);
+
+    if (!cancelled) {
+        message->function(platformData, message->userData);
+
+        pthread_mutex_lock(&sync->mutex);
+        sync->status = GLFMUIThreadSyncStatusDone;
+        pthread_cond_broadcast(&sync->cond);
+        pthread_mutex_unlock(&sync->mutex);
+    }
+    glfm__releaseUIThreadSync(sync);
+}
+
+/// Takes all queued messages, oldest first.
+static GLFMLooperMessage *glfm__takeUIThreadMessages(GLFMPlatformData *platformData) {
+    GLFMLooperMessage *message = atomic_exchange_explicit(&platformData->uiMessages, NULL, memory_order_acquire);
+    GLFMLooperMessage *reversed = NULL;
+    while (message) {
+        GLFMLooperMessage *next = message->next;
+        message->next = reversed;
+        reversed = message;
+        message = next;
+    }
+    return reversed;
+}
 
 // Called from the UI thread
-static int glfm__looperCallback(int pipe, int events, void *userData) {
+static int glfm__looperCallback(int fd, int events, void *userData) {
     GLFMPlatformData *platformData = userData;
-    GLFMLooperMessage message;
     assert(ALooper_forThread() == platformData->uiLooper);
     if ((events & ALOOPER_EVENT_INPUT) != 0) {
-        if (read(pipe, &message, sizeof(message)) == sizeof(message)) {
-            message.function(platformData, message.userData);
+        // Reset the eventfd counter before taking the messages, so that a message queued afterwards wakes the looper.
+        uint64_t count;
+        if (read(fd, &count, sizeof(count)) != sizeof(count) && errno != EAGAIN) {
+            GLFM_LOG("Couldn't read from UI eventfd");
+        }
+        GLFMLooperMessage *message = glfm__takeUIThreadMessages(platformData);
+        while (message) {
+            GLFMLooperMessage *next = message->next;
+            glfm__runUIThreadMessage(platformData, message);
+            free(message);
+            message = next;
         }
     }
     return 1;
 }
 
-/// Queues a function to execute on the UI thread.
+/// Frees messages that were never run. Sync messages are only queued by the GLFM thread, which isn't running.
+static void glfm__freeUIThreadMessages(GLFMPlatformData *platformData) {
+    GLFMLooperMessage *message = glfm__takeUIThreadMessages(platformData);
+    while (message) {
+        GLFMLooperMessage *next = message->next;
+        if (message->sync) {
+            glfm__releaseUIThreadSync(message->sync);
+        }
+        free(message);
+        message = next;
+    }
+}
+
+static bool glfm__postUIThreadMessage(GLFMPlatformData *platformData, GLFMUIThreadFunc function, void *userData,
+                                      GLFMUIThreadSync *sync) {
+    GLFMLooperMessage *message = malloc(sizeof(GLFMLooperMessage));
+    if (!message) {
+        return false;
+    }
+    message->function = function;
+    message->userData = userData;
+    message->sync = sync;
+
+    GLFMLooperMessage *head = atomic_load_explicit(&platformData->uiMessages, memory_order_relaxed);
+    do {
+        message->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&platformData->uiMessages, &head, message,
+                                                    memory_order_release, memory_order_relaxed));
+
+    // Only wake the looper if the queue was empty. Otherwise, a wakeup is already pending.
+    if (!head) {
+        const uint64_t one = 1;
+        if (write(platformData->uiEventFd, &one, sizeof(one)) != sizeof(one)) {
+            GLFM_LOG("Couldn't write to UI eventfd");
+        }
+    }
+    return true;
+}
+
+/// Queues a function to execute on the UI thread. Can be called from any thread.
 /// Returns true if the function was queued, false otherwise.
 static bool glfm__runOnUIThread(GLFMPlatformData *platformData, GLFMUIThreadFunc function, void *userData) {
-    assert(platformData->looper == ALooper_forThread());
-    if (platformData->looper != ALooper_forThread() || !function) {
+    if (!platformData || !function) {
         return false;
     }
+    return glfm__postUIThreadMessage(platformData, function, userData, NULL);
+}
 
-    GLFMLooperMessage message = { 0 };
-    message.function = function;
-    message.userData = userData;
-    if (write(platformData->uiCommandPipeWrite, &message, sizeof(message)) != sizeof(message)) {
-        // The pipe is full.
+/// Executes a function on the UI thread, and waits for it to finish. If called from the UI thread, the function is
+/// executed immediately.
+///
+/// Returns true if the function was executed, or false if it wasn't (the UI thread is blocked waiting for the GLFM
+/// thread, or didn't start the function within the timeout). Once the function has started, this function waits for
+/// it to finish regardless of the timeout, so `userData` may point to the caller's stack.
+///
+/// The UI thread may be blocked waiting for the GLFM thread (for example, in onNativeWindowCreated or onDestroy), so
+/// callers on the GLFM thread should have a fallback when this function returns false.
+static bool glfm__runOnUIThreadSync(GLFMPlatformData *platformData, GLFMUIThreadFunc function, void *userData,
+                                    int timeoutMillis) {
+    if (!platformData || !function) {
         return false;
     }
-    return true;
+    if (ALooper_forThread() == platformData->uiLooper) {
+        function(platformData, userData);
+        return true;
+    }
+
+    // Don't wait for the timeout if the UI thread is known to be blocked. If it blocks after this check, the timeout
+    // applies.
+    pthread_mutex_lock(&platformData->mutex);
+    bool uiThreadWaiting = platformData->uiThreadWaiting;
+    pthread_mutex_unlock(&platformData->mutex);
+    if (uiThreadWaiting) {
+        return false;
+    }
+
+    GLFMUIThreadSync *sync = calloc(1, sizeof(GLFMUIThreadSync));
+    if (!sync) {
+        return false;
+    }
+    pthread_mutex_init(&sync->mutex, NULL);
+    // Use the monotonic clock for the timeout, so it isn't affected by changes to the wall clock
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sync->cond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+    sync->status = GLFMUIThreadSyncStatusPending;
+    sync->refCount = 2;
+    if (!glfm__postUIThreadMessage(platformData, function, userData, sync)) {
+        sync->refCount = 1;
+        glfm__releaseUIThreadSync(sync);
+        return false;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutMillis / 1000;
+    deadline.tv_nsec += (long)(timeoutMillis % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&sync->mutex);
+    while (sync->status == GLFMUIThreadSyncStatusPending || sync->status == GLFMUIThreadSyncStatusRunning) {
+        if (sync->status == GLFMUIThreadSyncStatusRunning) {
+            pthread_cond_wait(&sync->cond, &sync->mutex);
+        } else if (pthread_cond_timedwait(&sync->cond, &sync->mutex, &deadline) == ETIMEDOUT &&
+                   sync->status == GLFMUIThreadSyncStatusPending) {
+            sync->status = GLFMUIThreadSyncStatusCancelled;
+        }
+    }
+    bool done = sync->status == GLFMUIThreadSyncStatusDone;
+    pthread_mutex_unlock(&sync->mutex);
+    glfm__releaseUIThreadSync(sync);
+    return done;
 }
 
 // MARK: - App command callback and input callbacks
@@ -863,6 +1389,11 @@ static void glfm__onAppCmd(GLFMPlatformData *platformData, GLFMActivityCommand c
         }
         case GLFMActivityCommandOnNativeWindowResized: {
             GLFM_LOG_LIFECYCLE("OnNativeWindowResized");
+            platformData->surfaceSizeChanged = true;
+            if (platformData->bufferGeometryScaled) {
+                // The buffer geometry is fixed, and must be updated for the new window size
+                platformData->renderScaleChanged = true;
+            }
             break;
         }
         case GLFMActivityCommandOnNativeWindowDestroyed: {
@@ -902,6 +1433,9 @@ static void glfm__onAppCmd(GLFMPlatformData *platformData, GLFMActivityCommand c
 #endif
 
             platformData->refreshRequested = true;
+            if (platformData->window && platformData->bufferGeometryScaled) {
+                glfm__applyRenderScale(platformData);
+            }
             if (platformData->window) {
                 bool sizedChanged = glfm__updateSurfaceSizeIfNeeded(platformData->display, true);
                 if (!sizedChanged) {
@@ -945,7 +1479,7 @@ static void glfm__onAppCmd(GLFMPlatformData *platformData, GLFMActivityCommand c
 #endif
         case GLFMActivityCommandOnDestroy: {
             GLFM_LOG_LIFECYCLE("OnDestroy");
-            glfm__eglDestroy(platformData);
+            glfm__eglRelease(platformData);
             glfm__setAnimating(platformData, false);
             platformData->destroyRequested = true;
             break;
@@ -983,6 +1517,71 @@ static void glfm__onAppCmd(GLFMPlatformData *platformData, GLFMActivityCommand c
     }
 }
 
+/// Handles all commands sent since the last call. Ordered commands are handled first, in the order they were sent.
+/// Then each pending coalesced command is handled once.
+static void glfm__onAppCmds(GLFMPlatformData *platformData) {
+    static const GLFMActivityCommand coalescedCommands[] = {
+        GLFMActivityCommandOnConfigurationChanged,
+        GLFMActivityCommandOnNativeWindowResized,
+        GLFMActivityCommandOnContentRectChanged,
+        GLFMActivityCommandOnNativeWindowRedrawNeeded,
+        GLFMActivityCommandOnLowMemory,
+    };
+
+    // Reset the eventfd counter first, so that a command sent afterwards wakes the looper again.
+    uint64_t count;
+    if (read(platformData->commandEventFd, &count, sizeof(count)) != sizeof(count) && errno != EAGAIN) {
+        GLFM_LOG("Couldn't read from command eventfd");
+    }
+
+    GLFMOverflowCommand *overflowCommands;
+    do {
+        uint32_t head = atomic_load_explicit(&platformData->orderedCommandsHead, memory_order_relaxed);
+        const uint32_t tail = atomic_load_explicit(&platformData->orderedCommandsTail, memory_order_acquire);
+        while (head != tail && !platformData->destroyRequested) {
+            GLFMActivityCommand command =
+                (GLFMActivityCommand)platformData->orderedCommands[head & (GLFM_MAX_ORDERED_COMMANDS - 1)];
+            head++;
+            atomic_store_explicit(&platformData->orderedCommandsHead, head, memory_order_release);
+            glfm__onAppCmd(platformData, command);
+        }
+        if (platformData->destroyRequested) {
+            break;
+        }
+
+        // The overflow list follows the ring. The UI thread doesn't add to the ring while the list is pending, so
+        // once the ring is empty, the list is next.
+        overflowCommands = NULL;
+        pthread_mutex_lock(&platformData->mutex);
+        if (head == atomic_load_explicit(&platformData->orderedCommandsTail, memory_order_acquire)) {
+            overflowCommands = platformData->overflowCommands;
+            platformData->overflowCommands = NULL;
+            platformData->overflowCommandsTail = NULL;
+            atomic_store_explicit(&platformData->overflowCommandsPending, false, memory_order_release);
+        }
+        pthread_mutex_unlock(&platformData->mutex);
+        for (GLFMOverflowCommand *overflowCommand = overflowCommands; overflowCommand;
+             overflowCommand = overflowCommand->next) {
+            if (platformData->destroyRequested) {
+                break;
+            }
+            glfm__onAppCmd(platformData, overflowCommand->command);
+        }
+        glfm__freeOverflowCommands(overflowCommands);
+        // Commands sent while handling the list are in the ring
+    } while (overflowCommands && !platformData->destroyRequested);
+
+    uint32_t mask = atomic_exchange_explicit(&platformData->pendingCommandMask, 0, memory_order_acquire);
+    for (size_t i = 0; i < sizeof(coalescedCommands) / sizeof(*coalescedCommands); i++) {
+        if (platformData->destroyRequested) {
+            break;
+        }
+        if ((mask & (1u << coalescedCommands[i])) != 0) {
+            glfm__onAppCmd(platformData, coalescedCommands[i]);
+        }
+    }
+}
+
 static void glfm__unicodeToUTF8(uint32_t unicode, char utf8[5]) {
     if (unicode < 0x80) {
         utf8[0] = (char)(unicode & 0x7fu);
@@ -1292,6 +1891,7 @@ static bool glfm__onTouchEvent(GLFMPlatformData *platformData, AInputEvent *even
     const int maxTouches = platformData->multitouchEnabled ? GLFM_MAX_SIMULTANEOUS_TOUCHES : 1;
     const int32_t action = AMotionEvent_getAction(event);
     const uint32_t maskedAction = (uint32_t)action & (uint32_t)AMOTION_EVENT_ACTION_MASK;
+    const double renderScaleFactor = glfm__getRenderScaleFactor(platformData);
 
     GLFMTouchPhase phase;
     bool validAction = true;
@@ -1323,8 +1923,8 @@ static bool glfm__onTouchEvent(GLFMPlatformData *platformData, AInputEvent *even
             for (size_t i = 0; i < count; i++) {
                 const int touchNumber = AMotionEvent_getPointerId(event, i);
                 if (touchNumber >= 0 && touchNumber < maxTouches && display->touchFunc) {
-                    double x = (double)AMotionEvent_getX(event, i);
-                    double y = (double)AMotionEvent_getY(event, i);
+                    double x = renderScaleFactor * (double)AMotionEvent_getX(event, i);
+                    double y = renderScaleFactor * (double)AMotionEvent_getY(event, i);
                     display->touchFunc(display, touchNumber, phase, x, y);
                 }
             }
@@ -1334,8 +1934,8 @@ static bool glfm__onTouchEvent(GLFMPlatformData *platformData, AInputEvent *even
                     (uint32_t)AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT);
             const int touchNumber = AMotionEvent_getPointerId(event, index);
             if (touchNumber >= 0 && touchNumber < maxTouches && display->touchFunc) {
-                double x = (double)AMotionEvent_getX(event, index);
-                double y = (double)AMotionEvent_getY(event, index);
+                double x = renderScaleFactor * (double)AMotionEvent_getX(event, index);
+                double y = renderScaleFactor * (double)AMotionEvent_getY(event, index);
                 display->touchFunc(display, touchNumber, phase, x, y);
             }
         }
@@ -1524,7 +2124,7 @@ static void *glfm__mainLoop(void *param) {
 
     // Init looper
     platformData->looper = ALooper_prepare(ALOOPER_PREPARE_ALLOW_NON_CALLBACKS);
-    ALooper_addFd(platformData->looper, platformData->commandPipeRead,
+    ALooper_addFd(platformData->looper, platformData->commandEventFd,
                   GLFMLooperIDCommand, ALOOPER_EVENT_INPUT, NULL, NULL);
 
     // Init java env
@@ -1548,7 +2148,6 @@ static void *glfm__mainLoop(void *param) {
         platformData->display->platformData = platformData;
         platformData->display->supportedOrientations = GLFMInterfaceOrientationAll;
         platformData->display->swapBehavior = GLFMSwapBehaviorPlatformDefault;
-        platformData->resizeEventWaitFrames = GLFM_RESIZE_EVENT_MAX_WAIT_FRAMES;
         glfmMain(platformData->display);
     }
 
@@ -1594,6 +2193,9 @@ static void *glfm__mainLoop(void *param) {
     pthread_cond_broadcast(&platformData->cond);
     pthread_mutex_unlock(&platformData->mutex);
 
+    // Create the context while the UI thread creates the window
+    glfm__eglSurfacelessInit(platformData);
+
     // Run the main loop
     while (!platformData->destroyRequested) {
         int eventIdentifier;
@@ -1601,13 +2203,7 @@ static void *glfm__mainLoop(void *param) {
         while ((eventIdentifier = ALooper_pollAll(platformData->animating ? 0 : -1,
                                                   NULL, NULL, NULL)) >= 0) {
             if (eventIdentifier == GLFMLooperIDCommand) {
-                uint8_t cmd = 0;
-                if (read(platformData->commandPipeRead, &cmd, sizeof(cmd)) == sizeof(cmd)) {
-                    GLFMActivityCommand command = (GLFMActivityCommand)cmd;
-                    glfm__onAppCmd(platformData, command);
-                } else {
-                    GLFM_LOG("Couldn't read from pipe");
-                }
+                glfm__onAppCmds(platformData);
             } else if (eventIdentifier == GLFMLooperIDInput) {
                 glfm__onInputEvent(platformData);
             } else if (eventIdentifier == GLFMLooperIDSensor) {
@@ -1662,7 +2258,7 @@ static void *glfm__mainLoop(void *param) {
         AConfiguration_delete(platformData->config);
         platformData->config = NULL;
     }
-    glfm__eglDestroy(platformData);
+    glfm__eglRelease(platformData);
     glfm__setAnimating(platformData, false);
     (*jvm)->DetachCurrentThread(jvm);
     platformData->window = NULL;
@@ -2038,30 +2634,42 @@ static float glfm__getRefreshRate(const GLFMDisplay *display) {
     return refreshRate;
 }
 
+/// Checks the surface size after a window event (window created or resized, content rect changed, or render scale
+/// changed), and reports a resize if the size changed. If `force` is false, no queries are made unless a window event
+/// occurred since the last check.
 static bool glfm__updateSurfaceSizeIfNeeded(GLFMDisplay *display, bool force) {
     GLFMPlatformData *platformData = (GLFMPlatformData *)display->platformData;
-    int32_t width = 0;
-    int32_t height = 0;
-    EGLBoolean success = true;
-    success &= eglQuerySurface(platformData->eglDisplay, platformData->eglSurface, EGL_WIDTH, &width);
-    success &= eglQuerySurface(platformData->eglDisplay, platformData->eglSurface, EGL_HEIGHT, &height);
-    if (success && (width != platformData->width || height != platformData->height)) {
-        if (force || platformData->resizeEventWaitFrames <= 0) {
-            GLFM_LOG_LIFECYCLE("Resize: %i x %i", width, height);
-            platformData->resizeEventWaitFrames = GLFM_RESIZE_EVENT_MAX_WAIT_FRAMES;
-            platformData->refreshRequested = true;
-            platformData->width = width;
-            platformData->height = height;
-            if (platformData->display && platformData->display->surfaceResizedFunc) {
-                platformData->display->surfaceResizedFunc(platformData->display, width, height);
-            }
-            glfm__reportOrientationChangeIfNeeded(platformData->display);
-            glfm__reportInsetsChangedIfNeeded(platformData->display);
-            glfm__updateKeyboardVisibility(platformData);
-            return true;
-        }
-        // Prefer to wait until after content rect changed, if possible
-        platformData->resizeEventWaitFrames--;
+    if (!force && !platformData->surfaceSizeChanged) {
+        return false;
+    }
+    platformData->surfaceSizeChanged = false;
+    if (!platformData->window) {
+        return false;
+    }
+    // The window size is the buffer geometry, if set (see glfm__applyRenderScale). The EGL surface uses this size for
+    // the next buffer it dequeues.
+    int32_t width = ANativeWindow_getWidth(platformData->window);
+    int32_t height = ANativeWindow_getHeight(platformData->window);
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    if (width != platformData->width || height != platformData->height) {
+        GLFM_LOG_LIFECYCLE("Resize: %i x %i", width, height);
+        platformData->refreshRequested = true;
+        platformData->width = width;
+        platformData->height = height;
+        platformData->eglSurfaceSwapped = false; // Preserved contents are invalid after a resize
+        if (!platformData->bufferGeometryScaled) {
+            platformData->windowWidth = width;
+            platformData->windowHeight = height;
+        }
+        if (platformData->display && platformData->display->surfaceResizedFunc) {
+            platformData->display->surfaceResizedFunc(platformData->display, width, height);
+        }
+        glfm__reportOrientationChangeIfNeeded(platformData->display);
+        glfm__reportInsetsChangedIfNeeded(platformData->display);
+        glfm__updateKeyboardVisibility(platformData);
+        return true;
     }
     return false;
 }
@@ -2080,15 +2688,15 @@ static void glfm__getDisplayChromeInsets(const GLFMDisplay *display, int *top, i
         // When rotating on some devices (API 16), the dimensions and visible display frame may be out of sync
         // for a moment. Report insets of 0 when this happens.
         if (visibleRect.right - visibleRect.left <= 0 || visibleRect.bottom - visibleRect.top <= 0 ||
-            visibleRect.right > platformData->width || visibleRect.bottom > platformData->height) {
+            visibleRect.right > platformData->windowWidth || visibleRect.bottom > platformData->windowHeight) {
             *top = 0;
             *right = 0;
             *bottom = 0;
             *left = 0;
         } else {
             *top = visibleRect.top;
-            *right = platformData->width - visibleRect.right;
-            *bottom = platformData->height - visibleRect.bottom;
+            *right = platformData->windowWidth - visibleRect.right;
+            *bottom = platformData->windowHeight - visibleRect.bottom;
             *left = visibleRect.left;
         }
     }
@@ -2237,6 +2845,14 @@ static void glfm__sensorFuncUpdated(GLFMDisplay *display) {
     }
 }
 
+/// Gets the JNIEnv for the current thread, which is either the UI thread or the GLFM thread.
+static JNIEnv *glfm__getJNIEnv(GLFMPlatformData *platformData) {
+    if (ALooper_forThread() == platformData->uiLooper) {
+        return platformData->activity->env;
+    }
+    return platformData->jniEnv;
+}
+
 /// Gets an Android system service. The "serviceName" is a field from android.content.Context, like
 /// "INPUT_METHOD_SERVICE" or "VIBRATOR_SERVICE".
 ///
@@ -2245,7 +2861,7 @@ static void glfm__sensorFuncUpdated(GLFMDisplay *display) {
 /// will invoke the java code:
 ///     activity.getSystemService(Context.INPUT_METHOD_SERVICE);
 static jobject glfm__getSystemService(GLFMPlatformData *platformData, const char *serviceName) {
-    JNIEnv *jni = platformData->jniEnv;
+    JNIEnv *jni = glfm__getJNIEnv(platformData);
     jclass contextClass = (*jni)->FindClass(jni, "android/content/Context");
     if (glfm__wasJavaExceptionThrown(jni)) {
         return NULL;
@@ -2268,7 +2884,7 @@ static jobject glfm__getSystemService(GLFMPlatformData *platformData, const char
 static bool glfm__setKeyboardVisible(GLFMPlatformData *platformData, bool visible) {
     static const int InputMethodManager_SHOW_FORCED = 2;
 
-    JNIEnv *jni = platformData->jniEnv;
+    JNIEnv *jni = glfm__getJNIEnv(platformData);
     if ((*jni)->ExceptionCheck(jni)) {
         return false;
     }
@@ -2368,10 +2984,11 @@ static void glfm__updateKeyboardVisibility(GLFMPlatformData *platformData) {
             platformData->keyboardFrame = keyboardFrame;
             platformData->refreshRequested = true;
             if (platformData->display->keyboardVisibilityChangedFunc) {
-                double x = keyboardFrame.left;
-                double y = keyboardFrame.top;
-                double width = keyboardFrame.right - keyboardFrame.left;
-                double height = keyboardFrame.bottom - keyboardFrame.top;
+                const double renderScaleFactor = glfm__getRenderScaleFactor(platformData);
+                double x = renderScaleFactor * keyboardFrame.left;
+                double y = renderScaleFactor * keyboardFrame.top;
+                double width = renderScaleFactor * (keyboardFrame.right - keyboardFrame.left);
+                double height = renderScaleFactor * (keyboardFrame.bottom - keyboardFrame.top);
                 platformData->display->keyboardVisibilityChangedFunc(platformData->display, keyboardVisible,
                                                                      x, y, width, height);
             }
@@ -2379,6 +2996,116 @@ static void glfm__updateKeyboardVisibility(GLFMPlatformData *platformData) {
     }
 }
 
+static int glfm__getPreferredWorkerCount(void) {
+    // On big.LITTLE devices, only use the cores in the faster clusters (the slowest cluster has the lowest max
+    // frequency). If all cores have the same max frequency, or it can't be read, use all cores.
+    long cpuCount = sysconf(_SC_NPROCESSORS_CONF);
+    if (cpuCount <= 1) {
+        return 1;
+    }
+    if (cpuCount > GLFM_MAX_CPUS) {
+        cpuCount = GLFM_MAX_CPUS;
+    }
+    long maxFrequencies[GLFM_MAX_CPUS] = { 0 };
+    long slowestMaxFrequency = 0;
+    for (int cpu = 0; cpu < cpuCount; cpu++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%i/cpufreq/cpuinfo_max_freq", cpu);
+        FILE *file = fopen(path, "r");
+        if (file) {
+            if (fscanf(file, "%ld", &maxFrequencies[cpu]) == 1 && maxFrequencies[cpu] > 0 &&
+                (slowestMaxFrequency == 0 || maxFrequencies[cpu] < slowestMaxFrequency)) {
+                slowestMaxFrequency = maxFrequencies[cpu];
+            }
+            fclose(file);
+        }
+    }
+    int fastCPUCount = 0;
+    for (int cpu = 0; cpu < cpuCount; cpu++) {
+        if (maxFrequencies[cpu] > slowestMaxFrequency) {
+            fastCPUCount++;
+        }
+    }
+    if (fastCPUCount == 0) {
+        fastCPUCount = (int)cpuCount;
+    }
+
+    // Leave one core for the render thread
+    return fastCPUCount > 1 ? fastCPUCount - 1 : 1;
+}
+
+static const char *glfm__getCacheDirectory(GLFMDisplay *display) {
+    GLFMPlatformData *platformData = display->platformData;
+    if (platformData->cacheDirectory[0] != '\0') {
+        return platformData->cacheDirectory;
+    }
+
+    // String path = activity.getCacheDir().getAbsolutePath();
+    JNIEnv *jni = glfm__getJNIEnv(platformData);
+    if ((*jni)->ExceptionCheck(jni)) {
+        return NULL;
+    }
+    jobject cacheDir = glfm__callJavaMethod(jni, platformData->activity->clazz, "getCacheDir", "()Ljava/io/File;",
+                                            Object);
+    if (glfm__wasJavaExceptionThrown(jni) || !cacheDir) {
+        return NULL;
+    }
+    jstring path = glfm__callJavaMethod(jni, cacheDir, "getAbsolutePath", "()Ljava/lang/String;", Object);
+    (*jni)->DeleteLocalRef(jni, cacheDir);
+    if (glfm__wasJavaExceptionThrown(jni) || !path) {
+        return NULL;
+    }
+    const char *pathUTF8 = (*jni)->GetStringUTFChars(jni, path, NULL);
+    if (pathUTF8) {
+        if (strlen(pathUTF8) < sizeof(platformData->cacheDirectory)) {
+            strcpy(platformData->cacheDirectory, pathUTF8);
+        }
+        (*jni)->ReleaseStringUTFChars(jni, path, pathUTF8);
+    }
+    (*jni)->DeleteLocalRef(jni, path);
+    return platformData->cacheDirectory[0] != '\0' ? platformData->cacheDirectory : NULL;
+}
+
+static void glfm__logMessage(const char *message) {
+    (void)message;
+    GLFM_LOG("%s", message);
+}
+
+static bool glfm__mapPlatformAsset(GLFMDisplay *display, const char *path, GLFMAssetMapping *mapping) {
+    static const char empty[1] = { 0 };
+    GLFMPlatformData *platformData = display->platformData;
+    ANativeActivity *activity = platformData ? platformData->activity : NULL;
+    if (!activity || !activity->assetManager) {
+        return false;
+    }
+    // With AASSET_MODE_BUFFER, uncompressed assets are mapped directly from the APK. Compressed assets are
+    // decompressed into memory once.
+    AAsset *asset = AAssetManager_open(activity->assetManager, path, AASSET_MODE_BUFFER);
+    if (!asset) {
+        return false;
+    }
+    off64_t length = AAsset_getLength64(asset);
+    if (length == 0) {
+        AAsset_close(asset);
+        mapping->data = empty;
+        mapping->size = 0;
+        return true;
+    }
+    const void *data = AAsset_getBuffer(asset);
+    if (!data || length < 0) {
+        AAsset_close(asset);
+        return false;
+    }
+    mapping->data = data;
+    mapping->size = (size_t)length;
+    mapping->platformAsset = asset;
+    return true;
+}
+
+static void glfm__releasePlatformAsset(void *platformAsset) {
+    AAsset_close((AAsset *)platformAsset);
+}
+
 // MARK: - GLFM public functions
 
 double glfmGetTime(void) {
@@ -2406,16 +3133,109 @@ double glfmGetTime(void) {
     return (double)(time.tv_sec - initTime) + (double)time.tv_nsec / 1e9;
 }
 
+static void glfm__swapBuffersCompleted(GLFMPlatformData *platformData, EGLBoolean result) {
+    platformData->swapCalled = true;
+    platformData->lastSwapTime = glfmGetTime();
+    if (result) {
+        platformData->eglSurfaceSwapped = true;
+        glfm__eglFrameFenceInsert(platformData->eglDisplay, &platformData->frameFences,
+                                  platformData->display ? platformData->display->maxFramesInFlight : 0);
+    } else {
+        glfm__eglCheckError(platformData);
+    }
+}
+
 void glfmSwapBuffers(GLFMDisplay *display) {
     if (display) {
         GLFMPlatformData *platformData = (GLFMPlatformData *)display->platformData;
         EGLBoolean result = eglSwapBuffers(platformData->eglDisplay, platformData->eglSurface);
-        platformData->swapCalled = true;
-        platformData->lastSwapTime = glfmGetTime();
-        if (!result) {
-            glfm__eglCheckError(platformData);
+        glfm__swapBuffersCompleted(platformData, result);
+    }
+}
+
+void glfmSwapBuffersWithDamage(GLFMDisplay *display, const GLFMRect *rects, int rectCount) {
+    if (!display) {
+        return;
+    }
+    GLFMPlatformData *platformData = (GLFMPlatformData *)display->platformData;
+    if (!platformData->eglSwapBuffersWithDamage || !rects || rectCount <= 0) {
+        glfmSwapBuffers(display);
+        return;
+    }
+
+    // EGL rects are {x, y, width, height} with the origin at the bottom-left, the same as GLFMRect
+    EGLint eglRects[GLFM_MAX_DAMAGE_RECTS * 4];
+    EGLint eglRectCount;
+    if (rectCount <= GLFM_MAX_DAMAGE_RECTS) {
+        for (int i = 0; i < rectCount; i++) {
+            eglRects[i * 4 + 0] = rects[i].x;
+            eglRects[i * 4 + 1] = rects[i].y;
+            eglRects[i * 4 + 2] = rects[i].width;
+            eglRects[i * 4 + 3] = rects[i].height;
         }
+        eglRectCount = rectCount;
+    } else {
+        // Too many rects; use the bounding box
+        int minX = rects[0].x;
+        int minY = rects[0].y;
+        int maxX = rects[0].x + rects[0].width;
+        int maxY = rects[0].y + rects[0].height;
+        for (int i = 1; i < rectCount; i++) {
+            minX = rects[i].x < minX ? rects[i].x : minX;
+            minY = rects[i].y < minY ? rects[i].y : minY;
+            maxX = rects[i].x + rects[i].width > maxX ? rects[i].x + rects[i].width : maxX;
+            maxY = rects[i].y + rects[i].height > maxY ? rects[i].y + rects[i].height : maxY;
+        }
+        eglRects[0] = minX;
+        eglRects[1] = minY;
+        eglRects[2] = maxX - minX;
+        eglRects[3] = maxY - minY;
+        eglRectCount = 1;
+    }
+    EGLBoolean result = platformData->eglSwapBuffersWithDamage(platformData->eglDisplay, platformData->eglSurface,
+                                                               eglRects, eglRectCount);
+    glfm__swapBuffersCompleted(platformData, result);
+}
+
+bool glfmIsSingleBufferActive(const GLFMDisplay *display) {
+    if (!display) {
+        return false;
     }
+    GLFMPlatformData *platformData = (GLFMPlatformData *)display->platformData;
+    if (!platformData->eglSingleBufferSupported || platformData->eglContext == EGL_NO_CONTEXT) {
+        return false;
+    }
+    // With EGL_KHR_mutable_render_buffer, the context reports the buffer actually rendered to, while the surface
+    // reports the requested buffer.
+    EGLint renderBuffer = EGL_BACK_BUFFER;
+    eglQueryContext(platformData->eglDisplay, platformData->eglContext, EGL_RENDER_BUFFER, &renderBuffer);
+    return renderBuffer == EGL_SINGLE_BUFFER;
+}
+
+int glfmGetBufferAge(const GLFMDisplay *display) {
+    if (!display) {
+        return 0;
+    }
+    GLFMPlatformData *platformData = (GLFMPlatformData *)display->platformData;
+    if (platformData->eglSurface == EGL_NO_SURFACE) {
+        return 0;
+    }
+    if (platformData->eglBufferAgeSupported) {
+        EGLint age = 0;
+        if (eglQuerySurface(platformData->eglDisplay, platformData->eglSurface, EGL_BUFFER_AGE_EXT, &age)) {
+            return age;
+        }
+        return 0;
+    }
+
+    // Fallback: With EGL_BUFFER_PRESERVED, the back buffer contains the previous frame
+    EGLint swapBehavior = 0;
+    if (platformData->eglSurfaceSwapped &&
+        eglQuerySurface(platformData->eglDisplay, platformData->eglSurface, EGL_SWAP_BEHAVIOR, &swapBehavior) &&
+        swapBehavior == EGL_BUFFER_PRESERVED) {
+        return 1;
+    }
+    return 0;
 }
 
 void glfmSetSupportedInterfaceOrientation(GLFMDisplay *display, GLFMInterfaceOrientation supportedOrientations) {
@@ -2468,17 +3288,32 @@ void glfmGetDisplaySize(const GLFMDisplay *display, int *width, int *height) {
 
 double glfmGetDisplayScale(const GLFMDisplay *display) {
     GLFMPlatformData *platformData = (GLFMPlatformData *)display->platformData;
-    return platformData->scale;
+    return platformData->scale * glfm__getRenderScaleFactor(platformData);
+}
+
+void glfmSetRenderScale(GLFMDisplay *display, double renderScale) {
+    if (!display || !display->platformData) {
+        return;
+    }
+    GLFMPlatformData *platformData = (GLFMPlatformData *)display->platformData;
+    renderScale = glfm__clampRenderScale(renderScale);
+    // Only apply a change, since applying it resizes the surface
+    const double delta = renderScale - glfmGetRenderScale(display);
+    if (delta > 1e-6 || delta < -1e-6) {
+        display->renderScale = renderScale;
+        platformData->renderScaleChanged = true;
+    }
 }
 
 void glfmGetDisplayChromeInsets(const GLFMDisplay *display, double *top, double *right,
                                 double *bottom, double *left) {
     int intTop, intRight, intBottom, intLeft;
     glfm__getDisplayChromeInsets(display, &intTop, &intRight, &intBottom, &intLeft);
-    if (top) *top = (double)intTop;
-    if (right) *right = (double)intRight;
-    if (bottom) *bottom = (double)intBottom;
-    if (left) *left = (double)intLeft;
+    const double renderScaleFactor = glfm__getRenderScaleFactor(display->platformData);
+    if (top) *top = renderScaleFactor * intTop;
+    if (right) *right = renderScaleFactor * intRight;
+    if (bottom) *bottom = renderScaleFactor * intBottom;
+    if (left) *left = renderScaleFactor * intLeft;
 }
 
 GLFMRenderingAPI glfmGetRenderingAPI(const GLFMDisplay *display) {
@@ -2525,9 +3360,27 @@ bool glfmHasVirtualKeyboard(const GLFMDisplay *display) {
     return true;
 }
 
+typedef struct {
+    bool visible;
+    bool result;
+} GLFMKeyboardVisibilityRequest;
+
+static void glfm__setKeyboardVisibleCallback(GLFMPlatformData *platformData, void *userData) {
+    GLFMKeyboardVisibilityRequest *request = userData;
+    request->result = glfm__setKeyboardVisible(platformData, request->visible);
+}
+
 void glfmSetKeyboardVisible(GLFMDisplay *display, bool visible) {
     GLFMPlatformData *platformData = (GLFMPlatformData *)display->platformData;
-    if (glfm__setKeyboardVisible(platformData, visible)) {
+    GLFMKeyboardVisibilityRequest request = { .visible = visible, .result = false };
+
+    // The InputMethodManager expects calls from the UI thread. If the UI thread is waiting for the GLFM thread (for
+    // example, during glfmMain() or onDestroy) or is busy, call directly.
+    if (!glfm__runOnUIThreadSync(platformData, glfm__setKeyboardVisibleCallback, &request,
+                                 GLFM_UI_THREAD_SYNC_TIMEOUT_MILLIS)) {
+        glfm__setKeyboardVisibleCallback(platformData, &request);
+    }
+    if (request.result) {
         glfm__updateUserInterfaceChrome(platformData);
     }
 }
@@ -2778,6 +3631,156 @@ bool glfmSetClipboardText(GLFMDisplay *display, const char *string) {
     return !glfm__wasJavaExceptionThrown(jni);
 }
 
+bool glfmIsContextPreserved(const GLFMDisplay *display) {
+    if (!display || !display->platformData) {
+        return false;
+    }
+    GLFMPlatformData *platformData = display->platformData;
+    return platformData->contextPreserved;
+}
+
+// MARK: - Shared contexts
+
+struct GLFMSharedContext {
+    EGLDisplay eglDisplay;
+    EGLContext eglContext;
+    EGLSurface eglSurface;
+};
+
+struct GLFMFence {
+    EGLDisplay eglDisplay;
+    EGLSyncKHR eglSync;
+};
+
+GLFMSharedContext *glfmCreateSharedContext(GLFMDisplay *display) {
+    if (!display || !display->platformData) {
+        return NULL;
+    }
+    GLFMPlatformData *platformData = display->platformData;
+    if (platformData->eglDisplay == EGL_NO_DISPLAY || platformData->eglContext == EGL_NO_CONTEXT) {
+        GLFM_LOG("Can't create shared context: No GL context");
+        return NULL;
+    }
+
+    EGLDisplay eglDisplay = platformData->eglDisplay;
+    EGLConfig config = platformData->eglConfig;
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (!glfm__eglHasExtension(eglDisplay, "EGL_KHR_surfaceless_context")) {
+        // The display's config only supports window surfaces. Find a config that supports pbuffers.
+        EGLint renderableType = EGL_OPENGL_ES2_BIT;
+        eglGetConfigAttrib(eglDisplay, platformData->eglConfig, EGL_RENDERABLE_TYPE, &renderableType);
+        const EGLint configAttribList[] = {
+            EGL_RENDERABLE_TYPE, renderableType,
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_NONE, EGL_NONE
+        };
+        EGLint numConfigs = 0;
+        if (!eglChooseConfig(eglDisplay, configAttribList, &config, 1, &numConfigs) || numConfigs == 0) {
+            GLFM_LOG("Can't create shared context: No pbuffer config");
+            return NULL;
+        }
+        const EGLint surfaceAttribList[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE, EGL_NONE };
+        surface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttribList);
+        if (surface == EGL_NO_SURFACE) {
+            GLFM_LOG("Can't create shared context: eglCreatePbufferSurface() failed");
+            return NULL;
+        }
+    }
+
+    EGLint clientVersion = 2;
+    eglQueryContext(eglDisplay, platformData->eglContext, EGL_CONTEXT_CLIENT_VERSION, &clientVersion);
+    const EGLint contextAttribList[] = { EGL_CONTEXT_CLIENT_VERSION, clientVersion, EGL_NONE, EGL_NONE };
+    EGLContext context = eglCreateContext(eglDisplay, config, platformData->eglContext, contextAttribList);
+    if (context == EGL_NO_CONTEXT) {
+        GLFM_LOG("Can't create shared context: eglCreateContext() failed");
+        if (surface != EGL_NO_SURFACE) {
+            eglDestroySurface(eglDisplay, surface);
+        }
+        return NULL;
+    }
+
+    GLFMSharedContext *sharedContext = calloc(1, sizeof(GLFMSharedContext));
+    if (!sharedContext) {
+        eglDestroyContext(eglDisplay, context);
+        if (surface != EGL_NO_SURFACE) {
+            eglDestroySurface(eglDisplay, surface);
+        }
+        return NULL;
+    }
+    sharedContext->eglDisplay = eglDisplay;
+    sharedContext->eglContext = context;
+    sharedContext->eglSurface = surface;
+    return sharedContext;
+}
+
+bool glfmMakeSharedContextCurrent(GLFMSharedContext *sharedContext) {
+    if (!sharedContext) {
+        EGLDisplay eglDisplay = eglGetCurrentDisplay();
+        if (eglDisplay == EGL_NO_DISPLAY) {
+            return true;
+        }
+        return eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+    return eglMakeCurrent(sharedContext->eglDisplay, sharedContext->eglSurface, sharedContext->eglSurface,
+                          sharedContext->eglContext);
+}
+
+void glfmDestroySharedContext(GLFMSharedContext *sharedContext) {
+    if (!sharedContext) {
+        return;
+    }
+    if (eglGetCurrentContext() == sharedContext->eglContext) {
+        eglMakeCurrent(sharedContext->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+    eglDestroyContext(sharedContext->eglDisplay, sharedContext->eglContext);
+    if (sharedContext->eglSurface != EGL_NO_SURFACE) {
+        eglDestroySurface(sharedContext->eglDisplay, sharedContext->eglSurface);
+    }
+    free(sharedContext);
+}
+
+GLFMFence *glfmCreateFence(GLFMDisplay *display) {
+    (void)display;
+    EGLDisplay eglDisplay = eglGetCurrentDisplay();
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        return NULL;
+    }
+    if (!glfm__eglFenceFuncsLoad()) {
+        return NULL;
+    }
+    EGLSyncKHR sync = glfm__eglFenceFuncs.createSync(eglDisplay, EGL_SYNC_FENCE_KHR, NULL);
+    if (sync == EGL_NO_SYNC_KHR) {
+        return NULL;
+    }
+    // Flush so that the fence can be signaled while another thread waits on it.
+    glFlush();
+    GLFMFence *fence = calloc(1, sizeof(GLFMFence));
+    if (!fence) {
+        glfm__eglFenceFuncs.destroySync(eglDisplay, sync);
+        return NULL;
+    }
+    fence->eglDisplay = eglDisplay;
+    fence->eglSync = sync;
+    return fence;
+}
+
+bool glfmWaitFence(GLFMFence *fence, double timeout) {
+    if (!fence) {
+        return false;
+    }
+    EGLTimeKHR eglTimeout = (timeout < 0.0) ? EGL_FOREVER_KHR : (EGLTimeKHR)(timeout * 1000000000.0);
+    EGLint result = glfm__eglFenceFuncs.clientWaitSync(fence->eglDisplay, fence->eglSync, 0, eglTimeout);
+    return result == EGL_CONDITION_SATISFIED_KHR;
+}
+
+void glfmDestroyFence(GLFMFence *fence) {
+    if (!fence) {
+        return;
+    }
+    glfm__eglFenceFuncs.destroySync(fence->eglDisplay, fence->eglSync);
+    free(fence);
+}
+
 // MARK: - Platform-specific functions
 
 bool glfmIsMetalSupported(const GLFMDisplay *display) {
@@ -31,6 +31,7 @@
 #endif
 
 #include <dlfcn.h>
+#include <sys/sysctl.h>
 
 #ifdef NDEBUG
 #  define GLFM_LOG(...) do { } while (0)
@@ -314,6 +315,9 @@ static void glfm__getDrawableSize(double displayWidth, double displayHeight, dou
         [self requestRefresh];
         self.drawableWidth = newDrawableWidth;
         self.drawableHeight = newDrawableHeight;
+        if (self.glfmDisplay->contextReadyFunc) {
+            self.glfmDisplay->contextReadyFunc(self.glfmDisplay);
+        }
         if (self.glfmDisplay->surfaceCreatedFunc) {
             self.glfmDisplay->surfaceCreatedFunc(self.glfmDisplay, self.drawableWidth, self.drawableHeight);
         }
@@ -784,6 +788,9 @@ static void glfm__getDrawableSize(double displayWidth, double displayHeight, dou
     if (!self.surfaceCreatedNotified) {
         self.surfaceCreatedNotified = YES;
         [self requestRefresh];
+        if (self.glfmDisplay->contextReadyFunc) {
+            self.glfmDisplay->contextReadyFunc(self.glfmDisplay);
+        }
         if (self.glfmDisplay->surfaceCreatedFunc) {
             self.glfmDisplay->surfaceCreatedFunc(self.glfmDisplay, self.drawableWidth, self.drawableHeight);
         }
@@ -1074,6 +1081,9 @@ static void glfm__getDrawableSize(double displayWidth, double displayHeight, dou
         [self requestRefresh];
         self.drawableWidth = newDrawableWidth;
         self.drawableHeight = newDrawableHeight;
+        if (self.glfmDisplay->contextReadyFunc) {
+            self.glfmDisplay->contextReadyFunc(self.glfmDisplay);
+        }
         if (self.glfmDisplay->surfaceCreatedFunc) {
             self.glfmDisplay->surfaceCreatedFunc(self.glfmDisplay, self.drawableWidth, self.drawableHeight);
         }
@@ -1315,6 +1325,8 @@ static void glfm__getDrawableSize(double displayWidth, double displayHeight, dou
     if (self.glfmViewIfLoaded.surfaceCreatedNotified && self.glfmDisplay->surfaceDestroyedFunc) {
         self.glfmDisplay->surfaceDestroyedFunc(self.glfmDisplay);
     }
+    glfm__jobPoolDestroy(self.glfmDisplay);
+    glfm__assetLoaderDestroy(self.glfmDisplay);
     free(self.glfmDisplay);
     self.glfmViewIfLoaded.preRenderCallback = nil;
 #if TARGET_OS_IOS
@@ -1425,6 +1437,8 @@ static void glfm__getDrawableSize(double displayWidth, double displayHeight, dou
 #if TARGET_OS_IOS
     [self handleMotionEvents];
 #endif
+    glfm__jobPoolDrainCompletions(self.glfmDisplay);
+    glfm__assetLoaderUpdate(self.glfmDisplay);
 }
 
 - (void)viewDidLoad {
@@ -3102,6 +3116,58 @@ static void glfm__sensorFuncUpdated(GLFMDisplay *display) {
 #endif
 }
 
+static int glfm__getPreferredWorkerCount(void) {
+    // On Apple silicon, only count the performance cores (perflevel0). Leave one core for the render thread.
+    int coreCount = 0;
+    size_t size = sizeof(coreCount);
+    if (sysctlbyname("hw.perflevel0.logicalcpu", &coreCount, &size, NULL, 0) != 0 || coreCount <= 0) {
+        coreCount = (int)NSProcessInfo.processInfo.activeProcessorCount;
+    }
+    return coreCount > 1 ? coreCount - 1 : 1;
+}
+
+static const char *glfm__getCacheDirectory(GLFMDisplay *display) {
+    (void)display;
+    static char cacheDirectory[GLFM_MAX_PATH];
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        NSArray<NSString *> *paths = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
+        NSString *path = paths.firstObject;
+        if (path && ![path getFileSystemRepresentation:cacheDirectory maxLength:sizeof(cacheDirectory)]) {
+            cacheDirectory[0] = '\0';
+        }
+    });
+    return cacheDirectory[0] != '\0' ? cacheDirectory : NULL;
+}
+
+static void glfm__logMessage(const char *message) {
+    (void)message;
+    GLFM_LOG("%s", message);
+}
+
+static bool glfm__mapPlatformAsset(GLFMDisplay *display, const char *path, GLFMAssetMapping *mapping) {
+    (void)display;
+    static char resourceDirectory[GLFM_MAX_PATH];
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        NSString *resourcePath = [NSBundle mainBundle].resourcePath;
+        if (!resourcePath || ![resourcePath getFileSystemRepresentation:resourceDirectory
+                                                              maxLength:sizeof(resourceDirectory)]) {
+            resourceDirectory[0] = '\0';
+        }
+    });
+    if (resourceDirectory[0] == '\0') {
+        return false;
+    }
+    char fullPath[GLFM_MAX_PATH];
+    int length = snprintf(fullPath, sizeof(fullPath), "%s/%s", resourceDirectory, path);
+    return length > 0 && (size_t)length < sizeof(fullPath) && glfm__mapFile(fullPath, mapping);
+}
+
+static void glfm__releasePlatformAsset(void *platformAsset) {
+    (void)platformAsset;
+}
+
 // MARK: - GLFM public functions
 
 double glfmGetTime(void) {
@@ -3123,6 +3189,23 @@ void glfmSwapBuffers(GLFMDisplay *display) {
     }
 }
 
+void glfmSwapBuffersWithDamage(GLFMDisplay *display, const GLFMRect *rects, int rectCount) {
+    // Partial presentation is not supported
+    (void)rects;
+    (void)rectCount;
+    glfmSwapBuffers(display);
+}
+
+int glfmGetBufferAge(const GLFMDisplay *display) {
+    (void)display;
+    return 0;
+}
+
+bool glfmIsSingleBufferActive(const GLFMDisplay *display) {
+    (void)display;
+    return false;
+}
+
 void glfmSetSupportedInterfaceOrientation(GLFMDisplay *display, GLFMInterfaceOrientation supportedOrientations) {
     if (display) {
         if (display->supportedOrientations != supportedOrientations) {
@@ -3197,6 +3280,12 @@ double glfmGetDisplayScale(const GLFMDisplay *display) {
 #endif
 }
 
+void glfmSetRenderScale(GLFMDisplay *display, double renderScale) {
+    // Not supported. The render scale is always 1.0.
+    (void)display;
+    (void)renderScale;
+}
+
 void glfmGetDisplayChromeInsets(const GLFMDisplay *display, double *top, double *right,
                                 double *bottom, double *left) {
     if (display && display->platformData) {
@@ -3538,6 +3627,148 @@ bool glfmSetClipboardText(GLFMDisplay *display, const char *string) {
 
 #endif // !TARGET_OS_TV
 
+bool glfmIsContextPreserved(const GLFMDisplay *display) {
+    (void)display;
+    return false;
+}
+
+// MARK: - Shared contexts
+
+struct GLFMSharedContext {
+    void *context; // Retained EAGLContext (iOS, tvOS) or NSOpenGLContext (macOS)
+};
+
+struct GLFMFence {
+    GLsync sync;
+};
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+
+GLFMSharedContext *glfmCreateSharedContext(GLFMDisplay *display) {
+    if (!display || !display->platformData) {
+        return NULL;
+    }
+    GLFMViewController *viewController = (__bridge GLFMViewController *)display->platformData;
+    UIView<GLFMView> *view = viewController.glfmViewIfLoaded;
+#if TARGET_OS_IOS || TARGET_OS_TV
+    if (![view isKindOfClass:[GLFMOpenGLESView class]]) {
+        return NULL;
+    }
+    EAGLContext *mainContext = ((GLFMOpenGLESView *)view).context;
+    EAGLContext *context = GLFM_AUTORELEASE([[EAGLContext alloc] initWithAPI:mainContext.API
+                                                                  sharegroup:mainContext.sharegroup]);
+#else
+    if (![view isKindOfClass:[GLFMOpenGLView class]]) {
+        return NULL;
+    }
+    GLFMOpenGLView *openGLView = (GLFMOpenGLView *)view;
+    NSOpenGLContext *context = GLFM_AUTORELEASE([[NSOpenGLContext alloc] initWithFormat:openGLView.pixelFormat
+                                                                           shareContext:openGLView.openGLContext]);
+#endif
+    if (!context) {
+        GLFM_LOG("Couldn't create shared context");
+        return NULL;
+    }
+    GLFMSharedContext *sharedContext = calloc(1, sizeof(GLFMSharedContext));
+    if (!sharedContext) {
+        return NULL;
+    }
+    sharedContext->context = (void *)CFBridgingRetain(context);
+    return sharedContext;
+}
+
+bool glfmMakeSharedContextCurrent(GLFMSharedContext *sharedContext) {
+#if TARGET_OS_IOS || TARGET_OS_TV
+    EAGLContext *context = sharedContext ? (__bridge EAGLContext *)sharedContext->context : nil;
+    return [EAGLContext setCurrentContext:context] == YES;
+#else
+    if (sharedContext) {
+        [(__bridge NSOpenGLContext *)sharedContext->context makeCurrentContext];
+    } else {
+        [NSOpenGLContext clearCurrentContext];
+    }
+    return true;
+#endif
+}
+
+void glfmDestroySharedContext(GLFMSharedContext *sharedContext) {
+    if (!sharedContext) {
+        return;
+    }
+#if TARGET_OS_IOS || TARGET_OS_TV
+    if ([EAGLContext currentContext] == (__bridge EAGLContext *)sharedContext->context) {
+        [EAGLContext setCurrentContext:nil];
+    }
+#else
+    if ([NSOpenGLContext currentContext] == (__bridge NSOpenGLContext *)sharedContext->context) {
+        [NSOpenGLContext clearCurrentContext];
+    }
+#endif
+    CFRelease(sharedContext->context);
+    free(sharedContext);
+}
+
+GLFMFence *glfmCreateFence(GLFMDisplay *display) {
+    (void)display;
+#if TARGET_OS_IOS || TARGET_OS_TV
+    if (![EAGLContext currentContext]) {
+        return NULL;
+    }
+    GLsync sync = glFenceSyncAPPLE(GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE, 0);
+#else
+    if (![NSOpenGLContext currentContext]) {
+        return NULL;
+    }
+    GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+    if (!sync) {
+        return NULL;
+    }
+    // Flush so that the fence can be signaled while another context waits on it.
+    glFlush();
+    GLFMFence *fence = calloc(1, sizeof(GLFMFence));
+    if (!fence) {
+#if TARGET_OS_IOS || TARGET_OS_TV
+        glDeleteSyncAPPLE(sync);
+#else
+        glDeleteSync(sync);
+#endif
+        return NULL;
+    }
+    fence->sync = sync;
+    return fence;
+}
+
+bool glfmWaitFence(GLFMFence *fence, double timeout) {
+    if (!fence) {
+        return false;
+    }
+#if TARGET_OS_IOS || TARGET_OS_TV
+    GLuint64 glTimeout = (timeout < 0.0) ? GL_TIMEOUT_IGNORED_APPLE : (GLuint64)(timeout * 1000000000.0);
+    GLenum result = glClientWaitSyncAPPLE(fence->sync, 0, glTimeout);
+    return result == GL_ALREADY_SIGNALED_APPLE || result == GL_CONDITION_SATISFIED_APPLE;
+#else
+    GLuint64 glTimeout = (timeout < 0.0) ? GL_TIMEOUT_IGNORED : (GLuint64)(timeout * 1000000000.0);
+    GLenum result = glClientWaitSync(fence->sync, 0, glTimeout);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+#endif
+}
+
+void glfmDestroyFence(GLFMFence *fence) {
+    if (!fence) {
+        return;
+    }
+#if TARGET_OS_IOS || TARGET_OS_TV
+    glDeleteSyncAPPLE(fence->sync);
+#else
+    glDeleteSync(fence->sync);
+#endif
+    free(fence);
+}
+
+#pragma clang diagnostic pop
+
 // MARK: - Apple-specific functions
 
 bool glfmIsMetalSupported(const GLFMDisplay *display) {
@@ -0,0 +1,274 @@
+// GLFM
+// https://github.com/brackeen/glfm
+
+#ifndef GLFM_EGL_H
+#define GLFM_EGL_H
+
+// EGL functions used by the Android backend. They only depend on EGL, not on Android or the rest of GLFM, so they can
+// be tested on a host with a headless EGL implementation (see tests/host).
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static bool glfm__eglHasExtension(EGLDisplay eglDisplay, const char *extension) {
+    const char *extensions = eglQueryString(eglDisplay, EGL_EXTENSIONS);
+    if (!extensions) {
+        return false;
+    }
+    size_t length = strlen(extension);
+    const char *start = extensions;
+    const char *match;
+    while ((match = strstr(start, extension)) != NULL) {
+        const char *end = match + length;
+        if ((match == extensions || match[-1] == ' ') && (*end == ' ' || *end == '\0')) {
+            return true;
+        }
+        start = end;
+    }
+    return false;
+}
+
+// MARK: - Config scoring
+
+typedef struct {
+    EGLint red, green, blue, alpha;
+    EGLint depth, stencil, samples;
+    EGLint surfaceType; // Required EGL_SURFACE_TYPE bits (not scored)
+    EGLint caveat; // EGL_CONFIG_CAVEAT of an actual config (not requested)
+} GLFMEGLConfigAttribs;
+
+static void glfm__eglGetConfigAttribs(EGLDisplay eglDisplay, EGLConfig config, GLFMEGLConfigAttribs *attribs) {
+    memset(attribs, 0, sizeof(*attribs));
+    attribs->caveat = EGL_NONE;
+    eglGetConfigAttrib(eglDisplay, config, EGL_RED_SIZE, &attribs->red);
+    eglGetConfigAttrib(eglDisplay, config, EGL_GREEN_SIZE, &attribs->green);
+    eglGetConfigAttrib(eglDisplay, config, EGL_BLUE_SIZE, &attribs->blue);
+    eglGetConfigAttrib(eglDisplay, config, EGL_ALPHA_SIZE, &attribs->alpha);
+    eglGetConfigAttrib(eglDisplay, config, EGL_DEPTH_SIZE, &attribs->depth);
+    eglGetConfigAttrib(eglDisplay, config, EGL_STENCIL_SIZE, &attribs->stencil);
+    eglGetConfigAttrib(eglDisplay, config, EGL_SAMPLES, &attribs->samples);
+    eglGetConfigAttrib(eglDisplay, config, EGL_SURFACE_TYPE, &attribs->surfaceType);
+    eglGetConfigAttrib(eglDisplay, config, EGL_CONFIG_CAVEAT, &attribs->caveat);
+}
+
+static int glfm__eglAttribPenalty(EGLint requested, EGLint actual, int missingPenalty, int extraPenalty) {
+    if (actual < requested) {
+        return (requested - actual) * missingPenalty;
+    } else {
+        return (actual - requested) * extraPenalty;
+    }
+}
+
+/// Returns a score for how well a config's attributes match the requested attributes. Lower is better.
+///
+/// Missing color or stencil bits are heavily penalized. Missing depth bits and samples are allowed, as a fallback.
+/// Extra bits are penalized for the extra memory bandwidth (for example, 10-bit color or a 32-bit depth buffer
+/// when 24-bit was requested).
+static int glfm__eglScoreAttribs(const GLFMEGLConfigAttribs *requested, const GLFMEGLConfigAttribs *actual) {
+    int score = 0;
+    score += glfm__eglAttribPenalty(requested->red, actual->red, 1000, 8);
+    score += glfm__eglAttribPenalty(requested->green, actual->green, 1000, 8);
+    score += glfm__eglAttribPenalty(requested->blue, actual->blue, 1000, 8);
+    score += glfm__eglAttribPenalty(requested->alpha, actual->alpha, 1000, 4);
+    score += glfm__eglAttribPenalty(requested->depth, actual->depth, 100, 4);
+    score += glfm__eglAttribPenalty(requested->stencil, actual->stencil, 1000, 4);
+    score += glfm__eglAttribPenalty(requested->samples, actual->samples, 50, 100);
+    if (actual->caveat == EGL_SLOW_CONFIG) {
+        score += 100000;
+    } else if (actual->caveat == EGL_NON_CONFORMANT_CONFIG) {
+        score += 10000;
+    }
+    return score;
+}
+
+static int glfm__eglScoreConfig(EGLDisplay eglDisplay, EGLConfig config, const GLFMEGLConfigAttribs *requested) {
+    GLFMEGLConfigAttribs actual;
+    glfm__eglGetConfigAttribs(eglDisplay, config, &actual);
+    return glfm__eglScoreAttribs(requested, &actual);
+}
+
+/// Scores all configs that support OpenGL ES 2 or newer and the requested surface type (usually `EGL_WINDOW_BIT`), and
+/// chooses the one with the lowest score.
+static bool glfm__eglChooseBestConfig(EGLDisplay eglDisplay, const GLFMEGLConfigAttribs *requested,
+                                      EGLConfig *outConfig) {
+    const EGLint attribList[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+        EGL_SURFACE_TYPE, requested->surfaceType,
+        EGL_NONE, EGL_NONE
+    };
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(eglDisplay, attribList, NULL, 0, &numConfigs) || numConfigs <= 0) {
+        return false;
+    }
+    EGLConfig *configs = malloc(sizeof(EGLConfig) * (size_t)numConfigs);
+    if (!configs) {
+        return false;
+    }
+    bool found = false;
+    if (eglChooseConfig(eglDisplay, attribList, configs, numConfigs, &numConfigs)) {
+        int bestScore = INT_MAX;
+        for (EGLint i = 0; i < numConfigs; i++) {
+            int score = glfm__eglScoreConfig(eglDisplay, configs[i], requested);
+            if (score < bestScore) {
+                // Ties keep the earlier config, since EGL sorts configs by preference.
+                bestScore = score;
+                *outConfig = configs[i];
+                found = true;
+            }
+        }
+    }
+    free(configs);
+    return found;
+}
+
+// MARK: - Config cache
+
+/// Loads the config ID chosen on a previous launch, so that the configs don't need to be scored again. Returns `false`
+/// if the file doesn't exist, its key doesn't match, or the config no longer supports OpenGL ES 2 and the required
+/// surface type.
+static bool glfm__eglLoadCachedConfig(EGLDisplay eglDisplay, const char *path, uint64_t key,
+                                      EGLint requiredSurfaceType, EGLConfig *outConfig) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    unsigned long long cachedKey = 0;
+    EGLint configID = 0;
+    bool valid = fscanf(file, "%llx %i", &cachedKey, &configID) == 2 && cachedKey == key;
+    fclose(file);
+    if (!valid) {
+        return false;
+    }
+
+    const EGLint attribList[] = { EGL_CONFIG_ID, configID, EGL_NONE, EGL_NONE };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(eglDisplay, attribList, &config, 1, &numConfigs) || numConfigs != 1) {
+        return false;
+    }
+    EGLint renderableType = 0;
+    EGLint surfaceType = 0;
+    eglGetConfigAttrib(eglDisplay, config, EGL_RENDERABLE_TYPE, &renderableType);
+    eglGetConfigAttrib(eglDisplay, config, EGL_SURFACE_TYPE, &surfaceType);
+    if ((renderableType & EGL_OPENGL_ES2_BIT) == 0 || (surfaceType & requiredSurfaceType) != requiredSurfaceType) {
+        return false;
+    }
+    *outConfig = config;
+    return true;
+}
+
+static bool glfm__eglStoreCachedConfig(EGLDisplay eglDisplay, const char *path, uint64_t key, EGLConfig config) {
+    EGLint configID = 0;
+    if (!eglGetConfigAttrib(eglDisplay, config, EGL_CONFIG_ID, &configID)) {
+        return false;
+    }
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    bool success = fprintf(file, "%016llx %i\n", (unsigned long long)key, configID) > 0;
+    return (fclose(file) == 0) && success;
+}
+
+// MARK: - Fences
+
+/// The maximum number of frame fences. At least `GLFM_MAX_FRAMES_IN_FLIGHT`.
+#define GLFM_EGL_MAX_FRAME_FENCES 4
+
+static struct {
+    pthread_once_t once;
+    PFNEGLCREATESYNCKHRPROC createSync;
+    PFNEGLCLIENTWAITSYNCKHRPROC clientWaitSync;
+    PFNEGLDESTROYSYNCKHRPROC destroySync;
+} glfm__eglFenceFuncs = { .once = PTHREAD_ONCE_INIT };
+
+/// Loads the `EGL_KHR_fence_sync` functions, if supported. `eglGetProcAddress` may return non-NULL stubs for
+/// unsupported extensions, so the extension is checked first. Android has one EGL display, and it is initialized
+/// before the first fence is created.
+static void glfm__eglFenceFuncsInit(void) {
+    if (!glfm__eglHasExtension(eglGetDisplay(EGL_DEFAULT_DISPLAY), "EGL_KHR_fence_sync")) {
+        return;
+    }
+    glfm__eglFenceFuncs.createSync = (PFNEGLCREATESYNCKHRPROC)eglGetProcAddress("eglCreateSyncKHR");
+    glfm__eglFenceFuncs.clientWaitSync = (PFNEGLCLIENTWAITSYNCKHRPROC)eglGetProcAddress("eglClientWaitSyncKHR");
+    glfm__eglFenceFuncs.destroySync = (PFNEGLDESTROYSYNCKHRPROC)eglGetProcAddress("eglDestroySyncKHR");
+}
+
+/// Loads the fence functions on first use. Returns `false` if fences are not supported.
+static bool glfm__eglFenceFuncsLoad(void) {
+    pthread_once(&glfm__eglFenceFuncs.once, glfm__eglFenceFuncsInit);
+    return glfm__eglFenceFuncs.createSync && glfm__eglFenceFuncs.clientWaitSync && glfm__eglFenceFuncs.destroySync;
+}
+
+/// Fences inserted after each swap, oldest first (ring buffer). Used to limit the number of frames in flight.
+typedef struct {
+    EGLSyncKHR fences[GLFM_EGL_MAX_FRAME_FENCES];
+    int head;
+    int count;
+} GLFMEGLFrameFences;
+
+static void glfm__eglFrameFencesDestroy(EGLDisplay eglDisplay, GLFMEGLFrameFences *frameFences) {
+    for (int i = 0; i < frameFences->count; i++) {
+        int index = (frameFences->head + i) % GLFM_EGL_MAX_FRAME_FENCES;
+        glfm__eglFenceFuncs.destroySync(eglDisplay, frameFences->fences[index]);
+    }
+    frameFences->head = 0;
+    frameFences->count = 0;
+}
+
+/// Inserts a fence after a swap, if the number of frames in flight is limited (`maxFramesInFlight` > 0).
+static void glfm__eglFrameFenceInsert(EGLDisplay eglDisplay, GLFMEGLFrameFences *frameFences,
+                                      int maxFramesInFlight) {
+    if (maxFramesInFlight <= 0 || frameFences->count >= GLFM_EGL_MAX_FRAME_FENCES || !glfm__eglFenceFuncsLoad()) {
+        return;
+    }
+    EGLSyncKHR sync = glfm__eglFenceFuncs.createSync(eglDisplay, EGL_SYNC_FENCE_KHR, NULL);
+    if (sync != EGL_NO_SYNC_KHR) {
+        int index = (frameFences->head + frameFences->count) % GLFM_EGL_MAX_FRAME_FENCES;
+        frameFences->fences[index] = sync;
+        frameFences->count++;
+    }
+}
+
+/// Waits until fewer than `maxFramesInFlight` frames are queued on the GPU. Called before the render function.
+/// Returns `true` if the GPU hadn't finished the oldest frame, and this function blocked.
+static bool glfm__eglFrameFenceWait(EGLDisplay eglDisplay, GLFMEGLFrameFences *frameFences, int maxFramesInFlight) {
+    if (frameFences->count == 0) {
+        return false;
+    }
+    if (maxFramesInFlight <= 0) {
+        // Limit was removed
+        glfm__eglFrameFencesDestroy(eglDisplay, frameFences);
+        return false;
+    }
+    bool waited = false;
+    while (frameFences->count >= maxFramesInFlight) {
+        EGLSyncKHR sync = frameFences->fences[frameFences->head];
+        EGLint result = glfm__eglFenceFuncs.clientWaitSync(eglDisplay, sync, 0, 0);
+        if (result == EGL_TIMEOUT_EXPIRED_KHR) {
+            waited = true;
+            glfm__eglFenceFuncs.clientWaitSync(eglDisplay, sync, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, EGL_FOREVER_KHR);
+        }
+        glfm__eglFenceFuncs.destroySync(eglDisplay, sync);
+        frameFences->head = (frameFences->head + 1) % GLFM_EGL_MAX_FRAME_FENCES;
+        frameFences->count--;
+    }
+    return waited;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,6 +8,9 @@
 #include <EGL/egl.h>
 #include <emscripten/emscripten.h>
 #include <emscripten/html5.h>
+#if defined(__EMSCRIPTEN_PTHREADS__)
+#include <emscripten/threading.h>
+#endif
 #include <math.h>
 #include <stdlib.h>
 #include <sys/time.h>
@@ -52,6 +55,7 @@ typedef struct {
     bool isVisible;
     bool isFocused;
     bool refreshRequested;
+    bool singleBufferActive;
 
     GLFMInterfaceOrientation orientation;
 } GLFMPlatformData;
@@ -117,6 +121,39 @@ void glfm__requestClipboardTextCallback(GLFMDisplay *display,
     }
 }
 
+static int glfm__getPreferredWorkerCount(void) {
+#if defined(__EMSCRIPTEN_PTHREADS__)
+    // Leave one core for the main thread
+    int coreCount = emscripten_num_logical_cores();
+    return coreCount > 1 ? coreCount - 1 : 1;
+#else
+    return 0;
+#endif
+}
+
+static const char *glfm__getCacheDirectory(GLFMDisplay *display) {
+    (void)display;
+    return NULL;
+}
+
+static void glfm__logMessage(const char *message) {
+    (void)message;
+    GLFM_LOG("%s", message);
+}
+
+static bool glfm__mapPlatformAsset(GLFMDisplay *display, const char *path, GLFMAssetMapping *mapping) {
+    (void)display;
+    // Preloaded files are in the root directory of the in-memory file system. File contents are stored outside of
+    // the WebAssembly heap, so mmap copies the file into the heap once.
+    char fullPath[GLFM_MAX_PATH];
+    int length = snprintf(fullPath, sizeof(fullPath), "/%s", path);
+    return length > 0 && (size_t)length < sizeof(fullPath) && glfm__mapFile(fullPath, mapping);
+}
+
+static void glfm__releasePlatformAsset(void *platformAsset) {
+    (void)platformAsset;
+}
+
 // MARK: - GLFM public functions
 
 double glfmGetTime(void) {
@@ -128,6 +165,24 @@ void glfmSwapBuffers(GLFMDisplay *display) {
     // Do nothing; swap is implicit
 }
 
+void glfmSwapBuffersWithDamage(GLFMDisplay *display, const GLFMRect *rects, int rectCount) {
+    (void)display;
+    (void)rects;
+    (void)rectCount;
+    // Do nothing; swap is implicit. WebGL always presents the entire canvas.
+}
+
+int glfmGetBufferAge(const GLFMDisplay *display) {
+    (void)display;
+    // Not tracked. The drawing buffer is only preserved in single buffer mode.
+    return 0;
+}
+
+bool glfmIsSingleBufferActive(const GLFMDisplay *display) {
+    GLFMPlatformData *platformData = display ? display->platformData : NULL;
+    return platformData ? platformData->singleBufferActive : false;
+}
+
 void glfmSetSupportedInterfaceOrientation(GLFMDisplay *display, GLFMInterfaceOrientation supportedOrientations) {
     if (display->supportedOrientations != supportedOrientations) {
         display->supportedOrientations = supportedOrientations;
@@ -185,6 +240,13 @@ double glfmGetDisplayScale(const GLFMDisplay *display) {
     return platformData->scale;
 }
 
+void glfmSetRenderScale(GLFMDisplay *display, double renderScale) {
+    if (display) {
+        // Applied in glfm__mainLoopFunc, before the next frame
+        display->renderScale = glfm__clampRenderScale(renderScale);
+    }
+}
+
 void glfmGetDisplayChromeInsets(const GLFMDisplay *display, double *top, double *right, double *bottom, double *left) {
     GLFMPlatformData *platformData = display->platformData;
     if (top) {
@@ -382,6 +444,42 @@ bool glfmSetClipboardText(GLFMDisplay *display, const char *string) {
     return result == 1;
 }
 
+bool glfmIsContextPreserved(const GLFMDisplay *display) {
+    (void)display;
+    return false;
+}
+
+// MARK: - Shared contexts
+
+GLFMSharedContext *glfmCreateSharedContext(GLFMDisplay *display) {
+    (void)display;
+    return NULL;
+}
+
+bool glfmMakeSharedContextCurrent(GLFMSharedContext *sharedContext) {
+    (void)sharedContext;
+    return false;
+}
+
+void glfmDestroySharedContext(GLFMSharedContext *sharedContext) {
+    (void)sharedContext;
+}
+
+GLFMFence *glfmCreateFence(GLFMDisplay *display) {
+    (void)display;
+    return NULL;
+}
+
+bool glfmWaitFence(GLFMFence *fence, double timeout) {
+    (void)fence;
+    (void)timeout;
+    return false;
+}
+
+void glfmDestroyFence(GLFMFence *fence) {
+    (void)fence;
+}
+
 // MARK: - Platform-specific functions
 
 bool glfmIsMetalSupported(const GLFMDisplay *display) {
@@ -429,12 +527,19 @@ static void glfm__mainLoopFunc(void *userData) {
     if (display) {
         GLFMPlatformData *platformData = display->platformData;
 
-        // Check if canvas size has changed
-        int displayChanged = EM_ASM_INT_V({
+        // Auto render scale
+        if (display->renderScaleController.enabled) {
+            // The display's refresh rate is not available to the web. Assume 60Hz.
+            glfm__updateAutoRenderScale(display, 1.0 / 60.0);
+        }
+
+        // Check if canvas size (or render scale) has changed
+        const double renderScale = glfmGetRenderScale(display);
+        int displayChanged = EM_ASM_INT({
             var canvas = Module['canvas'];
-            var devicePixelRatio = window.devicePixelRatio || 1;
-            var width = canvas.clientWidth * devicePixelRatio;
-            var height = canvas.clientHeight * devicePixelRatio;
+            var devicePixelRatio = (window.devicePixelRatio || 1) * $0;
+            var width = Math.max(1, Math.round(canvas.clientWidth * devicePixelRatio));
+            var height = Math.max(1, Math.round(canvas.clientHeight * devicePixelRatio));
             if (width != canvas.width || height != canvas.height) {
                 canvas.width = width;
                 canvas.height = height;
@@ -442,17 +547,21 @@ static void glfm__mainLoopFunc(void *userData) {
             } else {
                 return 0;
             }
-        });
+        }, renderScale);
         if (displayChanged) {
             platformData->refreshRequested = true;
             platformData->width = glfm__getDisplayWidth(display);
             platformData->height = glfm__getDisplayHeight(display);
-            platformData->scale = emscripten_get_device_pixel_ratio();
+            platformData->scale = emscripten_get_device_pixel_ratio() * renderScale;
             if (display->surfaceResizedFunc) {
                 display->surfaceResizedFunc(display, platformData->width, platformData->height);
             }
         }
 
+        // Finished jobs and asset loads
+        glfm__jobPoolDrainCompletions(display);
+        glfm__assetLoaderUpdate(display);
+
         // Tick
         if (platformData->refreshRequested) {
             platformData->refreshRequested = false;
@@ -461,7 +570,11 @@ static void glfm__mainLoopFunc(void *userData) {
             }
         }
         if (display->renderFunc) {
+            glfm__debugBeginFrame(display);
+            glfm__gpuTimerBeginFrame(display);
             display->renderFunc(display);
+            glfm__gpuTimerEndFrame(display);
+            glfm__debugEndFrame(display);
         }
     }
 }
@@ -473,11 +586,16 @@ static EM_BOOL glfm__webGLContextCallback(int eventType, const void *reserved, v
     platformData->refreshRequested = true;
     switch (eventType) {
         case EMSCRIPTEN_EVENT_WEBGLCONTEXTLOST:
+            glfm__gpuTimerReset(display);
+            glfm__debugReset(display);
             if (display->surfaceDestroyedFunc) {
                 display->surfaceDestroyedFunc(display);
             }
             return 1;
         case EMSCRIPTEN_EVENT_WEBGLCONTEXTRESTORED:
+            if (display->contextReadyFunc) {
+                display->contextReadyFunc(display);
+            }
             if (display->surfaceCreatedFunc) {
                 display->surfaceCreatedFunc(display, platformData->width, platformData->height);
             }
@@ -887,15 +1005,16 @@ int main(void) {
     glfmMain(glfmDisplay);
 
     // Init resizable canvas
+    const double renderScale = glfmGetRenderScale(glfmDisplay);
     EM_ASM({
         var canvas = Module['canvas'];
-        var devicePixelRatio = window.devicePixelRatio || 1;
-        canvas.width = canvas.clientWidth * devicePixelRatio;
-        canvas.height = canvas.clientHeight * devicePixelRatio;
-    });
+        var devicePixelRatio = (window.devicePixelRatio || 1) * $0;
+        canvas.width = Math.max(1, Math.round(canvas.clientWidth * devicePixelRatio));
+        canvas.height = Math.max(1, Math.round(canvas.clientHeight * devicePixelRatio));
+    }, renderScale);
     platformData->width = glfm__getDisplayWidth(glfmDisplay);
     platformData->height = glfm__getDisplayHeight(glfmDisplay);
-    platformData->scale = emscripten_get_device_pixel_ratio();
+    platformData->scale = emscripten_get_device_pixel_ratio() * renderScale;
 
     // Create WebGL context
     EmscriptenWebGLContextAttributes attribs;
@@ -905,11 +1024,27 @@ int main(void) {
     attribs.stencil = glfmDisplay->stencilFormat != GLFMStencilFormatNone;
     attribs.antialias = glfmDisplay->multisample != GLFMMultisampleNone;
     attribs.premultipliedAlpha = 1;
-    attribs.preserveDrawingBuffer = 0;
+    const bool singleBufferRequested = glfmDisplay->swapBehavior == GLFMSwapBehaviorSingleBuffer;
+    attribs.preserveDrawingBuffer = singleBufferRequested;
     attribs.powerPreference = EM_WEBGL_POWER_PREFERENCE_HIGH_PERFORMANCE;
     attribs.failIfMajorPerformanceCaveat = 0;
     attribs.enableExtensionsByDefault = 0;
 
+    if (singleBufferRequested) {
+        // EmscriptenWebGLContextAttributes doesn't include `desynchronized`, so add it when the context is created.
+        EM_ASM({
+            var canvas = Module['canvas'];
+            if (!canvas.glfmGetContext) {
+                canvas.glfmGetContext = canvas.getContext;
+                canvas.getContext = function(type, attributes) {
+                    attributes = attributes || {};
+                    attributes['desynchronized'] = true;
+                    return canvas.glfmGetContext.call(canvas, type, attributes);
+                };
+            }
+        });
+    }
+
     const char *webGLTarget = "#canvas";
     EMSCRIPTEN_WEBGL_CONTEXT_HANDLE contextHandle = 0;
     if (glfmDisplay->preferredAPI >= GLFMRenderingAPIOpenGLES3) {
@@ -930,6 +1065,15 @@ int main(void) {
             platformData->renderingAPI = GLFMRenderingAPIOpenGLES2;
         }
     }
+    if (singleBufferRequested) {
+        EM_ASM({
+            var canvas = Module['canvas'];
+            if (canvas.glfmGetContext) {
+                canvas.getContext = canvas.glfmGetContext;
+                delete canvas.glfmGetContext;
+            }
+        });
+    }
     if (!contextHandle) {
         GLFM_LOG("Couldn't create GL context");
         glfm__reportSurfaceError(glfmDisplay, "Couldn't create GL context");
@@ -938,6 +1082,24 @@ int main(void) {
 
     emscripten_webgl_make_context_current(contextHandle);
 
+    // Used by the GPU timer (see glfmSetGPUTimerEnabled). Extensions are not enabled by default.
+    if (platformData->renderingAPI >= GLFMRenderingAPIOpenGLES3) {
+        emscripten_webgl_enable_extension(contextHandle, "EXT_disjoint_timer_query_webgl2");
+    } else {
+        emscripten_webgl_enable_extension(contextHandle, "EXT_disjoint_timer_query");
+    }
+
+    if (singleBufferRequested) {
+        // Browsers that don't support low-latency canvases ignore the attribute
+        platformData->singleBufferActive = EM_ASM_INT_V({
+            var attributes = (typeof GLctx !== 'undefined' && GLctx) ? GLctx.getContextAttributes() : null;
+            return (attributes && attributes['desynchronized']) ? 1 : 0;
+        });
+    }
+
+    if (glfmDisplay->contextReadyFunc) {
+        glfmDisplay->contextReadyFunc(glfmDisplay);
+    }
     if (glfmDisplay->surfaceCreatedFunc) {
         glfmDisplay->surfaceCreatedFunc(glfmDisplay, platformData->width, platformData->height);
     }
@@ -5,16 +5,39 @@
 #define GLFM_INTERNAL_H
 
 #include "glfm.h"
+#include <errno.h>
+#include <pthread.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define GLFM_NUM_SENSORS 4
+#define GLFM_MAX_WORKERS 8
+#define GLFM_MAX_PATH 1024
+#define GLFM_MAX_FRAMES_IN_FLIGHT 4
+
+#if defined(__ANDROID__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define GLFM_JOBS_USE_PTHREADS 1
+#else
+#define GLFM_JOBS_USE_PTHREADS 0
+#endif
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#define GLFM_JOBS_USE_GCD 1
+#else
+#define GLFM_JOBS_USE_GCD 0
+#endif
 
 #if defined(__GNUC__) && __STDC_VERSION__ >= 199901
 #define GLFM_IGNORE_DEPRECATIONS_START \
@@ -27,6 +50,120 @@ extern "C" {
 #define GLFM_IGNORE_DEPRECATIONS_END
 #endif
 
+typedef struct GLFMJobPool GLFMJobPool;
+
+typedef void (*GLFMGetProgramBinaryFunc)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat,
+                                         void *binary);
+typedef void (*GLFMProgramBinaryFunc)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (*GLFMProgramParameteriFunc)(GLuint program, GLenum pname, GLint value);
+
+typedef struct {
+    bool initialized;
+    bool directoryCreated;
+    // NULL if program binaries are not supported
+    GLFMGetProgramBinaryFunc getProgramBinary;
+    GLFMProgramBinaryFunc programBinary;
+    GLFMProgramParameteriFunc programParameteri;
+    GLFMProgramCacheStats stats;
+} GLFMProgramCache;
+
+#define GLFM_GPU_TIMER_QUERY_COUNT 4
+
+typedef void (*GLFMGenQueriesFunc)(GLsizei n, GLuint *ids);
+typedef void (*GLFMDeleteQueriesFunc)(GLsizei n, const GLuint *ids);
+typedef void (*GLFMBeginQueryFunc)(GLenum target, GLuint id);
+typedef void (*GLFMEndQueryFunc)(GLenum target);
+typedef void (*GLFMGetQueryObjectuivFunc)(GLuint id, GLenum pname, GLuint *params);
+typedef void (*GLFMGetQueryObjectui64vFunc)(GLuint id, GLenum pname, GLuint64 *params);
+
+typedef struct {
+    bool enabled;
+    bool initialized; // Queries are created for the current context
+    bool queryActive;
+    bool resultValid;
+    // NULL if timer queries are not supported
+    GLFMGenQueriesFunc genQueries;
+    GLFMDeleteQueriesFunc deleteQueries;
+    GLFMBeginQueryFunc beginQuery;
+    GLFMEndQueryFunc endQuery;
+    GLFMGetQueryObjectuivFunc getQueryObjectuiv;
+    GLFMGetQueryObjectui64vFunc getQueryObjectui64v;
+    // Ring of queries. Results are read back a few frames later, when available, to avoid stalls.
+    GLuint queries[GLFM_GPU_TIMER_QUERY_COUNT];
+    int pendingHead; // Oldest pending query
+    int pendingCount;
+    double frameTime;
+} GLFMGPUTimer;
+
+typedef struct {
+    bool initialized; // Initialized for the current context
+    bool callbackInstalled; // False if GL_KHR_debug is not available
+    int frameCounts[GLFM_NUM_DEBUG_MESSAGE_TYPES];
+    GLFMDebugStats stats;
+} GLFMDebugState;
+
+typedef struct GLFMAssetMapping GLFMAssetMapping;
+
+/// A mapped asset. See ``glfmMapAsset``.
+struct GLFMAssetMapping {
+    const void *data;
+    size_t size;
+    // The mmap region, or NULL if the asset wasn't mapped with mmap
+    void *mapAddress;
+    size_t mapLength;
+    // The platform's asset object (AAsset on Android), or NULL
+    void *platformAsset;
+    GLFMAssetMapping *next;
+};
+
+typedef struct GLFMAssetRequest GLFMAssetRequest;
+
+/// A request made with ``glfmLoadAssetAsync``.
+struct GLFMAssetRequest {
+    unsigned int id;
+    GLFMAssetLoadFunc func;
+    void *userData;
+    GLFMAssetRequest *next;
+};
+
+typedef enum {
+    GLFMAssetLoadStatePending,
+    GLFMAssetLoadStateLoading, // Running on a worker thread
+    GLFMAssetLoadStateReady,
+    GLFMAssetLoadStateDelivering,
+} GLFMAssetLoadState;
+
+typedef struct GLFMAssetLoad GLFMAssetLoad;
+
+/// A load of one asset, shared by all requests for its path.
+struct GLFMAssetLoad {
+    GLFMDisplay *display;
+    char *path;
+    int priority; // The highest priority of the requests
+    GLFMAssetLoadState state;
+    GLFMAssetRequest *requests;
+    // Set on a worker thread. The render thread only reads these after the job has completed.
+    const void *data;
+    size_t size;
+    GLFMAssetLoad *next;
+};
+
+/// Only accessed on the render thread.
+typedef struct {
+    GLFMAssetLoad *loads;
+    unsigned int nextRequestID;
+    int loadingCount;
+    size_t readyBytes; // Loaded, but not delivered yet
+    size_t memoryBudget; // 0 means no limit
+} GLFMAssetLoader;
+
+typedef struct {
+    bool enabled;
+    double lastFrameTime;
+    double averageFrameDuration; // Exponential moving average, or 0 if not measured yet
+    int fastFrameCount;
+} GLFMRenderScaleController;
+
 struct GLFMDisplay {
     // Config
     GLFMRenderingAPI preferredAPI;
@@ -37,6 +174,10 @@ struct GLFMDisplay {
     GLFMInterfaceOrientation supportedOrientations;
     GLFMUserInterfaceChrome uiChrome;
     GLFMSwapBehavior swapBehavior;
+    bool persistentContextEnabled;
+    bool debugEnabled;
+    double renderScale; // 0 means 1.0
+    int maxFramesInFlight; // 0 means no limit
 
     // Callbacks
     GLFM_IGNORE_DEPRECATIONS_START
@@ -49,6 +190,7 @@ struct GLFMDisplay {
     GLFMMouseWheelFunc mouseWheelFunc;
     GLFMSurfaceErrorFunc surfaceErrorFunc;
     GLFMSurfaceCreatedFunc surfaceCreatedFunc;
+    GLFMContextReadyFunc contextReadyFunc;
     GLFMSurfaceResizedFunc surfaceResizedFunc;
     GLFMSurfaceRefreshFunc surfaceRefreshFunc;
     GLFMSurfaceDestroyedFunc surfaceDestroyedFunc;
@@ -57,8 +199,31 @@ struct GLFMDisplay {
     GLFMDisplayChromeInsetsChangedFunc displayChromeInsetsChangedFunc;
     GLFMMemoryWarningFunc lowMemoryFunc;
     GLFMAppFocusFunc focusFunc;
+    GLFMDebugMessageFunc debugMessageFunc;
     GLFMSensorFunc sensorFuncs[GLFM_NUM_SENSORS];
 
+    // Jobs (created on first dispatch)
+    GLFMJobPool *jobPool;
+
+    // Program cache (initialized on first use)
+    GLFMProgramCache programCache;
+
+    // Automatic render scale
+    GLFMRenderScaleController renderScaleController;
+
+    // Frame pacing
+    GLFMFrameStats frameStats;
+    GLFMGPUTimer gpuTimer;
+
+    // Debug mode
+    GLFMDebugState debug;
+
+    // Mapped assets, guarded by glfm__assetMutex
+    GLFMAssetMapping *assetMappings;
+
+    // Asset loads
+    GLFMAssetLoader assetLoader;
+
     // External data
     void *userData;
     void *platformData;
@@ -69,6 +234,23 @@ struct GLFMDisplay {
 static void glfm__displayChromeUpdated(GLFMDisplay *display);
 static void glfm__sensorFuncUpdated(GLFMDisplay *display);
 
+// MARK: - Platform functions
+
+/// Returns the preferred number of worker threads, or 0 if the platform can't run jobs on other threads.
+static int glfm__getPreferredWorkerCount(void);
+
+/// Returns the path of a directory for cached files, or NULL if not available.
+static const char *glfm__getCacheDirectory(GLFMDisplay *display);
+
+/// Logs a message in debug builds.
+static void glfm__logMessage(const char *message);
+
+/// Maps an asset, given a relative path. May be called from any thread. Returns `false` if the asset wasn't found.
+static bool glfm__mapPlatformAsset(GLFMDisplay *display, const char *path, GLFMAssetMapping *mapping);
+
+/// Releases the `platformAsset` of a mapping created by ``glfm__mapPlatformAsset``.
+static void glfm__releasePlatformAsset(void *platformAsset);
+
 // MARK: - Setters
 
 GLFMSurfaceErrorFunc glfmSetSurfaceErrorFunc(GLFMDisplay *display, GLFMSurfaceErrorFunc surfaceErrorFunc) {
@@ -164,6 +346,15 @@ GLFMSurfaceCreatedFunc glfmSetSurfaceCreatedFunc(GLFMDisplay *display, GLFMSurfa
     return previous;
 }
 
+GLFMContextReadyFunc glfmSetContextReadyFunc(GLFMDisplay *display, GLFMContextReadyFunc contextReadyFunc) {
+    GLFMContextReadyFunc previous = NULL;
+    if (display) {
+        previous = display->contextReadyFunc;
+        display->contextReadyFunc = contextReadyFunc;
+    }
+    return previous;
+}
+
 GLFMSurfaceResizedFunc glfmSetSurfaceResizedFunc(GLFMDisplay *display, GLFMSurfaceResizedFunc surfaceResizedFunc) {
     GLFMSurfaceResizedFunc previous = NULL;
     if (display) {
@@ -279,6 +470,15 @@ GLFMMemoryWarningFunc glfmSetMemoryWarningFunc(GLFMDisplay *display, GLFMMemoryW
     return previous;
 }
 
+GLFMDebugMessageFunc glfmSetDebugMessageFunc(GLFMDisplay *display, GLFMDebugMessageFunc debugMessageFunc) {
+    GLFMDebugMessageFunc previous = NULL;
+    if (display) {
+        previous = display->debugMessageFunc;
+        display->debugMessageFunc = debugMessageFunc;
+    }
+    return previous;
+}
+
 GLFMAppFocusFunc glfmSetAppFocusFunc(GLFMDisplay *display, GLFMAppFocusFunc focusFunc) {
     GLFMAppFocusFunc previous = NULL;
     if (display) {
@@ -302,6 +502,96 @@ GLFMSwapBehavior glfmGetSwapBehavior(const GLFMDisplay *display) {
     return GLFMSwapBehaviorPlatformDefault;
 }
 
+void glfmSetPersistentContextEnabled(GLFMDisplay *display, bool enabled) {
+    if (display) {
+        display->persistentContextEnabled = enabled;
+    }
+}
+
+bool glfmGetPersistentContextEnabled(const GLFMDisplay *display) {
+    return display ? display->persistentContextEnabled : false;
+}
+
+double glfmGetRenderScale(const GLFMDisplay *display) {
+    return (display && display->renderScale > 0.0) ? display->renderScale : 1.0;
+}
+
+void glfmSetAutoRenderScaleEnabled(GLFMDisplay *display, bool enabled) {
+    if (display) {
+        display->renderScaleController.enabled = enabled;
+        display->renderScaleController.lastFrameTime = 0.0;
+        display->renderScaleController.averageFrameDuration = 0.0;
+        display->renderScaleController.fastFrameCount = 0;
+    }
+}
+
+bool glfmGetAutoRenderScaleEnabled(const GLFMDisplay *display) {
+    return display ? display->renderScaleController.enabled : false;
+}
+
+void glfmSetMaxFramesInFlight(GLFMDisplay *display, int maxFramesInFlight) {
+    if (display) {
+        display->maxFramesInFlight = maxFramesInFlight <= 0 ? 0 :
+            (maxFramesInFlight > GLFM_MAX_FRAMES_IN_FLIGHT ? GLFM_MAX_FRAMES_IN_FLIGHT : maxFramesInFlight);
+    }
+}
+
+int glfmGetMaxFramesInFlight(const GLFMDisplay *display) {
+    return display ? display->maxFramesInFlight : 0;
+}
+
+void glfmSetGPUTimerEnabled(GLFMDisplay *display, bool enabled) {
+    if (display) {
+        display->gpuTimer.enabled = enabled;
+        if (!enabled) {
+            display->gpuTimer.resultValid = false;
+        }
+    }
+}
+
+bool glfmGetGPUTimerEnabled(const GLFMDisplay *display) {
+    return display ? display->gpuTimer.enabled : false;
+}
+
+double glfmGetGPUFrameTime(const GLFMDisplay *display) {
+    if (display && display->gpuTimer.enabled && display->gpuTimer.resultValid) {
+        return display->gpuTimer.frameTime;
+    }
+    return -1.0;
+}
+
+void glfmSetDebugEnabled(GLFMDisplay *display, bool enabled) {
+    if (display) {
+        display->debugEnabled = enabled;
+    }
+}
+
+bool glfmGetDebugEnabled(const GLFMDisplay *display) {
+    return display ? display->debugEnabled : false;
+}
+
+void glfmGetDebugStats(const GLFMDisplay *display, GLFMDebugStats *stats) {
+    if (!stats) {
+        return;
+    }
+    if (display) {
+        *stats = display->debug.stats;
+    } else {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+void glfmGetFrameStats(const GLFMDisplay *display, GLFMFrameStats *stats) {
+    if (!stats) {
+        return;
+    }
+    if (display) {
+        *stats = display->frameStats;
+    } else {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
 // MARK: - Helper functions
 
 static void glfm__reportSurfaceError(GLFMDisplay *display, const char *errorMessage) {
@@ -310,6 +600,1261 @@ static void glfm__reportSurfaceError(GLFMDisplay *display, const char *errorMess
     }
 }
 
+// MARK: - Render scale
+
+#if !defined(__APPLE__)
+
+// Apple platforms don't support the render scale.
+
+#define GLFM_RENDER_SCALE_STEP_DOWN 0.1
+#define GLFM_RENDER_SCALE_STEP_UP 0.05
+#define GLFM_RENDER_SCALE_STEP_UP_FRAMES 180
+
+static double glfm__clampRenderScale(double renderScale) {
+    if (!(renderScale >= GLFM_MIN_RENDER_SCALE)) { // Also catches NaN
+        return GLFM_MIN_RENDER_SCALE;
+    } else if (renderScale > 1.0) {
+        return 1.0;
+    } else {
+        return renderScale;
+    }
+}
+
+/// Adjusts the render scale from frame-time statistics, if automatic render scale is enabled. Called once per frame,
+/// before the render function, with the target frame duration (the inverse of the display's refresh rate).
+static void glfm__updateAutoRenderScale(GLFMDisplay *display, double targetFrameDuration) {
+    GLFMRenderScaleController *controller = &display->renderScaleController;
+    if (!controller->enabled || targetFrameDuration <= 0.0) {
+        return;
+    }
+    const double now = glfmGetTime();
+    const double frameDuration = now - controller->lastFrameTime;
+    controller->lastFrameTime = now;
+    if (frameDuration <= 0.0 || frameDuration > 0.25) {
+        // First frame, or resumed after a pause
+        controller->fastFrameCount = 0;
+        return;
+    }
+    if (controller->averageFrameDuration <= 0.0) {
+        controller->averageFrameDuration = frameDuration;
+    } else {
+        controller->averageFrameDuration = controller->averageFrameDuration * 0.9 + frameDuration * 0.1;
+    }
+
+    const double renderScale = glfmGetRenderScale(display);
+    if (controller->averageFrameDuration > targetFrameDuration * 1.2) {
+        controller->fastFrameCount = 0;
+        if (renderScale > GLFM_MIN_RENDER_SCALE) {
+            glfmSetRenderScale(display, renderScale - GLFM_RENDER_SCALE_STEP_DOWN);
+            // Give the new scale time to take effect before measuring again
+            controller->averageFrameDuration = targetFrameDuration;
+        }
+    } else if (controller->averageFrameDuration < targetFrameDuration * 1.05) {
+        controller->fastFrameCount++;
+        if (controller->fastFrameCount >= GLFM_RENDER_SCALE_STEP_UP_FRAMES && renderScale < 1.0) {
+            controller->fastFrameCount = 0;
+            glfmSetRenderScale(display, renderScale + GLFM_RENDER_SCALE_STEP_UP);
+        }
+    } else {
+        controller->fastFrameCount = 0;
+    }
+}
+
+#endif
+
+// MARK: - GPU timer
+
+#if !defined(__APPLE__)
+
+// Not implemented on Apple platforms.
+
+#ifndef GL_TIME_ELAPSED_EXT
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+#ifndef GL_QUERY_RESULT_EXT
+#define GL_QUERY_RESULT_EXT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE_EXT
+#define GL_QUERY_RESULT_AVAILABLE_EXT 0x8867
+#endif
+
+static bool glfm__gpuTimerInit(GLFMDisplay *display) {
+    GLFMGPUTimer *timer = &display->gpuTimer;
+    timer->initialized = true;
+    timer->queryActive = false;
+    timer->pendingHead = 0;
+    timer->pendingCount = 0;
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    if (!extensions || !strstr(extensions, "EXT_disjoint_timer_query")) {
+        // Also matches EXT_disjoint_timer_query_webgl2
+        timer->genQueries = NULL;
+        return false;
+    }
+    if (glfmGetRenderingAPI(display) >= GLFMRenderingAPIOpenGLES3) {
+        // With OpenGL ES 3.0, the extension uses the core query functions
+        timer->genQueries = (GLFMGenQueriesFunc)glfmGetProcAddress("glGenQueries");
+        timer->deleteQueries = (GLFMDeleteQueriesFunc)glfmGetProcAddress("glDeleteQueries");
+        timer->beginQuery = (GLFMBeginQueryFunc)glfmGetProcAddress("glBeginQuery");
+        timer->endQuery = (GLFMEndQueryFunc)glfmGetProcAddress("glEndQuery");
+        timer->getQueryObjectuiv = (GLFMGetQueryObjectuivFunc)glfmGetProcAddress("glGetQueryObjectuiv");
+    } else {
+        timer->genQueries = (GLFMGenQueriesFunc)glfmGetProcAddress("glGenQueriesEXT");
+        timer->deleteQueries = (GLFMDeleteQueriesFunc)glfmGetProcAddress("glDeleteQueriesEXT");
+        timer->beginQuery = (GLFMBeginQueryFunc)glfmGetProcAddress("glBeginQueryEXT");
+        timer->endQuery = (GLFMEndQueryFunc)glfmGetProcAddress("glEndQueryEXT");
+        timer->getQueryObjectuiv = (GLFMGetQueryObjectuivFunc)glfmGetProcAddress("glGetQueryObjectuivEXT");
+    }
+    timer->getQueryObjectui64v = (GLFMGetQueryObjectui64vFunc)glfmGetProcAddress("glGetQueryObjectui64vEXT");
+    if (!timer->genQueries || !timer->deleteQueries || !timer->beginQuery || !timer->endQuery ||
+        !timer->getQueryObjectuiv || !timer->getQueryObjectui64v) {
+        timer->genQueries = NULL;
+        return false;
+    }
+    timer->genQueries(GLFM_GPU_TIMER_QUERY_COUNT, timer->queries);
+    return true;
+}
+
+/// Forgets the queries without deleting them. Called when the context is destroyed or lost.
+static void glfm__gpuTimerReset(GLFMDisplay *display) {
+    display->gpuTimer.initialized = false;
+    display->gpuTimer.queryActive = false;
+    display->gpuTimer.resultValid = false;
+}
+
+/// Begins timing a frame. Called before the render function, with the context current.
+static void glfm__gpuTimerBeginFrame(GLFMDisplay *display) {
+    GLFMGPUTimer *timer = &display->gpuTimer;
+    if (!timer->enabled) {
+        if (timer->initialized) {
+            if (timer->genQueries) {
+                timer->deleteQueries(GLFM_GPU_TIMER_QUERY_COUNT, timer->queries);
+            }
+            timer->initialized = false;
+        }
+        return;
+    }
+    if (!timer->initialized && !glfm__gpuTimerInit(display)) {
+        return;
+    }
+    if (!timer->genQueries || timer->pendingCount >= GLFM_GPU_TIMER_QUERY_COUNT) {
+        // Not supported, or all queries are waiting for results. Skip this frame rather than stall.
+        return;
+    }
+    int index = (timer->pendingHead + timer->pendingCount) % GLFM_GPU_TIMER_QUERY_COUNT;
+    timer->beginQuery(GL_TIME_ELAPSED_EXT, timer->queries[index]);
+    timer->queryActive = true;
+}
+
+/// Ends timing a frame, and reads back the results of previous frames that are available.
+static void glfm__gpuTimerEndFrame(GLFMDisplay *display) {
+    GLFMGPUTimer *timer = &display->gpuTimer;
+    if (!timer->queryActive) {
+        return;
+    }
+    timer->endQuery(GL_TIME_ELAPSED_EXT);
+    timer->queryActive = false;
+    timer->pendingCount++;
+
+    bool hasResult = false;
+    GLuint64 elapsed = 0;
+    while (timer->pendingCount > 0) {
+        GLuint query = timer->queries[timer->pendingHead];
+        GLuint available = 0;
+        timer->getQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+        if (!available) {
+            break;
+        }
+        timer->getQueryObjectui64v(query, GL_QUERY_RESULT_EXT, &elapsed);
+        hasResult = true;
+        timer->pendingHead = (timer->pendingHead + 1) % GLFM_GPU_TIMER_QUERY_COUNT;
+        timer->pendingCount--;
+    }
+
+    // A disjoint event (for example, a GPU frequency change or power event) invalidates all pending results.
+    // Reading the flag clears it.
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    if (disjoint) {
+        timer->pendingCount = 0;
+    } else if (hasResult) {
+        timer->frameTime = (double)elapsed / 1e9;
+        timer->resultValid = true;
+    }
+}
+
+#endif
+
+// MARK: - Debug
+
+#if !defined(__APPLE__)
+
+// Not implemented on Apple platforms.
+
+#ifndef GL_DEBUG_OUTPUT_KHR
+#define GL_DEBUG_OUTPUT_KHR 0x92E0
+#endif
+#ifndef GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR 0x8242
+#endif
+#ifndef GL_DEBUG_TYPE_ERROR_KHR
+#define GL_DEBUG_TYPE_ERROR_KHR 0x824C
+#endif
+#ifndef GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR_KHR
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR_KHR 0x824D
+#endif
+#ifndef GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR_KHR
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR_KHR 0x824E
+#endif
+#ifndef GL_DEBUG_TYPE_PORTABILITY_KHR
+#define GL_DEBUG_TYPE_PORTABILITY_KHR 0x824F
+#endif
+#ifndef GL_DEBUG_TYPE_PERFORMANCE_KHR
+#define GL_DEBUG_TYPE_PERFORMANCE_KHR 0x8250
+#endif
+#ifndef GL_DEBUG_SEVERITY_NOTIFICATION_KHR
+#define GL_DEBUG_SEVERITY_NOTIFICATION_KHR 0x826B
+#endif
+
+typedef void (GL_APIENTRY *GLFMDebugProc)(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                          const GLchar *message, const void *userParam);
+typedef void (GL_APIENTRY *GLFMDebugMessageCallbackFunc)(GLFMDebugProc callback, const void *userParam);
+typedef void (GL_APIENTRY *GLFMDebugMessageControlFunc)(GLenum source, GLenum type, GLenum severity, GLsizei count,
+                                                        const GLuint *ids, GLboolean enabled);
+
+static void glfm__debugReport(GLFMDisplay *display, GLFMDebugMessageType type, const char *message) {
+    display->debug.frameCounts[type]++;
+    display->debug.stats.totalCounts[type]++;
+    if (display->debugMessageFunc) {
+        display->debugMessageFunc(display, type, message);
+    } else {
+        glfm__logMessage(message);
+    }
+}
+
+static void GL_APIENTRY glfm__debugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                            const GLchar *message, const void *userParam) {
+    (void)source;
+    (void)id;
+    (void)severity;
+    (void)length;
+    GLFMDisplay *display = (GLFMDisplay *)userParam;
+    GLFMDebugMessageType messageType;
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR_KHR:
+            messageType = GLFMDebugMessageTypeError;
+            break;
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR_KHR:
+            messageType = GLFMDebugMessageTypeDeprecatedBehavior;
+            break;
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR_KHR:
+            messageType = GLFMDebugMessageTypeUndefinedBehavior;
+            break;
+        case GL_DEBUG_TYPE_PORTABILITY_KHR:
+            messageType = GLFMDebugMessageTypePortability;
+            break;
+        case GL_DEBUG_TYPE_PERFORMANCE_KHR:
+            messageType = GLFMDebugMessageTypePerformance;
+            break;
+        default:
+            messageType = GLFMDebugMessageTypeOther;
+            break;
+    }
+    glfm__debugReport(display, messageType, message);
+}
+
+static void glfm__debugInit(GLFMDisplay *display) {
+    GLFMDebugState *debug = &display->debug;
+    debug->initialized = true;
+    debug->callbackInstalled = false;
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    if (!extensions || !strstr(extensions, "GL_KHR_debug")) {
+        return;
+    }
+    GLFMDebugMessageCallbackFunc debugMessageCallback =
+        (GLFMDebugMessageCallbackFunc)glfmGetProcAddress("glDebugMessageCallbackKHR");
+    GLFMDebugMessageControlFunc debugMessageControl =
+        (GLFMDebugMessageControlFunc)glfmGetProcAddress("glDebugMessageControlKHR");
+    if (!debugMessageCallback || !debugMessageControl) {
+        return;
+    }
+    // Synchronous output calls the callback on the render thread, during the GL call that caused the message.
+    glEnable(GL_DEBUG_OUTPUT_KHR);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+    debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION_KHR, 0, NULL, GL_FALSE);
+    debugMessageCallback(glfm__debugCallback, display);
+    debug->callbackInstalled = true;
+}
+
+/// Forgets the debug state of the context. Called when the context is destroyed or lost.
+static void glfm__debugReset(GLFMDisplay *display) {
+    display->debug.initialized = false;
+}
+
+/// Installs the debug callback, if needed. Called before the render function, with the context current.
+static void glfm__debugBeginFrame(GLFMDisplay *display) {
+    if (display->debugEnabled && !display->debug.initialized) {
+        glfm__debugInit(display);
+    }
+}
+
+/// Checks for errors (if GL_KHR_debug is not available), and updates the per-frame counts. Called after the render
+/// function.
+static void glfm__debugEndFrame(GLFMDisplay *display) {
+    if (!display->debugEnabled) {
+        return;
+    }
+    GLFMDebugState *debug = &display->debug;
+    if (!debug->callbackInstalled) {
+        GLenum error;
+        int errorCount = 0;
+        // Limit the count in case there is no current context (glGetError may return an error forever)
+        while ((error = glGetError()) != GL_NO_ERROR && errorCount < 8) {
+            char message[64];
+            snprintf(message, sizeof(message), "OpenGL error 0x%04x", error);
+            glfm__debugReport(display, GLFMDebugMessageTypeError, message);
+            errorCount++;
+        }
+    }
+    memcpy(debug->stats.lastFrameCounts, debug->frameCounts, sizeof(debug->frameCounts));
+    memset(debug->frameCounts, 0, sizeof(debug->frameCounts));
+}
+
+#endif
+
+// MARK: - Jobs
+
+typedef struct GLFMJob GLFMJob;
+
+struct GLFMJob {
+    GLFMJobPool *pool;
+    GLFMJobFunc jobFunc;
+    GLFMJobCompletionFunc completionFunc;
+    void *userData;
+    GLFMJob *next;
+};
+
+typedef struct {
+    GLFMJob *head;
+    GLFMJob *tail;
+} GLFMJobList;
+
+#if GLFM_JOBS_USE_PTHREADS
+
+typedef struct {
+    GLFMJobPool *pool;
+    int index;
+    pthread_mutex_t mutex;
+    GLFMJobList jobs;
+} GLFMWorker;
+
+#endif
+
+struct GLFMJobPool {
+    // Jobs waiting for their completion function to be called on the render thread
+    pthread_mutex_t completedMutex;
+    GLFMJobList completed;
+
+    // Job counts. The pendingCount is the number of queued jobs not yet taken by a worker. The runningCount is the
+    // number of dispatched jobs that haven't finished.
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_cond_t idleCond;
+    unsigned int pendingCount;
+    unsigned int runningCount;
+
+#if GLFM_JOBS_USE_PTHREADS
+    unsigned int nextWorker; // Guarded by mutex
+    int workerCount;
+    pthread_t threads[GLFM_MAX_WORKERS];
+    GLFMWorker workers[GLFM_MAX_WORKERS];
+#endif
+};
+
+static void glfm__jobListPush(GLFMJobList *list, GLFMJob *job) {
+    job->next = NULL;
+    if (list->tail) {
+        list->tail->next = job;
+    } else {
+        list->head = job;
+    }
+    list->tail = job;
+}
+
+static GLFMJob *glfm__jobListPop(GLFMJobList *list) {
+    GLFMJob *job = list->head;
+    if (job) {
+        list->head = job->next;
+        if (!list->head) {
+            list->tail = NULL;
+        }
+        job->next = NULL;
+    }
+    return job;
+}
+
+static int glfm__jobPoolWorkerCount(void) {
+    int count = glfm__getPreferredWorkerCount();
+    if (count < 0) {
+        count = 0;
+    } else if (count > GLFM_MAX_WORKERS) {
+        count = GLFM_MAX_WORKERS;
+    }
+    return count;
+}
+
+/// Runs a job (on any thread) and queues its completion function for the render thread.
+static void glfm__jobPoolRunJob(GLFMJobPool *pool, GLFMJob *job) {
+    job->jobFunc(job->userData);
+
+    if (job->completionFunc) {
+        pthread_mutex_lock(&pool->completedMutex);
+        glfm__jobListPush(&pool->completed, job);
+        pthread_mutex_unlock(&pool->completedMutex);
+    } else {
+        free(job);
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->runningCount--;
+    if (pool->runningCount == 0) {
+        pthread_cond_broadcast(&pool->idleCond);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+#if GLFM_JOBS_USE_PTHREADS
+
+/// Pops a job from the worker's own queue, or steals one from another worker's queue.
+static GLFMJob *glfm__workerNextJob(GLFMWorker *worker) {
+    GLFMJobPool *pool = worker->pool;
+    for (int i = 0; i < pool->workerCount; i++) {
+        GLFMWorker *victim = &pool->workers[(worker->index + i) % pool->workerCount];
+        pthread_mutex_lock(&victim->mutex);
+        GLFMJob *job = glfm__jobListPop(&victim->jobs);
+        pthread_mutex_unlock(&victim->mutex);
+        if (job) {
+            return job;
+        }
+    }
+    return NULL;
+}
+
+/// Waits until a job is available, and then takes it.
+static GLFMJob *glfm__workerWaitForJob(GLFMWorker *worker) {
+    GLFMJobPool *pool = worker->pool;
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->pendingCount == 0) {
+        pthread_cond_wait(&pool->cond, &pool->mutex);
+    }
+    pool->pendingCount--;
+    pthread_mutex_unlock(&pool->mutex);
+
+    // A pending job was reserved above, so one of the queues has a job for this worker.
+    GLFMJob *job = NULL;
+    while (!job) {
+        job = glfm__workerNextJob(worker);
+    }
+    return job;
+}
+
+static void *glfm__workerMain(void *arg) {
+    GLFMWorker *worker = arg;
+    GLFMJob *job;
+    while ((job = glfm__workerWaitForJob(worker)) != NULL) {
+        glfm__jobPoolRunJob(worker->pool, job);
+    }
+    return NULL;
+}
+
+#endif
+
+#if GLFM_JOBS_USE_GCD
+
+static void glfm__gcdJobMain(void *context) {
+    GLFMJob *job = context;
+    glfm__jobPoolRunJob(job->pool, job);
+}
+
+#endif
+
+/// Guards the creation and destruction of each display's job pool, since jobs may be dispatched from any thread.
+static pthread_mutex_t glfm__jobPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static GLFMJobPool *glfm__jobPoolCreate(void) {
+    GLFMJobPool *pool = calloc(1, sizeof(GLFMJobPool));
+    if (!pool) {
+        return NULL;
+    }
+    pthread_mutex_init(&pool->completedMutex, NULL);
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+    pthread_cond_init(&pool->idleCond, NULL);
+#if GLFM_JOBS_USE_PTHREADS
+    int workerCount = glfm__jobPoolWorkerCount();
+    for (int i = 0; i < workerCount; i++) {
+        GLFMWorker *worker = &pool->workers[pool->workerCount];
+        worker->pool = pool;
+        worker->index = pool->workerCount;
+        pthread_mutex_init(&worker->mutex, NULL);
+        if (pthread_create(&pool->threads[pool->workerCount], NULL, glfm__workerMain, worker) != 0) {
+            pthread_mutex_destroy(&worker->mutex);
+            break;
+        }
+        pool->workerCount++;
+    }
+#endif
+    return pool;
+}
+
+#if defined(__APPLE__)
+
+/// Waits for all dispatched jobs to finish, and then destroys the pool. Pending completion functions are not called.
+///
+/// Only Apple platforms destroy the display. On Android and Emscripten, the display (and its worker threads) exist for
+/// the lifetime of the process.
+static void glfm__jobPoolDestroy(GLFMDisplay *display) {
+    pthread_mutex_lock(&glfm__jobPoolMutex);
+    GLFMJobPool *pool = display->jobPool;
+    display->jobPool = NULL;
+    pthread_mutex_unlock(&glfm__jobPoolMutex);
+    if (!pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->runningCount > 0) {
+        pthread_cond_wait(&pool->idleCond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    GLFMJob *job;
+    while ((job = glfm__jobListPop(&pool->completed)) != NULL) {
+        free(job);
+    }
+    pthread_cond_destroy(&pool->idleCond);
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_mutex_destroy(&pool->completedMutex);
+    free(pool);
+}
+
+#endif
+
+/// Calls the completion functions of finished jobs. Must be called on the render thread, before the render function.
+static void glfm__jobPoolDrainCompletions(GLFMDisplay *display) {
+    pthread_mutex_lock(&glfm__jobPoolMutex);
+    GLFMJobPool *pool = display->jobPool;
+    pthread_mutex_unlock(&glfm__jobPoolMutex);
+    if (!pool) {
+        return;
+    }
+    pthread_mutex_lock(&pool->completedMutex);
+    GLFMJobList completed = pool->completed;
+    pool->completed.head = NULL;
+    pool->completed.tail = NULL;
+    pthread_mutex_unlock(&pool->completedMutex);
+
+    GLFMJob *job;
+    while ((job = glfm__jobListPop(&completed)) != NULL) {
+        job->completionFunc(display, job->userData);
+        free(job);
+    }
+}
+
+bool glfmDispatchAsync(GLFMDisplay *display, GLFMJobFunc jobFunc, GLFMJobCompletionFunc completionFunc,
+                       void *userData) {
+    if (!display || !jobFunc) {
+        return false;
+    }
+    pthread_mutex_lock(&glfm__jobPoolMutex);
+    if (!display->jobPool) {
+        display->jobPool = glfm__jobPoolCreate();
+    }
+    GLFMJobPool *pool = display->jobPool;
+    pthread_mutex_unlock(&glfm__jobPoolMutex);
+    if (!pool) {
+        return false;
+    }
+    GLFMJob *job = calloc(1, sizeof(GLFMJob));
+    if (!job) {
+        return false;
+    }
+    job->pool = pool;
+    job->jobFunc = jobFunc;
+    job->completionFunc = completionFunc;
+    job->userData = userData;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->runningCount++;
+#if GLFM_JOBS_USE_PTHREADS
+    unsigned int workerIndex = pool->nextWorker++;
+#endif
+    pthread_mutex_unlock(&pool->mutex);
+
+#if GLFM_JOBS_USE_GCD
+    dispatch_async_f(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), job, glfm__gcdJobMain);
+#else
+#if GLFM_JOBS_USE_PTHREADS
+    if (pool->workerCount > 0) {
+        // Distribute jobs round-robin. Idle workers steal from the other queues.
+        GLFMWorker *worker = &pool->workers[workerIndex % (unsigned int)pool->workerCount];
+        pthread_mutex_lock(&worker->mutex);
+        glfm__jobListPush(&worker->jobs, job);
+        pthread_mutex_unlock(&worker->mutex);
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->pendingCount++;
+        pthread_cond_signal(&pool->cond);
+        pthread_mutex_unlock(&pool->mutex);
+        return true;
+    }
+#endif
+    // No worker threads: run now, and call the completion function before the next render.
+    glfm__jobPoolRunJob(pool, job);
+#endif
+    return true;
+}
+
+int glfmGetWorkerCount(const GLFMDisplay *display) {
+#if GLFM_JOBS_USE_PTHREADS
+    if (display) {
+        pthread_mutex_lock(&glfm__jobPoolMutex);
+        int workerCount = display->jobPool ? display->jobPool->workerCount : -1;
+        pthread_mutex_unlock(&glfm__jobPoolMutex);
+        if (workerCount >= 0) {
+            return workerCount;
+        }
+    }
+#endif
+    return display ? glfm__jobPoolWorkerCount() : 0;
+}
+
+// MARK: - Program cache
+
+#define GLFM_PROGRAM_CACHE_MAGIC "GLFMPRG1"
+#define GLFM_PROGRAM_CACHE_MAX_BINARY_LENGTH (16 * 1024 * 1024)
+#define GLFM_HASH_INIT 0xcbf29ce484222325ull
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+typedef struct {
+    char magic[8];
+    uint64_t driverHash;
+    uint32_t binaryFormat;
+    uint32_t binaryLength;
+} GLFMProgramCacheHeader;
+
+/// FNV-1a hash of a null-terminated string, including the terminator.
+static uint64_t glfm__hashString(uint64_t hash, const char *string) {
+    const unsigned char *c = (const unsigned char *)(string ? string : "");
+    do {
+        hash ^= *c;
+        hash *= 0x100000001b3ull;
+    } while (*c++ != 0);
+    return hash;
+}
+
+/// Hashes `length` bytes followed by a zero byte, so the hash of a string matches ``glfm__hashString``.
+static uint64_t glfm__hashBytes(uint64_t hash, const char *data, size_t length) {
+    const unsigned char *c = (const unsigned char *)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= c[i];
+        hash *= 0x100000001b3ull;
+    }
+    hash *= 0x100000001b3ull;
+    return hash;
+}
+
+static uint64_t glfm__getDriverHash(void) {
+    uint64_t hash = GLFM_HASH_INIT;
+    hash = glfm__hashString(hash, (const char *)glGetString(GL_VENDOR));
+    hash = glfm__hashString(hash, (const char *)glGetString(GL_RENDERER));
+    hash = glfm__hashString(hash, (const char *)glGetString(GL_VERSION));
+    return hash;
+}
+
+static void glfm__programCacheInit(GLFMProgramCache *cache) {
+    cache->initialized = true;
+#if defined(__EMSCRIPTEN__)
+    // WebGL does not support program binaries
+    (void)cache;
+#else
+    const char *version = (const char *)glGetString(GL_VERSION);
+    bool isES = version && strncmp(version, "OpenGL ES", 9) == 0;
+    bool isES2 = version && strncmp(version, "OpenGL ES 2", 11) == 0;
+    const char *extensions = isES ? (const char *)glGetString(GL_EXTENSIONS) : NULL;
+    if (extensions && strstr(extensions, "GL_OES_get_program_binary")) {
+        cache->getProgramBinary = (GLFMGetProgramBinaryFunc)glfmGetProcAddress("glGetProgramBinaryOES");
+        cache->programBinary = (GLFMProgramBinaryFunc)glfmGetProcAddress("glProgramBinaryOES");
+    } else if (!isES2) {
+        cache->getProgramBinary = (GLFMGetProgramBinaryFunc)glfmGetProcAddress("glGetProgramBinary");
+        cache->programBinary = (GLFMProgramBinaryFunc)glfmGetProcAddress("glProgramBinary");
+    }
+    if (!isES2) {
+        cache->programParameteri = (GLFMProgramParameteriFunc)glfmGetProcAddress("glProgramParameteri");
+    }
+    GLint formatCount = 0;
+    if (cache->getProgramBinary && cache->programBinary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    }
+    if (formatCount <= 0) {
+        // Some drivers (Apple platforms, for example) support the functions but not any binary formats.
+        cache->getProgramBinary = NULL;
+        cache->programBinary = NULL;
+        cache->programParameteri = NULL;
+    }
+#endif
+}
+
+static bool glfm__getProgramCachePath(GLFMDisplay *display, uint64_t key, char *path, size_t pathSize) {
+    const char *cacheDirectory = glfm__getCacheDirectory(display);
+    if (!cacheDirectory) {
+        return false;
+    }
+    int length;
+    if (!display->programCache.directoryCreated) {
+        length = snprintf(path, pathSize, "%s/glfm_programs", cacheDirectory);
+        if (length < 0 || (size_t)length >= pathSize || (mkdir(path, 0700) != 0 && errno != EEXIST)) {
+            return false;
+        }
+        display->programCache.directoryCreated = true;
+    }
+    length = snprintf(path, pathSize, "%s/glfm_programs/%016llx.bin", cacheDirectory, (unsigned long long)key);
+    return length > 0 && (size_t)length < pathSize;
+}
+
+static GLuint glfm__loadCachedProgram(const GLFMProgramCache *cache, const char *path, uint64_t driverHash) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    GLFMProgramCacheHeader header;
+    void *binary = NULL;
+    bool valid = (fread(&header, sizeof(header), 1, file) == 1 &&
+                  memcmp(header.magic, GLFM_PROGRAM_CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+                  header.driverHash == driverHash &&
+                  header.binaryLength > 0 && header.binaryLength <= GLFM_PROGRAM_CACHE_MAX_BINARY_LENGTH);
+    if (valid) {
+        binary = malloc(header.binaryLength);
+        valid = binary && fread(binary, header.binaryLength, 1, file) == 1;
+    }
+    fclose(file);
+    if (!valid) {
+        free(binary);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    cache->programBinary(program, (GLenum)header.binaryFormat, binary, (GLsizei)header.binaryLength);
+    free(binary);
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // The driver rejected the binary. It is replaced after the program is compiled from source.
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+static void glfm__storeCachedProgram(const GLFMProgramCache *cache, GLuint program, const char *path,
+                                     uint64_t driverHash) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0 || length > GLFM_PROGRAM_CACHE_MAX_BINARY_LENGTH) {
+        return;
+    }
+    void *binary = malloc((size_t)length);
+    if (!binary) {
+        return;
+    }
+    GLsizei binaryLength = 0;
+    GLenum binaryFormat = 0;
+    cache->getProgramBinary(program, length, &binaryLength, &binaryFormat, binary);
+    if (binaryLength <= 0) {
+        free(binary);
+        return;
+    }
+
+    GLFMProgramCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GLFM_PROGRAM_CACHE_MAGIC, sizeof(header.magic));
+    header.driverHash = driverHash;
+    header.binaryFormat = (uint32_t)binaryFormat;
+    header.binaryLength = (uint32_t)binaryLength;
+
+    // Write to a temporary file first, so that a partially written file is never read.
+    char tempPath[GLFM_MAX_PATH];
+    int tempPathLength = snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    if (tempPathLength > 0 && (size_t)tempPathLength < sizeof(tempPath)) {
+        FILE *file = fopen(tempPath, "wb");
+        if (file) {
+            bool written = (fwrite(&header, sizeof(header), 1, file) == 1 &&
+                            fwrite(binary, (size_t)binaryLength, 1, file) == 1);
+            if (fclose(file) != 0 || !written || rename(tempPath, path) != 0) {
+                remove(tempPath);
+            }
+        }
+    }
+    free(binary);
+}
+
+static GLuint glfm__compileShader(GLenum type, const char *source, size_t length) {
+    GLuint shader = glCreateShader(type);
+    if (shader == 0) {
+        return 0;
+    }
+    const GLint sourceLength = (GLint)length;
+    glShaderSource(shader, 1, &source, &sourceLength);
+    glCompileShader(shader);
+    GLint compiled = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        char log[1024];
+        log[0] = 0;
+        glGetShaderInfoLog(shader, (GLsizei)sizeof(log), NULL, log);
+        glfm__logMessage(log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static GLuint glfm__compileProgram(const GLFMProgramCache *cache,
+                                   const char *vertexShaderSource, size_t vertexSourceLength,
+                                   const char *fragmentShaderSource, size_t fragmentSourceLength,
+                                   const char *const *attributeNames, int attributeCount) {
+    GLuint vertShader = glfm__compileShader(GL_VERTEX_SHADER, vertexShaderSource, vertexSourceLength);
+    GLuint fragShader = glfm__compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource, fragmentSourceLength);
+    GLuint program = 0;
+    if (vertShader != 0 && fragShader != 0) {
+        program = glCreateProgram();
+        glAttachShader(program, vertShader);
+        glAttachShader(program, fragShader);
+        for (int i = 0; i < attributeCount; i++) {
+            glBindAttribLocation(program, (GLuint)i, attributeNames[i]);
+        }
+        if (cache->programParameteri) {
+            cache->programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glLinkProgram(program);
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            char log[1024];
+            log[0] = 0;
+            glGetProgramInfoLog(program, (GLsizei)sizeof(log), NULL, log);
+            glfm__logMessage(log);
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    if (vertShader != 0) {
+        glDeleteShader(vertShader);
+    }
+    if (fragShader != 0) {
+        glDeleteShader(fragShader);
+    }
+    return program;
+}
+
+unsigned int glfmCreateProgram(GLFMDisplay *display, const char *vertexShaderSource, const char *fragmentShaderSource,
+                               const char *const *attributeNames, int attributeCount) {
+    if (!vertexShaderSource || !fragmentShaderSource) {
+        return 0;
+    }
+    return glfmCreateProgramWithSourceLengths(display, vertexShaderSource, strlen(vertexShaderSource),
+                                              fragmentShaderSource, strlen(fragmentShaderSource),
+                                              attributeNames, attributeCount);
+}
+
+unsigned int glfmCreateProgramWithSourceLengths(GLFMDisplay *display,
+                                                const char *vertexShaderSource, size_t vertexSourceLength,
+                                                const char *fragmentShaderSource, size_t fragmentSourceLength,
+                                                const char *const *attributeNames, int attributeCount) {
+    if (!display || !vertexShaderSource || !fragmentShaderSource || vertexSourceLength > INT32_MAX ||
+        fragmentSourceLength > INT32_MAX || attributeCount < 0 || (attributeCount > 0 && !attributeNames)) {
+        return 0;
+    }
+    GLFMProgramCache *cache = &display->programCache;
+    double startTime = glfmGetTime();
+    if (!cache->initialized) {
+        glfm__programCacheInit(cache);
+    }
+
+    char path[GLFM_MAX_PATH];
+    bool cacheAvailable = false;
+    uint64_t driverHash = 0;
+    if (cache->programBinary) {
+        uint64_t key = GLFM_HASH_INIT;
+        key = glfm__hashBytes(key, vertexShaderSource, vertexSourceLength);
+        key = glfm__hashBytes(key, fragmentShaderSource, fragmentSourceLength);
+        for (int i = 0; i < attributeCount; i++) {
+            key = glfm__hashString(key, attributeNames[i]);
+        }
+        cacheAvailable = glfm__getProgramCachePath(display, key, path, sizeof(path));
+        driverHash = glfm__getDriverHash();
+    }
+
+    GLuint program = cacheAvailable ? glfm__loadCachedProgram(cache, path, driverHash) : 0;
+    if (program != 0) {
+        cache->stats.hitCount++;
+    } else {
+        program = glfm__compileProgram(cache, vertexShaderSource, vertexSourceLength,
+                                       fragmentShaderSource, fragmentSourceLength, attributeNames, attributeCount);
+        cache->stats.missCount++;
+        if (program != 0 && cacheAvailable) {
+            glfm__storeCachedProgram(cache, program, path, driverHash);
+        }
+    }
+    cache->stats.totalTime += glfmGetTime() - startTime;
+    return program;
+}
+
+void glfmGetProgramCacheStats(const GLFMDisplay *display, GLFMProgramCacheStats *stats) {
+    if (!stats) {
+        return;
+    }
+    if (display) {
+        *stats = display->programCache.stats;
+    } else {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+// MARK: - Assets
+
+static pthread_mutex_t glfm__assetMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/// Maps a file with mmap. Empty files are mapped as a zero-length buffer.
+static bool glfm__mapFile(const char *path, GLFMAssetMapping *mapping) {
+    static const char empty[1] = { 0 };
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size < 0 ||
+        (uint64_t)info.st_size > (uint64_t)SIZE_MAX) {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)info.st_size;
+    if (size == 0) {
+        close(fd);
+        mapping->data = empty;
+        mapping->size = 0;
+        return true;
+    }
+    void *address = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the file is closed
+    close(fd);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    mapping->data = address;
+    mapping->size = size;
+    mapping->mapAddress = address;
+    mapping->mapLength = size;
+    return true;
+}
+
+const void *glfmMapAsset(GLFMDisplay *display, const char *path, size_t *size) {
+    if (size) {
+        *size = 0;
+    }
+    if (!display || !path || path[0] == '\0') {
+        return NULL;
+    }
+    GLFMAssetMapping *mapping = calloc(1, sizeof(GLFMAssetMapping));
+    if (!mapping) {
+        return NULL;
+    }
+    bool mapped;
+    if (path[0] == '/') {
+        mapped = glfm__mapFile(path, mapping);
+    } else {
+        mapped = glfm__mapPlatformAsset(display, path, mapping);
+    }
+    if (!mapped) {
+        free(mapping);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&glfm__assetMutex);
+    mapping->next = display->assetMappings;
+    display->assetMappings = mapping;
+    pthread_mutex_unlock(&glfm__assetMutex);
+
+    if (size) {
+        *size = mapping->size;
+    }
+    return mapping->data;
+}
+
+void glfmUnmapAsset(GLFMDisplay *display, const void *data) {
+    if (!display || !data) {
+        return;
+    }
+    pthread_mutex_lock(&glfm__assetMutex);
+    GLFMAssetMapping *mapping = NULL;
+    GLFMAssetMapping **link = &display->assetMappings;
+    while (*link) {
+        if ((*link)->data == data) {
+            mapping = *link;
+            *link = mapping->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    pthread_mutex_unlock(&glfm__assetMutex);
+
+    if (!mapping) {
+        glfm__logMessage("glfmUnmapAsset: Not a mapped asset");
+        return;
+    }
+    if (mapping->mapAddress) {
+        munmap(mapping->mapAddress, mapping->mapLength);
+    }
+    if (mapping->platformAsset) {
+        glfm__releasePlatformAsset(mapping->platformAsset);
+    }
+    free(mapping);
+}
+
+// MARK: - Asset loading
+
+/// The maximum time spent calling asset load callbacks each frame, in seconds.
+#define GLFM_ASSET_DELIVERY_TIME_SLICE 0.004
+
+#define GLFM_ASSET_PAGE_SIZE 4096
+
+static void glfm__assetLoadJob(void *userData) {
+    GLFMAssetLoad *load = userData;
+    load->data = glfmMapAsset(load->display, load->path, &load->size);
+    if (load->data) {
+        // Read each page now, so the render thread doesn't wait for storage when the data is used
+        const volatile uint8_t *bytes = load->data;
+        for (size_t i = 0; i < load->size; i += GLFM_ASSET_PAGE_SIZE) {
+            (void)bytes[i];
+        }
+    }
+}
+
+static void glfm__assetLoadRemove(GLFMDisplay *display, GLFMAssetLoad *load) {
+    GLFMAssetLoader *loader = &display->assetLoader;
+    GLFMAssetLoad **link = &loader->loads;
+    while (*link) {
+        if (*link == load) {
+            *link = load->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    if (load->state == GLFMAssetLoadStateReady || load->state == GLFMAssetLoadStateDelivering) {
+        loader->readyBytes -= load->size;
+    }
+    GLFMAssetRequest *request = load->requests;
+    while (request) {
+        GLFMAssetRequest *next = request->next;
+        free(request);
+        request = next;
+    }
+    glfmUnmapAsset(display, load->data);
+    free(load->path);
+    free(load);
+}
+
+static void glfm__assetLoadCompleted(GLFMDisplay *display, void *userData) {
+    GLFMAssetLoad *load = userData;
+    GLFMAssetLoader *loader = &display->assetLoader;
+    loader->loadingCount--;
+    load->state = GLFMAssetLoadStateReady;
+    loader->readyBytes += load->size;
+    if (!load->requests) {
+        // All requests were cancelled while loading
+        glfm__assetLoadRemove(display, load);
+    }
+}
+
+/// Returns the load in the given state with the highest priority, or NULL. Loads are added to the head of the list, so
+/// among loads with the same priority, the oldest is returned.
+static GLFMAssetLoad *glfm__assetLoaderNext(GLFMAssetLoader *loader, GLFMAssetLoadState state) {
+    GLFMAssetLoad *next = NULL;
+    for (GLFMAssetLoad *load = loader->loads; load; load = load->next) {
+        if (load->state == state && (!next || load->priority >= next->priority)) {
+            next = load;
+        }
+    }
+    return next;
+}
+
+static void glfm__assetLoadDeliver(GLFMDisplay *display, GLFMAssetLoad *load) {
+    // Callbacks may cancel or add requests for this load while it is delivering
+    load->state = GLFMAssetLoadStateDelivering;
+    GLFMAssetRequest *request;
+    while ((request = load->requests) != NULL) {
+        load->requests = request->next;
+        request->func(display, load->path, load->data, load->data ? load->size : 0, request->userData);
+        free(request);
+    }
+    glfm__assetLoadRemove(display, load);
+}
+
+/// Delivers loaded assets and starts pending loads. Must be called on the render thread, after
+/// ``glfm__jobPoolDrainCompletions`` and before the render function.
+static void glfm__assetLoaderUpdate(GLFMDisplay *display) {
+    GLFMAssetLoader *loader = &display->assetLoader;
+    if (!loader->loads) {
+        return;
+    }
+
+    // Deliver, highest priority first, until the time slice is used
+    double startTime = glfmGetTime();
+    GLFMAssetLoad *load;
+    while ((load = glfm__assetLoaderNext(loader, GLFMAssetLoadStateReady)) != NULL) {
+        glfm__assetLoadDeliver(display, load);
+        if (glfmGetTime() - startTime >= GLFM_ASSET_DELIVERY_TIME_SLICE) {
+            break;
+        }
+    }
+
+    // Start loads, one per worker, while within the memory budget
+    int maxLoadingCount = glfmGetWorkerCount(display);
+    if (maxLoadingCount < 1) {
+        maxLoadingCount = 1;
+    }
+    while (loader->loadingCount < maxLoadingCount &&
+           (loader->memoryBudget == 0 || loader->readyBytes < loader->memoryBudget)) {
+        load = glfm__assetLoaderNext(loader, GLFMAssetLoadStatePending);
+        if (!load) {
+            break;
+        }
+        load->state = GLFMAssetLoadStateLoading;
+        loader->loadingCount++;
+        if (!glfmDispatchAsync(display, glfm__assetLoadJob, glfm__assetLoadCompleted, load)) {
+            // Deliver as a failed load
+            loader->loadingCount--;
+            load->state = GLFMAssetLoadStateReady;
+        }
+    }
+}
+
+#if defined(__APPLE__)
+
+/// Unmaps all loaded assets, without calling their callbacks. Must be called after ``glfm__jobPoolDestroy``.
+static void glfm__assetLoaderDestroy(GLFMDisplay *display) {
+    GLFMAssetLoader *loader = &display->assetLoader;
+    while (loader->loads) {
+        glfm__assetLoadRemove(display, loader->loads);
+    }
+    loader->loadingCount = 0;
+    loader->readyBytes = 0;
+}
+
+#endif
+
+unsigned int glfmLoadAssetAsync(GLFMDisplay *display, const char *path, int priority, GLFMAssetLoadFunc func,
+                                void *userData) {
+    if (!display || !path || path[0] == '\0' || !func) {
+        return 0;
+    }
+    GLFMAssetLoader *loader = &display->assetLoader;
+    GLFMAssetRequest *request = calloc(1, sizeof(GLFMAssetRequest));
+    if (!request) {
+        return 0;
+    }
+
+    // Coalesce with an existing load of the same path
+    GLFMAssetLoad *load = loader->loads;
+    while (load && strcmp(load->path, path) != 0) {
+        load = load->next;
+    }
+    if (load) {
+        if (priority > load->priority) {
+            load->priority = priority;
+        }
+    } else {
+        size_t pathLength = strlen(path);
+        load = calloc(1, sizeof(GLFMAssetLoad));
+        char *pathCopy = malloc(pathLength + 1);
+        if (!load || !pathCopy) {
+            free(load);
+            free(pathCopy);
+            free(request);
+            return 0;
+        }
+        memcpy(pathCopy, path, pathLength + 1);
+        load->display = display;
+        load->path = pathCopy;
+        load->priority = priority;
+        load->state = GLFMAssetLoadStatePending;
+        load->next = loader->loads;
+        loader->loads = load;
+    }
+
+    loader->nextRequestID++;
+    if (loader->nextRequestID == 0) {
+        loader->nextRequestID++;
+    }
+    request->id = loader->nextRequestID;
+    request->func = func;
+    request->userData = userData;
+
+    // Append, so coalesced requests are called in the order they were made
+    GLFMAssetRequest **link = &load->requests;
+    while (*link) {
+        link = &(*link)->next;
+    }
+    *link = request;
+    return request->id;
+}
+
+bool glfmCancelAssetLoad(GLFMDisplay *display, unsigned int requestID) {
+    if (!display || requestID == 0) {
+        return false;
+    }
+    for (GLFMAssetLoad *load = display->assetLoader.loads; load; load = load->next) {
+        GLFMAssetRequest **link = &load->requests;
+        while (*link) {
+            GLFMAssetRequest *request = *link;
+            if (request->id == requestID) {
+                *link = request->next;
+                free(request);
+                // Loads running on a worker thread are removed when completed, and delivering loads when delivered
+                if (!load->requests &&
+                    (load->state == GLFMAssetLoadStatePending || load->state == GLFMAssetLoadStateReady)) {
+                    glfm__assetLoadRemove(display, load);
+                }
+                return true;
+            }
+            link = &request->next;
+        }
+    }
+    return false;
+}
+
+void glfmSetAssetMemoryBudget(GLFMDisplay *display, size_t budget) {
+    if (display) {
+        display->assetLoader.memoryBudget = budget;
+    }
+}
+
+size_t glfmGetAssetMemoryBudget(const GLFMDisplay *display) {
+    return display ? display->assetLoader.memoryBudget : 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,6 +5,7 @@
 # Android: Requires ANDROID_NDK_HOME set.
 # Apple: Requires xcodebuild.
 # Emscripten: Requires emcmake in the path.
+# Host tests: Requires Linux with Mesa's EGL and OpenGL ES libraries.
 #
 # For verbose mode, use:
 # ./build_all.sh -v
@@ -72,3 +73,9 @@ else
     run_test ./build_emscripten.sh
     run_test ./build_emscripten_examples.sh
 fi
+
+if [ "$(uname -s)" != "Linux" ]; then
+    echo "./build_host.sh: Skipped (not Linux)"
+else
+    run_test ./build_host.sh
+fi
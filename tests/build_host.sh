@@ -0,0 +1,8 @@
+#!/bin/sh
+#
+# Builds and runs the host tests (see host/CMakeLists.txt). Requires Linux with Mesa's EGL and OpenGL ES libraries.
+
+rm -rf build/host
+cmake -S host -B build/host || exit $?
+cmake --build build/host || exit $?
+ctest --test-dir build/host --output-on-failure
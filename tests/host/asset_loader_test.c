@@ -0,0 +1,349 @@
+// Tests the asynchronous asset loader (glfmLoadAssetAsync): priorities, coalescing, cancellation, and the memory
+// budget. Each frame is simulated by waiting for running loads, and then calling glfm__assetLoaderUpdate, like the
+// Android backend does before the render function.
+#include <stdlib.h>
+#include "glfm_host.h"
+#include "test.h"
+
+#define MAX_CALLBACKS 32
+#define WAIT_TIMEOUT 5.0
+
+typedef struct {
+    int userData;
+    const void *data; // Only valid during the callback
+    size_t size;
+    int lastByte; // -1 if no data
+} Callback;
+
+static struct {
+    Callback callbacks[MAX_CALLBACKS];
+    int count;
+    bool slow; // Use the whole delivery time slice in each callback
+} received;
+
+static void onAssetLoaded(GLFMDisplay *display, const char *path, const void *data, size_t size, void *userData) {
+    (void)display;
+    (void)path;
+    if (received.count < MAX_CALLBACKS) {
+        Callback *callback = &received.callbacks[received.count];
+        callback->userData = (int)(intptr_t)userData;
+        callback->data = data;
+        callback->size = size;
+        callback->lastByte = data && size > 0 ? ((const uint8_t *)data)[size - 1] : -1;
+    }
+    received.count++;
+    if (received.slow) {
+        usleep((useconds_t)(GLFM_ASSET_DELIVERY_TIME_SLICE * 1000000.0) + 1000);
+    }
+}
+
+static unsigned int loadAsset(GLFMDisplay *display, const char *path, int priority, int userData) {
+    return glfmLoadAssetAsync(display, path, priority, onAssetLoaded, (void *)(intptr_t)userData);
+}
+
+static bool writeFile(const char *path, size_t size) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    for (size_t i = 0; i < size; i++) {
+        fputc((int)(i & 0xff), file);
+    }
+    return fclose(file) == 0;
+}
+
+/// Creates a display with its own job pool.
+static GLFMDisplay *createDisplay(int workerCount) {
+    glfmHostWorkerCount = workerCount;
+    GLFMDisplay *display = calloc(1, sizeof(GLFMDisplay));
+    memset(&received, 0, sizeof(received));
+    return display;
+}
+
+static GLFMAssetLoad *findLoad(GLFMDisplay *display, const char *path) {
+    for (GLFMAssetLoad *load = display->assetLoader.loads; load; load = load->next) {
+        if (strcmp(load->path, path) == 0) {
+            return load;
+        }
+    }
+    return NULL;
+}
+
+/// Waits for loads running on worker threads, and calls their completion functions.
+static void waitForLoads(GLFMDisplay *display) {
+    double startTime = glfmGetTime();
+    glfm__jobPoolDrainCompletions(display);
+    while (display->assetLoader.loadingCount > 0 && glfmGetTime() - startTime < WAIT_TIMEOUT) {
+        usleep(1000);
+        glfm__jobPoolDrainCompletions(display);
+    }
+    CHECK(display->assetLoader.loadingCount == 0);
+}
+
+static void runFrame(GLFMDisplay *display) {
+    waitForLoads(display);
+    glfm__assetLoaderUpdate(display);
+}
+
+/// Runs frames until all loads are delivered. Returns the number of frames.
+static int runFrames(GLFMDisplay *display) {
+    int frameCount = 0;
+    while (display->assetLoader.loads && frameCount < 100) {
+        runFrame(display);
+        frameCount++;
+    }
+    CHECK(display->assetLoader.loads == NULL);
+    return frameCount;
+}
+
+/// Returns true if no assets are mapped.
+static bool allUnmapped(GLFMDisplay *display) {
+    return display->assetMappings == NULL && display->assetLoader.readyBytes == 0;
+}
+
+// MARK: - Tests
+
+static void testPriority(void) {
+    // One worker, so loads start one at a time in priority order
+    GLFMDisplay *display = createDisplay(1);
+    CHECK(loadAsset(display, "a.bin", 0, 1) != 0);
+    CHECK(loadAsset(display, "b.bin", 5, 2) != 0);
+    CHECK(loadAsset(display, "c.bin", 2, 3) != 0);
+    CHECK(loadAsset(display, "d.bin", 5, 4) != 0); // Same priority as b.bin, requested later
+    CHECK(loadAsset(display, "e.bin", -1, 5) != 0);
+    CHECK(loadAsset(display, "f.bin", 1, 6) != 0);
+    CHECK(loadAsset(display, "f.bin", 3, 7) != 0); // Raises the priority of f.bin
+    runFrames(display);
+
+    static const int expected[] = { 2, 4, 6, 7, 3, 1, 5 };
+    CHECK(received.count == 7);
+    for (int i = 0; i < 7; i++) {
+        CHECK(received.callbacks[i].userData == expected[i]);
+    }
+    CHECK(allUnmapped(display));
+}
+
+static void testPriorityManyWorkers(void) {
+    // Loads that finish together are delivered in priority order
+    GLFMDisplay *display = createDisplay(4);
+    loadAsset(display, "a.bin", 0, 1);
+    loadAsset(display, "b.bin", 5, 2);
+    loadAsset(display, "c.bin", 2, 3);
+    loadAsset(display, "d.bin", 1, 4);
+    runFrame(display);
+    CHECK(display->assetLoader.loadingCount == 4);
+    waitForLoads(display);
+    CHECK(display->assetLoader.readyBytes == 7000);
+    runFrames(display);
+
+    static const int expected[] = { 2, 3, 4, 1 };
+    CHECK(received.count == 4);
+    for (int i = 0; i < 4; i++) {
+        CHECK(received.callbacks[i].userData == expected[i]);
+    }
+    CHECK(allUnmapped(display));
+}
+
+static void testCoalescing(void) {
+    GLFMDisplay *display = createDisplay(2);
+    int mapCount = atomic_load(&glfmHostAssetMapCount);
+    unsigned int ids[4];
+    ids[0] = loadAsset(display, "a.bin", 0, 1);
+    ids[1] = loadAsset(display, "a.bin", 0, 2);
+    ids[2] = loadAsset(display, "b.bin", 0, 3);
+    ids[3] = loadAsset(display, "a.bin", 0, 4);
+    CHECK(ids[0] != 0 && ids[1] != ids[0] && ids[2] != ids[1] && ids[3] != ids[2]);
+    runFrames(display);
+
+    // One read per asset, one callback per request, in request order
+    CHECK(atomic_load(&glfmHostAssetMapCount) - mapCount == 2);
+    CHECK(received.count == 4);
+    const Callback *a[3] = { NULL, NULL, NULL };
+    int aCount = 0;
+    for (int i = 0; i < received.count && i < MAX_CALLBACKS; i++) {
+        const Callback *callback = &received.callbacks[i];
+        if (callback->userData == 3) {
+            CHECK(callback->data != NULL && callback->size == 2000);
+        } else if (aCount < 3) {
+            a[aCount++] = callback;
+        }
+    }
+    CHECK(aCount == 3);
+    if (aCount == 3) {
+        CHECK(a[0]->userData == 1 && a[1]->userData == 2 && a[2]->userData == 4);
+        CHECK(a[0]->data != NULL && a[0]->size == 1000);
+        CHECK(a[1]->data == a[0]->data && a[2]->data == a[0]->data);
+        CHECK(a[1]->size == a[0]->size && a[2]->size == a[0]->size);
+        CHECK(a[0]->lastByte == (999 & 0xff));
+    }
+    CHECK(allUnmapped(display));
+
+    // A new request after delivery is a new load
+    loadAsset(display, "a.bin", 0, 5);
+    runFrames(display);
+    CHECK(atomic_load(&glfmHostAssetMapCount) - mapCount == 3);
+    CHECK(received.count == 5);
+
+    // Missing assets are delivered as failed loads
+    loadAsset(display, "missing.bin", 0, 6);
+    loadAsset(display, "missing.bin", 0, 7);
+    runFrames(display);
+    CHECK(received.count == 7);
+    CHECK(received.callbacks[5].data == NULL && received.callbacks[5].size == 0);
+    CHECK(received.callbacks[6].data == NULL && received.callbacks[6].size == 0);
+
+    // Invalid arguments
+    CHECK(glfmLoadAssetAsync(display, "", 0, onAssetLoaded, NULL) == 0);
+    CHECK(glfmLoadAssetAsync(display, NULL, 0, onAssetLoaded, NULL) == 0);
+    CHECK(glfmLoadAssetAsync(display, "a.bin", 0, NULL, NULL) == 0);
+    CHECK(display->assetLoader.loads == NULL);
+}
+
+static void testCancel(void) {
+    GLFMDisplay *display = createDisplay(1);
+    int mapCount = atomic_load(&glfmHostAssetMapCount);
+
+    // Pending: removed without being read
+    unsigned int id = loadAsset(display, "a.bin", 0, 1);
+    CHECK(glfmCancelAssetLoad(display, id));
+    CHECK(!glfmCancelAssetLoad(display, id));
+    CHECK(findLoad(display, "a.bin") == NULL);
+    runFrames(display);
+    CHECK(atomic_load(&glfmHostAssetMapCount) == mapCount);
+    CHECK(received.count == 0);
+
+    // Loading: the load finishes on the worker thread, and is unmapped without being delivered
+    unsigned int id1 = loadAsset(display, "a.bin", 0, 2);
+    unsigned int id2 = loadAsset(display, "a.bin", 0, 3);
+    glfm__assetLoaderUpdate(display);
+    GLFMAssetLoad *load = findLoad(display, "a.bin");
+    CHECK(load && load->state == GLFMAssetLoadStateLoading);
+    CHECK(glfmCancelAssetLoad(display, id1));
+    CHECK(glfmCancelAssetLoad(display, id2));
+    CHECK(findLoad(display, "a.bin") == load);
+    waitForLoads(display);
+    CHECK(findLoad(display, "a.bin") == NULL);
+    runFrames(display);
+    CHECK(atomic_load(&glfmHostAssetMapCount) == mapCount + 1);
+    CHECK(received.count == 0);
+    CHECK(allUnmapped(display));
+
+    // Ready: unmapped before delivery
+    id = loadAsset(display, "b.bin", 0, 4);
+    runFrame(display);
+    waitForLoads(display);
+    load = findLoad(display, "b.bin");
+    CHECK(load && load->state == GLFMAssetLoadStateReady);
+    CHECK(display->assetMappings != NULL && display->assetLoader.readyBytes == 2000);
+    CHECK(glfmCancelAssetLoad(display, id));
+    CHECK(findLoad(display, "b.bin") == NULL);
+    CHECK(allUnmapped(display));
+    runFrames(display);
+    CHECK(received.count == 0);
+
+    // Cancelling one of several requests: the others are still delivered
+    id1 = loadAsset(display, "a.bin", 0, 5);
+    id2 = loadAsset(display, "a.bin", 0, 6);
+    runFrame(display);
+    CHECK(glfmCancelAssetLoad(display, id1));
+    runFrames(display);
+    CHECK(received.count == 1 && received.callbacks[0].userData == 6);
+    CHECK(!glfmCancelAssetLoad(display, id2));
+    CHECK(allUnmapped(display));
+}
+
+static void testMemoryBudget(void) {
+    // Four workers, so four loads finish together, and slow callbacks, so one is delivered per frame
+    GLFMDisplay *display = createDisplay(4);
+    glfmSetAssetMemoryBudget(display, 3000);
+    CHECK(glfmGetAssetMemoryBudget(display) == 3000);
+    received.slow = true;
+    loadAsset(display, "b.bin", 6, 1); // 2000 bytes each
+    loadAsset(display, "c.bin", 5, 2);
+    loadAsset(display, "d.bin", 4, 3);
+    loadAsset(display, "e.bin", 3, 4);
+    loadAsset(display, "f.bin", 2, 5);
+    loadAsset(display, "g.bin", 1, 6);
+
+    // Frame 1: four loads start
+    runFrame(display);
+    CHECK(display->assetLoader.loadingCount == 4);
+    CHECK(findLoad(display, "f.bin")->state == GLFMAssetLoadStatePending);
+
+    // Frame 2: 8000 bytes ready. One is delivered, leaving 6000, over the budget.
+    runFrame(display);
+    CHECK(received.count == 1);
+    CHECK(display->assetLoader.readyBytes == 6000);
+    CHECK(display->assetLoader.loadingCount == 0);
+    CHECK(findLoad(display, "f.bin")->state == GLFMAssetLoadStatePending);
+
+    // Frame 3: 4000 bytes ready, still over the budget
+    runFrame(display);
+    CHECK(received.count == 2);
+    CHECK(display->assetLoader.readyBytes == 4000);
+    CHECK(display->assetLoader.loadingCount == 0);
+
+    // Frame 4: 2000 bytes ready, within the budget, so the held loads start
+    runFrame(display);
+    CHECK(received.count == 3);
+    CHECK(display->assetLoader.readyBytes == 2000);
+    CHECK(display->assetLoader.loadingCount == 2);
+    CHECK(findLoad(display, "f.bin")->state == GLFMAssetLoadStateLoading);
+    CHECK(findLoad(display, "g.bin")->state == GLFMAssetLoadStateLoading);
+
+    runFrames(display);
+    CHECK(received.count == 6);
+    for (int i = 0; i < 6; i++) {
+        CHECK(received.callbacks[i].userData == i + 1);
+    }
+    CHECK(allUnmapped(display));
+
+    // Without a budget, loads start while others wait for delivery
+    glfmSetAssetMemoryBudget(display, 0);
+    received.count = 0;
+    loadAsset(display, "b.bin", 2, 1);
+    loadAsset(display, "c.bin", 2, 2);
+    loadAsset(display, "d.bin", 1, 3);
+    loadAsset(display, "e.bin", 1, 4);
+    loadAsset(display, "f.bin", 0, 5);
+    runFrame(display);
+    runFrame(display);
+    CHECK(received.count == 1);
+    CHECK(display->assetLoader.loadingCount == 1);
+    received.slow = false;
+    runFrames(display);
+    CHECK(received.count == 5);
+    CHECK(allUnmapped(display));
+}
+
+int main(void) {
+    char directory[] = "/tmp/glfm_asset_loader_XXXXXX";
+    if (!mkdtemp(directory) || chdir(directory) != 0) {
+        fprintf(stderr, "Couldn't create a temporary directory\n");
+        return 1;
+    }
+    static const char *const paths[] = { "a.bin", "b.bin", "c.bin", "d.bin", "e.bin", "f.bin", "g.bin" };
+    static const size_t sizes[] = { 1000, 2000, 2000, 2000, 2000, 2000, 2000 };
+    const int fileCount = (int)(sizeof(paths) / sizeof(*paths));
+    for (int i = 0; i < fileCount; i++) {
+        if (!writeFile(paths[i], sizes[i])) {
+            fprintf(stderr, "Couldn't write %s\n", paths[i]);
+            return 1;
+        }
+    }
+
+    testPriority();
+    testPriorityManyWorkers();
+    testCoalescing();
+    testCancel();
+    testMemoryBudget();
+
+    for (int i = 0; i < fileCount; i++) {
+        unlink(paths[i]);
+    }
+    if (chdir("/") == 0) {
+        rmdir(directory);
+    }
+    // Worker threads exist for the lifetime of the process, like on Android
+    return testResult();
+}
@@ -0,0 +1,451 @@
+// Tests the asset pack reader (examples/asset_pack.c) with packs created by the writer (examples/asset_pack_writer.c),
+// and with truncated or corrupt packs and LZ4 blocks built by hand.
+#include <stdlib.h>
+#include <string.h>
+#include "asset_pack.h"
+#include "asset_pack_writer.h"
+#include "test.h"
+
+#define HEADER_SIZE 24
+#define ENTRIES_OFFSET (HEADER_SIZE + 256 * 4)
+#define ENTRY_SIZE 32
+
+typedef struct {
+    const char *path;
+    uint8_t *data;
+    size_t size;
+} TestAsset;
+
+static uint32_t readU32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t readU64(const uint8_t *p) {
+    return (uint64_t)readU32(p) | ((uint64_t)readU32(p + 4) << 32);
+}
+
+static void writeU16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void writeU32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(value >> (i * 8));
+    }
+}
+
+static void writeU64(uint8_t *p, uint64_t value) {
+    writeU32(p, (uint32_t)value);
+    writeU32(p + 4, (uint32_t)(value >> 32));
+}
+
+/// Rewrites the fan-out table from the hashes in the entries.
+static void writeFanout(uint8_t *pack, uint32_t entryCount) {
+    uint32_t counts[256] = { 0 };
+    for (uint32_t i = 0; i < entryCount; i++) {
+        counts[readU64(pack + ENTRIES_OFFSET + i * ENTRY_SIZE) >> 56]++;
+    }
+    uint32_t total = 0;
+    for (int i = 0; i < 256; i++) {
+        total += counts[i];
+        writeU32(pack + HEADER_SIZE + i * 4, total);
+    }
+}
+
+/// Fills `size` bytes with a pattern. Compressible patterns repeat short runs; the others are pseudo-random.
+static uint8_t *createData(size_t size, uint32_t seed, bool compressible) {
+    uint8_t *data = malloc(size > 0 ? size : 1);
+    uint32_t state = seed * 2654435761u + 1;
+    for (size_t i = 0; i < size; i++) {
+        state = state * 1664525u + 1013904223u;
+        data[i] = compressible ? (uint8_t)("abcabcabd"[(i / 3 + seed) % 9] + (i / 4096)) : (uint8_t)(state >> 24);
+    }
+    return data;
+}
+
+/// Creates a pack with the writer. Returns NULL on failure.
+static uint8_t *createPack(const TestAsset *assets, int assetCount, bool compress, size_t *size) {
+    AssetPackWriter *writer = assetPackWriterCreate();
+    CHECK(writer != NULL);
+    if (!writer) {
+        return NULL;
+    }
+    for (int i = 0; i < assetCount; i++) {
+        CHECK(assetPackWriterAdd(writer, assets[i].path, assets[i].data, assets[i].size, compress));
+    }
+    uint8_t *pack = assetPackWriterFinish(writer, size);
+    CHECK(pack != NULL);
+    assetPackWriterDestroy(writer);
+    return pack;
+}
+
+// MARK: - Round trip
+
+static void testRoundTrip(bool compress) {
+    TestAsset assets[] = {
+        { "shaders/texture.vert", NULL, 300 },
+        { "shaders/texture.frag", NULL, 17 },
+        { "textures/wood.ktx2", NULL, 100000 },
+        { "textures/noise.bin", NULL, 5000 },
+        { "empty.txt", NULL, 0 },
+        { "tiny", NULL, 3 },
+    };
+    const int assetCount = (int)(sizeof(assets) / sizeof(*assets));
+    for (int i = 0; i < assetCount; i++) {
+        assets[i].data = createData(assets[i].size, (uint32_t)i, strstr(assets[i].path, "noise") == NULL);
+    }
+
+    size_t packSize = 0;
+    uint8_t *packData = createPack(assets, assetCount, compress, &packSize);
+    AssetPack pack;
+    CHECK(packData && assetPackOpen(&pack, packData, packSize));
+    CHECK(pack.entryCount == (uint32_t)assetCount);
+
+    for (int i = 0; i < assetCount; i++) {
+        AssetPackEntry entry;
+        CHECK(assetPackFind(&pack, assets[i].path, &entry));
+        CHECK(strcmp(entry.path, assets[i].path) == 0);
+        CHECK(entry.size == assets[i].size);
+        CHECK((size_t)(entry.data - packData) % ASSET_PACK_ALIGNMENT == 0);
+
+        // Compressed only if requested, and only if it's worth it
+        if (!compress || strstr(assets[i].path, "noise") || assets[i].size < 4) {
+            CHECK(entry.compression == AssetPackCompressionNone);
+        } else if (strstr(assets[i].path, "wood")) {
+            CHECK(entry.compression == AssetPackCompressionLZ4);
+        }
+        if (entry.compression == AssetPackCompressionLZ4) {
+            CHECK(entry.storedSize < entry.size - entry.size / 8);
+        } else {
+            CHECK(entry.storedSize == entry.size);
+        }
+
+        uint8_t *decompressed = malloc(entry.size + 1);
+        CHECK(assetPackDecompress(&entry, decompressed, entry.size));
+        CHECK(memcmp(decompressed, assets[i].data, assets[i].size) == 0);
+        if (entry.size > 0) {
+            CHECK(!assetPackDecompress(&entry, decompressed, entry.size - 1));
+        }
+        free(decompressed);
+    }
+
+    // Listing, in hash order
+    uint64_t previousHash = 0;
+    for (uint32_t i = 0; i < pack.entryCount; i++) {
+        AssetPackEntry entry;
+        CHECK(assetPackGetEntry(&pack, i, &entry));
+        uint64_t hash = assetPackHash(entry.path);
+        CHECK(hash >= previousHash);
+        previousHash = hash;
+    }
+    AssetPackEntry entry;
+    CHECK(!assetPackGetEntry(&pack, pack.entryCount, &entry));
+    CHECK(!assetPackFind(&pack, "shaders/missing.vert", &entry));
+    CHECK(!assetPackFind(&pack, "shaders", &entry));
+    CHECK(!assetPackFind(&pack, "", &entry));
+    CHECK(!assetPackFind(&pack, NULL, &entry));
+
+    free(packData);
+    for (int i = 0; i < assetCount; i++) {
+        free(assets[i].data);
+    }
+}
+
+static void testWriter(void) {
+    AssetPackWriter *writer = assetPackWriterCreate();
+    uint8_t data[4] = { 1, 2, 3, 4 };
+    CHECK(assetPackWriterAdd(writer, "a", data, sizeof(data), false));
+    CHECK(!assetPackWriterAdd(writer, "a", data, sizeof(data), false));
+    CHECK(!assetPackWriterAdd(writer, "", data, sizeof(data), false));
+    CHECK(!assetPackWriterAdd(writer, NULL, data, sizeof(data), false));
+    CHECK(!assetPackWriterAdd(writer, "b", NULL, sizeof(data), false));
+    assetPackWriterDestroy(writer);
+
+    // An empty pack
+    writer = assetPackWriterCreate();
+    size_t packSize = 0;
+    uint8_t *packData = assetPackWriterFinish(writer, &packSize);
+    AssetPack pack;
+    AssetPackEntry entry;
+    CHECK(packData && assetPackOpen(&pack, packData, packSize));
+    CHECK(pack.entryCount == 0);
+    CHECK(!assetPackFind(&pack, "a", &entry));
+    free(packData);
+    assetPackWriterDestroy(writer);
+}
+
+// MARK: - Hash collisions
+
+static void testHashCollision(void) {
+    uint8_t dataA[] = "first";
+    uint8_t dataB[] = "second";
+    TestAsset assets[] = {
+        { "collision/a", dataA, sizeof(dataA) },
+        { "collision/b", dataB, sizeof(dataB) },
+    };
+    size_t packSize = 0;
+    uint8_t *packData = createPack(assets, 2, false, &packSize);
+    if (!packData) {
+        return;
+    }
+    // Give the first entry the second entry's hash, so a lookup of the second entry's path finds the first entry
+    // before it. Entries stay sorted by hash.
+    uint8_t *entry0 = packData + ENTRIES_OFFSET;
+    uint8_t *entry1 = entry0 + ENTRY_SIZE;
+    char *path0 = (char *)packData + ENTRIES_OFFSET + 2 * ENTRY_SIZE;
+    const char *path1 = path0 + strlen(path0) + 1;
+    CHECK(readU64(entry0) < readU64(entry1));
+    writeU64(entry0, readU64(entry1));
+    writeFanout(packData, 2);
+
+    AssetPack pack;
+    AssetPackEntry entry;
+    CHECK(assetPackOpen(&pack, packData, packSize));
+    CHECK(assetPackFind(&pack, path1, &entry));
+    CHECK(strcmp(entry.path, path1) == 0);
+    CHECK(memcmp(entry.data, strcmp(path1, "collision/a") == 0 ? dataA : dataB, entry.size) == 0);
+    // The first entry's real hash is no longer in the index
+    CHECK(!assetPackFind(&pack, path0, &entry));
+
+    // Both entries have the same hash and path: the first is found
+    memcpy(path0, path1, strlen(path1));
+    CHECK(assetPackFind(&pack, path1, &entry));
+    CHECK(entry.path == path0);
+    free(packData);
+}
+
+// MARK: - LZ4
+
+static bool decompressLZ4(const uint8_t *block, size_t blockSize, uint8_t *dst, size_t dstSize) {
+    AssetPackEntry entry = {
+        .path = "block", .data = block, .storedSize = blockSize, .size = dstSize,
+        .compression = AssetPackCompressionLZ4,
+    };
+    return assetPackDecompress(&entry, dst, dstSize);
+}
+
+static void testLZ4OverlappingMatches(void) {
+    uint8_t out[64];
+
+    // Offset 1 repeats one byte. Match length 20 uses an extra length byte (15 + 1 + 4).
+    static const uint8_t run[] = { 0x1f, 'x', 0x01, 0x00, 0x01, 0x10, 'y' };
+    CHECK(decompressLZ4(run, sizeof(run), out, 22));
+    for (int i = 0; i < 21; i++) {
+        CHECK(out[i] == 'x');
+    }
+    CHECK(out[21] == 'y');
+
+    // Offset 2, match length 10, with the match starting in the literals and continuing in its own output
+    static const uint8_t pattern[] = { 0x26, 'a', 'b', 0x02, 0x00, 0x10, 'c' };
+    CHECK(decompressLZ4(pattern, sizeof(pattern), out, 13));
+    CHECK(memcmp(out, "ababababababc", 13) == 0);
+
+    // A match that doesn't overlap, after a long literal run (15 + 5 literals)
+    static const uint8_t literals[] = {
+        0xf0, 0x05, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't',
+        0x0e, 0x00
+    };
+    CHECK(decompressLZ4(literals, sizeof(literals), out, 24));
+    CHECK(memcmp(out, "abcdefghijklmnopqrstghij", 24) == 0);
+
+    // The compressor's output for data with overlapping repeats
+    uint8_t src[4096];
+    for (size_t i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)(i < 7 ? 'a' + i : (i % 997 < 500 ? src[i - 1] : src[i - 7]));
+    }
+    uint8_t compressed[sizeof(src)];
+    uint8_t decompressed[sizeof(src)];
+    size_t compressedSize = assetPackCompressLZ4(src, sizeof(src), compressed, sizeof(compressed));
+    CHECK(compressedSize > 0 && compressedSize < sizeof(src) / 8);
+    CHECK(decompressLZ4(compressed, compressedSize, decompressed, sizeof(decompressed)));
+    CHECK(memcmp(src, decompressed, sizeof(src)) == 0);
+}
+
+static void testLZ4Corrupt(void) {
+    uint8_t out[64];
+
+    // Match offset 0
+    static const uint8_t offsetZero[] = { 0x10, 'a', 0x00, 0x00, 0x10, 'b' };
+    CHECK(!decompressLZ4(offsetZero, sizeof(offsetZero), out, 6));
+
+    // Match offset past the start of the output
+    static const uint8_t offsetPastStart[] = { 0x10, 'a', 0x02, 0x00, 0x10, 'b' };
+    CHECK(!decompressLZ4(offsetPastStart, sizeof(offsetPastStart), out, 6));
+
+    // Literal run past the end of the block. The bytes after the block aren't read.
+    static const uint8_t literalsPastEnd[] = { 0x50, 'a', 'b', 'c', 'd', 'e' };
+    memset(out, 0xee, sizeof(out));
+    CHECK(!decompressLZ4(literalsPastEnd, 3, out, 5));
+    CHECK(out[0] == 0xee && out[2] == 0xee);
+
+    // Literal length bytes past the end of the block
+    static const uint8_t literalLengthPastEnd[] = { 0xf0, 0xff };
+    CHECK(!decompressLZ4(literalLengthPastEnd, sizeof(literalLengthPastEnd), out, sizeof(out)));
+
+    // Match offset cut off
+    static const uint8_t offsetCut[] = { 0x10, 'a', 0x01 };
+    CHECK(!decompressLZ4(offsetCut, sizeof(offsetCut), out, 5));
+
+    // Match length bytes past the end of the block
+    static const uint8_t matchLengthPastEnd[] = { 0x1f, 'a', 0x01, 0x00 };
+    CHECK(!decompressLZ4(matchLengthPastEnd, sizeof(matchLengthPastEnd), out, 20));
+
+    // Output larger than the entry's size: literals, then a match
+    static const uint8_t pattern[] = { 0x26, 'a', 'b', 0x02, 0x00, 0x10, 'c' };
+    CHECK(!decompressLZ4(pattern, 3, out, 1));
+    CHECK(!decompressLZ4(pattern, sizeof(pattern), out, 11));
+    // Output smaller than the entry's size
+    CHECK(!decompressLZ4(pattern, sizeof(pattern), out, 14));
+    CHECK(decompressLZ4(pattern, sizeof(pattern), out, 13));
+
+    // Every prefix of a valid block is rejected
+    static const uint8_t run[] = { 0x1f, 'x', 0x01, 0x00, 0x01, 0x10, 'y' };
+    for (size_t length = 0; length < sizeof(run); length++) {
+        CHECK(!decompressLZ4(run, length, out, 22));
+    }
+}
+
+// MARK: - Corrupt packs
+
+static void testCorruptPack(void) {
+    uint8_t data[100];
+    memset(data, 'd', sizeof(data));
+    TestAsset assets[] = {
+        { "one", data, sizeof(data) },
+        { "two", data, 50 },
+        { "three", data, 1 },
+    };
+    size_t packSize = 0;
+    uint8_t *original = createPack(assets, 3, false, &packSize);
+    uint8_t *packData = malloc(packSize);
+    if (!original || !packData) {
+        free(original);
+        free(packData);
+        return;
+    }
+    AssetPack pack;
+    AssetPackEntry entry;
+
+#define RESET() memcpy(packData, original, packSize)
+
+    RESET();
+    CHECK(assetPackOpen(&pack, packData, packSize));
+    CHECK(!assetPackOpen(&pack, NULL, packSize));
+
+    // Header
+    packData[0] = 'X';
+    CHECK(!assetPackOpen(&pack, packData, packSize));
+    CHECK(pack.data == NULL && !assetPackFind(&pack, "one", &entry));
+    RESET();
+    writeU32(packData + 8, ASSET_PACK_VERSION + 1);
+    CHECK(!assetPackOpen(&pack, packData, packSize));
+    RESET();
+    writeU32(packData + 12, 4);
+    CHECK(!assetPackOpen(&pack, packData, packSize));
+    RESET();
+    writeU32(packData + 12, UINT32_MAX);
+    writeU32(packData + HEADER_SIZE + 255 * 4, UINT32_MAX);
+    CHECK(!assetPackOpen(&pack, packData, packSize));
+
+    // Every prefix is rejected, since the header has the file size
+    RESET();
+    for (size_t length = 0; length < packSize; length++) {
+        CHECK(!assetPackOpen(&pack, packData, length));
+    }
+
+    // A file size that matches a truncated file: the index or entries past the end are rejected
+    for (size_t length = 0; length < packSize; length++) {
+        RESET();
+        writeU64(packData + 16, length);
+        if (!assetPackOpen(&pack, packData, length)) {
+            continue;
+        }
+        for (uint32_t i = 0; i < pack.entryCount; i++) {
+            if (assetPackGetEntry(&pack, i, &entry)) {
+                CHECK(entry.data + entry.storedSize <= packData + length);
+                CHECK((const uint8_t *)entry.path + strlen(entry.path) < packData + length);
+            }
+        }
+    }
+
+    // Fan-out not increasing
+    RESET();
+    writeU32(packData + HEADER_SIZE + 100 * 4, 3);
+    writeU32(packData + HEADER_SIZE + 101 * 4, 0);
+    CHECK(!assetPackOpen(&pack, packData, packSize));
+    // Fan-out total doesn't match the entry count
+    RESET();
+    writeU32(packData + HEADER_SIZE + 255 * 4, 2);
+    CHECK(!assetPackOpen(&pack, packData, packSize));
+
+    // Entries. Corrupt entries are skipped by lookups.
+    for (uint32_t i = 0; i < 3; i++) {
+        uint8_t *p = packData + ENTRIES_OFFSET + i * ENTRY_SIZE;
+
+        // Name past the end of the file
+        RESET();
+        writeU32(p + 24, (uint32_t)packSize - 2);
+        writeU16(p + 28, 5);
+        CHECK(assetPackOpen(&pack, packData, packSize));
+        CHECK(!assetPackGetEntry(&pack, i, &entry));
+        RESET();
+        writeU32(p + 24, UINT32_MAX);
+        CHECK(assetPackOpen(&pack, packData, packSize));
+        CHECK(!assetPackGetEntry(&pack, i, &entry));
+        RESET();
+        writeU16(p + 28, UINT16_MAX);
+        CHECK(assetPackOpen(&pack, packData, packSize));
+        CHECK(!assetPackGetEntry(&pack, i, &entry));
+
+        // Name not null-terminated
+        RESET();
+        writeU16(p + 28, (uint16_t)(p[28] - 1));
+        CHECK(assetPackOpen(&pack, packData, packSize));
+        CHECK(!assetPackGetEntry(&pack, i, &entry));
+
+        // Data past the end of the file
+        RESET();
+        writeU64(p + 8, packSize - readU32(p + 16) + 1);
+        CHECK(assetPackOpen(&pack, packData, packSize));
+        CHECK(!assetPackGetEntry(&pack, i, &entry));
+        RESET();
+        writeU64(p + 8, UINT64_MAX - 1);
+        CHECK(assetPackOpen(&pack, packData, packSize));
+        CHECK(!assetPackGetEntry(&pack, i, &entry));
+
+        // Unknown compression, or an uncompressed entry with a different size
+        RESET();
+        p[30] = 2;
+        CHECK(assetPackOpen(&pack, packData, packSize));
+        CHECK(!assetPackGetEntry(&pack, i, &entry));
+        RESET();
+        writeU32(p + 20, 1000);
+        CHECK(assetPackOpen(&pack, packData, packSize));
+        CHECK(!assetPackGetEntry(&pack, i, &entry));
+    }
+
+    // A corrupt entry isn't found by path
+    RESET();
+    CHECK(assetPackOpen(&pack, packData, packSize));
+    CHECK(assetPackGetEntry(&pack, 0, &entry));
+    char path[16];
+    snprintf(path, sizeof(path), "%s", entry.path);
+    writeU64(packData + ENTRIES_OFFSET + 8, packSize);
+    CHECK(!assetPackFind(&pack, path, &entry));
+
+#undef RESET
+    free(packData);
+    free(original);
+}
+
+int main(void) {
+    testRoundTrip(false);
+    testRoundTrip(true);
+    testWriter();
+    testHashCollision();
+    testLZ4OverlappingMatches();
+    testLZ4Corrupt();
+    testCorruptPack();
+    return testResult();
+}
@@ -0,0 +1,177 @@
+// Tests debug mode (glfmSetDebugEnabled) with a headless OpenGL ES debug context: message classification, the
+// per-frame and total counts, and routing to the debug message function or the log. Run with EGL_PLATFORM=surfaceless.
+#include "glfm_host.h"
+#include "test.h"
+
+#define TEST_SKIPPED 77
+
+#ifndef GL_DEBUG_SOURCE_APPLICATION_KHR
+#define GL_DEBUG_SOURCE_APPLICATION_KHR 0x824A
+#endif
+#ifndef GL_DEBUG_SEVERITY_MEDIUM_KHR
+#define GL_DEBUG_SEVERITY_MEDIUM_KHR 0x9147
+#endif
+
+typedef void (GL_APIENTRY *DebugMessageInsertFunc)(GLenum source, GLenum type, GLuint id, GLenum severity,
+                                                   GLsizei length, const GLchar *buf);
+
+static struct {
+    int counts[GLFM_NUM_DEBUG_MESSAGE_TYPES];
+    GLFMDisplay *lastDisplay;
+} received;
+
+static void onDebugMessage(GLFMDisplay *display, GLFMDebugMessageType type, const char *message) {
+    CHECK(message != NULL);
+    CHECK(type >= 0 && type < GLFM_NUM_DEBUG_MESSAGE_TYPES);
+    received.counts[type]++;
+    received.lastDisplay = display;
+}
+
+/// Causes one GL_INVALID_ENUM error.
+static void triggerError(void) {
+    glBindBuffer(0xdead, 0);
+}
+
+static void insertMessage(DebugMessageInsertFunc debugMessageInsert, GLenum type) {
+    debugMessageInsert(GL_DEBUG_SOURCE_APPLICATION_KHR, type, 1, GL_DEBUG_SEVERITY_MEDIUM_KHR, -1, "Test message");
+}
+
+static void testCallback(GLFMDisplay *display) {
+    DebugMessageInsertFunc debugMessageInsert =
+        (DebugMessageInsertFunc)glfmGetProcAddress("glDebugMessageInsertKHR");
+    CHECK(debugMessageInsert != NULL);
+    if (!debugMessageInsert) {
+        return;
+    }
+
+    // Disabled: nothing is installed or counted
+    glfm__debugBeginFrame(display);
+    CHECK(!display->debug.initialized);
+    triggerError();
+    glfm__debugEndFrame(display);
+    GLFMDebugStats stats;
+    glfmGetDebugStats(display, &stats);
+    CHECK(stats.totalCounts[GLFMDebugMessageTypeError] == 0);
+    glGetError();
+
+    // Frame 1: one error and two performance messages, routed to the debug message function
+    glfmSetDebugEnabled(display, true);
+    CHECK(glfmSetDebugMessageFunc(display, onDebugMessage) == NULL);
+    glfm__debugBeginFrame(display);
+    CHECK(display->debug.initialized);
+    CHECK(display->debug.callbackInstalled);
+    triggerError();
+    insertMessage(debugMessageInsert, GL_DEBUG_TYPE_PERFORMANCE_KHR);
+    insertMessage(debugMessageInsert, GL_DEBUG_TYPE_PERFORMANCE_KHR);
+    glfm__debugEndFrame(display);
+    glfmGetDebugStats(display, &stats);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypeError] == 1);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypePerformance] == 2);
+    CHECK(stats.totalCounts[GLFMDebugMessageTypeError] == 1);
+    CHECK(stats.totalCounts[GLFMDebugMessageTypePerformance] == 2);
+    CHECK(received.counts[GLFMDebugMessageTypeError] == 1);
+    CHECK(received.counts[GLFMDebugMessageTypePerformance] == 2);
+    CHECK(received.lastDisplay == display);
+
+    // Frame 2: each type is classified
+    glfm__debugBeginFrame(display);
+    insertMessage(debugMessageInsert, GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR_KHR);
+    insertMessage(debugMessageInsert, GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR_KHR);
+    insertMessage(debugMessageInsert, GL_DEBUG_TYPE_PORTABILITY_KHR);
+    insertMessage(debugMessageInsert, GL_DEBUG_TYPE_PERFORMANCE_KHR);
+    insertMessage(debugMessageInsert, 0x8251); // GL_DEBUG_TYPE_OTHER_KHR
+    glfm__debugEndFrame(display);
+    glfmGetDebugStats(display, &stats);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypeError] == 0);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypeDeprecatedBehavior] == 1);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypeUndefinedBehavior] == 1);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypePortability] == 1);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypePerformance] == 1);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypeOther] == 1);
+    CHECK(stats.totalCounts[GLFMDebugMessageTypeError] == 1);
+    CHECK(stats.totalCounts[GLFMDebugMessageTypePerformance] == 3);
+
+    // Frame 3: no messages. The last frame counts are cleared; the totals are kept.
+    glfm__debugBeginFrame(display);
+    glfm__debugEndFrame(display);
+    glfmGetDebugStats(display, &stats);
+    for (int i = 0; i < GLFM_NUM_DEBUG_MESSAGE_TYPES; i++) {
+        CHECK(stats.lastFrameCounts[i] == 0);
+    }
+    CHECK(stats.totalCounts[GLFMDebugMessageTypePerformance] == 3);
+
+    // Notifications are not reported
+    glfm__debugBeginFrame(display);
+    debugMessageInsert(GL_DEBUG_SOURCE_APPLICATION_KHR, GL_DEBUG_TYPE_PERFORMANCE_KHR, 2,
+                       GL_DEBUG_SEVERITY_NOTIFICATION_KHR, -1, "Notification");
+    glfm__debugEndFrame(display);
+    glfmGetDebugStats(display, &stats);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypePerformance] == 0);
+
+    // Without a debug message function, messages are logged
+    CHECK(glfmSetDebugMessageFunc(display, NULL) == onDebugMessage);
+    int logCount = glfmHostLogCount;
+    int receivedCount = received.counts[GLFMDebugMessageTypeError];
+    glfm__debugBeginFrame(display);
+    triggerError();
+    glfm__debugEndFrame(display);
+    CHECK(glfmHostLogCount == logCount + 1);
+    CHECK(received.counts[GLFMDebugMessageTypeError] == receivedCount);
+    glfmGetDebugStats(display, &stats);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypeError] == 1);
+    CHECK(stats.totalCounts[GLFMDebugMessageTypeError] == 2);
+}
+
+static void testWithoutCallback(GLFMDisplay *display) {
+    // Without GL_KHR_debug, errors are found with glGetError after each frame
+    glfmSetDebugEnabled(display, true);
+    glfmSetDebugMessageFunc(display, onDebugMessage);
+    glfm__debugReset(display);
+    glfm__debugBeginFrame(display);
+    CHECK(display->debug.initialized);
+    glDisable(GL_DEBUG_OUTPUT_KHR);
+    display->debug.callbackInstalled = false;
+    GLFMDebugStats before;
+    glfmGetDebugStats(display, &before);
+    int receivedCount = received.counts[GLFMDebugMessageTypeError];
+
+    triggerError();
+    glfm__debugEndFrame(display);
+    GLFMDebugStats stats;
+    glfmGetDebugStats(display, &stats);
+    CHECK(stats.lastFrameCounts[GLFMDebugMessageTypeError] == 1);
+    CHECK(stats.totalCounts[GLFMDebugMessageTypeError] == before.totalCounts[GLFMDebugMessageTypeError] + 1);
+    CHECK(received.counts[GLFMDebugMessageTypeError] == receivedCount + 1);
+    CHECK(glGetError() == GL_NO_ERROR);
+
+    // Disabled: glGetError isn't checked
+    glfmSetDebugEnabled(display, false);
+    triggerError();
+    glfm__debugEndFrame(display);
+    CHECK(glGetError() == GL_INVALID_ENUM);
+}
+
+int main(void) {
+    // No display
+    GLFMDebugStats stats;
+    memset(&stats, 0xff, sizeof(stats));
+    glfmGetDebugStats(NULL, &stats);
+    CHECK(stats.totalCounts[GLFMDebugMessageTypeError] == 0);
+
+    if (!glfmHostCreateContext(true)) {
+        fprintf(stderr, "Skipped debug tests: no EGL context\n");
+        return testFailureCount > 0 ? testResult() : TEST_SKIPPED;
+    }
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    if (!extensions || !strstr(extensions, "GL_KHR_debug")) {
+        fprintf(stderr, "Skipped debug tests: GL_KHR_debug not available\n");
+        glfmHostDestroyContext();
+        return testFailureCount > 0 ? testResult() : TEST_SKIPPED;
+    }
+    GLFMDisplay *display = calloc(1, sizeof(GLFMDisplay));
+    testCallback(display);
+    testWithoutCallback(display);
+    free(display);
+    glfmHostDestroyContext();
+    return testResult();
+}
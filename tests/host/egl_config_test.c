@@ -0,0 +1,181 @@
+// Tests EGL config scoring and the config cache (glfm_egl.h), with synthetic attributes and with the configs of the
+// host's EGL implementation. Run with EGL_PLATFORM=surfaceless.
+#include <stdlib.h>
+#include <unistd.h>
+#include "glfm_egl.h"
+#include "test.h"
+
+#define TEST_SKIPPED 77
+
+static GLFMEGLConfigAttribs makeAttribs(EGLint red, EGLint green, EGLint blue, EGLint alpha, EGLint depth,
+                                        EGLint stencil, EGLint samples) {
+    GLFMEGLConfigAttribs attribs = {
+        .red = red, .green = green, .blue = blue, .alpha = alpha,
+        .depth = depth, .stencil = stencil, .samples = samples,
+        .surfaceType = EGL_PBUFFER_BIT, .caveat = EGL_NONE,
+    };
+    return attribs;
+}
+
+static void testScoring(void) {
+    const GLFMEGLConfigAttribs rgb8Depth24 = makeAttribs(8, 8, 8, 0, 24, 0, 0);
+    const GLFMEGLConfigAttribs exact = rgb8Depth24;
+    const GLFMEGLConfigAttribs tenBit = makeAttribs(10, 10, 10, 2, 24, 0, 0);
+    const GLFMEGLConfigAttribs depth32 = makeAttribs(8, 8, 8, 0, 32, 0, 0);
+    const GLFMEGLConfigAttribs depth16 = makeAttribs(8, 8, 8, 0, 16, 0, 0);
+    const GLFMEGLConfigAttribs rgb565 = makeAttribs(5, 6, 5, 0, 24, 0, 0);
+    const GLFMEGLConfigAttribs multisampled = makeAttribs(8, 8, 8, 0, 24, 0, 4);
+
+    CHECK(glfm__eglScoreAttribs(&rgb8Depth24, &exact) == 0);
+
+    // Extra color and depth bits cost bandwidth
+    CHECK(glfm__eglScoreAttribs(&rgb8Depth24, &tenBit) > 0);
+    CHECK(glfm__eglScoreAttribs(&rgb8Depth24, &depth32) > 0);
+    CHECK(glfm__eglScoreAttribs(&rgb8Depth24, &multisampled) > 0);
+
+    // Extra bits are better than missing bits
+    CHECK(glfm__eglScoreAttribs(&rgb8Depth24, &depth32) < glfm__eglScoreAttribs(&rgb8Depth24, &depth16));
+    CHECK(glfm__eglScoreAttribs(&rgb8Depth24, &tenBit) < glfm__eglScoreAttribs(&rgb8Depth24, &rgb565));
+
+    // Missing depth is a fallback, but missing color or stencil is not
+    CHECK(glfm__eglScoreAttribs(&rgb8Depth24, &depth16) < glfm__eglScoreAttribs(&rgb8Depth24, &rgb565));
+    const GLFMEGLConfigAttribs depth24Stencil8 = makeAttribs(8, 8, 8, 0, 24, 8, 0);
+    const GLFMEGLConfigAttribs depth16Stencil8 = makeAttribs(8, 8, 8, 0, 16, 8, 0);
+    CHECK(glfm__eglScoreAttribs(&depth24Stencil8, &depth16Stencil8) <
+          glfm__eglScoreAttribs(&depth24Stencil8, &depth32));
+
+    // Caveats
+    GLFMEGLConfigAttribs slow = exact;
+    slow.caveat = EGL_SLOW_CONFIG;
+    GLFMEGLConfigAttribs nonConformant = exact;
+    nonConformant.caveat = EGL_NON_CONFORMANT_CONFIG;
+    CHECK(glfm__eglScoreAttribs(&rgb8Depth24, &slow) > glfm__eglScoreAttribs(&rgb8Depth24, &rgb565));
+    CHECK(glfm__eglScoreAttribs(&rgb8Depth24, &nonConformant) > glfm__eglScoreAttribs(&rgb8Depth24, &depth16));
+    CHECK(glfm__eglScoreAttribs(&rgb8Depth24, &slow) > glfm__eglScoreAttribs(&rgb8Depth24, &nonConformant));
+}
+
+/// Returns the lowest score of all ES 2 configs with the requested surface type.
+static int lowestScore(EGLDisplay eglDisplay, const GLFMEGLConfigAttribs *requested) {
+    EGLConfig configs[512];
+    EGLint count = 0;
+    eglGetConfigs(eglDisplay, configs, 512, &count);
+    int lowest = INT_MAX;
+    for (EGLint i = 0; i < count; i++) {
+        GLFMEGLConfigAttribs actual;
+        EGLint renderableType = 0;
+        glfm__eglGetConfigAttribs(eglDisplay, configs[i], &actual);
+        eglGetConfigAttrib(eglDisplay, configs[i], EGL_RENDERABLE_TYPE, &renderableType);
+        if ((renderableType & EGL_OPENGL_ES2_BIT) != 0 &&
+            (actual.surfaceType & requested->surfaceType) == requested->surfaceType) {
+            int score = glfm__eglScoreAttribs(requested, &actual);
+            if (score < lowest) {
+                lowest = score;
+            }
+        }
+    }
+    return lowest;
+}
+
+static void testChooseBestConfig(EGLDisplay eglDisplay) {
+    static const EGLint requests[][7] = {
+        { 8, 8, 8, 0, 24, 0, 0 },
+        { 8, 8, 8, 8, 24, 8, 0 },
+        { 8, 8, 8, 8, 0, 0, 4 },
+        { 5, 6, 5, 0, 16, 0, 0 },
+    };
+    for (size_t i = 0; i < sizeof(requests) / sizeof(*requests); i++) {
+        const EGLint *r = requests[i];
+        GLFMEGLConfigAttribs requested = makeAttribs(r[0], r[1], r[2], r[3], r[4], r[5], r[6]);
+        EGLConfig config;
+        CHECK(glfm__eglChooseBestConfig(eglDisplay, &requested, &config));
+        CHECK(glfm__eglScoreConfig(eglDisplay, config, &requested) == lowestScore(eglDisplay, &requested));
+    }
+
+    // EGL sorts deeper color first, so the first matching config is often 10-bit. The scored choice is not.
+    GLFMEGLConfigAttribs requested = makeAttribs(8, 8, 8, 0, 24, 0, 0);
+    EGLConfig config;
+    if (glfm__eglChooseBestConfig(eglDisplay, &requested, &config)) {
+        GLFMEGLConfigAttribs actual;
+        glfm__eglGetConfigAttribs(eglDisplay, config, &actual);
+        CHECK(actual.red == 8 && actual.green == 8 && actual.blue == 8);
+        CHECK(actual.depth == 24);
+        CHECK(actual.stencil == 0);
+        CHECK(actual.samples == 0);
+    }
+
+    // No config supports the surface type
+    requested.surfaceType = EGL_PBUFFER_BIT | EGL_MUTABLE_RENDER_BUFFER_BIT_KHR;
+    CHECK(!glfm__eglChooseBestConfig(eglDisplay, &requested, &config));
+}
+
+static void testConfigCache(EGLDisplay eglDisplay) {
+    char path[] = "/tmp/glfm_egl_config_XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    close(fd);
+
+    GLFMEGLConfigAttribs requested = makeAttribs(8, 8, 8, 8, 24, 8, 0);
+    EGLConfig config;
+    CHECK(glfm__eglChooseBestConfig(eglDisplay, &requested, &config));
+    EGLint configID = 0;
+    eglGetConfigAttrib(eglDisplay, config, EGL_CONFIG_ID, &configID);
+
+    // Round trip
+    const uint64_t key = 0x0123456789abcdefull;
+    CHECK(glfm__eglStoreCachedConfig(eglDisplay, path, key, config));
+    EGLConfig cachedConfig = NULL;
+    CHECK(glfm__eglLoadCachedConfig(eglDisplay, path, key, EGL_PBUFFER_BIT, &cachedConfig));
+    EGLint cachedConfigID = -1;
+    eglGetConfigAttrib(eglDisplay, cachedConfig, EGL_CONFIG_ID, &cachedConfigID);
+    CHECK(cachedConfigID == configID);
+
+    // Different key (driver update or different attributes)
+    CHECK(!glfm__eglLoadCachedConfig(eglDisplay, path, key + 1, EGL_PBUFFER_BIT, &cachedConfig));
+
+    // The config doesn't support the required surface type
+    CHECK(!glfm__eglLoadCachedConfig(eglDisplay, path, key, EGL_PBUFFER_BIT | EGL_MUTABLE_RENDER_BUFFER_BIT_KHR,
+                                     &cachedConfig));
+
+    // Config ID that doesn't exist
+    FILE *file = fopen(path, "w");
+    CHECK(file != NULL);
+    if (file) {
+        fprintf(file, "%016llx %i\n", (unsigned long long)key, 999999);
+        fclose(file);
+    }
+    CHECK(!glfm__eglLoadCachedConfig(eglDisplay, path, key, EGL_PBUFFER_BIT, &cachedConfig));
+
+    // Corrupt file
+    file = fopen(path, "w");
+    CHECK(file != NULL);
+    if (file) {
+        fputs("not a config", file);
+        fclose(file);
+    }
+    CHECK(!glfm__eglLoadCachedConfig(eglDisplay, path, key, EGL_PBUFFER_BIT, &cachedConfig));
+
+    // Missing file
+    unlink(path);
+    CHECK(!glfm__eglLoadCachedConfig(eglDisplay, path, key, EGL_PBUFFER_BIT, &cachedConfig));
+}
+
+int main(void) {
+    testScoring();
+
+    EGLDisplay eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, NULL, NULL)) {
+        fprintf(stderr, "Skipped EGL tests: no EGL display\n");
+        return testFailureCount > 0 ? testResult() : TEST_SKIPPED;
+    }
+    // Extensions are matched as whole words
+    CHECK(glfm__eglHasExtension(eglDisplay, "EGL_KHR_fence_sync") ==
+          (strstr(eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_KHR_fence_sync") != NULL));
+    CHECK(!glfm__eglHasExtension(eglDisplay, "EGL_KHR_fence"));
+    testChooseBestConfig(eglDisplay);
+    testConfigCache(eglDisplay);
+    eglTerminate(eglDisplay);
+    return testResult();
+}
@@ -0,0 +1,195 @@
+// Tests the frames-in-flight fence ring (glfm_egl.h) with stubbed EGL_KHR_fence_sync functions. The stubs simulate a
+// GPU that finishes frames in order.
+#include "glfm_egl.h"
+#include "test.h"
+
+#define MAX_STUB_FENCES 64
+
+static struct {
+    bool created[MAX_STUB_FENCES];
+    bool destroyed[MAX_STUB_FENCES];
+    int createCount;
+    int outstandingCount;
+    int maxOutstandingCount;
+    int completedCount; // Fences [0, completedCount) are signaled
+    int blockingWaitCount;
+    bool failCreate;
+} stub;
+
+static int stubIndex(EGLSyncKHR sync) {
+    return (int)(intptr_t)sync - 1;
+}
+
+static EGLSyncKHR EGLAPIENTRY stubCreateSync(EGLDisplay dpy, EGLenum type, const EGLint *attribList) {
+    (void)dpy;
+    (void)attribList;
+    CHECK(type == EGL_SYNC_FENCE_KHR);
+    if (stub.failCreate || stub.createCount >= MAX_STUB_FENCES) {
+        return EGL_NO_SYNC_KHR;
+    }
+    int index = stub.createCount++;
+    stub.created[index] = true;
+    stub.outstandingCount++;
+    if (stub.outstandingCount > stub.maxOutstandingCount) {
+        stub.maxOutstandingCount = stub.outstandingCount;
+    }
+    return (EGLSyncKHR)(intptr_t)(index + 1);
+}
+
+static EGLint EGLAPIENTRY stubClientWaitSync(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags, EGLTimeKHR timeout) {
+    (void)dpy;
+    int index = stubIndex(sync);
+    CHECK(index >= 0 && index < stub.createCount && !stub.destroyed[index]);
+    if (index < stub.completedCount) {
+        return EGL_CONDITION_SATISFIED_KHR;
+    }
+    if (timeout == 0) {
+        return EGL_TIMEOUT_EXPIRED_KHR;
+    }
+    // Blocking wait: the GPU finishes every frame up to and including this one
+    CHECK((flags & EGL_SYNC_FLUSH_COMMANDS_BIT_KHR) != 0);
+    CHECK(timeout == EGL_FOREVER_KHR);
+    stub.blockingWaitCount++;
+    stub.completedCount = index + 1;
+    return EGL_CONDITION_SATISFIED_KHR;
+}
+
+static EGLBoolean EGLAPIENTRY stubDestroySync(EGLDisplay dpy, EGLSyncKHR sync) {
+    (void)dpy;
+    int index = stubIndex(sync);
+    CHECK(index >= 0 && index < stub.createCount);
+    CHECK(!stub.destroyed[index]);
+    stub.destroyed[index] = true;
+    stub.outstandingCount--;
+    return EGL_TRUE;
+}
+
+static void noFenceFuncsInit(void) {
+}
+
+static void installStubs(void) {
+    // Mark the fence functions as loaded, so glfm__eglFenceFuncsLoad() doesn't replace the stubs
+    pthread_once(&glfm__eglFenceFuncs.once, noFenceFuncsInit);
+    glfm__eglFenceFuncs.createSync = stubCreateSync;
+    glfm__eglFenceFuncs.clientWaitSync = stubClientWaitSync;
+    glfm__eglFenceFuncs.destroySync = stubDestroySync;
+}
+
+static void resetStub(void) {
+    memset(&stub, 0, sizeof(stub));
+}
+
+/// Checks that every fence that was created has been destroyed.
+static bool allFencesDestroyed(void) {
+    for (int i = 0; i < stub.createCount; i++) {
+        if (!stub.destroyed[i]) {
+            return false;
+        }
+    }
+    return stub.outstandingCount == 0;
+}
+
+/// Simulates frames where the GPU never catches up on its own: wait, render, swap, insert.
+static void testLimit(int maxFramesInFlight) {
+    resetStub();
+    GLFMEGLFrameFences fences = { 0 };
+    const int frameCount = 20;
+    int waitedCount = 0;
+    for (int frame = 0; frame < frameCount; frame++) {
+        bool waited = glfm__eglFrameFenceWait(EGL_NO_DISPLAY, &fences, maxFramesInFlight);
+        if (waited) {
+            waitedCount++;
+        }
+        CHECK(fences.count < maxFramesInFlight);
+        glfm__eglFrameFenceInsert(EGL_NO_DISPLAY, &fences, maxFramesInFlight);
+        CHECK(fences.count <= maxFramesInFlight);
+        CHECK(fences.count == stub.outstandingCount);
+    }
+    CHECK(stub.createCount == frameCount);
+    CHECK(stub.maxOutstandingCount == maxFramesInFlight);
+    // The first maxFramesInFlight frames don't wait; every frame after that waits for the oldest
+    CHECK(waitedCount == frameCount - maxFramesInFlight);
+    CHECK(stub.blockingWaitCount == waitedCount);
+
+    glfm__eglFrameFencesDestroy(EGL_NO_DISPLAY, &fences);
+    CHECK(fences.count == 0);
+    CHECK(fences.head == 0);
+    CHECK(allFencesDestroyed());
+}
+
+static void testGPUAhead(void) {
+    resetStub();
+    GLFMEGLFrameFences fences = { 0 };
+    const int maxFramesInFlight = 2;
+    for (int frame = 0; frame < 10; frame++) {
+        // The GPU finishes each frame before the next one starts
+        stub.completedCount = stub.createCount;
+        CHECK(!glfm__eglFrameFenceWait(EGL_NO_DISPLAY, &fences, maxFramesInFlight));
+        glfm__eglFrameFenceInsert(EGL_NO_DISPLAY, &fences, maxFramesInFlight);
+    }
+    CHECK(stub.blockingWaitCount == 0);
+    CHECK(fences.count <= maxFramesInFlight);
+    glfm__eglFrameFencesDestroy(EGL_NO_DISPLAY, &fences);
+    CHECK(allFencesDestroyed());
+}
+
+static void testLimitChanges(void) {
+    resetStub();
+    GLFMEGLFrameFences fences = { 0 };
+    for (int frame = 0; frame < 5; frame++) {
+        glfm__eglFrameFenceWait(EGL_NO_DISPLAY, &fences, 3);
+        glfm__eglFrameFenceInsert(EGL_NO_DISPLAY, &fences, 3);
+    }
+    CHECK(fences.count == 3);
+
+    // Lowering the limit drains the ring to below the new limit
+    CHECK(glfm__eglFrameFenceWait(EGL_NO_DISPLAY, &fences, 1));
+    CHECK(fences.count == 0);
+    glfm__eglFrameFenceInsert(EGL_NO_DISPLAY, &fences, 1);
+    CHECK(fences.count == 1);
+
+    // Raising the limit doesn't wait
+    CHECK(!glfm__eglFrameFenceWait(EGL_NO_DISPLAY, &fences, GLFM_EGL_MAX_FRAME_FENCES));
+    for (int frame = 0; frame < GLFM_EGL_MAX_FRAME_FENCES; frame++) {
+        glfm__eglFrameFenceInsert(EGL_NO_DISPLAY, &fences, GLFM_EGL_MAX_FRAME_FENCES);
+    }
+    // The ring never overflows, even if the caller doesn't wait
+    CHECK(fences.count == GLFM_EGL_MAX_FRAME_FENCES);
+    CHECK(stub.outstandingCount == GLFM_EGL_MAX_FRAME_FENCES);
+
+    // Removing the limit destroys all fences without waiting
+    int blockingWaitCount = stub.blockingWaitCount;
+    CHECK(!glfm__eglFrameFenceWait(EGL_NO_DISPLAY, &fences, 0));
+    CHECK(stub.blockingWaitCount == blockingWaitCount);
+    CHECK(fences.count == 0);
+    CHECK(allFencesDestroyed());
+
+    // No fences are inserted without a limit
+    int createCount = stub.createCount;
+    glfm__eglFrameFenceInsert(EGL_NO_DISPLAY, &fences, 0);
+    CHECK(stub.createCount == createCount);
+    CHECK(fences.count == 0);
+}
+
+static void testCreateFailure(void) {
+    resetStub();
+    GLFMEGLFrameFences fences = { 0 };
+    stub.failCreate = true;
+    for (int frame = 0; frame < 5; frame++) {
+        CHECK(!glfm__eglFrameFenceWait(EGL_NO_DISPLAY, &fences, 2));
+        glfm__eglFrameFenceInsert(EGL_NO_DISPLAY, &fences, 2);
+        CHECK(fences.count == 0);
+    }
+}
+
+int main(void) {
+    installStubs();
+    CHECK(glfm__eglFenceFuncsLoad());
+    for (int maxFramesInFlight = 1; maxFramesInFlight <= GLFM_EGL_MAX_FRAME_FENCES; maxFramesInFlight++) {
+        testLimit(maxFramesInFlight);
+    }
+    testGPUAhead();
+    testLimitChanges();
+    testCreateFailure();
+    return testResult();
+}
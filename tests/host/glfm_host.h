@@ -0,0 +1,145 @@
+#ifndef GLFM_HOST_H
+#define GLFM_HOST_H
+
+// A minimal host "backend" for tests of the shared implementation in glfm_internal.h. Tests are compiled with
+// __ANDROID__ defined (using the stand-in headers in include/), so they run the same code paths as the Android backend,
+// with Mesa's headless EGL instead of a window.
+//
+// Include this header in exactly one source file of a test.
+
+#include "glfm_internal.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifndef EGL_CONTEXT_OPENGL_DEBUG
+#define EGL_CONTEXT_OPENGL_DEBUG 0x31B0
+#endif
+
+// MARK: - Platform functions
+
+/// Messages sent to glfm__logMessage, for tests that check logging.
+static int glfmHostLogCount = 0;
+
+/// Assets mapped with glfm__mapPlatformAsset (relative paths), for tests that check how often assets are read.
+static atomic_int glfmHostAssetMapCount = 0;
+
+/// The number of worker threads for job pools created after it is set. If negative, the number of CPUs is used.
+static int glfmHostWorkerCount = -1;
+
+static void glfm__displayChromeUpdated(GLFMDisplay *display) {
+    (void)display;
+}
+
+static void glfm__sensorFuncUpdated(GLFMDisplay *display) {
+    (void)display;
+}
+
+static int glfm__getPreferredWorkerCount(void) {
+    if (glfmHostWorkerCount >= 0) {
+        return glfmHostWorkerCount;
+    }
+    long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpuCount > 1 ? (int)cpuCount : 1;
+}
+
+static const char *glfm__getCacheDirectory(GLFMDisplay *display) {
+    (void)display;
+    return "/tmp";
+}
+
+static void glfm__logMessage(const char *message) {
+    glfmHostLogCount++;
+    printf("%s\n", message);
+}
+
+// Assets are relative to the working directory
+static bool glfm__mapPlatformAsset(GLFMDisplay *display, const char *path, GLFMAssetMapping *mapping) {
+    (void)display;
+    atomic_fetch_add(&glfmHostAssetMapCount, 1);
+    return glfm__mapFile(path, mapping);
+}
+
+static void glfm__releasePlatformAsset(void *platformAsset) {
+    (void)platformAsset;
+}
+
+// MARK: - GLFM public functions
+
+double glfmGetTime(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+GLFMProc glfmGetProcAddress(const char *functionName) {
+    return eglGetProcAddress(functionName);
+}
+
+GLFMRenderingAPI glfmGetRenderingAPI(const GLFMDisplay *display) {
+    (void)display;
+    return GLFMRenderingAPIOpenGLES3;
+}
+
+void glfmSetRenderScale(GLFMDisplay *display, double renderScale) {
+    (void)display;
+    (void)renderScale;
+}
+
+void glfmSetSupportedInterfaceOrientation(GLFMDisplay *display, GLFMInterfaceOrientation supportedOrientations) {
+    (void)display;
+    (void)supportedOrientations;
+}
+
+void glfmSwapBuffers(GLFMDisplay *display) {
+    (void)display;
+}
+
+// MARK: - Headless context
+
+/// Creates an OpenGL ES 3 context without a surface, and makes it current. Returns `false` if EGL or
+/// `EGL_KHR_surfaceless_context` is not available.
+static bool glfmHostCreateContext(bool debug) {
+    EGLDisplay eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, NULL, NULL)) {
+        return false;
+    }
+    const char *extensions = eglQueryString(eglDisplay, EGL_EXTENSIONS);
+    if (!extensions || !strstr(extensions, "EGL_KHR_surfaceless_context")) {
+        return false;
+    }
+    // Any surface type (the default is EGL_WINDOW_BIT, which surfaceless configs lack)
+    const EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT, EGL_SURFACE_TYPE, 0, EGL_NONE };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(eglDisplay, configAttribs, &config, 1, &numConfigs) || numConfigs != 1) {
+        return false;
+    }
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_CLIENT_VERSION, 3,
+        EGL_CONTEXT_OPENGL_DEBUG, debug ? EGL_TRUE : EGL_FALSE,
+        EGL_NONE
+    };
+    if (!eglBindAPI(EGL_OPENGL_ES_API)) {
+        return false;
+    }
+    EGLContext context = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        return false;
+    }
+    return eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+}
+
+/// Destroys the current context.
+static void glfmHostDestroyContext(void) {
+    EGLDisplay eglDisplay = eglGetCurrentDisplay();
+    EGLContext context = eglGetCurrentContext();
+    if (eglDisplay != EGL_NO_DISPLAY && context != EGL_NO_CONTEXT) {
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(eglDisplay, context);
+        eglTerminate(eglDisplay);
+    }
+}
+
+#endif
@@ -0,0 +1,86 @@
+// Heightmap generator benchmark (examples/heightmap_generator.c) without a display. Measures samples per second for
+// maps up to 4096x4096, generated on the calling thread only and then split across GLFM's worker threads, and checks
+// that both generate the same heights.
+//
+// Usage: heightmap_bench [sideTileCount ...]
+//
+// Returns 1 if the serial and parallel results differ.
+#include <stdlib.h>
+#include "glfm_host.h"
+#include "heightmap_generator.h"
+
+#define BENCH_MIN_DURATION 0.25
+
+static const int BENCH_SIZES[] = { 256, 1024, 4096 };
+#define BENCH_SIZE_COUNT ((int)(sizeof(BENCH_SIZES) / sizeof(BENCH_SIZES[0])))
+
+static uint32_t heightmapChecksum(const Heightmap *heightmap) {
+    uint32_t checksum = 0;
+    size_t count = (size_t)heightmap->sideVertexCount * (size_t)heightmap->sideVertexCount;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits;
+        memcpy(&bits, &heightmap->heights[i], sizeof(bits));
+        checksum = (checksum ^ bits) * 16777619u;
+    }
+    return checksum;
+}
+
+static bool dispatchJob(void *dispatchData, void (*job)(void *jobData), void *jobData) {
+    return glfmDispatchAsync((GLFMDisplay *)dispatchData, job, NULL, jobData);
+}
+
+// Returns millions of samples per second. Generates at least once, and repeats until BENCH_MIN_DURATION has passed.
+static double runGenerator(Heightmap *heightmap, const HeightmapDispatcher *dispatcher, uint32_t *checksum) {
+    double sampleCount = (double)heightmap->sideVertexCount * (double)heightmap->sideVertexCount;
+    double startTime = glfmGetTime();
+    double duration;
+    int iterations = 0;
+    do {
+        heightmapGenerate(heightmap, 1, 1.0f, dispatcher);
+        iterations++;
+        duration = glfmGetTime() - startTime;
+    } while (duration < BENCH_MIN_DURATION);
+    *checksum = heightmapChecksum(heightmap);
+    return duration > 0.0 ? (sampleCount * iterations / duration) / 1000000.0 : 0.0;
+}
+
+// Returns false if the serial and parallel results differ.
+static bool runSize(GLFMDisplay *display, int sideTileCount) {
+    Heightmap heightmap;
+    if (!heightmapInit(&heightmap, sideTileCount)) {
+        printf("%ix%i: Couldn't allocate heightmap\n", sideTileCount, sideTileCount);
+        return false;
+    }
+    const HeightmapDispatcher dispatcher = { dispatchJob, display, glfmGetWorkerCount(display) };
+    uint32_t serialChecksum, parallelChecksum;
+    double serial = runGenerator(&heightmap, NULL, &serialChecksum);
+    double parallel = runGenerator(&heightmap, &dispatcher, &parallelChecksum);
+    bool match = serialChecksum == parallelChecksum;
+    printf("%ix%i: %.1f Msamples/s serial, %.1f Msamples/s parallel (%.2fx)%s\n",
+           sideTileCount, sideTileCount, serial, parallel, serial > 0.0 ? parallel / serial : 0.0,
+           match ? "" : " MISMATCH");
+    heightmapFree(&heightmap);
+    return match;
+}
+
+int main(int argc, char *argv[]) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    // The display is only used for its job pool
+    GLFMDisplay *display = calloc(1, sizeof(GLFMDisplay));
+    if (!display) {
+        return 1;
+    }
+    printf("Workers: %i\n", glfmGetWorkerCount(display));
+    bool success = true;
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            success &= runSize(display, atoi(argv[i]));
+        }
+    } else {
+        for (int i = 0; i < BENCH_SIZE_COUNT; i++) {
+            success &= runSize(display, BENCH_SIZES[i]);
+        }
+    }
+    // Worker threads exist for the lifetime of the process, like on Android
+    return success ? 0 : 1;
+}
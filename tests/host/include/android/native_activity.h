@@ -0,0 +1,7 @@
+// Stand-in for the NDK header, so that glfm.h can be included on a host with __ANDROID__ defined. See glfm_host.h.
+#ifndef GLFM_HOST_NATIVE_ACTIVITY_H
+#define GLFM_HOST_NATIVE_ACTIVITY_H
+
+typedef struct ANativeActivity ANativeActivity;
+
+#endif
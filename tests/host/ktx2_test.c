@@ -0,0 +1,417 @@
+// Tests the KTX2 parser and the mip level upload scheduler (examples/ktx2.c) with containers built in memory.
+#include <stdlib.h>
+#include <string.h>
+#include "ktx2.h"
+#include "test.h"
+
+#define VK_FORMAT_R8G8B8A8_UNORM 37
+#define VK_FORMAT_BC1_RGB_UNORM_BLOCK 131
+#define VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK 151
+#define VK_FORMAT_ASTC_6x5_UNORM_BLOCK 163
+
+#define KTX2_SUPERCOMPRESSION_BASISLZ 1
+#define KTX2_SUPERCOMPRESSION_ZSTD 2
+
+#define MAX_FILE_SIZE (64 * 1024)
+
+typedef struct {
+    uint32_t vkFormat;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount; // 0 stores one level
+    uint32_t supercompressionScheme;
+} Ktx2Desc;
+
+static Ktx2Desc makeDesc(uint32_t vkFormat, uint32_t width, uint32_t height, uint32_t levelCount) {
+    Ktx2Desc desc = {
+        .vkFormat = vkFormat, .width = width, .height = height, .depth = 0,
+        .layerCount = 0, .faceCount = 1, .levelCount = levelCount, .supercompressionScheme = 0,
+    };
+    return desc;
+}
+
+static void writeU32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static void writeU64(uint8_t *p, uint64_t value) {
+    writeU32(p, (uint32_t)value);
+    writeU32(p + 4, (uint32_t)(value >> 32));
+}
+
+/// Writes a KTX2 container: header, level index, a minimal DFD, then the levels (smallest first, as in KTX2 files).
+/// Each level's bytes are filled with (level + 1). Returns the file size.
+static size_t buildKtx2(uint8_t *file, const Ktx2Desc *desc) {
+    static const uint8_t identifier[12] = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+    };
+    const uint32_t storedLevelCount = desc->levelCount == 0 ? 1 : desc->levelCount;
+    const uint32_t indexOffset = 80;
+    const uint32_t dfdOffset = indexOffset + 24 * storedLevelCount;
+    const uint32_t dfdLength = 4;
+
+    memset(file, 0, MAX_FILE_SIZE);
+    memcpy(file, identifier, sizeof(identifier));
+    writeU32(file + 12, desc->vkFormat);
+    writeU32(file + 16, 1); // typeSize
+    writeU32(file + 20, desc->width);
+    writeU32(file + 24, desc->height);
+    writeU32(file + 28, desc->depth);
+    writeU32(file + 32, desc->layerCount);
+    writeU32(file + 36, desc->faceCount);
+    writeU32(file + 40, desc->levelCount);
+    writeU32(file + 44, desc->supercompressionScheme);
+    writeU32(file + 48, dfdOffset);
+    writeU32(file + 52, dfdLength);
+    writeU32(file + dfdOffset, dfdLength);
+
+    // Use the first supported format's block size for unsupported formats, so the rest of the file is well formed
+    const Ktx2Format *format = ktx2GetFormat(desc->vkFormat);
+    if (!format) {
+        format = ktx2GetFormat(VK_FORMAT_R8G8B8A8_UNORM);
+    }
+    size_t offset = dfdOffset + dfdLength;
+    for (int i = (int)storedLevelCount - 1; i >= 0; i--) {
+        uint32_t width = desc->width >> i ? desc->width >> i : 1;
+        uint32_t height = desc->height >> i ? desc->height >> i : 1;
+        size_t size = ktx2GetLevelSize(format, width, height);
+        if (offset + size > MAX_FILE_SIZE) {
+            return 0;
+        }
+        uint8_t *entry = file + indexOffset + 24 * (uint32_t)i;
+        writeU64(entry, offset);
+        writeU64(entry + 8, size);
+        writeU64(entry + 16, size);
+        memset(file + offset, i + 1, size);
+        offset += size;
+    }
+    return offset;
+}
+
+// MARK: - Parsing
+
+static void testValid(void) {
+    static uint8_t file[MAX_FILE_SIZE];
+    Ktx2Texture texture;
+
+    // RGBA8 with a full mip chain
+    Ktx2Desc desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 16, 8, 5);
+    size_t size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultOK);
+    CHECK(texture.format == ktx2GetFormat(VK_FORMAT_R8G8B8A8_UNORM));
+    CHECK(texture.width == 16 && texture.height == 8);
+    CHECK(texture.levelCount == 5);
+    static const uint32_t expectedSizes[5][3] = {
+        { 16, 8, 512 }, { 8, 4, 128 }, { 4, 2, 32 }, { 2, 1, 8 }, { 1, 1, 4 }
+    };
+    for (uint32_t i = 0; i < texture.levelCount; i++) {
+        const Ktx2Level *level = &texture.levels[i];
+        CHECK(level->width == expectedSizes[i][0]);
+        CHECK(level->height == expectedSizes[i][1]);
+        CHECK(level->size == expectedSizes[i][2]);
+        CHECK(level->data >= file && level->data + level->size <= file + size);
+        CHECK(level->data[0] == i + 1 && level->data[level->size - 1] == i + 1);
+    }
+
+    // Block-compressed, not a multiple of the block size: 10x6 is 3x2 blocks, 5x3 is 2x1, 2x1 is 1x1
+    desc = makeDesc(VK_FORMAT_BC1_RGB_UNORM_BLOCK, 10, 6, 3);
+    size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultOK);
+    CHECK(texture.levels[0].size == 3 * 2 * 8);
+    CHECK(texture.levels[1].size == 2 * 1 * 8);
+    CHECK(texture.levels[2].size == 1 * 1 * 8);
+
+    // ASTC with non-square blocks
+    desc = makeDesc(VK_FORMAT_ASTC_6x5_UNORM_BLOCK, 13, 11, 1);
+    size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultOK);
+    CHECK(texture.levels[0].size == 3 * 3 * 16);
+
+    // A level count of 0 stores one level
+    desc = makeDesc(VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, 8, 8, 0);
+    size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultOK);
+    CHECK(texture.levelCount == 1);
+
+    // A layer count of 1 is a non-array texture
+    desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 4, 4, 1);
+    desc.layerCount = 1;
+    size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultOK);
+}
+
+static void testTruncated(void) {
+    static uint8_t file[MAX_FILE_SIZE];
+    Ktx2Texture texture;
+    Ktx2Desc desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 16, 8, 5);
+    size_t size = buildKtx2(file, &desc);
+
+    // Every prefix is rejected. The levels are at the end of the file, so any cut truncates one of them.
+    for (size_t length = 0; length < size; length++) {
+        Ktx2Result result = ktx2Parse(file, length, &texture);
+        if (length < 12) {
+            CHECK(result == Ktx2ResultInvalid);
+        } else {
+            CHECK(result == Ktx2ResultTruncated);
+        }
+        CHECK(texture.levelCount == 0);
+    }
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultOK);
+
+    // A level that points past the end of the file
+    writeU64(file + 80, size);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultTruncated);
+    writeU64(file + 80, UINT64_MAX - 8);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultTruncated);
+
+    // A DFD past the end of the file
+    size = buildKtx2(file, &desc);
+    writeU32(file + 52, (uint32_t)size);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultTruncated);
+}
+
+static void testInvalid(void) {
+    static uint8_t file[MAX_FILE_SIZE];
+    Ktx2Texture texture;
+    Ktx2Desc desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 16, 8, 5);
+    size_t size = buildKtx2(file, &desc);
+
+    CHECK(ktx2Parse(NULL, size, &texture) == Ktx2ResultInvalid);
+
+    file[5] ^= 0xff;
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultInvalid);
+    file[5] ^= 0xff;
+
+    // Level size doesn't match the format and dimensions
+    writeU64(file + 80 + 8, 511);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultInvalid);
+
+    // More levels than the dimensions allow
+    desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 16, 8, 6);
+    size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultInvalid);
+
+    // Zero width
+    desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 0, 8, 1);
+    size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultInvalid);
+}
+
+static void testUnsupported(void) {
+    static uint8_t file[MAX_FILE_SIZE];
+    Ktx2Texture texture;
+
+    // Supercompression is rejected before anything else is checked, including the format
+    static const uint32_t schemes[] = { KTX2_SUPERCOMPRESSION_BASISLZ, KTX2_SUPERCOMPRESSION_ZSTD, 3 };
+    for (size_t i = 0; i < sizeof(schemes) / sizeof(*schemes); i++) {
+        Ktx2Desc desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 16, 8, 5);
+        desc.supercompressionScheme = schemes[i];
+        size_t size = buildKtx2(file, &desc);
+        CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultSupercompressed);
+        CHECK(texture.levelCount == 0);
+
+        desc.vkFormat = 0; // VK_FORMAT_UNDEFINED, as in Basis Universal files
+        size = buildKtx2(file, &desc);
+        CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultSupercompressed);
+    }
+
+    Ktx2Desc desc = makeDesc(0, 16, 8, 1);
+    size_t size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultUnsupportedFormat);
+    CHECK(ktx2GetFormat(0) == NULL);
+
+    // 1D, 3D, array, and cube map textures
+    desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 16, 0, 1);
+    size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultUnsupportedLayout);
+    desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 16, 8, 1);
+    desc.depth = 4;
+    size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultUnsupportedLayout);
+    desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 16, 8, 1);
+    desc.layerCount = 2;
+    size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultUnsupportedLayout);
+    desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 16, 16, 1);
+    desc.faceCount = 6;
+    size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultUnsupportedLayout);
+
+    for (int result = Ktx2ResultOK; result <= Ktx2ResultSupercompressed; result++) {
+        const char *string = ktx2ResultString((Ktx2Result)result);
+        CHECK(string != NULL && string[0] != '\0');
+    }
+}
+
+// MARK: - Upload scheduling
+
+#define MAX_CHUNKS 256
+
+typedef struct {
+    Ktx2UploadCursor *cursor;
+    Ktx2UploadChunk chunk;
+} RecordedChunk;
+
+typedef struct {
+    RecordedChunk chunks[MAX_CHUNKS];
+    int count;
+} ChunkLog;
+
+static void recordChunk(void *userData, Ktx2UploadCursor *cursor, const Ktx2UploadChunk *chunk) {
+    ChunkLog *log = userData;
+    CHECK(log->count < MAX_CHUNKS);
+    if (log->count < MAX_CHUNKS) {
+        log->chunks[log->count].cursor = cursor;
+        log->chunks[log->count].chunk = *chunk;
+        log->count++;
+    }
+}
+
+/// Runs frames until every cursor is complete. Checks the per-frame budget, and that each texture's chunks are in
+/// order (smallest level first, top to bottom within a level) and cover every level exactly once.
+static int runFrames(Ktx2UploadCursor *const *cursors, int cursorCount, size_t budget, ChunkLog *log) {
+    int frameCount = 0;
+    bool complete = false;
+    while (!complete && frameCount < 1000) {
+        int firstChunk = log->count;
+        size_t scheduled = ktx2ScheduleUploads(cursors, cursorCount, budget, recordChunk, log);
+        frameCount++;
+
+        size_t sum = 0;
+        for (int i = firstChunk; i < log->count; i++) {
+            sum += log->chunks[i].chunk.size;
+        }
+        CHECK(sum == scheduled);
+        CHECK(scheduled > 0);
+        // Over budget only if a single chunk didn't fit (forced, so uploads make progress)
+        CHECK(scheduled <= budget || log->count - firstChunk == 1);
+
+        complete = true;
+        for (int i = 0; i < cursorCount; i++) {
+            if (cursors[i] && !cursors[i]->complete) {
+                complete = false;
+            }
+        }
+    }
+    CHECK(complete);
+
+    for (int c = 0; c < cursorCount; c++) {
+        Ktx2UploadCursor *cursor = cursors[c];
+        if (!cursor) {
+            continue;
+        }
+        const Ktx2Texture *texture = cursor->texture;
+        int level = (int)texture->levelCount - 1;
+        size_t levelOffset = 0;
+        bool textureComplete = false;
+        for (int i = 0; i < log->count; i++) {
+            if (log->chunks[i].cursor != cursor) {
+                continue;
+            }
+            const Ktx2UploadChunk *chunk = &log->chunks[i].chunk;
+            CHECK(!textureComplete);
+            CHECK(level >= 0 && chunk->level == (uint32_t)level);
+            if (level < 0 || chunk->level != (uint32_t)level) {
+                break;
+            }
+            const Ktx2Level *expected = &texture->levels[level];
+            CHECK(chunk->width == expected->width);
+            CHECK(chunk->data == expected->data + levelOffset);
+            CHECK(chunk->y < expected->height && chunk->y + chunk->height <= expected->height);
+            levelOffset += chunk->size;
+            CHECK(chunk->levelComplete == (levelOffset == expected->size));
+            if (chunk->levelComplete) {
+                CHECK(chunk->y + chunk->height == expected->height);
+                textureComplete = chunk->textureComplete;
+                CHECK(textureComplete == (level == 0));
+                level--;
+                levelOffset = 0;
+            }
+        }
+        CHECK(textureComplete);
+    }
+    return frameCount;
+}
+
+static void testSchedule(void) {
+    static uint8_t file[MAX_FILE_SIZE];
+    static uint8_t file2[MAX_FILE_SIZE];
+    Ktx2Texture texture;
+    Ktx2Texture texture2;
+    Ktx2UploadCursor cursor;
+    Ktx2UploadCursor cursor2;
+    static ChunkLog log;
+
+    // Level sizes: 512, 128, 32, 8, 4
+    Ktx2Desc desc = makeDesc(VK_FORMAT_R8G8B8A8_UNORM, 16, 8, 5);
+    size_t size = buildKtx2(file, &desc);
+    CHECK(ktx2Parse(file, size, &texture) == Ktx2ResultOK);
+    Ktx2UploadCursor *cursors[] = { &cursor };
+
+    // Unlimited budget: every level in one frame, smallest first
+    memset(&log, 0, sizeof(log));
+    ktx2UploadCursorInit(&cursor, &texture, false);
+    CHECK(runFrames(cursors, 1, SIZE_MAX, &log) == 1);
+    CHECK(log.count == 5);
+
+    // Whole levels with a 64-byte budget: 4 + 8 + 32, then 128 (forced), then 512 (forced)
+    memset(&log, 0, sizeof(log));
+    ktx2UploadCursorInit(&cursor, &texture, false);
+    CHECK(runFrames(cursors, 1, 64, &log) == 3);
+    CHECK(log.count == 5);
+    CHECK(log.chunks[3].chunk.size == 128 && log.chunks[4].chunk.size == 512);
+
+    // Split levels with a 64-byte budget: no frame goes over budget, since one block row (64 bytes) always fits
+    memset(&log, 0, sizeof(log));
+    ktx2UploadCursorInit(&cursor, &texture, true);
+    // Frames: 4 + 8 + 32, then two rows of 32 per frame (level 1), then one row of 64 per frame (level 0)
+    CHECK(runFrames(cursors, 1, 64, &log) == 1 + 2 + 8);
+    for (int i = 0; i < log.count; i++) {
+        CHECK(log.chunks[i].chunk.size <= 64);
+    }
+
+    // Split levels of a block-compressed texture, with a budget smaller than one block row (forced, one row at a time)
+    desc = makeDesc(VK_FORMAT_BC1_RGB_UNORM_BLOCK, 32, 32, 6);
+    size = buildKtx2(file2, &desc);
+    CHECK(ktx2Parse(file2, size, &texture2) == Ktx2ResultOK);
+    memset(&log, 0, sizeof(log));
+    ktx2UploadCursorInit(&cursor2, &texture2, true);
+    Ktx2UploadCursor *cursors2[] = { &cursor2 };
+    runFrames(cursors2, 1, 1, &log);
+    for (int i = 0; i < log.count; i++) {
+        CHECK(log.chunks[i].chunk.height <= 4 || log.chunks[i].chunk.levelComplete);
+    }
+
+    // Two textures, and a NULL cursor. When the first texture's next level doesn't fit, the second texture's small
+    // levels use the rest of the budget.
+    memset(&log, 0, sizeof(log));
+    ktx2UploadCursorInit(&cursor, &texture, false);
+    ktx2UploadCursorInit(&cursor2, &texture2, false);
+    Ktx2UploadCursor *both[] = { &cursor, NULL, &cursor2 };
+    // First frame: 4 + 8 + 32 from the first texture, then 8 + 8 from the second (its 1x1 and 2x2 levels)
+    CHECK(ktx2ScheduleUploads(both, 3, 64, recordChunk, &log) == 60);
+    CHECK(log.count == 5);
+    CHECK(log.chunks[2].cursor == &cursor && log.chunks[2].chunk.level == 2);
+    CHECK(log.chunks[3].cursor == &cursor2 && log.chunks[3].chunk.level == 5);
+    CHECK(log.chunks[4].cursor == &cursor2 && log.chunks[4].chunk.level == 4);
+    runFrames(both, 3, 64, &log);
+
+    // Complete cursors are skipped
+    size_t scheduled = ktx2ScheduleUploads(both, 3, 64, recordChunk, &log);
+    CHECK(scheduled == 0);
+}
+
+int main(void) {
+    testValid();
+    testTruncated();
+    testInvalid();
+    testUnsupported();
+    testSchedule();
+    return testResult();
+}
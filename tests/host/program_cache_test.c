@@ -0,0 +1,76 @@
+// Tests glfmCreateProgram and glfmCreateProgramWithSourceLengths with a headless OpenGL ES context: source that isn't
+// null-terminated, and cache keys that match for both functions. Run with EGL_PLATFORM=surfaceless.
+#include "glfm_host.h"
+#include "test.h"
+
+#define TEST_SKIPPED 77
+
+static const char *const VERTEX_SHADER =
+    "attribute highp vec4 position;\n"
+    "void main() {\n"
+    "   gl_Position = position;\n"
+    "}\n";
+
+static const char *const FRAGMENT_SHADER =
+    "void main() {\n"
+    "    gl_FragColor = vec4(1.0);\n"
+    "}\n";
+
+int main(void) {
+    if (!glfmHostCreateContext(false)) {
+        printf("Skipped: Couldn't create a headless OpenGL ES context\n");
+        return TEST_SKIPPED;
+    }
+    GLFMDisplay *display = calloc(1, sizeof(GLFMDisplay));
+    static const char *const attributeNames[] = { "position" };
+    GLFMProgramCacheStats stats;
+
+    // A unique comment, so an earlier run's cache entry isn't used
+    char vertexSource[512];
+    snprintf(vertexSource, sizeof(vertexSource), "// %f\n%s", glfmGetTime(), VERTEX_SHADER);
+    size_t vertexLength = strlen(vertexSource);
+
+    // Not null-terminated: the bytes after the length aren't valid GLSL
+    char mapped[512];
+    memset(mapped, '@', sizeof(mapped));
+    memcpy(mapped, vertexSource, vertexLength);
+    const size_t fragmentOffset = 256;
+    size_t fragmentLength = strlen(FRAGMENT_SHADER);
+    memcpy(mapped + fragmentOffset, FRAGMENT_SHADER, fragmentLength);
+
+    GLuint program = glfmCreateProgramWithSourceLengths(display, mapped, vertexLength, mapped + fragmentOffset,
+                                                        fragmentLength, attributeNames, 1);
+    CHECK(program != 0);
+    glfmGetProgramCacheStats(display, &stats);
+    CHECK(stats.hitCount == 0);
+    CHECK(stats.missCount == 1);
+    glDeleteProgram(program);
+
+    // The same source, null-terminated
+    program = glfmCreateProgram(display, vertexSource, FRAGMENT_SHADER, attributeNames, 1);
+    CHECK(program != 0);
+    glfmGetProgramCacheStats(display, &stats);
+    if (display->programCache.programBinary) {
+        CHECK(stats.hitCount == 1);
+        CHECK(stats.missCount == 1);
+    } else {
+        printf("Program binaries not supported; cache hits not checked\n");
+        CHECK(stats.missCount == 2);
+    }
+    glDeleteProgram(program);
+
+    // Invalid arguments
+    CHECK(glfmCreateProgramWithSourceLengths(display, NULL, 0, FRAGMENT_SHADER, fragmentLength, NULL, 0) == 0);
+    CHECK(glfmCreateProgramWithSourceLengths(display, mapped, vertexLength, mapped + fragmentOffset,
+                                             fragmentLength, NULL, 1) == 0);
+
+    // A length that cuts the source short doesn't compile
+    glfmHostLogCount = 0;
+    CHECK(glfmCreateProgramWithSourceLengths(display, mapped, vertexLength - 4, mapped + fragmentOffset,
+                                             fragmentLength, attributeNames, 1) == 0);
+    CHECK(glfmHostLogCount > 0);
+
+    free(display);
+    glfmHostDestroyContext();
+    return testResult();
+}
@@ -0,0 +1,26 @@
+#ifndef GLFM_HOST_TEST_H
+#define GLFM_HOST_TEST_H
+
+#include <stdio.h>
+
+// Minimal test helpers. A test's main() returns testResult().
+
+static int testFailureCount = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #condition); \
+        testFailureCount++; \
+    } \
+} while (0)
+
+static int testResult(void) {
+    if (testFailureCount > 0) {
+        fprintf(stderr, "%d check(s) failed\n", testFailureCount);
+        return 1;
+    }
+    printf("Passed\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,113 @@
+// Draws the test pattern (examples/test_pattern_draw.c) with the software renderer, and compares the frame with the
+// golden images in golden/.
+//
+// Usage: test_pattern_test [--update]
+//
+// With --update, the golden images are rewritten instead. Check the new images before committing them.
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_pattern_renderer.h"
+#include "test.h"
+
+#ifndef GOLDEN_DIR
+#error GOLDEN_DIR must be defined
+#endif
+
+typedef struct {
+    const char *name;
+    int width;
+    int height;
+    double top, right, bottom, left;
+} TestPatternCase;
+
+static const TestPatternCase CASES[] = {
+    { "test_pattern_64x48.ppm", 64, 48, 6, 4, 3, 5 },
+    { "test_pattern_33x17_no_insets.ppm", 33, 17, 0, 0, 0, 0 },
+};
+
+/// Reads a whole file. Returns NULL on failure.
+static uint8_t *readFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    uint8_t *data = NULL;
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    if (length >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)length + 1);
+        if (data && fread(data, 1, (size_t)length, file) != (size_t)length) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+    *size = (size_t)length;
+    return data;
+}
+
+static void testCase(const TestPatternCase *testCase, bool update) {
+    Renderer *renderer = createRendererSoftware();
+    CHECK(renderer != NULL);
+    if (!renderer) {
+        return;
+    }
+    Texture texture = testPatternCreateTexture(renderer, (uint32_t)testCase->width, (uint32_t)testCase->height,
+                                               testCase->top, testCase->right, testCase->bottom, testCase->left);
+    CHECK(texture != NULL_TEXTURE);
+    testPatternDraw(renderer, texture, testCase->width, testCase->height);
+    renderer->textureDestroy(renderer, texture);
+
+    // One quad covering every pixel once
+    const RendererSoftwareStats *stats = rendererSoftwareGetStats(renderer);
+    CHECK(stats->frameCount == 1);
+    CHECK(stats->quadCount == 1);
+    CHECK(stats->pixelCount == (uint64_t)testCase->width * (uint64_t)testCase->height);
+
+    char goldenPath[1024];
+    snprintf(goldenPath, sizeof(goldenPath), "%s/%s", GOLDEN_DIR, testCase->name);
+    if (update) {
+        CHECK(rendererSoftwareWritePPM(renderer, goldenPath));
+        printf("Updated %s\n", goldenPath);
+        renderer->destroy(renderer);
+        return;
+    }
+
+    char actualPath[] = "/tmp/glfm_test_pattern_XXXXXX";
+    int fd = mkstemp(actualPath);
+    CHECK(fd >= 0);
+    if (fd >= 0) {
+        close(fd);
+        CHECK(rendererSoftwareWritePPM(renderer, actualPath));
+        size_t goldenSize = 0;
+        size_t actualSize = 0;
+        uint8_t *golden = readFile(goldenPath, &goldenSize);
+        uint8_t *actual = readFile(actualPath, &actualSize);
+        CHECK(golden != NULL);
+        CHECK(actual != NULL);
+        if (golden && actual) {
+            bool match = goldenSize == actualSize && memcmp(golden, actual, goldenSize) == 0;
+            if (!match) {
+                fprintf(stderr, "%s: Frame differs from the golden image. Actual frame: %s\n", testCase->name,
+                        actualPath);
+            } else {
+                unlink(actualPath);
+            }
+            CHECK(match);
+        }
+        free(golden);
+        free(actual);
+    }
+    renderer->destroy(renderer);
+}
+
+int main(int argc, char *argv[]) {
+    bool update = argc > 1 && strcmp(argv[1], "--update") == 0;
+    for (size_t i = 0; i < sizeof(CASES) / sizeof(*CASES); i++) {
+        testCase(&CASES[i], update);
+    }
+    return testResult();
+}